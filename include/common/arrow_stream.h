@@ -0,0 +1,68 @@
+#ifndef ATC_ARROW_STREAM_H
+#define ATC_ARROW_STREAM_H
+
+#include <cstddef>
+#include <cstdint>
+#include <ostream>
+#include <string>
+#include <vector>
+
+namespace atc {
+
+// Minimal Arrow IPC stream writer (columnar format v5, little endian, no nulls).
+// Flatbuffer metadata is encoded by hand; column buffers are written straight
+// from the caller's memory.
+class ArrowStreamWriter {
+public:
+    enum class Type {
+        INT64,
+        TIMESTAMP_MS,     // int64 milliseconds since epoch, UTC
+        FLOAT64,
+        UINT8,
+        UTF8,
+        DICTIONARY_UTF8   // int32 indices into a dictionary batch
+    };
+
+    struct Field {
+        std::string name;
+        Type type;
+    };
+
+    // Values of one column in a batch. Fixed-width and dictionary columns only
+    // use values; UTF8 columns also need rows + 1 offsets starting at 0.
+    struct Column {
+        const void* values;
+        const int32_t* offsets;
+    };
+
+    explicit ArrowStreamWriter(std::ostream& out);
+
+    bool writeSchema(const std::vector<Field>& fields);
+
+    // Sets (or replaces) the dictionary of a DICTIONARY_UTF8 field
+    bool writeDictionary(size_t field, const std::vector<std::string>& values);
+
+    bool writeBatch(size_t rows, const std::vector<Column>& columns);
+
+    // End-of-stream marker
+    bool finish();
+
+    uint64_t getBytesWritten() const { return bytes_written_; }
+
+private:
+    struct Buffer {
+        const void* data;
+        uint64_t length;
+    };
+
+    bool writeMessage(const std::vector<uint8_t>& metadata, const std::vector<Buffer>& body);
+    void write(const void* data, size_t size);
+
+    std::ostream& out_;
+    std::vector<Field> fields_;
+    uint64_t bytes_written_;
+};
+
+} // namespace atc
+
+#endif // ATC_ARROW_STREAM_H
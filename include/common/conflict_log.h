@@ -0,0 +1,72 @@
+#ifndef ATC_CONFLICT_LOG_H
+#define ATC_CONFLICT_LOG_H
+
+#include "common/types.h"
+#include <cstdint>
+#include <fstream>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace atc {
+
+enum class ConflictKind : uint8_t {
+    VIOLATION,
+    CRITICAL_WARNING,
+    MEDIUM_WARNING,
+    EARLY_WARNING
+};
+
+// Fixed-size binary violation/warning record, appended in time order
+struct ConflictRecord {
+    static constexpr size_t CALLSIGN_LENGTH = 16;
+
+    int64_t timestamp_ms;
+    char aircraft1[CALLSIGN_LENGTH];
+    char aircraft2[CALLSIGN_LENGTH];
+    uint8_t kind;                  // ConflictKind
+    uint8_t reserved[7];
+    double horizontal_separation;  // at detection time
+    double vertical_separation;
+    double time_to_violation;      // seconds, 0 for current violations
+    double min_separation;         // predicted minimum horizontal separation
+    double x, y, z;                // conflict point
+
+    std::string getAircraft1() const;
+    std::string getAircraft2() const;
+};
+
+static_assert(sizeof(ConflictRecord) == 104, "ConflictRecord layout must stay stable on disk");
+
+// Append-only conflict file next to the history segments: <dir>/conflicts.dat
+class ConflictLog {
+public:
+    explicit ConflictLog(const std::string& directory);
+
+    void record(const ConflictRecord& record);
+    bool isOperational() const { return operational_; }
+
+private:
+    std::string path_;
+    std::ofstream file_;
+    std::mutex mutex_;
+    bool operational_;
+};
+
+namespace history {
+
+std::string conflictPath(const std::string& directory);
+const char* conflictKindName(ConflictKind kind);
+
+// Records with timestamps in [t_start, t_end], visited in chunks of up to
+// chunk_records; the visitor returns false to stop early
+bool readConflicts(const std::string& directory, int64_t t_start, int64_t t_end,
+                   size_t chunk_records,
+                   const std::function<bool(const ConflictRecord*, size_t)>& visit);
+
+}
+
+} // namespace atc
+
+#endif // ATC_CONFLICT_LOG_H
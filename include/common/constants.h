@@ -33,6 +33,12 @@ extern const int OPERATOR_PRIORITY;           // Operator console priority
 // Violation prediction
 extern const int DEFAULT_LOOKAHEAD_TIME;     // 3 minutes in seconds
 extern const int MAX_LOOKAHEAD_TIME;         // 5 minutes max
+extern const double ROUTE_CLIMB_RATE;        // Level change rate along a route, units/s
+extern const double ROUTE_CONFORMANCE_TOLERANCE; // Drift from a cached trajectory before it is rebuilt
+extern const double KINETIC_DRIFT_TOLERANCE;  // Drift from a kinetic pair schedule's straight line before it is redone
+extern const double KINETIC_MAX_REPORT_AGE;   // Oldest position report a kinetic pair schedule allows for, seconds
+extern const double VELOCITY_LINE_TOLERANCE;  // Drift from an aircraft's straight line before its velocity version changes
+extern const double CERTIFICATE_MAX_REPORT_SKEW; // Widest gap between a pair's report times a certificate allows for, seconds
 
 // Aircraft performance limits
 extern const double MIN_SPEED;               // Minimum safe speed
@@ -44,6 +50,59 @@ extern const int DISPLAY_GRID_HEIGHT;
 extern const int DISPLAY_UPDATE_MIN_INTERVAL;  // Minimum refresh interval (1s)
 extern const int DISPLAY_UPDATE_MAX_INTERVAL;  // Maximum refresh interval (10s)
 
+// History storage
+extern const int HISTORY_SNAPSHOT_INTERVAL;   // 1s between binary snapshots
+extern const int HISTORY_BLOCK_RECORDS;       // Records per indexed block
+extern const int HISTORY_SEGMENT_BLOCKS;      // Blocks per segment file
+extern const int HISTORY_COMPRESSION_INTERVAL; // 5s between background compression passes
+extern const int HISTORY_ROLLUP_FINE_INTERVAL;   // 10s per-aircraft rollup
+extern const int HISTORY_ROLLUP_COARSE_INTERVAL; // 60s per-aircraft rollup
+extern const int HISTORY_OCCUPANCY_INTERVAL;    // 1min per-sector occupancy buckets
+extern const int SECTOR_GRID_COLUMNS;           // Airspace split into columns x rows sectors
+extern const int SECTOR_GRID_ROWS;
+
+// Traffic load forecast
+extern const int TRAFFIC_FORECAST_INTERVAL;     // 1s between forecast updates
+extern const int TRAFFIC_FORECAST_BIN;          // 1min forecast bins
+extern const int TRAFFIC_FORECAST_BINS;         // Bins ahead, an hour of 1min bins
+extern const int SECTOR_CAPACITY;               // Aircraft a sector takes in one bin before overload
+
+// Arrival sequencing
+extern const double ARRIVAL_FIX_X;             // Runway fix that arrival routes end at
+extern const double ARRIVAL_FIX_Y;
+extern const int ARRIVAL_SEQUENCE_INTERVAL;    // 5s between re-sequencing passes
+extern const int ARRIVAL_FREEZE_TIME;          // Seconds before landing a slot stops moving
+extern const double ARRIVAL_ADVISORY_STEP;     // Smallest speed change worth advising, units/s
+
+// Browser display
+extern const int WEB_DISPLAY_PORT;             // Localhost HTTP/WebSocket port
+extern const int WEB_DISPLAY_INTERVAL;         // 1s between snapshots, matching position updates
+
+// Track trails
+extern const int TRAIL_LENGTH;                 // Positions kept per track
+extern const int TRAIL_SAMPLE_INTERVAL;        // 2s between trail samples
+extern const int TRAIL_MAX_TRACKS;             // Preallocated trail slots
+
+// Split deployment
+extern const int SHM_RING_SIZE;                // Bytes per shared-memory ring between processes
+extern const int SHM_RING_SPIN_TIME;           // Microseconds a reader spins before sleeping
+extern const int SUPERVISOR_RESTART_DELAY;     // 1s before restarting a failed process
+extern const int SUPERVISOR_MAX_RESTARTS;      // Restarts before a process is left down
+extern const int SUPERVISOR_STOP_TIMEOUT;      // 2s for processes to exit before SIGKILL
+
+// Hot-standby replication
+extern const int REPLICATION_KEY_FRAME_INTERVAL;  // State deltas between full key frames (5s of cycles)
+extern const int REPLICATION_CYCLE_BUDGET;        // Microseconds of replication work per 100ms cycle
+extern const int REPLICATION_RECONNECT_DROPS;     // Consecutive drops before reopening the ring
+extern const int REPLICATION_TAKEOVER_TIMEOUT;    // Primary silence before the standby takes over
+
+// Logging
+extern const int LOG_FLUSH_INTERVAL;           // 1s between staged log batches
+extern const int LOG_STAGING_BUFFER_SIZE;      // Per-thread bytes staged before a flush
+
+// Metrics
+extern const int METRICS_INTERVAL;             // 5s between metrics file writes
+
 } // namespace constants
 } // namespace atc
 
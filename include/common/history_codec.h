@@ -0,0 +1,50 @@
+#ifndef ATC_HISTORY_CODEC_H
+#define ATC_HISTORY_CODEC_H
+
+#include "common/history_store.h"
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace atc {
+
+// Column-oriented view of one history block (callsigns dictionary-encoded)
+struct HistoryColumns {
+    std::vector<std::string> dictionary;
+    std::vector<uint32_t> callsign_id;
+    std::vector<int64_t> timestamp_ms;
+    std::vector<double> x, y, z;
+    std::vector<double> vx, vy, vz;
+    std::vector<double> heading;
+    std::vector<uint8_t> status;
+
+    size_t size() const { return timestamp_ms.size(); }
+    void resize(size_t count);
+    void clear();
+
+    void fromRecords(const std::vector<HistoryRecord>& records);
+    void toRecords(std::vector<HistoryRecord>& records) const;
+};
+
+namespace codec {
+
+enum BlockCodec : uint32_t {
+    RAW_RECORDS = 0,
+    PACKED_LZ = 1
+};
+
+// Delta + bit-packing + LZ encoding of a block. Each block is self-contained,
+// so random access per block is preserved. Decoding fails unless the block
+// holds exactly record_count records, as its index entry says.
+void compressBlock(const HistoryColumns& columns, std::vector<uint8_t>& out);
+bool decompressBlock(const uint8_t* data, size_t size, size_t record_count, HistoryColumns& columns);
+
+// Lightweight byte-oriented LZ77 used as the final stage
+void lzCompress(const uint8_t* data, size_t size, std::vector<uint8_t>& out);
+bool lzDecompress(const uint8_t* data, size_t size, uint8_t* out, size_t out_size);
+
+}
+
+} // namespace atc
+
+#endif // ATC_HISTORY_CODEC_H
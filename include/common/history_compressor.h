@@ -0,0 +1,34 @@
+#ifndef ATC_HISTORY_COMPRESSOR_H
+#define ATC_HISTORY_COMPRESSOR_H
+
+#include "common/periodic_task.h"
+#include <deque>
+#include <mutex>
+#include <string>
+
+namespace atc {
+
+// Background task that rewrites completed history segments with compressed blocks
+class HistoryCompressor : public PeriodicTask {
+public:
+    HistoryCompressor();
+    ~HistoryCompressor();
+
+    void enqueue(const std::string& segment_path);
+    size_t getPendingCount() const;
+    uint64_t getRawBytes() const { return raw_bytes_; }
+    uint64_t getCompressedBytes() const { return compressed_bytes_; }
+
+protected:
+    void execute() override;
+
+private:
+    std::deque<std::string> pending_;
+    mutable std::mutex queue_mutex_;
+    std::atomic<uint64_t> raw_bytes_{0};
+    std::atomic<uint64_t> compressed_bytes_{0};
+};
+
+}
+
+#endif // ATC_HISTORY_COMPRESSOR_H
@@ -0,0 +1,24 @@
+#ifndef ATC_HISTORY_EXPORT_H
+#define ATC_HISTORY_EXPORT_H
+
+#include "common/history_store.h"
+#include <cstdint>
+#include <ostream>
+#include <string>
+
+namespace atc {
+namespace history {
+
+// Arrow IPC stream of snapshots in [t_start, t_end]: one record batch per
+// stored block, columns taken directly from the decoded block
+bool exportSnapshotsArrow(const HistoryReader& reader, int64_t t_start, int64_t t_end,
+                          std::ostream& out, uint64_t* rows = nullptr);
+
+// Arrow IPC stream of violation and warning records in [t_start, t_end]
+bool exportConflictsArrow(const std::string& directory, int64_t t_start, int64_t t_end,
+                          std::ostream& out, uint64_t* rows = nullptr);
+
+}
+} // namespace atc
+
+#endif // ATC_HISTORY_EXPORT_H
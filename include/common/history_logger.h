@@ -3,6 +3,9 @@
 
 #include "common/periodic_task.h"
 #include "common/types.h"
+#include "common/history_store.h"
+#include "common/history_compressor.h"
+#include "common/history_rollup.h"
 #include "core/aircraft.h"
 #include <vector>
 #include <memory>
@@ -13,12 +16,16 @@ namespace atc {
 
 class HistoryLogger : public PeriodicTask {
 public:
-    explicit HistoryLogger(const std::string& filename = "airspace_history.log");
+    explicit HistoryLogger(const std::string& filename = "airspace_history.log",
+                           const std::string& store_directory = "history");
     ~HistoryLogger();
 
     void updateAircraftStates(const std::vector<std::shared_ptr<Aircraft>>& aircraft);
     bool isOperational() const { return file_operational_; }
 
+    // Hand completed segments (including leftovers from earlier runs) to a compressor
+    void setCompressor(const std::shared_ptr<HistoryCompressor>& compressor);
+
 
 protected:
     void execute() override;
@@ -35,6 +42,11 @@ private:
     bool file_operational_;
     const std::string filename_;
     static constexpr size_t MAX_BUFFER_SIZE = 1024 * 1024;  // 1MB buffer size
+
+    // Indexed binary snapshots for history queries
+    std::unique_ptr<HistoryWriter> store_;
+    std::unique_ptr<HistoryRollupWriter> rollup_;
+    std::chrono::steady_clock::time_point last_snapshot_;
 };
 
 }
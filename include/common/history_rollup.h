@@ -0,0 +1,107 @@
+#ifndef ATC_HISTORY_ROLLUP_H
+#define ATC_HISTORY_ROLLUP_H
+
+#include "common/history_store.h"
+#include <cstdint>
+#include <fstream>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+namespace atc {
+
+// Number of distinct aircraft seen in one sector during one occupancy bucket
+struct SectorOccupancy {
+    int64_t bucket_ms;   // start of the bucket
+    uint32_t sector;
+    uint32_t aircraft;
+};
+
+static_assert(sizeof(SectorOccupancy) == 16, "SectorOccupancy layout must stay stable on disk");
+
+// Maintains downsampled series next to the 1 Hz store while it is written:
+// one sample per aircraft every 10 s and 60 s, plus per-sector occupancy per minute
+class HistoryRollupWriter {
+public:
+    explicit HistoryRollupWriter(const std::string& directory);
+    ~HistoryRollupWriter();
+
+    void append(const std::vector<AircraftState>& states);
+    void flush();
+
+    // Per-aircraft rollup writers, finest first
+    std::vector<HistoryWriter*> getWriters() const;
+    // Aircraft a rollup level remembers the last sample of, summed over levels
+    size_t trackedAircraft() const;
+
+private:
+    struct Level {
+        int interval_ms;
+        std::unique_ptr<HistoryWriter> writer;
+        // Only aircraft seen in the current or previous bucket
+        std::unordered_map<std::string, int64_t> last_bucket;
+        int64_t current_bucket;
+    };
+
+    void openOccupancy();
+    void closeOccupancyBucket();
+
+    std::string directory_;
+    std::vector<Level> levels_;
+
+    std::ofstream occupancy_;
+    int64_t occupancy_bucket_;
+    int64_t last_written_bucket_;
+    std::vector<std::unordered_set<std::string>> sector_aircraft_;
+};
+
+// Query front end over the 1 Hz store and its rollups. Each query takes the
+// coarsest sample spacing the caller can accept and is answered from the
+// coarsest series that is at least that fine.
+class HistoryArchive {
+public:
+    explicit HistoryArchive(const std::string& directory);
+
+    size_t refresh();
+
+    std::vector<HistoryRecord> trajectory(const std::string& callsign, int64_t t_start,
+                                          int64_t t_end, int resolution_ms = 0) const;
+    std::vector<HistoryRecord> window(int64_t t_start, int64_t t_end,
+                                      const HistoryRegion& region = HistoryRegion::everything(),
+                                      int resolution_ms = 0) const;
+
+    // Occupancy buckets overlapping [t_start, t_end]
+    std::vector<SectorOccupancy> sectorOccupancy(int64_t t_start, int64_t t_end) const;
+
+    // Sample spacing of the series that would answer a query
+    int selectResolution(int resolution_ms, int64_t t_start) const;
+
+private:
+    struct Level {
+        int interval_ms;
+        HistoryReader reader;
+    };
+
+    const Level& selectLevel(int resolution_ms, int64_t t_start) const;
+
+    std::string directory_;
+    std::vector<Level> levels_;  // finest first
+};
+
+namespace history {
+
+// Rollup series prefix for a sample interval, e.g. "history_r10"
+std::string rollupPrefix(int interval_ms);
+std::string occupancyPath(const std::string& directory);
+
+// Sector grid over the airspace boundaries
+uint32_t sectorCount();
+uint32_t sectorOf(double x, double y);
+
+}
+
+} // namespace atc
+
+#endif // ATC_HISTORY_ROLLUP_H
@@ -0,0 +1,168 @@
+#ifndef ATC_HISTORY_STORE_H
+#define ATC_HISTORY_STORE_H
+
+#include "common/types.h"
+#include <cstdint>
+#include <fstream>
+#include <functional>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace atc {
+
+struct HistoryColumns;
+
+// Fixed-size binary snapshot record as stored in history segments
+struct HistoryRecord {
+    static constexpr size_t CALLSIGN_LENGTH = 16;
+
+    int64_t timestamp_ms;
+    char callsign[CALLSIGN_LENGTH];
+    double x, y, z;
+    double vx, vy, vz;
+    double heading;
+    uint8_t status;
+    uint8_t reserved[7];
+
+    static HistoryRecord fromState(const AircraftState& state);
+    AircraftState toState() const;
+    std::string getCallsign() const;
+};
+
+static_assert(sizeof(HistoryRecord) == 88, "HistoryRecord layout must stay stable on disk");
+
+// Index entry for one block of records inside a segment
+struct HistoryBlockInfo {
+    uint64_t offset;        // file offset of the block header
+    uint32_t record_count;
+    uint32_t stored_bytes;  // payload size following the block header
+    uint32_t codec;         // codec::BlockCodec of the payload
+    uint32_t reserved;
+    int64_t t_min;
+    int64_t t_max;
+};
+
+// Optional spatial filter for airspace window queries
+struct HistoryRegion {
+    double x_min, x_max;
+    double y_min, y_max;
+    double z_min, z_max;
+
+    static HistoryRegion everything();
+    bool contains(const HistoryRecord& record) const;
+};
+
+// Per-segment index: time -> block offsets, callsign -> block bitmap
+class HistorySegmentIndex {
+public:
+    void addBlock(const HistoryBlockInfo& block, const std::vector<HistoryRecord>& records);
+
+    bool save(const std::string& path) const;
+    bool load(const std::string& path);
+
+    // Index blocks appended to the segment after the last indexed one
+    bool scan(const std::string& segment_path);
+
+    // Blocks overlapping [t_start, t_end], optionally restricted to one callsign
+    std::vector<size_t> findBlocks(int64_t t_start, int64_t t_end) const;
+    std::vector<size_t> findBlocks(const std::string& callsign, int64_t t_start, int64_t t_end) const;
+
+    const std::vector<HistoryBlockInfo>& blocks() const { return blocks_; }
+    int64_t getStartTime() const { return t_min_; }
+    int64_t getEndTime() const { return t_max_; }
+    bool empty() const { return blocks_.empty(); }
+
+private:
+    std::vector<HistoryBlockInfo> blocks_;
+    std::unordered_map<std::string, std::vector<uint64_t>> callsign_blocks_;
+    int64_t t_min_ = 0;
+    int64_t t_max_ = 0;
+};
+
+// Appends snapshots into indexed binary segments: <dir>/<prefix>_NNNNNN.seg + .idx
+class HistoryWriter {
+public:
+    HistoryWriter(const std::string& directory, const std::string& prefix = "history");
+    ~HistoryWriter();
+
+    void append(const std::vector<AircraftState>& states);
+    void append(const HistoryRecord& record);
+    void flush();
+    bool isOperational() const { return operational_; }
+    const std::string& getDirectory() const { return directory_; }
+    const std::string& getPrefix() const { return prefix_; }
+    const std::string& getSegmentPath() const { return segment_path_; }
+
+    // Invoked with the path of every segment once it is complete
+    void setSegmentClosedCallback(std::function<void(const std::string&)> callback);
+
+private:
+    bool openSegment();
+    void closeSegment();
+    void writeBlock();
+
+    std::string directory_;
+    std::string prefix_;
+    std::string segment_path_;
+    std::ofstream segment_;
+    HistorySegmentIndex index_;
+    std::vector<HistoryRecord> block_;
+    std::function<void(const std::string&)> on_segment_closed_;
+    uint64_t segment_offset_;
+    uint32_t segment_sequence_;
+    bool operational_;
+};
+
+// Query side: loads segment indexes and seeks straight to the relevant blocks
+class HistoryReader {
+public:
+    HistoryReader(const std::string& directory, const std::string& prefix = "history");
+
+    size_t refresh();
+
+    std::vector<HistoryRecord> trajectory(const std::string& callsign,
+                                          int64_t t_start, int64_t t_end) const;
+    std::vector<HistoryRecord> window(int64_t t_start, int64_t t_end,
+                                      const HistoryRegion& region = HistoryRegion::everything()) const;
+
+    // Visit the blocks overlapping [t_start, t_end] in time order, as columns;
+    // the visitor returns false to stop early
+    bool forEachBlock(int64_t t_start, int64_t t_end,
+                      const std::function<bool(const HistoryColumns&)>& visit) const;
+
+    size_t getSegmentCount() const { return segments_.size(); }
+    int64_t getStartTime() const;
+    int64_t getEndTime() const;
+
+private:
+    struct Segment {
+        std::string path;
+        HistorySegmentIndex index;
+    };
+
+    std::string directory_;
+    std::string prefix_;
+    std::vector<Segment> segments_;
+};
+
+namespace history {
+
+// Segment file names for a given store prefix and sequence number
+std::string segmentPath(const std::string& directory, const std::string& prefix, uint32_t sequence);
+std::string indexPath(const std::string& segment_path);
+std::vector<std::string> listSegments(const std::string& directory, const std::string& prefix);
+
+// Read one block in either codec, as records or as columns
+bool readBlock(std::ifstream& in, const HistoryBlockInfo& info, std::vector<HistoryRecord>& records);
+bool readBlock(std::ifstream& in, const HistoryBlockInfo& info, HistoryColumns& columns);
+
+// Rewrite a completed segment with compressed blocks; returns false on error
+bool compressSegment(const std::string& segment_path, uint64_t* raw_bytes = nullptr,
+                     uint64_t* compressed_bytes = nullptr);
+
+}
+
+} // namespace atc
+
+#endif // ATC_HISTORY_STORE_H
@@ -0,0 +1,79 @@
+#ifndef ATC_JOURNAL_H
+#define ATC_JOURNAL_H
+
+#include "communication/message_types.h"
+#include <chrono>
+#include <cstdint>
+#include <fstream>
+#include <string>
+
+namespace atc {
+
+// Binary input journal for record (--record) and replay (--replay). It holds
+// every input that can change what surveillance and detection compute: the
+// scenario rows, channel messages in the cycle they were handled, the RNG seed
+// and the wall-clock epoch of virtual time. Everything else is derived from
+// virtual time. Alerts are journaled too, so a replay can check that it
+// reproduced the recording.
+//
+// File: "ATCJ", u32 version, u64 seed, i64 epoch (us since the Unix epoch),
+// then records of u8 kind, u32 virtual time (ms), u32 length and the payload.
+enum class JournalKind : uint8_t {
+    SCENARIO_ROW = 1,
+    CHANNEL_MESSAGE = 2,
+    ALERT = 3,
+    END = 4         // payload empty; `at` is when the recording stopped
+};
+
+struct JournalEntry {
+    JournalKind kind;
+    std::chrono::milliseconds at;
+    std::string payload;
+};
+
+class JournalWriter {
+public:
+    explicit JournalWriter(const std::string& path);
+    ~JournalWriter();
+
+    bool open(uint64_t seed, std::chrono::system_clock::time_point epoch);
+    bool isOperational() const { return operational_; }
+
+    void writeScenarioRow(std::chrono::milliseconds at, const std::string& row);
+    void writeMessage(std::chrono::milliseconds at, const comm::Message& message);
+    void writeAlert(std::chrono::milliseconds at, const std::string& text);
+    // Once per cycle, so a crash loses at most the cycle in progress
+    void flush();
+    // Writes the END record; later writes are ignored
+    void close(std::chrono::milliseconds at);
+
+private:
+    void write(JournalKind kind, std::chrono::milliseconds at, const std::string& payload);
+
+    std::string path_;
+    std::ofstream file_;
+    std::string buffer_;
+    bool operational_ = false;
+};
+
+class JournalReader {
+public:
+    bool open(const std::string& path);
+
+    uint64_t getSeed() const { return seed_; }
+    std::chrono::system_clock::time_point getEpoch() const { return epoch_; }
+
+    // False at the end of the file or at a record cut short by a crash
+    bool next(JournalEntry& entry);
+
+    static bool decodeMessage(const std::string& payload, comm::Message& message);
+
+private:
+    std::ifstream file_;
+    uint64_t seed_ = 0;
+    std::chrono::system_clock::time_point epoch_;
+};
+
+}
+
+#endif // ATC_JOURNAL_H
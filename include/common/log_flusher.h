@@ -0,0 +1,20 @@
+#ifndef ATC_LOG_FLUSHER_H
+#define ATC_LOG_FLUSHER_H
+
+#include "common/periodic_task.h"
+
+namespace atc {
+
+// Background task that writes staged log lines and LogEvent counts each LOG_FLUSH_INTERVAL
+class LogFlusher : public PeriodicTask {
+public:
+    LogFlusher();
+    ~LogFlusher();
+
+protected:
+    void execute() override;
+};
+
+}
+
+#endif // ATC_LOG_FLUSHER_H
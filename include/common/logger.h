@@ -1,28 +1,122 @@
 #ifndef ATC_LOGGER_H
 #define ATC_LOGGER_H
 
+#include <atomic>
+#include <chrono>
+#include <cstdint>
 #include <fstream>
 #include <mutex>
 #include <string>
+#include <vector>
+
+// Compile-time floor for log statements: 0 debug, 1 info, 2 warning, 3 error, 4 off.
+// Statements below it compile to nothing.
+#ifndef ATC_LOG_MIN_LEVEL
+#define ATC_LOG_MIN_LEVEL 0
+#endif
 
 namespace atc {
 
+enum class LogLevel {
+    DEBUG = 0,
+    INFO = 1,
+    WARNING = 2,
+    ERROR = 3,
+    OFF = 4
+};
+
+// Lines are staged in a per-thread buffer and written in batches; WARNING and
+// above, a full buffer or a LOG_FLUSH_INTERVAL old batch write through at once.
 class Logger {
 public:
     static Logger& getInstance();
     void log(const std::string& message);
+    void log(LogLevel level, const std::string& message);
+
+    // Writes the calling thread's staged lines
+    void flush();
+    // Writes every thread's staged lines and reports LogEvent counts
+    void flushAll();
+
+    // Runtime threshold, checked before any message is formatted
+    static bool isEnabled(LogLevel level) {
+        return static_cast<int>(level) >= runtime_level_.load(std::memory_order_relaxed);
+    }
+    static void setLevel(LogLevel level);
+    static LogLevel getLevel();
+    static bool parseLevel(const std::string& name, LogLevel& level);
+    static const char* getLevelName(LogLevel level);
 
 private:
+    struct StagingBuffer;
+
     Logger();
     ~Logger();
     Logger(const Logger&) = delete;
     Logger& operator=(const Logger&) = delete;
 
+    StagingBuffer& threadBuffer();
+    void release(StagingBuffer* buffer);
+    void stage(StagingBuffer& buffer, LogLevel level, const std::string& message);
+    void writeStaged(StagingBuffer& buffer);
+
     std::ofstream log_file_;
     std::mutex log_mutex_;
+    std::mutex buffers_mutex_;
+    std::vector<StagingBuffer*> buffers_;
+
+    static std::atomic<int> runtime_level_;
+};
+
+// Counter for a high-frequency event. Instead of one line per event, each
+// Logger::flushAll writes "<count> <name> in last <ms> ms" at the event's level.
+class LogEvent {
+public:
+    LogEvent(std::string name, LogLevel level);
+    ~LogEvent();
+    LogEvent(const LogEvent&) = delete;
+    LogEvent& operator=(const LogEvent&) = delete;
+
+    // True for the first event of a reporting interval, so callers can log one
+    // detailed sample; false (and not counted) when the level is disabled
+    bool record(uint64_t count = 1) {
+        if (static_cast<int>(level_) < ATC_LOG_MIN_LEVEL || !Logger::isEnabled(level_)) {
+            return false;
+        }
+        return count_.fetch_add(count, std::memory_order_relaxed) == 0;
+    }
+
+    const std::string& getName() const { return name_; }
+    LogLevel getLevel() const { return level_; }
+
+private:
+    friend class Logger;
+
+    std::string name_;
+    LogLevel level_;
+    std::atomic<uint64_t> count_{0};
+    std::chrono::steady_clock::time_point last_report_;
 };
 
 } // namespace atc
 
-#endif // ATC_LOGGER_H
+// True if a statement at this level would be written; use to guard code that
+// only builds a log message
+#define ATC_LOG_ENABLED(level) \
+    (static_cast<int>(::atc::LogLevel::level) >= ATC_LOG_MIN_LEVEL && \
+     ::atc::Logger::isEnabled(::atc::LogLevel::level))
+
+// The message expression is only evaluated when the level is enabled
+#define ATC_LOG(level, message)                                                  \
+    do {                                                                         \
+        if (ATC_LOG_ENABLED(level)) {                                            \
+            ::atc::Logger::getInstance().log(::atc::LogLevel::level, (message)); \
+        }                                                                        \
+    } while (0)
 
+#define ATC_LOG_DEBUG(message) ATC_LOG(DEBUG, message)
+#define ATC_LOG_INFO(message) ATC_LOG(INFO, message)
+#define ATC_LOG_WARNING(message) ATC_LOG(WARNING, message)
+#define ATC_LOG_ERROR(message) ATC_LOG(ERROR, message)
+
+#endif // ATC_LOGGER_H
@@ -0,0 +1,148 @@
+#ifndef ATC_METRICS_H
+#define ATC_METRICS_H
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace atc {
+namespace metrics {
+
+// Writers spread over this many cache-line sized shards, one per thread in
+// turn, so concurrent updates never share a line. Reads add the shards up.
+constexpr size_t SHARDS = 16;
+
+// The calling thread's shard
+size_t shardIndex();
+
+// Label names and values telling apart metrics of the same name
+using Labels = std::vector<std::pair<std::string, std::string>>;
+
+// Base of every metric. Each one registers itself on construction, like
+// LogEvent, so a subsystem declares its metrics next to the code it measures.
+class Metric {
+public:
+    Metric(std::string name, std::string help, const Labels& labels = {});
+    virtual ~Metric();
+    Metric(const Metric&) = delete;
+    Metric& operator=(const Metric&) = delete;
+
+    const std::string& getName() const { return name_; }
+    const std::string& getHelp() const { return help_; }
+    // `name="value",...` as exposed, empty without labels
+    const std::string& getLabels() const { return labels_; }
+    // Counter and gauge value, histogram observation count
+    virtual double value() const = 0;
+    virtual const char* type() const = 0;
+    // Appends the metric's sample lines in the Prometheus text format
+    virtual void expose(std::string& out) const = 0;
+
+protected:
+    // `<name><suffix>{<labels>,<extra>} ` ready for the value
+    std::string series(const char* suffix = "", const std::string& extra = "") const;
+
+private:
+    std::string name_;
+    std::string help_;
+    std::string labels_;
+};
+
+// Monotonic count of events
+class Counter : public Metric {
+public:
+    Counter(std::string name, std::string help, const Labels& labels = {})
+        : Metric(std::move(name), std::move(help), labels) {}
+
+    void increment(uint64_t count = 1) {
+        shards_[shardIndex()].value.fetch_add(count, std::memory_order_relaxed);
+    }
+    uint64_t count() const;
+
+    double value() const override { return static_cast<double>(count()); }
+    const char* type() const override { return "counter"; }
+    void expose(std::string& out) const override;
+
+private:
+    struct alignas(64) Shard {
+        std::atomic<uint64_t> value{0};
+    };
+    Shard shards_[SHARDS];
+};
+
+// Current level of something, last write wins
+class Gauge : public Metric {
+public:
+    Gauge(std::string name, std::string help, const Labels& labels = {})
+        : Metric(std::move(name), std::move(help), labels) {}
+
+    void set(double value) { value_.store(value, std::memory_order_relaxed); }
+
+    double value() const override { return value_.load(std::memory_order_relaxed); }
+    const char* type() const override { return "gauge"; }
+    void expose(std::string& out) const override;
+
+private:
+    std::atomic<double> value_{0.0};
+};
+
+// Distribution of observations over fixed bucket upper bounds
+class Histogram : public Metric {
+public:
+    Histogram(std::string name, std::string help, std::vector<double> bounds, const Labels& labels = {});
+
+    void observe(double value);
+    std::vector<uint64_t> bucketCounts() const;   // per bucket, not cumulative; last is +Inf
+    double sum() const;
+
+    double value() const override;
+    const char* type() const override { return "histogram"; }
+    void expose(std::string& out) const override;
+
+    // Upper bounds in seconds from 10 us to 10 s, for latencies
+    static std::vector<double> latencyBounds();
+
+private:
+    struct alignas(64) Shard {
+        std::atomic<double> sum{0.0};
+        std::unique_ptr<std::atomic<uint64_t>[]> buckets;
+    };
+
+    const std::vector<double> bounds_;
+    Shard shards_[SHARDS];
+};
+
+// Every live metric of the process
+class MetricsRegistry {
+public:
+    static MetricsRegistry& getInstance();
+
+    // Prometheus text exposition (format 0.0.4), sorted by name and labels
+    std::string expose() const;
+    // Writes the exposition next to `path` and renames it over, so a reader never sees half a file
+    bool writeFile(const std::string& path) const;
+    // Value of the named metric summed over its labels, 0 if there is none
+    double value(const std::string& name) const;
+
+private:
+    friend class Metric;
+
+    MetricsRegistry() = default;
+    MetricsRegistry(const MetricsRegistry&) = delete;
+    MetricsRegistry& operator=(const MetricsRegistry&) = delete;
+
+    void add(Metric* metric);
+    void remove(Metric* metric);
+
+    mutable std::mutex mutex_;
+    std::vector<Metric*> metrics_;
+};
+
+} // namespace metrics
+} // namespace atc
+
+#endif // ATC_METRICS_H
@@ -0,0 +1,84 @@
+#ifndef ATC_PERF_COUNTERS_H
+#define ATC_PERF_COUNTERS_H
+
+#include "common/metrics.h"
+#include <atomic>
+#include <cstdint>
+#include <string>
+#include <typeinfo>
+
+namespace atc {
+
+// Hardware event counts, either running totals or the difference over a stretch of code
+struct PerfSample {
+    uint64_t cycles = 0;
+    uint64_t instructions = 0;
+    uint64_t cache_misses = 0;
+    uint64_t branch_misses = 0;
+};
+
+// Optional hardware counter instrumentation (ATC_PERF_COUNTERS=1). Each thread
+// opens one perf_event_open group of cycles, instructions, cache misses and
+// branch misses on first use, counting its own user-space execution. Counts
+// are scaled up if the kernel had to multiplex the group. When disabled, or
+// where perf_event_open is unavailable, a PerfScope costs one relaxed load.
+class PerfCounters {
+public:
+    // False, and instrumentation stays off, if the calling thread cannot open the counters
+    static bool enable();
+    static bool isEnabled() { return enabled_.load(std::memory_order_relaxed); }
+
+    // The calling thread's running totals; false if its counters could not be opened
+    static bool read(PerfSample& sample);
+
+    // Totals and per-run averages of every kernel that ran, for the shutdown log
+    static std::string report();
+
+private:
+    static std::atomic<bool> enabled_;
+};
+
+// A measured stretch of code. Its counts go to the metrics registry as
+// atc_perf_<event>_total{scope="<scope>"}. Declare one per kernel next to the
+// code, like a LogEvent; periodic tasks get one per class from forTask().
+class PerfKernel {
+public:
+    explicit PerfKernel(const std::string& scope);
+    ~PerfKernel();
+    PerfKernel(const PerfKernel&) = delete;
+    PerfKernel& operator=(const PerfKernel&) = delete;
+
+    // Shared kernel named after the task's class, kept for the life of the process
+    static PerfKernel& forTask(const std::type_info& type);
+
+    void add(const PerfSample& delta);
+    const std::string& getScope() const { return scope_; }
+    uint64_t getRuns() const { return runs_.count(); }
+    PerfSample getTotals() const;
+
+private:
+    std::string scope_;
+    metrics::Counter runs_;
+    metrics::Counter cycles_;
+    metrics::Counter instructions_;
+    metrics::Counter cache_misses_;
+    metrics::Counter branch_misses_;
+};
+
+// Adds the thread's counts over its lifetime to the kernel
+class PerfScope {
+public:
+    explicit PerfScope(PerfKernel& kernel)
+        : kernel_(PerfCounters::isEnabled() && PerfCounters::read(start_) ? &kernel : nullptr) {}
+    ~PerfScope();
+    PerfScope(const PerfScope&) = delete;
+    PerfScope& operator=(const PerfScope&) = delete;
+
+private:
+    PerfSample start_;
+    PerfKernel* kernel_;
+};
+
+}
+
+#endif // ATC_PERF_COUNTERS_H
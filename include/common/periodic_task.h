@@ -1,10 +1,13 @@
 #ifndef ATC_PERIODIC_TASK_H
 #define ATC_PERIODIC_TASK_H
 
+#include "common/perf_counters.h"
 #include <chrono>
 #include <thread>
 #include <atomic>
+#include <condition_variable>
 #include <mutex>
+#include <typeinfo>
 #include <sys/neutrino.h>
 
 namespace atc {
@@ -32,12 +35,35 @@ public:
     }
 
     void stop() {
-        running_ = false;
-        if (thread_.joinable()) {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            running_ = false;
+        }
+        stop_cv_.notify_all();
+        // A task stopping itself from execute() cannot join its own thread;
+        // run() returns after this period and a later stop() joins it
+        if (thread_.joinable() && thread_.get_id() != std::this_thread::get_id()) {
             thread_.join();
         }
     }
 
+    // Virtual-time scheduling: the task is marked running without a thread of
+    // its own, and the scheduler calls runOnce() once per period
+    void startScheduled() {
+        running_ = true;
+    }
+
+    // One period's work on the caller's thread; false once the task has stopped
+    bool runOnce() {
+        if (!running_) return false;
+        auto exec_start = std::chrono::steady_clock::now();
+        measuredExecute();
+        auto exec_end = std::chrono::steady_clock::now();
+        updateExecutionStats(std::chrono::duration_cast<std::chrono::microseconds>(
+            exec_end - exec_start).count());
+        return running_;
+    }
+
     // Get execution time statistics
     int64_t getBestExecutionTime() const { return best_execution_time_; }
     int64_t getWorstExecutionTime() const { return worst_execution_time_; }
@@ -63,7 +89,7 @@ private:
 
             // Execute periodic task and measure time
             auto exec_start = std::chrono::steady_clock::now();
-            execute();
+            measuredExecute();
             auto exec_end = std::chrono::steady_clock::now();
 
             // Update execution time statistics
@@ -71,20 +97,23 @@ private:
                 exec_end - exec_start).count();
             updateExecutionStats(duration);
 
-            // Get current period
-            std::chrono::milliseconds current_period;
-            {
-                std::lock_guard<std::mutex> lock(mutex_);
-                current_period = period_;
-            }
-
-            // Sleep for remaining time in period
-            auto end = std::chrono::steady_clock::now();
-            auto next_period = start + current_period;
-            if (next_period > end) {
-                std::this_thread::sleep_until(next_period);
-            }
+            // Sleep for remaining time in period; stop() cuts the wait short
+            std::unique_lock<std::mutex> lock(mutex_);
+            stop_cv_.wait_until(lock, start + period_, [this] { return !running_; });
+        }
+    }
+
+    // Hardware counts go to one PerfKernel per task class when instrumentation is on
+    void measuredExecute() {
+        if (!PerfCounters::isEnabled()) {
+            execute();
+            return;
+        }
+        if (!perf_kernel_) {
+            perf_kernel_ = &PerfKernel::forTask(typeid(*this));
         }
+        PerfScope perf(*perf_kernel_);
+        execute();
     }
 
     void updateExecutionStats(int64_t duration) {
@@ -101,7 +130,9 @@ private:
     std::thread thread_;
     std::atomic<int64_t> best_execution_time_{0};
     std::atomic<int64_t> worst_execution_time_{0};
+    PerfKernel* perf_kernel_ = nullptr;   // only touched by the thread running the task
     mutable std::mutex mutex_;
+    std::condition_variable stop_cv_;
 };
 
 }
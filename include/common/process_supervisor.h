@@ -0,0 +1,65 @@
+#ifndef ATC_PROCESS_SUPERVISOR_H
+#define ATC_PROCESS_SUPERVISOR_H
+
+#include <atomic>
+#include <chrono>
+#include <functional>
+#include <string>
+#include <sys/types.h>
+#include <vector>
+
+namespace atc {
+
+// Runs each part of a split deployment in its own forked process and watches
+// them. A non-critical process that exits is restarted after a delay, up to a
+// limit. Losing a critical process stops the whole deployment rather than
+// running on with detection or surveillance missing.
+class ProcessSupervisor {
+public:
+    // Runs in the child; the return value is its exit status
+    using Entry = std::function<int()>;
+
+    ProcessSupervisor(std::chrono::milliseconds restart_delay, int max_restarts);
+    ProcessSupervisor();
+    ~ProcessSupervisor();
+    ProcessSupervisor(const ProcessSupervisor&) = delete;
+    ProcessSupervisor& operator=(const ProcessSupervisor&) = delete;
+
+    void addProcess(const std::string& name, Entry entry, bool critical);
+
+    // Forks every process; call before this process starts any threads
+    bool start();
+    // Reaps exited processes and restarts those that are due. False once a critical process is gone.
+    bool poll();
+    // Polls until `running` clears or a critical process fails, then stops everything
+    int run(const std::atomic<bool>& running);
+    // SIGTERM, then SIGKILL for anything still running after SUPERVISOR_STOP_TIMEOUT
+    void stop();
+
+    pid_t getPid(const std::string& name) const;
+    int getRestartCount(const std::string& name) const;
+
+private:
+    struct Process {
+        std::string name;
+        Entry entry;
+        bool critical;
+        pid_t pid = -1;
+        int restarts = 0;
+        bool restart_pending = false;
+        std::chrono::steady_clock::time_point restart_at;
+    };
+
+    bool launch(Process& process);
+    void handleExit(Process& process, int status);
+    const Process* find(const std::string& name) const;
+
+    std::vector<Process> processes_;
+    std::chrono::milliseconds restart_delay_;
+    int max_restarts_;
+    bool critical_failed_ = false;
+};
+
+}
+
+#endif // ATC_PROCESS_SUPERVISOR_H
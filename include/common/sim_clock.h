@@ -0,0 +1,61 @@
+#ifndef ATC_SIM_CLOCK_H
+#define ATC_SIM_CLOCK_H
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+
+namespace atc {
+namespace sim_clock {
+
+// Time reads that feed surveillance and detection go through here. Normally
+// they are the real clocks. Record and replay switch to virtual time, which
+// only the scheduler advances, so a replay reads exactly the times the
+// recording did.
+
+namespace detail {
+inline std::atomic<bool> virtual_time{false};
+inline std::atomic<int64_t> epoch_us{0};
+inline std::atomic<int64_t> elapsed_us{0};
+
+// Any fixed point will do; it only has to be the same in recording and replay
+inline std::chrono::steady_clock::time_point steadyBase() {
+    return std::chrono::steady_clock::time_point(std::chrono::hours(24));
+}
+}
+
+// Virtual time starts at `epoch` (wall clock) with nothing elapsed
+inline void useVirtualTime(std::chrono::system_clock::time_point epoch) {
+    detail::epoch_us = std::chrono::duration_cast<std::chrono::microseconds>(
+        epoch.time_since_epoch()).count();
+    detail::elapsed_us = 0;
+    detail::virtual_time = true;
+}
+
+inline void setElapsed(std::chrono::microseconds elapsed) {
+    detail::elapsed_us = elapsed.count();
+}
+
+inline bool isVirtual() {
+    return detail::virtual_time;
+}
+
+inline std::chrono::steady_clock::time_point steadyNow() {
+    if (!detail::virtual_time) {
+        return std::chrono::steady_clock::now();
+    }
+    return detail::steadyBase() + std::chrono::microseconds(detail::elapsed_us.load());
+}
+
+inline std::chrono::system_clock::time_point systemNow() {
+    if (!detail::virtual_time) {
+        return std::chrono::system_clock::now();
+    }
+    return std::chrono::system_clock::time_point(
+        std::chrono::microseconds(detail::epoch_us.load() + detail::elapsed_us.load()));
+}
+
+}
+} // namespace atc
+
+#endif // ATC_SIM_CLOCK_H
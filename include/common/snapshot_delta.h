@@ -0,0 +1,56 @@
+#ifndef ATC_SNAPSHOT_DELTA_H
+#define ATC_SNAPSHOT_DELTA_H
+
+#include "common/types.h"
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace atc {
+
+// SnapshotTrack::flags
+constexpr uint8_t TRACK_FLAG_VIOLATION = 0x01;
+constexpr uint8_t TRACK_FLAG_PREDICTED = 0x02;
+
+// Presentation view of one track, at the precision clients draw with
+struct SnapshotTrack {
+    std::string callsign;
+    float x;
+    float y;
+    float z;
+    float heading;
+    float speed;
+    uint8_t status;
+    uint8_t flags;
+
+    bool operator==(const SnapshotTrack& other) const {
+        return callsign == other.callsign && x == other.x && y == other.y && z == other.z &&
+               heading == other.heading && speed == other.speed &&
+               status == other.status && flags == other.flags;
+    }
+    bool operator!=(const SnapshotTrack& other) const { return !(*this == other); }
+};
+
+struct Snapshot {
+    uint64_t sequence = 0;
+    int64_t timestamp_ms = 0;
+    std::vector<SnapshotTrack> tracks;   // sorted by callsign
+};
+
+Snapshot makeSnapshot(const std::vector<AircraftState>& states, uint64_t sequence,
+                      int64_t timestamp_ms);
+
+// Binary frame that turns `base` into `current`: a 40-byte little-endian header
+// ("ATCS", version, key flag, sequence, base sequence, timestamp, counts), the
+// added or changed tracks, then the callsigns of removed tracks. A null base
+// gives a key frame carrying every track.
+void encodeSnapshotDelta(const Snapshot* base, const Snapshot& current, std::string& out);
+
+// Applies a frame to `state`. Fails on a malformed frame or a delta whose base
+// is not state.sequence, leaving `state` unchanged.
+bool applySnapshotDelta(Snapshot& state, const char* data, size_t size);
+
+}
+
+#endif // ATC_SNAPSHOT_DELTA_H
@@ -0,0 +1,29 @@
+#ifndef ATC_TIMESTAMP_H
+#define ATC_TIMESTAMP_H
+
+#include <chrono>
+#include <cstddef>
+#include <string>
+
+namespace atc {
+namespace timestamp {
+
+// "YYYY-MM-DD HH:MM:SS" and "YYYY-MM-DD HH:MM:SS.uuuuuu" in local time
+constexpr size_t SECONDS_LENGTH = 19;
+constexpr size_t MICROS_LENGTH = 26;
+
+// Each thread caches the formatted date and time of the current second, so
+// only the first call in a new second goes through localtime_r. Writes
+// SECONDS_LENGTH or MICROS_LENGTH characters (no terminator) and returns the count.
+size_t format(std::chrono::system_clock::time_point time, char* out, bool micros = true);
+
+std::string format(std::chrono::system_clock::time_point time, bool micros = true);
+std::string now(bool micros = true);
+
+// Wall-clock time of a steady_clock point, for reporting
+std::chrono::system_clock::time_point toSystem(std::chrono::steady_clock::time_point time);
+
+}
+} // namespace atc
+
+#endif // ATC_TIMESTAMP_H
@@ -0,0 +1,84 @@
+#ifndef ATC_TRAIL_STORE_H
+#define ATC_TRAIL_STORE_H
+
+#include "common/types.h"
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace atc {
+
+struct TrailPoint {
+    double x;
+    double y;
+    double z;
+    int64_t timestamp_ms;
+};
+
+// Turn and acceleration statistics over one trail
+struct TrailSmoothness {
+    size_t samples = 0;
+    double mean_turn = 0.0;         // degrees between consecutive legs
+    double max_turn = 0.0;
+    double rms_acceleration = 0.0;  // units/s^2 from second differences
+};
+
+// Last positions of every track in one preallocated structure-of-arrays block:
+// track slot s keeps its ring of `length` samples at [s * length, (s + 1) * length).
+// Slots are recycled when a track leaves, and callsigns map to slots through a
+// preallocated open-addressing table, so nothing is allocated per aircraft.
+class TrailStore {
+public:
+    TrailStore(size_t max_tracks, size_t length, int sample_interval_ms);
+    TrailStore();
+
+    // One pass over all live tracks; tracks missing from the batch are released
+    void update(const std::vector<AircraftState>& states);
+
+    // Oldest sample first; returns the number of samples copied
+    size_t copyTrail(const std::string& callsign, std::vector<TrailPoint>& out) const;
+    bool smoothness(const std::string& callsign, TrailSmoothness& out) const;
+
+    size_t getTrackCount() const;
+    size_t getLength() const { return length_; }
+    uint64_t getDroppedCount() const;
+
+private:
+    struct Slot {
+        uint32_t head = 0;   // next write position
+        uint32_t count = 0;
+        uint64_t seen = 0;   // generation of the last update containing the track
+        bool used = false;
+        size_t hash = 0;
+        std::string callsign;   // reassigned in place when the slot is recycled
+    };
+
+    static constexpr uint32_t NO_SLOT = UINT32_MAX;
+
+    size_t index(uint32_t slot, uint32_t offset) const;
+    // Linear probing over table_; NO_SLOT if the callsign has no slot
+    uint32_t findSlot(const std::string& callsign, size_t hash) const;
+    void insertSlot(uint32_t slot);
+    void eraseSlot(uint32_t slot);
+    void copySlot(uint32_t slot, std::vector<TrailPoint>& out) const;
+
+    const size_t length_;
+    const int sample_interval_ms_;
+
+    mutable std::mutex mutex_;
+    std::vector<double> x_;
+    std::vector<double> y_;
+    std::vector<double> z_;
+    std::vector<int64_t> t_;
+    std::vector<Slot> slot_info_;
+    std::vector<uint32_t> free_slots_;
+    std::vector<uint32_t> table_;   // slot per bucket, at most half full
+    size_t track_count_ = 0;
+    uint64_t generation_ = 0;
+    uint64_t dropped_ = 0;
+};
+
+}
+
+#endif // ATC_TRAIL_STORE_H
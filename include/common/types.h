@@ -2,7 +2,9 @@
 #define ATC_TYPES_H
 #include <string>
 #include <cmath>
+#include <cstdint>
 #include <chrono>
+#include "common/sim_clock.h"
 
 namespace atc {
 namespace constants {
@@ -52,6 +54,14 @@ enum class AircraftStatus {
     EMERGENCY
 };
 
+// Wake turbulence category, lightest first; sets the spacing behind a leader
+enum class WakeCategory : uint8_t {
+    LIGHT,
+    MEDIUM,
+    HEAVY,
+    SUPER
+};
+
 struct AircraftState {
     std::string callsign;
     Position position;
@@ -72,7 +82,7 @@ struct AircraftState {
     }
 
     void updateTimestamp() {
-        auto now = std::chrono::system_clock::now();
+        auto now = sim_clock::systemNow();
         auto duration = now.time_since_epoch();
         timestamp = std::chrono::duration_cast<std::chrono::milliseconds>(duration).count();
     }
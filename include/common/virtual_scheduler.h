@@ -0,0 +1,67 @@
+#ifndef ATC_VIRTUAL_SCHEDULER_H
+#define ATC_VIRTUAL_SCHEDULER_H
+
+#include "common/periodic_task.h"
+#include <atomic>
+#include <chrono>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <queue>
+#include <vector>
+
+namespace atc {
+
+// Runs periodic work on one thread in virtual time, in place of each task's own
+// thread. Events run in order of due time. Events due at the same time run in
+// the order they were added, so a run depends only on its inputs. A paced
+// scheduler sleeps until each event's wall-clock deadline, which is what
+// recording does. An unpaced one jumps straight to the next event, which is
+// what replay does.
+class VirtualScheduler {
+public:
+    using Action = std::function<bool()>;   // false drops the event
+    using Period = std::function<std::chrono::milliseconds()>;
+
+    explicit VirtualScheduler(bool paced);
+
+    // Runs `action` at `first` and then every `period()`. The period is re-read
+    // after each run, so tasks that adapt their period keep working.
+    void addPeriodic(std::chrono::milliseconds first, Action action, Period period);
+    // A PeriodicTask driven through runOnce(), starting now
+    void addTask(const std::shared_ptr<PeriodicTask>& task);
+
+    // Runs events due up to `until`. `running` is checked only between
+    // distinct virtual times, so every event of the last time is run. False if
+    // stopped before `until`.
+    bool runUntil(std::chrono::milliseconds until, const std::atomic<bool>& running);
+
+    std::chrono::milliseconds now() const { return now_; }
+    bool empty() const { return queue_.empty(); }
+
+private:
+    struct Event {
+        Action action;
+        Period period;
+    };
+
+    struct Due {
+        std::chrono::milliseconds at;
+        size_t event;   // index in events_, also the tie-break order
+
+        bool operator>(const Due& other) const {
+            return at != other.at ? at > other.at : event > other.event;
+        }
+    };
+
+    bool paced_;
+    bool started_ = false;
+    std::chrono::steady_clock::time_point wall_start_;
+    std::chrono::milliseconds now_{0};
+    std::deque<Event> events_;   // stable while an action adds events
+    std::priority_queue<Due, std::vector<Due>, std::greater<Due>> queue_;
+};
+
+}
+
+#endif // ATC_VIRTUAL_SCHEDULER_H
@@ -16,7 +16,10 @@ enum class MessageType {
     COMMAND,           // Controller commands
     ALERT,            // System alerts
     STATUS_REQUEST,   // Request for aircraft status
-    STATUS_RESPONSE   // Response with aircraft status
+    STATUS_RESPONSE,  // Response with aircraft status
+    FLIGHT_PLAN,      // Route filed for an aircraft, before or after it enters
+    AIRCRAFT_ENTER,   // Aircraft admitted live with its initial state
+    AIRCRAFT_EXIT     // Aircraft leaves the system; only the callsign is used
 };
 
 // Command data structure
@@ -40,8 +43,18 @@ struct AlertData {
         : level(l), description(desc) {}
 };
 
+// Flight plan data structure
+struct FlightPlanData {
+    std::string callsign;
+    std::vector<Position> waypoints;   // in the order they are flown
+    double cruise_speed;
+    WakeCategory wake_category;
+
+    FlightPlanData() : cruise_speed(0.0), wake_category(WakeCategory::MEDIUM) {}
+};
+
 // Message payload variant type
-using MessagePayload = std::variant<AircraftState, CommandData, AlertData>;
+using MessagePayload = std::variant<AircraftState, CommandData, AlertData, FlightPlanData>;
 
 // Message structure
 struct Message {
@@ -78,6 +91,32 @@ struct Message {
         msg.payload = alert;
         return msg;
     }
+
+    static Message createFlightPlan(const std::string& sender, const FlightPlanData& plan) {
+        Message msg;
+        msg.type = MessageType::FLIGHT_PLAN;
+        msg.sender_id = sender;
+        msg.payload = plan;
+        return msg;
+    }
+
+    static Message createAircraftEnter(const std::string& sender, const AircraftState& state) {
+        Message msg;
+        msg.type = MessageType::AIRCRAFT_ENTER;
+        msg.sender_id = sender;
+        msg.payload = state;
+        return msg;
+    }
+
+    static Message createAircraftExit(const std::string& sender, const std::string& callsign) {
+        Message msg;
+        msg.type = MessageType::AIRCRAFT_EXIT;
+        msg.sender_id = sender;
+        AircraftState state{};
+        state.callsign = callsign;
+        msg.payload = state;
+        return msg;
+    }
 };
 
 }
@@ -0,0 +1,114 @@
+#ifndef ATC_REPLICATION_H
+#define ATC_REPLICATION_H
+
+#include "common/types.h"
+#include "communication/message_types.h"
+#include "communication/shm_ring.h"
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace atc {
+namespace comm {
+
+// Replication stream from a primary atc_system to a hot standby. Records are:
+// - state deltas: full-precision AircraftState upserts plus removed callsigns,
+//   chained by sequence number, with a periodic key frame carrying every track
+// - alerts raised by the primary
+// - controller commands, in the order the primary applied them
+// Sending a delta every cycle also serves as the primary's heartbeat.
+enum class ReplicationKind : uint8_t {
+    STATE_DELTA = 1,
+    ALERT = 2,
+    COMMAND = 3
+};
+
+struct ReplicationStats {
+    uint64_t frames = 0;
+    uint64_t key_frames = 0;
+    uint64_t bytes = 0;
+    uint64_t dropped = 0;
+    uint64_t total_cost_ns = 0;    // encoding and ring writes on the primary
+    uint64_t max_cost_ns = 0;      // worst single record
+    uint64_t over_budget = 0;      // state deltas that took longer than the cycle budget
+};
+
+// Primary side. Encodes into a reused buffer and writes to the ring without
+// blocking, so the primary's cost is one pass over the tracks plus one copy of
+// the changed ones per cycle. A record that cannot be written forces the next
+// delta to be a key frame, and the writer reopens the ring after repeated drops
+// in case the standby was restarted with a fresh one.
+class ReplicationWriter {
+public:
+    ReplicationWriter(const std::string& ring_name, int key_frame_interval,
+                      std::chrono::microseconds cycle_budget);
+    explicit ReplicationWriter(const std::string& ring_name);
+
+    void appendStates(const std::vector<AircraftState>& states);
+    void appendAlert(const std::string& text);
+    void appendCommand(const CommandData& command);
+
+    bool isConnected() const { return ring_ && ring_->isOpen(); }
+    ReplicationStats getStats() const { return stats_; }
+
+private:
+    struct SentState {
+        AircraftState state;
+        uint64_t cycle;
+    };
+
+    bool send(std::chrono::steady_clock::time_point start);
+    bool connect();
+
+    std::string ring_name_;
+    std::unique_ptr<ShmRing> ring_;
+    std::chrono::steady_clock::time_point last_connect_attempt_;
+    int key_frame_interval_;
+    std::chrono::microseconds cycle_budget_;
+    int frames_since_key_ = 0;
+    int consecutive_drops_ = 0;
+    bool force_key_ = true;
+    uint64_t sequence_ = 0;
+    uint64_t cycle_ = 0;
+    std::unordered_map<std::string, SentState> sent_;
+    std::string frame_;
+    ReplicationStats stats_;
+};
+
+// Standby side: the primary's state as of the last applied record
+class ReplicaState {
+public:
+    // False for a malformed record or a delta that does not follow the last
+    // applied one; the replica then waits for the next key frame
+    bool apply(const std::string& record);
+
+    bool isSynchronised() const { return synchronised_; }
+    uint64_t getSequence() const { return sequence_; }
+    std::vector<AircraftState> getStates() const;
+    // Records after the last state delta: their effect is not in getStates() yet
+    const std::vector<CommandData>& getPendingCommands() const { return pending_commands_; }
+    const std::vector<std::string>& getRecentAlerts() const { return recent_alerts_; }
+
+    // True once nothing has arrived for `timeout` after the first key frame
+    bool primaryLost(std::chrono::steady_clock::time_point now,
+                     std::chrono::milliseconds timeout) const;
+
+private:
+    bool applyStates(const std::string& record);
+
+    bool synchronised_ = false;
+    bool seeded_ = false;          // has applied a key frame at some point
+    uint64_t sequence_ = 0;
+    std::unordered_map<std::string, AircraftState> states_;
+    std::vector<CommandData> pending_commands_;
+    std::vector<std::string> recent_alerts_;
+    std::chrono::steady_clock::time_point last_record_;
+};
+
+}
+}
+
+#endif // ATC_REPLICATION_H
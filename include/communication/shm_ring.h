@@ -0,0 +1,55 @@
+#ifndef ATC_SHM_RING_H
+#define ATC_SHM_RING_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+namespace atc {
+namespace comm {
+
+struct ShmRingHeader;
+
+// Single-producer, single-consumer ring of variable-length records in a named
+// POSIX shared-memory segment, for handing snapshots and alerts between the
+// processes of a split deployment. The writer never blocks: a record that does
+// not fit is dropped and counted, so a stalled reader cannot hold back the
+// writer. The reader spins briefly and then sleeps on a process-shared
+// semaphore that the writer only posts while the reader is asleep.
+class ShmRing {
+public:
+    explicit ShmRing(const std::string& name);
+    ~ShmRing();
+    ShmRing(const ShmRing&) = delete;
+    ShmRing& operator=(const ShmRing&) = delete;
+
+    // Creates a fresh segment (replacing a stale one); the creator unlinks it on destruction.
+    // Capacity is rounded up to a power of two.
+    bool create(size_t capacity);
+    // Maps a segment created by another process
+    bool open();
+
+    bool write(const void* data, size_t size);
+    // Waits up to timeout_us for a record; 0 only polls
+    bool read(std::string& out, int64_t timeout_us);
+
+    bool isOpen() const { return header_ != nullptr; }
+    size_t getCapacity() const;
+    size_t getMaxRecordSize() const;
+    uint64_t getDroppedCount() const;
+
+private:
+    bool map(size_t capacity, bool create);
+    void unmap();
+
+    std::string name_;
+    ShmRingHeader* header_ = nullptr;
+    char* data_ = nullptr;
+    size_t mapped_size_ = 0;
+    bool owner_ = false;
+};
+
+}
+}
+
+#endif // ATC_SHM_RING_H
@@ -0,0 +1,29 @@
+#ifndef ATC_SITUATION_FRAMES_H
+#define ATC_SITUATION_FRAMES_H
+
+#include "common/types.h"
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace atc {
+namespace comm {
+
+// Records exchanged over the shared-memory rings of a split deployment. The
+// first byte is the kind; states keep full precision since detection runs on them.
+enum class FrameKind : uint8_t {
+    TRACK_STATES = 1,
+    ALERT = 2
+};
+
+void encodeTrackStates(const std::vector<AircraftState>& states, std::string& out);
+void encodeAlert(const std::string& text, std::string& out);
+
+bool frameKind(const std::string& frame, FrameKind& kind);
+bool decodeTrackStates(const std::string& frame, std::vector<AircraftState>& states);
+bool decodeAlert(const std::string& frame, std::string& text);
+
+}
+}
+
+#endif // ATC_SITUATION_FRAMES_H
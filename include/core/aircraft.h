@@ -3,6 +3,8 @@
 
 #include "common/periodic_task.h"
 #include "common/types.h"
+#include "common/logger.h"
+#include "core/route.h"
 #include <mutex>
 #include <string>
 
@@ -22,9 +24,18 @@ public:
     bool updateSpeed(double new_speed);
     bool updateHeading(double new_heading);
     bool updateAltitude(double new_altitude);
+    // Fly this route from its first fix, at its cruise speed when that is valid.
+    // A heading clearance leaves the route; speed and altitude clearances keep it.
+    void setRoute(const std::shared_ptr<const Route>& route);
 
     // Method to get current state
     AircraftState getState() const;
+    // Route progress together with the state it belongs to
+    RouteProgress getRouteProgress(AircraftState& state) const;
+    // Fixed at construction, so lookups need not copy the state under its lock
+    const std::string& getCallsign() const { return callsign_; }
+    // For tracks mirrored from another process; the mirror's own task is never started
+    void setState(const AircraftState& state);
 
     // Static method to get status string
     static std::string getStatusString(AircraftStatus status);
@@ -34,12 +45,25 @@ protected:
 
 private:
     void updatePosition();
+    // Takes a new velocity version if the state has left its line; call after every change
+    void followLine();
     bool validateSpeed(double speed) const;
     bool validateAltitude(double altitude) const;
-    void logState(const std::string& event, const AircraftState& state);
+    void logState(const std::string& event, const AircraftState& state,
+                  LogLevel level = LogLevel::INFO);
 
+    const std::string callsign_;
     mutable std::mutex state_mutex_;
     AircraftState state_;
+    RouteProgress route_;
+    // The line flown since the velocity version last changed
+    struct Line {
+        Position origin;
+        Velocity velocity;
+        double time;        // at origin, seconds
+        double latest;      // of the latest state on the line
+    };
+    Line line_{};
 };
 
 } // namespace atc
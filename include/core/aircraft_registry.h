@@ -0,0 +1,42 @@
+#ifndef ATC_AIRCRAFT_REGISTRY_H
+#define ATC_AIRCRAFT_REGISTRY_H
+
+#include "core/aircraft.h"
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace atc {
+
+// Aircraft by callsign, kept in one dense vector for the per-cycle scans.
+// Adding and removing are O(1) amortized. Removal moves the last aircraft into
+// the gap, so iteration order is not arrival order, but it is the same for the
+// same sequence of adds and removes. Not thread-safe; owners lock around it.
+class AircraftRegistry {
+public:
+    using List = std::vector<std::shared_ptr<Aircraft>>;
+
+    // False if the callsign is already registered
+    bool add(const std::shared_ptr<Aircraft>& aircraft);
+    // The removed aircraft, or null if the callsign is not registered
+    std::shared_ptr<Aircraft> remove(const std::string& callsign);
+    std::shared_ptr<Aircraft> find(const std::string& callsign) const;
+    bool contains(const std::string& callsign) const { return index_.count(callsign) != 0; }
+    void clear();
+
+    const List& all() const { return aircraft_; }
+    size_t size() const { return aircraft_.size(); }
+    bool empty() const { return aircraft_.empty(); }
+    const std::shared_ptr<Aircraft>& operator[](size_t i) const { return aircraft_[i]; }
+    List::const_iterator begin() const { return aircraft_.begin(); }
+    List::const_iterator end() const { return aircraft_.end(); }
+
+private:
+    List aircraft_;
+    std::unordered_map<std::string, size_t> index_;
+};
+
+}
+
+#endif // ATC_AIRCRAFT_REGISTRY_H
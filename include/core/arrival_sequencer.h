@@ -0,0 +1,64 @@
+#ifndef ATC_ARRIVAL_SEQUENCER_H
+#define ATC_ARRIVAL_SEQUENCER_H
+
+#include "core/route.h"
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace atc {
+
+// Landing sequence for aircraft whose route ends at the runway fix. ETAs come
+// from the predicted trajectories and change only when a trajectory is rebuilt.
+// Each pass orders the aircraft first come, first served by ETA. An aircraft
+// may then swap with its neighbour when that lowers the total delay. Aircraft
+// due within ARRIVAL_FREEZE_TIME keep their place. Scheduled times keep
+// wake-category spacing behind each leader. Delayed aircraft get a speed
+// advisory, or a hold if even MIN_SPEED arrives too early. Not thread-safe.
+class ArrivalSequencer {
+public:
+    struct Slot {
+        std::string callsign;
+        WakeCategory wake;
+        double eta;             // seconds over the runway fix, trajectory clock
+        double scheduled;       // landing slot time
+        double advised_speed;   // 0 if no speed change is needed
+        bool hold;              // the delay cannot be absorbed by slowing down
+    };
+
+    explicit ArrivalSequencer(const Position& runway_fix);
+
+    // Takes a new trajectory for a routed aircraft. False, and the aircraft
+    // leaves the sequence, if the route does not end at the runway fix.
+    bool update(const std::string& callsign, const Route& route,
+                const std::shared_ptr<const Trajectory>& trajectory);
+    void remove(const std::string& callsign);
+
+    // Re-sequences at `now`. Returns the slots whose advisory changed since the last pass.
+    std::vector<Slot> resequence(double now);
+    const std::vector<Slot>& sequence() const { return sequence_; }
+
+    // Seconds between a leader and its follower over the runway fix
+    static double spacing(WakeCategory leader, WakeCategory follower);
+
+private:
+    struct Inbound {
+        WakeCategory wake;
+        double eta;
+        double speed;            // ground speed the ETA assumes
+        double advised_speed;    // last advisory handed out
+        bool hold;
+    };
+
+    void schedule(size_t from, double leader_time, WakeCategory leader_wake);
+    void improveOrder(size_t from, double leader_time, WakeCategory leader_wake);
+
+    Position runway_fix_;
+    std::unordered_map<std::string, Inbound> inbound_;
+    std::vector<Slot> sequence_;
+};
+
+}
+
+#endif // ATC_ARRIVAL_SEQUENCER_H
@@ -0,0 +1,171 @@
+#ifndef ATC_KINETIC_SCHEDULE_H
+#define ATC_KINETIC_SCHEDULE_H
+
+#include "common/constants.h"
+#include "common/types.h"
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <functional>
+#include <queue>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace atc {
+
+// When each aircraft pair next needs a separation check (kinetic detection).
+// Between reports an aircraft that is not on a route flies a straight line,
+// so its geometry against any other aircraft is known in advance. After a
+// pair is checked, the schedule solves for the first time its classification
+// could change. That is when its horizontal or vertical distance comes within
+// a margin of a separation threshold, or its closest approach enters the
+// lookahead window. Until then the pair is not checked. The margins cover
+// reports up to KINETIC_MAX_REPORT_AGE old and KINETIC_DRIFT_TOLERANCE off
+// the line.
+//
+// Every pair of an aircraft is checked again when it joins or reports off
+// its line: after a clearance (intent version), a velocity change, drift or
+// a late report. So is every pair of an aircraft on a route. Pairs in
+// conflict are checked every pass. Not thread-safe.
+class KineticSchedule {
+public:
+    struct Track {
+        const AircraftState* state;
+        bool routed;
+        uint64_t intent_version;
+    };
+
+    // Pairs of tracks (indices, first < second, in order) to check at `now`.
+    // Every other pair keeps the classification it was last checked with.
+    // Aircraft missing from `tracks` are forgotten. Report every due pair
+    // back through checked().
+    const std::vector<std::pair<size_t, size_t>>& due(const std::vector<Track>& tracks,
+                                                      double now, double lookahead);
+    // Outcome of a due pair's check: whether it is, or may be, in conflict
+    void checked(size_t first, size_t second, bool conflict);
+    // Forgets everything, so the next pass checks every pair
+    void reset();
+
+    // Pairs waiting on an event; the others only change with their aircraft
+    size_t scheduledPairs() const { return generations_.size(); }
+
+private:
+    struct Model {
+        Position position;
+        Velocity velocity;
+        double time;
+        uint64_t intent_version;
+    };
+
+    struct Slot {
+        std::string callsign;
+        Model model;
+        size_t index;       // in this pass's tracks
+        uint64_t seen;      // last pass it was in
+        bool live;
+        bool moved;         // model replaced this pass
+    };
+
+    struct Event {
+        double time;
+        uint32_t first;
+        uint32_t second;
+        uint64_t generation;
+        bool operator>(const Event& other) const { return time > other.time; }
+    };
+
+    static uint64_t pairKey(uint32_t first, uint32_t second);
+    bool follows(const Model& model, const Track& track) const;
+    // The first time the pair's classification could differ from now, or infinity
+    double nextChange(const Model& first, const Model& second) const;
+    uint32_t acquire(const std::string& callsign);
+    void release(uint32_t slot);
+    void addDue(uint32_t first, uint32_t second);
+
+    double now_ = 0.0;
+    double lookahead_ = 0.0;
+    uint64_t pass_ = 0;
+    uint64_t generation_ = 0;
+    std::vector<Slot> slots_;
+    std::vector<uint32_t> free_slots_;
+    std::unordered_map<std::string, uint32_t> by_callsign_;
+    // Generation of each pair's pending event; a popped event is current only if it matches
+    std::unordered_map<uint64_t, uint64_t> generations_;
+    std::priority_queue<Event, std::vector<Event>, std::greater<Event>> events_;
+    std::vector<uint32_t> track_slots_;
+    std::vector<uint32_t> moved_;
+    std::vector<std::pair<size_t, size_t>> due_;
+};
+
+// One value per aircraft pair, by the pair's indices (first < second) into
+// the caller's aircraft list. Row `first` holds its pairs with each higher
+// index in turn, so a scan in pair order reads them in order. Entries never
+// written are value-initialized.
+template <typename Entry>
+class PairTable {
+public:
+    const Entry* find(size_t first, size_t second) const {
+        size_t column = second - first - 1;
+        if (first >= rows_.size() || column >= rows_[first].size()) return nullptr;
+        return &rows_[first][column];
+    }
+    Entry& operator()(size_t first, size_t second) {
+        if (first >= rows_.size()) rows_.resize(first + 1);
+        auto& row = rows_[first];
+        size_t column = second - first - 1;
+        if (column >= row.size()) row.resize(column + 1, Entry{});
+        return row[column];
+    }
+    void clear() { rows_.clear(); }
+
+private:
+    std::vector<std::vector<Entry>> rows_;
+};
+
+// Divergence certificates: "this pair cannot be in conflict before report
+// time T unless one of them leaves its line" (RouteProgress::velocity_version).
+// A pair gets one when it is clear in a way that does not depend on any
+// prediction: level but at least the minimum apart, stacked at least the
+// minimum apart vertically, or outside the warning range both ways. T is when
+// the horizontal or vertical distance could first reach the edge of that
+// region. T is infinite when the pair is diverging and not closing
+// vertically. A certificate allows for each report lying up to
+// VELOCITY_LINE_TOLERANCE off its line and for the two reports being up to
+// CERTIFICATE_MAX_REPORT_SKEW apart. It is held per pair of indices into the
+// caller's aircraft list, so an aircraft taking another's index finds
+// versions that cannot match. Not thread-safe.
+class PairCertificates {
+public:
+    struct Track {
+        double time;                // of the report, seconds
+        uint64_t velocity_version;
+        const AircraftState* state;
+    };
+
+    // Whether the pair (first < second) holds a certificate for these reports
+    bool holds(size_t first, size_t second, const Track& track1, const Track& track2) const {
+        const Certificate* certificate = certificates_.find(first, second);
+        return certificate && certificate->version1 == track1.velocity_version &&
+               certificate->version2 == track2.velocity_version &&
+               std::max(track1.time, track2.time) < certificate->until &&
+               std::abs(track1.time - track2.time) <= constants::CERTIFICATE_MAX_REPORT_SKEW;
+    }
+    // Certifies a pair just checked and found clear, if its geometry allows
+    void certify(size_t first, size_t second, const Track& track1, const Track& track2);
+    void clear() { certificates_.clear(); }
+
+private:
+    struct Certificate {
+        uint64_t version1;
+        uint64_t version2;
+        double until;
+    };
+
+    PairTable<Certificate> certificates_;
+};
+
+}
+
+#endif // ATC_KINETIC_SCHEDULE_H
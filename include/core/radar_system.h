@@ -5,6 +5,7 @@
 #include "common/types.h"
 #include "communication/qnx_channel.h"
 #include "core/aircraft.h"
+#include "core/aircraft_registry.h"
 #include <memory>
 #include <vector>
 #include <mutex>
@@ -23,6 +24,9 @@ public:
     // Aircraft tracking management
     void addAircraft(const std::shared_ptr<Aircraft>& aircraft);
     void removeAircraft(const std::string& callsign);
+    // One tick's admissions and exits under a single lock
+    void addAircraft(const std::vector<std::shared_ptr<Aircraft>>& aircraft);
+    void removeAircraft(const std::vector<std::string>& callsigns);
 
     // Radar data access
     std::vector<AircraftState> getTrackedAircraft() const;
@@ -51,7 +55,7 @@ private:
 
     std::shared_ptr<comm::QnxChannel> channel_;
     std::unordered_map<std::string, RadarTrack> tracks_;
-    std::vector<std::shared_ptr<Aircraft>> aircraft_;
+    AircraftRegistry aircraft_;
     mutable std::mutex radar_mutex_;
 
     // Performance metrics
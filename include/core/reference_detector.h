@@ -0,0 +1,50 @@
+#ifndef ATC_REFERENCE_DETECTOR_H
+#define ATC_REFERENCE_DETECTOR_H
+
+#include "core/aircraft.h"
+#include "core/route.h"
+#include "core/violation_detector.h"
+#include "common/types.h"
+#include <memory>
+#include <vector>
+
+namespace atc {
+namespace reference {
+
+// Brute-force separation checks kept as the oracle that faster detectors are
+// tested against (test/core/detection_oracle_test.cpp). Every pair is checked
+// with ViolationDetector's rules, without warning cooldowns, and the closest
+// approach is searched on its own. This code is written to be obviously right
+// rather than fast. Keep it that way, and do not share its code with the
+// detectors it checks.
+
+struct Flight {
+    AircraftState state;
+    Trajectory trajectory;
+};
+
+// The aircraft's current states, each with a trajectory built afresh
+std::vector<Flight> snapshot(const std::vector<std::shared_ptr<Aircraft>>& aircraft);
+
+// Least horizontal distance over [from, until], at the earliest time it occurs
+ClosestApproach closestApproach(const Trajectory& a, const Trajectory& b, double from, double until);
+
+// Each pair is reported in callsign order, as the detector reports it.
+
+// What ViolationDetector::findConflicts() must find, in any order. Resolution
+// options are left empty.
+std::vector<ViolationDetector::PairConflict> findConflicts(const std::vector<Flight>& flights,
+                                                           double now, double lookahead);
+
+// What ViolationDetector::getCurrentViolations() must find, by callsign
+std::vector<ViolationInfo> currentViolations(const std::vector<Flight>& flights);
+
+// What ViolationDetector::getPredictedViolations() must find, in any order.
+// Resolution options are left empty.
+std::vector<ViolationDetector::ViolationPrediction> predictedViolations(
+    const std::vector<Flight>& flights, double now, double lookahead);
+
+} // namespace reference
+} // namespace atc
+
+#endif // ATC_REFERENCE_DETECTOR_H
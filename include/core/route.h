@@ -0,0 +1,119 @@
+#ifndef ATC_ROUTE_H
+#define ATC_ROUTE_H
+
+#include "common/types.h"
+#include <cstdint>
+#include <limits>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <tuple>
+#include <unordered_map>
+#include <vector>
+
+namespace atc {
+
+using FixId = uint32_t;
+
+// Route points of the airspace, each stored once however many routes pass
+// through it. Fixes are only ever added, so an id stays valid for the life of
+// the database. Thread-safe.
+class FixDatabase {
+public:
+    // Id of the fix at this position, adding it if it is new
+    FixId intern(const Position& position);
+    Position position(FixId id) const;
+    size_t size() const;
+
+private:
+    mutable std::mutex mutex_;
+    std::vector<Position> fixes_;
+    std::map<std::tuple<double, double, double>, FixId> index_;
+};
+
+// A filed route: fix ids into the shared database and the planned speed
+struct Route {
+    std::shared_ptr<const FixDatabase> fixes;
+    std::vector<FixId> waypoints;
+    double cruise_speed;
+    WakeCategory wake = WakeCategory::MEDIUM;
+};
+
+// How far an aircraft has flown along its route and what it is cleared to do.
+// intent_version changes with every new route or clearance, so predictions
+// made from an older version are stale. velocity_version changes whenever the
+// aircraft leaves the straight line it was flying, so while it is unchanged the
+// state stays within VELOCITY_LINE_TOLERANCE of that line. No two aircraft
+// share a velocity version.
+struct RouteProgress {
+    std::shared_ptr<const Route> route;
+    size_t next_waypoint = 0;
+    // Held instead of the fix altitudes once a level is assigned
+    double cleared_altitude = std::numeric_limits<double>::quiet_NaN();
+    uint64_t intent_version = 0;
+    uint64_t velocity_version = 0;
+};
+
+// Predicted flight as straight pieces, each flown at constant velocity from its
+// start time until the next piece starts; the last one continues indefinitely.
+// Times are seconds on the clock of AircraftState::timestamp.
+class Trajectory {
+public:
+    struct Segment {
+        double start;
+        Position position;
+        Velocity velocity;
+    };
+
+    // Current velocity held, as for aircraft without a route
+    static Trajectory straight(const AircraftState& state);
+    // To the end of the route with the model flyRoute() uses
+    static Trajectory alongRoute(const AircraftState& state, RouteProgress progress);
+
+    Position positionAt(double time) const;
+    // When the trajectory passes over this point, or infinity if it never does
+    double timeOver(const Position& point) const;
+    const std::vector<Segment>& segments() const { return segments_; }
+
+private:
+    std::vector<Segment> segments_;
+};
+
+// Predicted trajectories by callsign. One is rebuilt only when the aircraft's
+// intent version changes or it drifts beyond ROUTE_CONFORMANCE_TOLERANCE from
+// the prediction. Not thread-safe.
+class TrajectoryCache {
+public:
+    // Sets rebuilt, if given, when the returned trajectory is not the cached one
+    std::shared_ptr<const Trajectory> get(const AircraftState& state, const RouteProgress& progress,
+                                          bool* rebuilt = nullptr);
+    void erase(const std::string& callsign) { entries_.erase(callsign); }
+
+private:
+    struct Entry {
+        uint64_t intent_version;
+        std::shared_ptr<const Trajectory> trajectory;
+    };
+    std::unordered_map<std::string, Entry> entries_;
+};
+
+// Moves the state dt seconds along its route: straight to each fix at the
+// current ground speed, turning onto the next leg at the fix and changing level
+// at ROUTE_CLIMB_RATE toward the fix (or cleared) altitude. Past the last fix
+// the aircraft holds its heading.
+void flyRoute(AircraftState& state, RouteProgress& progress, double dt);
+
+struct ClosestApproach {
+    double time;        // when the horizontal distance is least
+    double distance;    // that distance
+};
+
+// Least horizontal distance between two trajectories over [from, until],
+// at its earliest time
+ClosestApproach closestApproach(const Trajectory& a, const Trajectory& b,
+                                double from, double until);
+
+}
+
+#endif // ATC_ROUTE_H
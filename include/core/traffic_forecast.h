@@ -0,0 +1,76 @@
+#ifndef ATC_TRAFFIC_FORECAST_H
+#define ATC_TRAFFIC_FORECAST_H
+
+#include "core/route.h"
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace atc {
+
+// Predicted aircraft per sector (the history sector grid) per future time bin.
+// Each aircraft keeps its footprint of (bin, sector) cells, so an entry, new
+// trajectory or exit only changes that aircraft's cells. The window slides one
+// bin at a time and adds only the bin that comes into view. Not thread-safe.
+class TrafficForecast {
+public:
+    struct Overload {
+        uint32_t sector;
+        double bin_start;    // seconds, on the trajectory clock
+        uint32_t aircraft;
+    };
+
+    TrafficForecast(size_t bins, double bin_seconds, uint32_t capacity);
+
+    // Slides the window so it starts with the bin holding `now`
+    void advance(double now);
+    // Sets or replaces an aircraft's predicted trajectory
+    void update(const std::string& callsign, const std::shared_ptr<const Trajectory>& trajectory);
+    void remove(const std::string& callsign);
+
+    // Aircraft in the sector during a bin; bin 0 is the one holding the current time
+    uint32_t count(uint32_t sector, size_t bin) const;
+    // The whole window, bin-major: counts()[bin * sectors() + sector]
+    std::vector<uint32_t> counts() const;
+    // Sector bins that went over capacity since the last call, each reported once
+    std::vector<Overload> takeOverloads();
+
+    double windowStart() const { return static_cast<double>(first_bin_) * bin_seconds_; }
+    size_t bins() const { return bins_; }
+    uint32_t sectors() const { return sectors_; }
+    size_t aircraftCount() const { return aircraft_.size(); }
+
+private:
+    struct Cell {
+        int64_t bin;
+        uint32_t sector;
+    };
+
+    struct Footprint {
+        std::shared_ptr<const Trajectory> trajectory;
+        std::deque<Cell> cells;   // ascending bins
+    };
+
+    size_t slotOf(int64_t bin, uint32_t sector) const;
+    void addBin(Footprint& footprint, int64_t bin);
+    void clearBin(int64_t bin);
+    bool inWindow(int64_t bin) const { return bin >= first_bin_ && bin < first_bin_ + static_cast<int64_t>(bins_); }
+
+    const size_t bins_;
+    const double bin_seconds_;
+    const uint32_t capacity_;
+    const uint32_t sectors_;
+    int64_t first_bin_ = 0;
+    bool started_ = false;
+    std::vector<uint32_t> counts_;   // ring over bins, sectors_ per bin
+    std::vector<bool> reported_;     // overloads already handed out, same layout
+    std::vector<Cell> overloads_;    // reported on the next takeOverloads()
+    std::unordered_map<std::string, Footprint> aircraft_;
+};
+
+}
+
+#endif // ATC_TRAFFIC_FORECAST_H
@@ -3,7 +3,12 @@
 
 #include "common/periodic_task.h"
 #include "core/aircraft.h"
+#include "core/aircraft_registry.h"
+#include "core/kinetic_schedule.h"
+#include "core/route.h"
 #include "common/types.h"
+#include "common/conflict_log.h"
+#include <chrono>
 #include <vector>
 #include <memory>
 #include <mutex>
@@ -29,14 +34,54 @@ public:
         std::time_t last_warning;
     };
 
+    // What a detection pass finds for one pair, before warning cooldowns apply
+    struct PairConflict {
+        ConflictKind kind;
+        double horizontal_separation;     // now
+        double vertical_separation;
+        ViolationInfo violation;          // for VIOLATION
+        ViolationPrediction prediction;   // for the warnings
+    };
+
+    // Pairs a detection pass found needing a check, and how it got on
+    struct Coverage {
+        size_t candidates = 0;
+        size_t refreshed = 0;
+        size_t overdue_deferred = 0;      // left unchecked past their refresh deadline
+    };
+
     ViolationDetector();
     ~ViolationDetector() = default;
 
     void addAircraft(const std::shared_ptr<Aircraft>& aircraft);
     void removeAircraft(const std::string& callsign);
+    // One tick's admissions and exits under a single lock
+    void addAircraft(const std::vector<std::shared_ptr<Aircraft>>& aircraft);
+    void removeAircraft(const std::vector<std::string>& callsigns);
     void setLookaheadTime(int seconds);
+    void setConflictLog(const std::shared_ptr<ConflictLog>& log);
+    // Kinetic mode checks a pair only when its classification could have
+    // changed (see KineticSchedule) rather than every pair every pass
+    void setKinetic(bool enabled);
+    // Pairs holding a divergence certificate (see PairCertificates) are not
+    // checked at all. On by default.
+    void setCertificates(bool enabled);
+    // Anytime mode: a pass checks pairs in order of refresh deadline, most
+    // urgent first, and stops once its checks have run for `budget`; the rest
+    // carry over to the next pass. Zero, the default, checks them all.
+    // Ignored in virtual time, where a replay must check the same pairs its
+    // recording did.
+    void setCheckBudget(std::chrono::nanoseconds budget);
+    // Of the last periodic pass
+    Coverage getLastCoverage() const;
+    // Each pair names its aircraft in callsign order, and the results come
+    // sorted by callsign, soonest first for predictions. None of it depends
+    // on the order aircraft were added in or on the detection mode.
     std::vector<ViolationInfo> getCurrentViolations() const;
     std::vector<ViolationPrediction> getPredictedViolations() const;
+    // Every pair the next pass would report, ignoring cooldowns; what faster
+    // detectors are checked against the reference detector with
+    std::vector<PairConflict> findConflicts() const;
 
 protected:
     void execute() override;
@@ -47,28 +92,54 @@ private:
     static constexpr double CRITICAL_WARNING_THRESHOLD = 2.0; // 200% of minimum separation
     static constexpr int WARNING_COOLDOWN = 15;              // Seconds between warnings
 
+    // An aircraft's state and predicted trajectory, taken together once per pass
+    struct Flight {
+        AircraftState state;
+        std::shared_ptr<const Trajectory> trajectory;
+        bool routed;
+        uint64_t intent_version;
+        uint64_t velocity_version;
+    };
+
     void checkViolations();
+    std::vector<Flight> snapshotFlights() const;
+    // When a pair must next be checked under a budget: its last check plus
+    // its time to closest approach, or then if it was in conflict. Pairs not
+    // checked since either velocity version changed are due at once.
+    struct RefreshDeadline {
+        uint64_t version1;
+        uint64_t version2;
+        double time;
+    };
+
+    // Calls check(i, j) for every pair of flights that may be in conflict at
+    // `now` and holds no certificate; check returns false only if the pair
+    // certainly is not. A budgeted pass stops at the budget, most urgent first.
+    template <typename Check>
+    Coverage forCandidatePairs(const std::vector<Flight>& flights, double now, Check check,
+                               bool budgeted = false) const;
+
+    // Fills in the pair's current separation; true if it is close enough to warn about
+    bool withinWarningRange(const AircraftState& state1, const AircraftState& state2,
+                            PairConflict& conflict) const;
+    // The rest of the check for a pair within warning range
+    bool classifyPair(const Flight& flight1, const Flight& flight2, double now,
+                      PairConflict& conflict) const;
+    void reportConflict(const PairConflict& conflict);
 
     bool checkPairViolation(
         const AircraftState& state1,
         const AircraftState& state2,
         ViolationInfo& violation) const;
 
-    bool canIssueWarning(const std::string& ac1, const std::string& ac2);
+    bool canIssueWarning(const std::string& ac1, const std::string& ac2) const;
     void updateWarning(const std::string& ac1, const std::string& ac2);
     void cleanupWarnings();
 
-    Position predictPosition(
-        const AircraftState& state,
-        double time_seconds) const;
-
     ViolationPrediction predictViolation(
-        const AircraftState& state1,
-        const AircraftState& state2) const;
-
-    double calculateTimeToMinimumSeparation(
-        const AircraftState& state1,
-        const AircraftState& state2) const;
+        const Flight& flight1,
+        const Flight& flight2,
+        double now) const;
 
     std::vector<std::string> generateResolutionOptions(
         const AircraftState& state1,
@@ -79,10 +150,21 @@ private:
     void handleMediumWarning(const ViolationPrediction& prediction);
     void handleEarlyWarning(const ViolationPrediction& prediction);
     void logViolation(const ViolationInfo& violation) const;
+    void recordConflict(ConflictKind kind, const ViolationInfo* violation,
+                        const ViolationPrediction* prediction,
+                        double horizontal_separation, double vertical_separation);
 
     mutable std::mutex mutex_;
-    std::vector<std::shared_ptr<Aircraft>> aircraft_;
+    AircraftRegistry aircraft_;
+    mutable TrajectoryCache trajectories_;
     std::vector<WarningRecord> warnings_;
+    std::shared_ptr<ConflictLog> conflict_log_;
+    std::unique_ptr<KineticSchedule> kinetic_;   // null unless in kinetic mode
+    mutable PairCertificates certificates_;
+    bool certify_ = true;
+    mutable PairTable<RefreshDeadline> deadlines_;
+    std::chrono::nanoseconds check_budget_{0};
+    Coverage coverage_;
     int lookahead_time_seconds_;
 };
 
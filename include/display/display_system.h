@@ -4,6 +4,8 @@
 #include "common/periodic_task.h"
 #include "core/violation_detector.h"
 #include "core/aircraft.h"
+#include "common/trail_store.h"
+#include "display/label_layout.h"
 #include <memory>
 #include <mutex>
 #include <vector>
@@ -23,6 +25,7 @@ public:
     void removeAircraft(const std::string& callsign);
     void displayAlert(const std::string& alert_message);
     void updateDisplay(const std::vector<std::shared_ptr<Aircraft>>& current_aircraft);
+    void setTrailStore(const std::shared_ptr<TrailStore>& trails);
 
 protected:
     void execute() override;
@@ -46,14 +49,6 @@ private:
     static constexpr double WARNING_MEDIUM = 1.5;    // 150% of minimum separation
     static constexpr double WARNING_CRITICAL = 1.2;  // 120% of minimum separation
 
-    enum class WarningLevel {
-        NONE,
-        EARLY,
-        MEDIUM,
-        CRITICAL,
-        VIOLATION
-    };
-
     // Direction indicators
     const char DIRECTION_SYMBOLS[8] = {'^', '/', '>', '\\', 'v', '/', '<', '\\'};
 
@@ -67,6 +62,8 @@ private:
         AircraftStatus status;
         WarningLevel warning_level;
         bool is_predicted;
+        bool is_trail;
+        int count;  // aircraft merged into this label
 
         AircraftDisplayInfo()
             : marker(' ')
@@ -75,7 +72,15 @@ private:
             , altitude(0.0)
             , status(AircraftStatus::CRUISING)
             , warning_level(WarningLevel::NONE)
-            , is_predicted(false) {}
+            , is_predicted(false)
+            , is_trail(false)
+            , count(0) {}
+    };
+
+    // Aircraft whose label collided with another in the last frame
+    struct LabelCollisions {
+        int offset = 0;   // moved to a neighbouring cell
+        int merged = 0;   // folded into an existing label's count
     };
 
     // Display methods
@@ -108,12 +113,15 @@ private:
     static constexpr int MAX_DISPLAY_UPDATE = 10000; // milliseconds
 
     static constexpr char PREDICTED_POSITION_MARKER = '*';
+    static constexpr char TRAIL_MARKER = '.';
 
     // Member variables
     mutable std::mutex display_mutex_;
     std::vector<std::shared_ptr<Aircraft>> aircraft_;
     std::shared_ptr<ViolationDetector> violation_detector_;
+    std::shared_ptr<TrailStore> trails_;
     int update_count_ = 0;
+    mutable LabelCollisions last_collisions_;
     std::string current_alert_message_;
 };
 
@@ -0,0 +1,57 @@
+#ifndef ATC_LABEL_LAYOUT_H
+#define ATC_LABEL_LAYOUT_H
+
+#include <vector>
+
+namespace atc {
+
+enum class WarningLevel {
+    NONE,
+    EARLY,
+    MEDIUM,
+    CRITICAL,
+    VIOLATION
+};
+
+// Where aircraft labels go on the radar grid, one frame at a time. A label
+// whose cell is taken moves to the first free neighbour. Once all eight are
+// taken it is folded into the label already there, which then shows the
+// count and the highest warning among the aircraft it holds. Predicted
+// positions are only drawn in cells without a label.
+class LabelLayout {
+public:
+    struct Placement {
+        int x;
+        int y;
+        bool merged;    // folded into the label at (x, y)
+    };
+
+    LabelLayout(int width, int height);
+
+    // Places one aircraft's label for its cell (x, y), which must be on the grid
+    Placement place(int x, int y, WarningLevel warning);
+    bool mayMarkPrediction(int x, int y) const { return !labelled(x, y); }
+
+    bool labelled(int x, int y) const { return count(x, y) > 0; }
+    // Aircraft sharing the label at (x, y)
+    int count(int x, int y) const { return counts_[y * width_ + x]; }
+    WarningLevel warning(int x, int y) const { return warnings_[y * width_ + x]; }
+
+    // Labels moved to a neighbour, and folded into another, so far this frame
+    int moved() const { return moved_; }
+    int merged() const { return merged_; }
+
+private:
+    bool findFreeNeighbour(int& x, int& y) const;
+
+    int width_;
+    int height_;
+    std::vector<int> counts_;
+    std::vector<WarningLevel> warnings_;
+    int moved_ = 0;
+    int merged_ = 0;
+};
+
+}
+
+#endif // ATC_LABEL_LAYOUT_H
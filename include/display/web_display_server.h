@@ -0,0 +1,85 @@
+#ifndef ATC_WEB_DISPLAY_SERVER_H
+#define ATC_WEB_DISPLAY_SERVER_H
+
+#include "common/snapshot_delta.h"
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace atc {
+
+// Localhost HTTP + WebSocket endpoint for a browser situation display.
+// GET / serves the page and GET /metrics the process metrics (metrics.h).
+// /ws upgrades to a WebSocket that streams binary snapshot frames (see
+// snapshot_delta.h). Each client has at most one frame in its send queue.
+// When the queue drains it gets a single delta from the last snapshot it was
+// sent to the newest one, so a slow client skips snapshots instead of holding
+// back publish() or other clients.
+class WebDisplayServer {
+public:
+    explicit WebDisplayServer(uint16_t port, std::string page = defaultPage());
+    ~WebDisplayServer();
+    WebDisplayServer(const WebDisplayServer&) = delete;
+    WebDisplayServer& operator=(const WebDisplayServer&) = delete;
+
+    // Binds 127.0.0.1:port (0 picks a free port) and starts the I/O thread
+    bool start();
+    void stop();
+
+    // Never blocks on clients
+    void publish(std::shared_ptr<const Snapshot> snapshot);
+
+    uint16_t getPort() const { return port_; }
+    size_t getClientCount() const { return client_count_; }
+    uint64_t getFramesSent() const { return frames_sent_; }
+    uint64_t getSnapshotsConflated() const { return snapshots_conflated_; }
+
+    static const std::string& defaultPage();
+
+private:
+    struct Client {
+        int fd;
+        bool websocket = false;
+        bool closing = false;     // drop once `out` is written
+        std::string in;
+        std::string out;
+        size_t out_offset = 0;
+        std::shared_ptr<const Snapshot> sent;
+    };
+
+    void run();
+    void acceptClients();
+    bool readClient(Client& client);
+    bool handleRequest(Client& client);
+    bool handleFrames(Client& client);
+    void queueSnapshot(Client& client, const std::shared_ptr<const Snapshot>& latest);
+    bool writeClient(Client& client);
+    void queueFrame(Client& client, uint8_t opcode, const char* data, size_t size);
+    void wake();
+
+    uint16_t port_;
+    const std::string page_;
+    int listen_fd_ = -1;
+    int wake_fds_[2] = {-1, -1};
+    std::thread thread_;
+    std::atomic<bool> running_{false};
+
+    std::mutex snapshot_mutex_;
+    std::shared_ptr<const Snapshot> latest_;
+
+    // Owned by the I/O thread
+    std::vector<Client> clients_;
+    std::string frame_scratch_;
+
+    std::atomic<size_t> client_count_{0};
+    std::atomic<uint64_t> frames_sent_{0};
+    std::atomic<uint64_t> snapshots_conflated_{0};
+};
+
+}
+
+#endif // ATC_WEB_DISPLAY_SERVER_H
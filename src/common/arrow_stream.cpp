@@ -0,0 +1,396 @@
+#include "common/arrow_stream.h"
+#include <algorithm>
+#include <cstring>
+
+namespace atc {
+
+namespace {
+
+// Arrow flatbuffer schema constants (Schema.fbs / Message.fbs)
+constexpr int16_t METADATA_V5 = 4;
+constexpr uint8_t HEADER_SCHEMA = 1;
+constexpr uint8_t HEADER_DICTIONARY_BATCH = 2;
+constexpr uint8_t HEADER_RECORD_BATCH = 3;
+constexpr uint8_t TYPE_INT = 2;
+constexpr uint8_t TYPE_FLOATING_POINT = 3;
+constexpr uint8_t TYPE_UTF8 = 5;
+constexpr uint8_t TYPE_TIMESTAMP = 10;
+constexpr int16_t PRECISION_DOUBLE = 2;
+constexpr int16_t UNIT_MILLISECOND = 1;
+constexpr uint32_t CONTINUATION = 0xFFFFFFFF;
+
+struct FieldNode {
+    int64_t length;
+    int64_t null_count;
+};
+
+struct BufferSpec {
+    int64_t offset;
+    int64_t length;
+};
+
+uint64_t padded(uint64_t size) {
+    return (size + 7) & ~uint64_t(7);
+}
+
+// Back-to-front flatbuffer builder covering the subset Arrow metadata needs:
+// tables with scalar/offset fields, strings, offset vectors and struct vectors
+class FlatBuilder {
+public:
+    FlatBuilder() : buffer_(512), head_(buffer_.size()) {}
+
+    uint32_t size() const { return static_cast<uint32_t>(buffer_.size() - head_); }
+
+    uint32_t createString(const std::string& text) {
+        prep(4, text.size() + 1);
+        push<uint8_t>(0);
+        pushBytes(text.data(), text.size());
+        push<uint32_t>(static_cast<uint32_t>(text.size()));
+        return size();
+    }
+
+    uint32_t createStructVector(const void* data, size_t count, size_t element_size) {
+        prep(4, count * element_size);
+        prep(8, count * element_size);
+        pushBytes(data, count * element_size);
+        push<uint32_t>(static_cast<uint32_t>(count));
+        return size();
+    }
+
+    uint32_t createOffsetVector(const std::vector<uint32_t>& offsets) {
+        prep(4, offsets.size() * 4);
+        for (auto it = offsets.rbegin(); it != offsets.rend(); ++it) {
+            push<uint32_t>(size() + 4 - *it);
+        }
+        push<uint32_t>(static_cast<uint32_t>(offsets.size()));
+        return size();
+    }
+
+    void startTable() {
+        slots_.clear();
+        table_start_ = size();
+    }
+
+    template <typename T>
+    void addScalar(uint16_t id, T value) {
+        prep(sizeof(T), 0);
+        push<T>(value);
+        slots_.push_back({id, size()});
+    }
+
+    void addOffset(uint16_t id, uint32_t target) {
+        prep(4, 0);
+        push<uint32_t>(size() + 4 - target);
+        slots_.push_back({id, size()});
+    }
+
+    uint32_t endTable() {
+        prep(4, 0);
+        push<int32_t>(0);
+        uint32_t table = size();
+
+        uint16_t slot_count = 0;
+        for (const auto& slot : slots_) {
+            slot_count = std::max<uint16_t>(slot_count, slot.id + 1);
+        }
+        std::vector<uint16_t> vtable(slot_count, 0);
+        for (const auto& slot : slots_) {
+            vtable[slot.id] = static_cast<uint16_t>(table - slot.offset);
+        }
+        for (auto it = vtable.rbegin(); it != vtable.rend(); ++it) {
+            push<uint16_t>(*it);
+        }
+        push<uint16_t>(static_cast<uint16_t>(table - table_start_));
+        push<uint16_t>(static_cast<uint16_t>(4 + 2 * slot_count));
+
+        // The table's first word points back to its vtable
+        int32_t vtable_distance = static_cast<int32_t>(size() - table);
+        std::memcpy(&buffer_[buffer_.size() - table], &vtable_distance, sizeof(vtable_distance));
+        return table;
+    }
+
+    std::vector<uint8_t> finish(uint32_t root) {
+        prep(8, 4);
+        push<uint32_t>(size() + 4 - root);
+        return std::vector<uint8_t>(buffer_.begin() + head_, buffer_.end());
+    }
+
+private:
+    struct Slot {
+        uint16_t id;
+        uint32_t offset;
+    };
+
+    void reserve(size_t bytes) {
+        if (head_ >= bytes) return;
+        size_t used = size();
+        std::vector<uint8_t> grown(std::max(buffer_.size() * 2, used + bytes));
+        std::memcpy(grown.data() + grown.size() - used, buffer_.data() + head_, used);
+        head_ = grown.size() - used;
+        buffer_.swap(grown);
+    }
+
+    void prep(size_t alignment, size_t additional) {
+        size_t padding = (~(size() + additional) + 1) & (alignment - 1);
+        reserve(padding);
+        for (size_t i = 0; i < padding; ++i) {
+            buffer_[--head_] = 0;
+        }
+    }
+
+    void pushBytes(const void* data, size_t bytes) {
+        reserve(bytes);
+        head_ -= bytes;
+        if (bytes > 0) {
+            std::memcpy(&buffer_[head_], data, bytes);
+        }
+    }
+
+    template <typename T>
+    void push(T value) {
+        pushBytes(&value, sizeof(T));
+    }
+
+    std::vector<uint8_t> buffer_;
+    size_t head_;
+    std::vector<Slot> slots_;
+    uint32_t table_start_ = 0;
+};
+
+uint32_t createIntType(FlatBuilder& fb, int32_t bit_width, bool is_signed) {
+    fb.startTable();
+    fb.addScalar<int32_t>(0, bit_width);
+    fb.addScalar<uint8_t>(1, is_signed ? 1 : 0);
+    return fb.endTable();
+}
+
+uint32_t createRecordBatch(FlatBuilder& fb, int64_t rows,
+                           const std::vector<FieldNode>& nodes,
+                           const std::vector<BufferSpec>& buffers) {
+    uint32_t node_vector = fb.createStructVector(nodes.data(), nodes.size(), sizeof(FieldNode));
+    uint32_t buffer_vector = fb.createStructVector(buffers.data(), buffers.size(), sizeof(BufferSpec));
+    fb.startTable();
+    fb.addScalar<int64_t>(0, rows);
+    fb.addOffset(1, node_vector);
+    fb.addOffset(2, buffer_vector);
+    return fb.endTable();
+}
+
+std::vector<uint8_t> finishMessage(FlatBuilder& fb, uint8_t header_type, uint32_t header,
+                                   int64_t body_length) {
+    fb.startTable();
+    fb.addScalar<int64_t>(3, body_length);
+    fb.addOffset(2, header);
+    fb.addScalar<int16_t>(0, METADATA_V5);
+    fb.addScalar<uint8_t>(1, header_type);
+    return fb.finish(fb.endTable());
+}
+
+size_t valueWidth(ArrowStreamWriter::Type type) {
+    switch (type) {
+        case ArrowStreamWriter::Type::INT64:
+        case ArrowStreamWriter::Type::TIMESTAMP_MS:
+        case ArrowStreamWriter::Type::FLOAT64:
+            return 8;
+        case ArrowStreamWriter::Type::DICTIONARY_UTF8:
+            return 4;
+        case ArrowStreamWriter::Type::UINT8:
+            return 1;
+        case ArrowStreamWriter::Type::UTF8:
+            return 0;
+    }
+    return 0;
+}
+
+// Body layout shared by record and dictionary batches: an empty validity
+// buffer per column, then offsets (UTF8 only) and values
+void addBuffers(std::vector<BufferSpec>& specs, std::vector<const void*>& data,
+                uint64_t& body_length, const void* values, uint64_t length) {
+    specs.push_back({static_cast<int64_t>(body_length), static_cast<int64_t>(length)});
+    data.push_back(values);
+    body_length += padded(length);
+}
+
+} // namespace
+
+ArrowStreamWriter::ArrowStreamWriter(std::ostream& out)
+    : out_(out)
+    , bytes_written_(0) {
+}
+
+void ArrowStreamWriter::write(const void* data, size_t size) {
+    out_.write(static_cast<const char*>(data), static_cast<std::streamsize>(size));
+    bytes_written_ += size;
+}
+
+bool ArrowStreamWriter::writeMessage(const std::vector<uint8_t>& metadata,
+                                     const std::vector<Buffer>& body) {
+    static const uint8_t zeros[8] = {};
+
+    // Continuation marker and metadata length keep the body 8-byte aligned
+    uint32_t metadata_length = static_cast<uint32_t>(padded(metadata.size()));
+    write(&CONTINUATION, sizeof(CONTINUATION));
+    write(&metadata_length, sizeof(metadata_length));
+    write(metadata.data(), metadata.size());
+    write(zeros, metadata_length - metadata.size());
+
+    for (const auto& buffer : body) {
+        if (buffer.length > 0) {
+            write(buffer.data, buffer.length);
+        }
+        write(zeros, padded(buffer.length) - buffer.length);
+    }
+    return out_.good();
+}
+
+bool ArrowStreamWriter::writeSchema(const std::vector<Field>& fields) {
+    fields_ = fields;
+
+    FlatBuilder fb;
+    uint32_t no_children = fb.createOffsetVector({});
+    std::vector<uint32_t> field_offsets;
+    for (size_t i = 0; i < fields.size(); ++i) {
+        const Field& field = fields[i];
+        uint32_t name = fb.createString(field.name);
+
+        uint8_t type_type = 0;
+        uint32_t type = 0;
+        uint32_t dictionary = 0;
+        switch (field.type) {
+            case Type::INT64:
+                type_type = TYPE_INT;
+                type = createIntType(fb, 64, true);
+                break;
+            case Type::UINT8:
+                type_type = TYPE_INT;
+                type = createIntType(fb, 8, false);
+                break;
+            case Type::FLOAT64:
+                type_type = TYPE_FLOATING_POINT;
+                fb.startTable();
+                fb.addScalar<int16_t>(0, PRECISION_DOUBLE);
+                type = fb.endTable();
+                break;
+            case Type::TIMESTAMP_MS: {
+                uint32_t timezone = fb.createString("UTC");
+                type_type = TYPE_TIMESTAMP;
+                fb.startTable();
+                fb.addOffset(1, timezone);
+                fb.addScalar<int16_t>(0, UNIT_MILLISECOND);
+                type = fb.endTable();
+                break;
+            }
+            case Type::DICTIONARY_UTF8: {
+                uint32_t index_type = createIntType(fb, 32, true);
+                fb.startTable();
+                fb.addScalar<int64_t>(0, static_cast<int64_t>(i));
+                fb.addOffset(1, index_type);
+                dictionary = fb.endTable();
+                // The field's own type is the dictionary value type
+                [[fallthrough]];
+            }
+            case Type::UTF8:
+                type_type = TYPE_UTF8;
+                fb.startTable();
+                type = fb.endTable();
+                break;
+        }
+
+        fb.startTable();
+        fb.addOffset(0, name);
+        fb.addOffset(3, type);
+        if (dictionary != 0) {
+            fb.addOffset(4, dictionary);
+        }
+        fb.addOffset(5, no_children);
+        fb.addScalar<uint8_t>(1, 0);  // not nullable
+        fb.addScalar<uint8_t>(2, type_type);
+        field_offsets.push_back(fb.endTable());
+    }
+
+    uint32_t field_vector = fb.createOffsetVector(field_offsets);
+    fb.startTable();
+    fb.addOffset(1, field_vector);
+    fb.addScalar<int16_t>(0, 0);  // little endian
+    uint32_t schema = fb.endTable();
+
+    return writeMessage(finishMessage(fb, HEADER_SCHEMA, schema, 0), {});
+}
+
+bool ArrowStreamWriter::writeDictionary(size_t field, const std::vector<std::string>& values) {
+    if (field >= fields_.size() || fields_[field].type != Type::DICTIONARY_UTF8) {
+        return false;
+    }
+
+    std::vector<int32_t> offsets(values.size() + 1, 0);
+    std::string chars;
+    for (size_t i = 0; i < values.size(); ++i) {
+        chars += values[i];
+        offsets[i + 1] = static_cast<int32_t>(chars.size());
+    }
+
+    std::vector<BufferSpec> specs;
+    std::vector<const void*> data;
+    uint64_t body_length = 0;
+    addBuffers(specs, data, body_length, nullptr, 0);
+    addBuffers(specs, data, body_length, offsets.data(), offsets.size() * sizeof(int32_t));
+    addBuffers(specs, data, body_length, chars.data(), chars.size());
+
+    FlatBuilder fb;
+    int64_t rows = static_cast<int64_t>(values.size());
+    uint32_t batch = createRecordBatch(fb, rows, {{rows, 0}}, specs);
+    fb.startTable();
+    fb.addScalar<int64_t>(0, static_cast<int64_t>(field));
+    fb.addOffset(1, batch);
+    fb.addScalar<uint8_t>(2, 0);  // replacement, not delta
+    uint32_t dictionary_batch = fb.endTable();
+
+    std::vector<Buffer> body;
+    for (size_t i = 0; i < specs.size(); ++i) {
+        body.push_back({data[i], static_cast<uint64_t>(specs[i].length)});
+    }
+    return writeMessage(finishMessage(fb, HEADER_DICTIONARY_BATCH, dictionary_batch,
+                                      static_cast<int64_t>(body_length)), body);
+}
+
+bool ArrowStreamWriter::writeBatch(size_t rows, const std::vector<Column>& columns) {
+    if (columns.size() != fields_.size()) {
+        return false;
+    }
+
+    std::vector<FieldNode> nodes;
+    std::vector<BufferSpec> specs;
+    std::vector<const void*> data;
+    uint64_t body_length = 0;
+    for (size_t i = 0; i < columns.size(); ++i) {
+        nodes.push_back({static_cast<int64_t>(rows), 0});
+        addBuffers(specs, data, body_length, nullptr, 0);
+        if (fields_[i].type == Type::UTF8) {
+            addBuffers(specs, data, body_length, columns[i].offsets, (rows + 1) * sizeof(int32_t));
+            addBuffers(specs, data, body_length, columns[i].values,
+                       static_cast<uint64_t>(columns[i].offsets[rows]));
+        } else {
+            addBuffers(specs, data, body_length, columns[i].values,
+                       rows * valueWidth(fields_[i].type));
+        }
+    }
+
+    FlatBuilder fb;
+    uint32_t batch = createRecordBatch(fb, static_cast<int64_t>(rows), nodes, specs);
+
+    std::vector<Buffer> body;
+    for (size_t i = 0; i < specs.size(); ++i) {
+        body.push_back({data[i], static_cast<uint64_t>(specs[i].length)});
+    }
+    return writeMessage(finishMessage(fb, HEADER_RECORD_BATCH, batch,
+                                      static_cast<int64_t>(body_length)), body);
+}
+
+bool ArrowStreamWriter::finish() {
+    uint32_t end_of_stream[2] = {CONTINUATION, 0};
+    write(end_of_stream, sizeof(end_of_stream));
+    out_.flush();
+    return out_.good();
+}
+
+} // namespace atc
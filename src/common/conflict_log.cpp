@@ -0,0 +1,175 @@
+#include "common/conflict_log.h"
+#include "common/logger.h"
+#include <algorithm>
+#include <cstring>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace atc {
+
+namespace {
+
+constexpr char CONFLICT_MAGIC[8] = {'A', 'T', 'C', 'C', 'O', 'N', 'F', '1'};
+
+struct ConflictHeader {
+    char magic[8];
+    uint32_t record_size;
+    uint32_t reserved;
+};
+
+bool readConflictHeader(std::ifstream& in) {
+    ConflictHeader header;
+    if (!in.read(reinterpret_cast<char*>(&header), sizeof(header))) {
+        return false;
+    }
+    return std::memcmp(header.magic, CONFLICT_MAGIC, sizeof(header.magic)) == 0 &&
+           header.record_size == sizeof(ConflictRecord);
+}
+
+std::string fromFixed(const char* text, size_t length) {
+    return std::string(text, strnlen(text, length));
+}
+
+} // namespace
+
+std::string ConflictRecord::getAircraft1() const {
+    return fromFixed(aircraft1, CALLSIGN_LENGTH);
+}
+
+std::string ConflictRecord::getAircraft2() const {
+    return fromFixed(aircraft2, CALLSIGN_LENGTH);
+}
+
+ConflictLog::ConflictLog(const std::string& directory)
+    : path_(history::conflictPath(directory))
+    , operational_(false) {
+
+    ::mkdir(directory.c_str(), 0755);
+
+    // Keep records from earlier runs, dropping a torn trailing record
+    std::ifstream existing(path_, std::ios::binary | std::ios::ate);
+    if (existing) {
+        auto size = static_cast<int64_t>(existing.tellg());
+        existing.seekg(0);
+        if (size >= static_cast<int64_t>(sizeof(ConflictHeader)) && readConflictHeader(existing)) {
+            int64_t records = (size - static_cast<int64_t>(sizeof(ConflictHeader))) /
+                              static_cast<int64_t>(sizeof(ConflictRecord));
+            int64_t valid_size = static_cast<int64_t>(sizeof(ConflictHeader)) +
+                                 records * static_cast<int64_t>(sizeof(ConflictRecord));
+            existing.close();
+            if (valid_size != size && ::truncate(path_.c_str(), valid_size) != 0) {
+                ATC_LOG_ERROR("Failed to truncate conflict log: " + path_);
+            }
+            file_.open(path_, std::ios::binary | std::ios::app);
+            operational_ = file_.is_open();
+            return;
+        }
+        existing.close();
+    }
+
+    file_.open(path_, std::ios::binary | std::ios::trunc);
+    if (!file_) {
+        ATC_LOG_ERROR("Failed to open conflict log: " + path_);
+        return;
+    }
+    ConflictHeader header;
+    std::memcpy(header.magic, CONFLICT_MAGIC, sizeof(header.magic));
+    header.record_size = sizeof(ConflictRecord);
+    header.reserved = 0;
+    file_.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    file_.flush();
+    operational_ = !file_.fail();
+}
+
+void ConflictLog::record(const ConflictRecord& record) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (!operational_) return;
+
+    // Conflicts are rare; flush each one so exports see it immediately
+    file_.write(reinterpret_cast<const char*>(&record), sizeof(record));
+    file_.flush();
+    if (file_.fail()) {
+        ATC_LOG_ERROR("Failed writing conflict record to " + path_);
+        operational_ = false;
+    }
+}
+
+namespace history {
+
+std::string conflictPath(const std::string& directory) {
+    return directory + "/conflicts.dat";
+}
+
+const char* conflictKindName(ConflictKind kind) {
+    switch (kind) {
+        case ConflictKind::VIOLATION: return "VIOLATION";
+        case ConflictKind::CRITICAL_WARNING: return "CRITICAL";
+        case ConflictKind::MEDIUM_WARNING: return "MEDIUM";
+        case ConflictKind::EARLY_WARNING: return "EARLY";
+    }
+    return "UNKNOWN";
+}
+
+bool readConflicts(const std::string& directory, int64_t t_start, int64_t t_end,
+                   size_t chunk_records,
+                   const std::function<bool(const ConflictRecord*, size_t)>& visit) {
+    std::ifstream in(conflictPath(directory), std::ios::binary | std::ios::ate);
+    if (!in) {
+        return false;
+    }
+    auto size = static_cast<int64_t>(in.tellg());
+    in.seekg(0);
+    if (size < static_cast<int64_t>(sizeof(ConflictHeader)) || !readConflictHeader(in)) {
+        return false;
+    }
+
+    int64_t count = (size - static_cast<int64_t>(sizeof(ConflictHeader))) /
+                    static_cast<int64_t>(sizeof(ConflictRecord));
+    auto seekRecord = [&in](int64_t index) {
+        in.clear();
+        in.seekg(static_cast<std::streamoff>(sizeof(ConflictHeader) + index * sizeof(ConflictRecord)));
+    };
+
+    // Binary search the first record at or after t_start
+    int64_t low = 0;
+    int64_t high = count;
+    ConflictRecord record;
+    while (low < high) {
+        int64_t mid = low + (high - low) / 2;
+        seekRecord(mid);
+        if (!in.read(reinterpret_cast<char*>(&record), sizeof(record))) {
+            return false;
+        }
+        if (record.timestamp_ms < t_start) {
+            low = mid + 1;
+        } else {
+            high = mid;
+        }
+    }
+
+    std::vector<ConflictRecord> chunk(std::max<size_t>(chunk_records, 1));
+    seekRecord(low);
+    for (int64_t index = low; index < count; ) {
+        size_t n = static_cast<size_t>(std::min<int64_t>(chunk.size(), count - index));
+        if (!in.read(reinterpret_cast<char*>(chunk.data()), n * sizeof(ConflictRecord))) {
+            return false;
+        }
+        index += n;
+
+        size_t keep = 0;
+        while (keep < n && chunk[keep].timestamp_ms <= t_end) {
+            ++keep;
+        }
+        if (keep > 0 && !visit(chunk.data(), keep)) {
+            return true;
+        }
+        if (keep < n) {
+            break;
+        }
+    }
+    return true;
+}
+
+}
+
+} // namespace atc
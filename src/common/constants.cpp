@@ -32,6 +32,12 @@ const int OPERATOR_PRIORITY = 10;
 // Violation prediction
 const int DEFAULT_LOOKAHEAD_TIME = 180;         // 3 minutes in seconds
 const int MAX_LOOKAHEAD_TIME = 300;             // 5 minutes max
+const double ROUTE_CLIMB_RATE = 25.0;           // 1,500ft per minute
+const double ROUTE_CONFORMANCE_TOLERANCE = 150.0;
+const double KINETIC_DRIFT_TOLERANCE = 25.0;
+const double KINETIC_MAX_REPORT_AGE = 1.5;
+const double VELOCITY_LINE_TOLERANCE = 5.0;
+const double CERTIFICATE_MAX_REPORT_SKEW = 1.5;
 
 // Aircraft performance limits
 const double MIN_SPEED = 150.0;
@@ -43,5 +49,58 @@ const int DISPLAY_GRID_HEIGHT = 25;
 const int DISPLAY_UPDATE_MIN_INTERVAL = 1000;
 const int DISPLAY_UPDATE_MAX_INTERVAL = 10000;
 
+// History storage
+const int HISTORY_SNAPSHOT_INTERVAL = 1000;
+const int HISTORY_BLOCK_RECORDS = 1024;
+const int HISTORY_SEGMENT_BLOCKS = 256;
+const int HISTORY_COMPRESSION_INTERVAL = 5000;
+const int HISTORY_ROLLUP_FINE_INTERVAL = 10000;
+const int HISTORY_ROLLUP_COARSE_INTERVAL = 60000;
+const int HISTORY_OCCUPANCY_INTERVAL = 60000;
+const int SECTOR_GRID_COLUMNS = 4;
+const int SECTOR_GRID_ROWS = 4;
+
+// Traffic load forecast
+const int TRAFFIC_FORECAST_INTERVAL = 1000;
+const int TRAFFIC_FORECAST_BIN = 60000;
+const int TRAFFIC_FORECAST_BINS = 60;
+const int SECTOR_CAPACITY = 12;
+
+// Arrival sequencing
+const double ARRIVAL_FIX_X = 50000.0;
+const double ARRIVAL_FIX_Y = 50000.0;
+const int ARRIVAL_SEQUENCE_INTERVAL = 5000;
+const int ARRIVAL_FREEZE_TIME = 120;
+const double ARRIVAL_ADVISORY_STEP = 10.0;
+
+// Browser display
+const int WEB_DISPLAY_PORT = 8080;
+const int WEB_DISPLAY_INTERVAL = 1000;
+
+// Track trails
+const int TRAIL_LENGTH = 16;
+const int TRAIL_SAMPLE_INTERVAL = 2000;
+const int TRAIL_MAX_TRACKS = 256;
+
+// Split deployment
+const int SHM_RING_SIZE = 1 << 20;
+const int SHM_RING_SPIN_TIME = 50;
+const int SUPERVISOR_RESTART_DELAY = 1000;
+const int SUPERVISOR_MAX_RESTARTS = 5;
+const int SUPERVISOR_STOP_TIMEOUT = 2000;
+
+// Hot-standby replication
+const int REPLICATION_KEY_FRAME_INTERVAL = 50;
+const int REPLICATION_CYCLE_BUDGET = 1000;       // 1% of the control cycle
+const int REPLICATION_RECONNECT_DROPS = 10;
+const int REPLICATION_TAKEOVER_TIMEOUT = 500;    // Half a radar scan
+
+// Logging
+const int LOG_FLUSH_INTERVAL = 1000;
+const int LOG_STAGING_BUFFER_SIZE = 16384;
+
+// Metrics
+const int METRICS_INTERVAL = 5000;
+
 } // namespace constants
 } // namespace atc
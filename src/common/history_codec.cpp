@@ -0,0 +1,452 @@
+#include "common/history_codec.h"
+#include <algorithm>
+#include <cstring>
+#include <unordered_map>
+
+namespace atc {
+
+namespace {
+
+constexpr size_t FRAME_SIZE = 32;       // values per bit-packed frame
+constexpr size_t UNPACK_SLACK = 16;     // over-read allowance for 64-bit loads
+constexpr size_t PACKED_COLUMNS = 10;   // callsign id, timestamp, status and seven doubles
+constexpr size_t LZ_MIN_MATCH = 4;
+constexpr size_t LZ_MAX_OFFSET = 65535;
+constexpr int LZ_HASH_BITS = 12;
+
+inline uint64_t zigzag(int64_t value) {
+    return (static_cast<uint64_t>(value) << 1) ^ static_cast<uint64_t>(value >> 63);
+}
+
+inline int64_t unzigzag(uint64_t value) {
+    return static_cast<int64_t>(value >> 1) ^ -static_cast<int64_t>(value & 1);
+}
+
+inline uint64_t doubleBits(double value) {
+    uint64_t bits;
+    std::memcpy(&bits, &value, sizeof(bits));
+    return bits;
+}
+
+inline double bitsDouble(uint64_t bits) {
+    double value;
+    std::memcpy(&value, &bits, sizeof(value));
+    return value;
+}
+
+inline uint64_t load64(const uint8_t* p) {
+    uint64_t value;
+    std::memcpy(&value, p, sizeof(value));
+    return value;
+}
+
+inline uint32_t load32(const uint8_t* p) {
+    uint32_t value;
+    std::memcpy(&value, p, sizeof(value));
+    return value;
+}
+
+inline unsigned bitWidth(uint64_t value) {
+    return value == 0 ? 0 : 64 - __builtin_clzll(value);
+}
+
+template <typename T>
+void put(std::vector<uint8_t>& out, T value) {
+    size_t pos = out.size();
+    out.resize(pos + sizeof(T));
+    std::memcpy(out.data() + pos, &value, sizeof(T));
+}
+
+inline void writeBits(uint8_t* base, size_t bit, uint64_t value, unsigned width) {
+    uint8_t* p = base + (bit >> 3);
+    unsigned shift = bit & 7;
+    uint64_t word = load64(p) | (value << shift);
+    std::memcpy(p, &word, sizeof(word));
+    if (shift != 0 && width + shift > 64) {
+        p[8] |= static_cast<uint8_t>(value >> (64 - shift));
+    }
+}
+
+// Appends values as frames of FRAME_SIZE: [width byte][width * n bits]
+void packColumn(const std::vector<uint64_t>& values, std::vector<uint8_t>& out) {
+    for (size_t start = 0; start < values.size(); start += FRAME_SIZE) {
+        size_t count = std::min(FRAME_SIZE, values.size() - start);
+
+        uint64_t all_bits = 0;
+        for (size_t i = 0; i < count; ++i) {
+            all_bits |= values[start + i];
+        }
+        unsigned width = bitWidth(all_bits);
+        out.push_back(static_cast<uint8_t>(width));
+        if (width == 0) continue;
+
+        size_t pos = out.size();
+        size_t bytes = (count * width + 7) / 8;
+        out.resize(pos + bytes + UNPACK_SLACK, 0);
+        for (size_t i = 0; i < count; ++i) {
+            writeBits(out.data() + pos, i * width, values[start + i], width);
+        }
+        out.resize(pos + bytes);
+    }
+}
+
+inline uint64_t readBits(const uint8_t* base, size_t bit, unsigned width) {
+    uint64_t value = load64(base + (bit >> 3)) >> (bit & 7);
+    return width == 64 ? value : value & ((uint64_t(1) << width) - 1);
+}
+
+// Reverse of packColumn; returns the position after the column or nullptr
+const uint8_t* unpackColumn(const uint8_t* p, const uint8_t* end, size_t count, uint64_t* out) {
+    for (size_t start = 0; start < count; start += FRAME_SIZE) {
+        size_t n = std::min(FRAME_SIZE, count - start);
+        if (p >= end) return nullptr;
+        unsigned width = *p++;
+        if (width > 64) return nullptr;
+
+        uint64_t* dst = out + start;
+        if (width == 0) {
+            std::fill(dst, dst + n, 0);
+            continue;
+        }
+
+        size_t bytes = (n * width + 7) / 8;
+        if (static_cast<size_t>(end - p) < bytes) return nullptr;
+
+        if (width <= 56) {
+            for (size_t i = 0; i < n; ++i) {
+                dst[i] = readBits(p, i * width, width);
+            }
+        } else {
+            for (size_t i = 0; i < n; ++i) {
+                size_t bit = i * width;
+                dst[i] = readBits(p, bit, 32) | (readBits(p, bit + 32, width - 32) << 32);
+            }
+        }
+        p += bytes;
+    }
+    return p;
+}
+
+// Per-aircraft second-order delta over the raw bit pattern of a double column.
+// Constant velocities, headings and altitudes collapse to zero.
+void encodeDoubles(const std::vector<double>& column, const std::vector<uint32_t>& ids,
+                   size_t dictionary_size, std::vector<uint64_t>& out) {
+    std::vector<uint64_t> previous(dictionary_size, 0);
+    std::vector<uint64_t> previous_delta(dictionary_size, 0);
+    out.resize(column.size());
+    for (size_t i = 0; i < column.size(); ++i) {
+        uint32_t id = ids[i];
+        uint64_t bits = doubleBits(column[i]);
+        uint64_t delta = bits - previous[id];
+        out[i] = zigzag(static_cast<int64_t>(delta - previous_delta[id]));
+        previous[id] = bits;
+        previous_delta[id] = delta;
+    }
+}
+
+void decodeDoubles(const uint64_t* values, const std::vector<uint32_t>& ids,
+                   size_t dictionary_size, std::vector<double>& column) {
+    std::vector<uint64_t> previous(dictionary_size, 0);
+    std::vector<uint64_t> previous_delta(dictionary_size, 0);
+    for (size_t i = 0; i < column.size(); ++i) {
+        uint32_t id = ids[i];
+        uint64_t delta = previous_delta[id] + static_cast<uint64_t>(unzigzag(values[i]));
+        uint64_t bits = previous[id] + delta;
+        column[i] = bitsDouble(bits);
+        previous[id] = bits;
+        previous_delta[id] = delta;
+    }
+}
+
+void putLength(std::vector<uint8_t>& out, size_t length) {
+    while (length >= 255) {
+        out.push_back(255);
+        length -= 255;
+    }
+    out.push_back(static_cast<uint8_t>(length));
+}
+
+bool getLength(const uint8_t*& p, const uint8_t* end, size_t& length) {
+    uint8_t byte;
+    do {
+        if (p >= end) return false;
+        byte = *p++;
+        length += byte;
+    } while (byte == 255);
+    return true;
+}
+
+} // namespace
+
+void HistoryColumns::resize(size_t count) {
+    callsign_id.resize(count);
+    timestamp_ms.resize(count);
+    x.resize(count);
+    y.resize(count);
+    z.resize(count);
+    vx.resize(count);
+    vy.resize(count);
+    vz.resize(count);
+    heading.resize(count);
+    status.resize(count);
+}
+
+void HistoryColumns::clear() {
+    dictionary.clear();
+    resize(0);
+}
+
+void HistoryColumns::fromRecords(const std::vector<HistoryRecord>& records) {
+    clear();
+    resize(records.size());
+
+    std::unordered_map<std::string, uint32_t> ids;
+    for (size_t i = 0; i < records.size(); ++i) {
+        const auto& record = records[i];
+        auto inserted = ids.emplace(record.getCallsign(), static_cast<uint32_t>(dictionary.size()));
+        if (inserted.second) {
+            dictionary.push_back(inserted.first->first);
+        }
+        callsign_id[i] = inserted.first->second;
+        timestamp_ms[i] = record.timestamp_ms;
+        x[i] = record.x;
+        y[i] = record.y;
+        z[i] = record.z;
+        vx[i] = record.vx;
+        vy[i] = record.vy;
+        vz[i] = record.vz;
+        heading[i] = record.heading;
+        status[i] = record.status;
+    }
+}
+
+void HistoryColumns::toRecords(std::vector<HistoryRecord>& records) const {
+    records.resize(size());
+    for (size_t i = 0; i < size(); ++i) {
+        auto& record = records[i];
+        std::memset(&record, 0, sizeof(record));
+        record.timestamp_ms = timestamp_ms[i];
+        const std::string& callsign = dictionary[callsign_id[i]];
+        std::memcpy(record.callsign, callsign.data(),
+                    std::min(callsign.size(), HistoryRecord::CALLSIGN_LENGTH - 1));
+        record.x = x[i];
+        record.y = y[i];
+        record.z = z[i];
+        record.vx = vx[i];
+        record.vy = vy[i];
+        record.vz = vz[i];
+        record.heading = heading[i];
+        record.status = status[i];
+    }
+}
+
+namespace codec {
+
+void compressBlock(const HistoryColumns& columns, std::vector<uint8_t>& out) {
+    size_t count = columns.size();
+    size_t dictionary_size = columns.dictionary.size();
+
+    std::vector<uint8_t> packed;
+    packed.reserve(count * 16);
+    put<uint32_t>(packed, static_cast<uint32_t>(count));
+    put<uint16_t>(packed, static_cast<uint16_t>(dictionary_size));
+    for (const auto& callsign : columns.dictionary) {
+        packed.push_back(static_cast<uint8_t>(callsign.size()));
+        packed.insert(packed.end(), callsign.begin(), callsign.end());
+    }
+
+    std::vector<uint64_t> values(count);
+    for (size_t i = 0; i < count; ++i) {
+        values[i] = columns.callsign_id[i];
+    }
+    packColumn(values, packed);
+
+    int64_t previous_time = 0;
+    for (size_t i = 0; i < count; ++i) {
+        values[i] = zigzag(columns.timestamp_ms[i] - previous_time);
+        previous_time = columns.timestamp_ms[i];
+    }
+    packColumn(values, packed);
+
+    std::vector<uint8_t> previous_status(dictionary_size, 0);
+    for (size_t i = 0; i < count; ++i) {
+        uint32_t id = columns.callsign_id[i];
+        values[i] = zigzag(int64_t(columns.status[i]) - previous_status[id]);
+        previous_status[id] = columns.status[i];
+    }
+    packColumn(values, packed);
+
+    for (const auto* column : {&columns.x, &columns.y, &columns.z,
+                               &columns.vx, &columns.vy, &columns.vz, &columns.heading}) {
+        encodeDoubles(*column, columns.callsign_id, dictionary_size, values);
+        packColumn(values, packed);
+    }
+
+    out.clear();
+    put<uint32_t>(out, static_cast<uint32_t>(packed.size()));
+    lzCompress(packed.data(), packed.size(), out);
+}
+
+// Largest packed form of a block: the header, one dictionary entry per
+// record at most, and every column at full width
+size_t maxPackedSize(size_t record_count) {
+    size_t callsigns = std::min<size_t>(record_count, UINT16_MAX);
+    size_t frames = (record_count + FRAME_SIZE - 1) / FRAME_SIZE;
+    return 6 + callsigns * (1 + UINT8_MAX) + PACKED_COLUMNS * (frames + record_count * sizeof(uint64_t));
+}
+
+bool decompressBlock(const uint8_t* data, size_t size, size_t record_count, HistoryColumns& columns) {
+    if (size < sizeof(uint32_t)) return false;
+    size_t packed_size = load32(data);
+    // Sizes come from the file, so bound them before allocating
+    if (packed_size > maxPackedSize(record_count)) return false;
+
+    std::vector<uint8_t> packed(packed_size + UNPACK_SLACK, 0);
+    if (!lzDecompress(data + sizeof(uint32_t), size - sizeof(uint32_t),
+                      packed.data(), packed_size)) {
+        return false;
+    }
+
+    const uint8_t* p = packed.data();
+    const uint8_t* end = p + packed_size;
+    if (packed_size < 6) return false;
+    size_t count = load32(p);
+    size_t dictionary_size = p[4] | (p[5] << 8);
+    p += 6;
+    if (count != record_count) return false;
+
+    columns.clear();
+    for (size_t i = 0; i < dictionary_size; ++i) {
+        if (p >= end || static_cast<size_t>(end - p) < size_t(1) + *p) return false;
+        columns.dictionary.emplace_back(reinterpret_cast<const char*>(p + 1), *p);
+        p += 1 + *p;
+    }
+    columns.resize(count);
+
+    std::vector<uint64_t> values(count);
+    if (!(p = unpackColumn(p, end, count, values.data()))) return false;
+    for (size_t i = 0; i < count; ++i) {
+        if (values[i] >= dictionary_size) return false;
+        columns.callsign_id[i] = static_cast<uint32_t>(values[i]);
+    }
+
+    if (!(p = unpackColumn(p, end, count, values.data()))) return false;
+    int64_t time = 0;
+    for (size_t i = 0; i < count; ++i) {
+        time += unzigzag(values[i]);
+        columns.timestamp_ms[i] = time;
+    }
+
+    if (!(p = unpackColumn(p, end, count, values.data()))) return false;
+    std::vector<uint8_t> previous_status(dictionary_size, 0);
+    for (size_t i = 0; i < count; ++i) {
+        uint32_t id = columns.callsign_id[i];
+        previous_status[id] = static_cast<uint8_t>(previous_status[id] + unzigzag(values[i]));
+        columns.status[i] = previous_status[id];
+    }
+
+    for (auto* column : {&columns.x, &columns.y, &columns.z,
+                         &columns.vx, &columns.vy, &columns.vz, &columns.heading}) {
+        if (!(p = unpackColumn(p, end, count, values.data()))) return false;
+        decodeDoubles(values.data(), columns.callsign_id, dictionary_size, *column);
+    }
+    return true;
+}
+
+// Sequences of [token][literal length ext][literals][offset][match length ext],
+// token = literal length (high nibble) | match length - 4 (low nibble).
+// The final sequence carries literals only.
+void lzCompress(const uint8_t* data, size_t size, std::vector<uint8_t>& out) {
+    std::vector<uint32_t> table(size_t(1) << LZ_HASH_BITS, UINT32_MAX);
+    size_t anchor = 0;
+    size_t ip = 0;
+
+    auto emit = [&](size_t literal_end, size_t offset, size_t match_length) {
+        size_t literals = literal_end - anchor;
+        size_t match_code = match_length ? match_length - LZ_MIN_MATCH : 0;
+        out.push_back(static_cast<uint8_t>((std::min<size_t>(literals, 15) << 4) |
+                                           std::min<size_t>(match_code, 15)));
+        if (literals >= 15) putLength(out, literals - 15);
+        out.insert(out.end(), data + anchor, data + literal_end);
+        if (match_length) {
+            put<uint16_t>(out, static_cast<uint16_t>(offset));
+            if (match_code >= 15) putLength(out, match_code - 15);
+        }
+    };
+
+    while (ip + LZ_MIN_MATCH <= size) {
+        uint32_t sequence = load32(data + ip);
+        uint32_t hash = (sequence * 2654435761u) >> (32 - LZ_HASH_BITS);
+        uint32_t candidate = table[hash];
+        table[hash] = static_cast<uint32_t>(ip);
+
+        if (candidate != UINT32_MAX && ip - candidate <= LZ_MAX_OFFSET &&
+            load32(data + candidate) == sequence) {
+            size_t length = LZ_MIN_MATCH;
+            while (ip + length < size && data[candidate + length] == data[ip + length]) {
+                ++length;
+            }
+            emit(ip, ip - candidate, length);
+            ip += length;
+            anchor = ip;
+        } else {
+            ++ip;
+        }
+    }
+
+    if (anchor < size || size == 0) {
+        emit(size, 0, 0);
+    }
+}
+
+bool lzDecompress(const uint8_t* data, size_t size, uint8_t* out, size_t out_size) {
+    const uint8_t* ip = data;
+    const uint8_t* end = data + size;
+    uint8_t* op = out;
+    uint8_t* op_end = out + out_size;
+
+    while (ip < end) {
+        uint8_t token = *ip++;
+
+        size_t literals = token >> 4;
+        if (literals == 15 && !getLength(ip, end, literals)) return false;
+        if (static_cast<size_t>(end - ip) < literals ||
+            static_cast<size_t>(op_end - op) < literals) {
+            return false;
+        }
+        std::memcpy(op, ip, literals);
+        ip += literals;
+        op += literals;
+
+        if (ip >= end) break;  // final literal-only sequence
+
+        if (end - ip < 2) return false;
+        size_t offset = ip[0] | (ip[1] << 8);
+        ip += 2;
+        size_t length = (token & 0x0F);
+        if (length == 15 && !getLength(ip, end, length)) return false;
+        length += LZ_MIN_MATCH;
+
+        if (offset == 0 || offset > static_cast<size_t>(op - out) ||
+            static_cast<size_t>(op_end - op) < length) {
+            return false;
+        }
+
+        const uint8_t* match = op - offset;
+        if (offset >= length) {
+            std::memcpy(op, match, length);
+            op += length;
+        } else {
+            // Overlapping copy replicates the last `offset` bytes
+            for (size_t i = 0; i < length; ++i) {
+                *op++ = *match++;
+            }
+        }
+    }
+
+    return op == op_end;
+}
+
+}
+
+} // namespace atc
@@ -0,0 +1,63 @@
+#include "common/history_compressor.h"
+#include "common/history_store.h"
+#include "common/constants.h"
+#include "common/logger.h"
+#include <algorithm>
+#include <sstream>
+
+namespace atc {
+
+HistoryCompressor::HistoryCompressor()
+    : PeriodicTask(std::chrono::milliseconds(constants::HISTORY_COMPRESSION_INTERVAL),
+                   constants::LOGGING_PRIORITY) {
+}
+
+HistoryCompressor::~HistoryCompressor() {
+    stop();
+}
+
+void HistoryCompressor::enqueue(const std::string& segment_path) {
+    std::lock_guard<std::mutex> lock(queue_mutex_);
+    if (std::find(pending_.begin(), pending_.end(), segment_path) == pending_.end()) {
+        pending_.push_back(segment_path);
+    }
+}
+
+size_t HistoryCompressor::getPendingCount() const {
+    std::lock_guard<std::mutex> lock(queue_mutex_);
+    return pending_.size();
+}
+
+void HistoryCompressor::execute() {
+    std::string segment_path;
+    {
+        std::lock_guard<std::mutex> lock(queue_mutex_);
+        if (pending_.empty()) return;
+        segment_path = pending_.front();
+        pending_.pop_front();
+    }
+
+    // One segment per cycle keeps the background I/O bounded
+    auto start = std::chrono::steady_clock::now();
+    uint64_t raw = 0;
+    uint64_t compressed = 0;
+    if (!history::compressSegment(segment_path, &raw, &compressed)) {
+        ATC_LOG_ERROR("Failed to compress history segment: " + segment_path);
+        return;
+    }
+    if (raw == 0) return;  // already compressed
+
+    raw_bytes_ += raw;
+    compressed_bytes_ += compressed;
+
+    if (ATC_LOG_ENABLED(INFO)) {
+        auto elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(
+            std::chrono::steady_clock::now() - start).count();
+        std::ostringstream oss;
+        oss << "Compressed history segment " << segment_path << ": "
+            << raw << " -> " << compressed << " bytes in " << elapsed << "ms";
+        ATC_LOG_INFO(oss.str());
+    }
+}
+
+}
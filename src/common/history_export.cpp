@@ -0,0 +1,179 @@
+#include "common/history_export.h"
+#include "common/arrow_stream.h"
+#include "common/conflict_log.h"
+#include "common/history_codec.h"
+#include <cstring>
+#include <vector>
+
+namespace atc {
+namespace history {
+
+namespace {
+
+constexpr size_t CONFLICT_BATCH_RECORDS = 4096;
+constexpr size_t CALLSIGN_FIELD = 1;
+constexpr size_t KIND_FIELD = 1;
+
+// Copy the rows of a boundary block that fall inside the exported range
+void selectRows(const HistoryColumns& in, int64_t t_start, int64_t t_end, HistoryColumns& out) {
+    out.clear();
+    out.dictionary = in.dictionary;
+    for (size_t i = 0; i < in.size(); ++i) {
+        if (in.timestamp_ms[i] < t_start || in.timestamp_ms[i] > t_end) continue;
+        out.callsign_id.push_back(in.callsign_id[i]);
+        out.timestamp_ms.push_back(in.timestamp_ms[i]);
+        out.x.push_back(in.x[i]);
+        out.y.push_back(in.y[i]);
+        out.z.push_back(in.z[i]);
+        out.vx.push_back(in.vx[i]);
+        out.vy.push_back(in.vy[i]);
+        out.vz.push_back(in.vz[i]);
+        out.heading.push_back(in.heading[i]);
+        out.status.push_back(in.status[i]);
+    }
+}
+
+void appendText(const char* text, size_t length, std::string& chars, std::vector<int32_t>& offsets) {
+    chars.append(text, strnlen(text, length));
+    offsets.push_back(static_cast<int32_t>(chars.size()));
+}
+
+} // namespace
+
+bool exportSnapshotsArrow(const HistoryReader& reader, int64_t t_start, int64_t t_end,
+                          std::ostream& out, uint64_t* rows) {
+    using Type = ArrowStreamWriter::Type;
+    ArrowStreamWriter writer(out);
+    bool ok = writer.writeSchema({
+        {"time", Type::TIMESTAMP_MS},
+        {"callsign", Type::DICTIONARY_UTF8},
+        {"x", Type::FLOAT64}, {"y", Type::FLOAT64}, {"z", Type::FLOAT64},
+        {"vx", Type::FLOAT64}, {"vy", Type::FLOAT64}, {"vz", Type::FLOAT64},
+        {"heading", Type::FLOAT64},
+        {"status", Type::UINT8}
+    });
+
+    uint64_t exported = 0;
+    bool have_dictionary = false;
+    std::vector<std::string> dictionary;
+    HistoryColumns boundary;
+
+    reader.forEachBlock(t_start, t_end, [&](const HistoryColumns& block) {
+        size_t inside = 0;
+        for (int64_t timestamp : block.timestamp_ms) {
+            inside += (timestamp >= t_start && timestamp <= t_end);
+        }
+        if (inside == 0) return true;
+
+        // Only blocks straddling the range boundaries are copied
+        const HistoryColumns* columns = &block;
+        if (inside != block.size()) {
+            selectRows(block, t_start, t_end, boundary);
+            columns = &boundary;
+        }
+
+        // Dictionaries are per block; resend only when the callsign set changes
+        if (!have_dictionary || columns->dictionary != dictionary) {
+            dictionary = columns->dictionary;
+            have_dictionary = true;
+            ok = ok && writer.writeDictionary(CALLSIGN_FIELD, dictionary);
+        }
+
+        ok = ok && writer.writeBatch(columns->size(), {
+            {columns->timestamp_ms.data(), nullptr},
+            {columns->callsign_id.data(), nullptr},
+            {columns->x.data(), nullptr}, {columns->y.data(), nullptr}, {columns->z.data(), nullptr},
+            {columns->vx.data(), nullptr}, {columns->vy.data(), nullptr}, {columns->vz.data(), nullptr},
+            {columns->heading.data(), nullptr},
+            {columns->status.data(), nullptr}
+        });
+        exported += columns->size();
+        return ok;
+    });
+
+    ok = writer.finish() && ok;
+    if (rows) *rows = exported;
+    return ok;
+}
+
+bool exportConflictsArrow(const std::string& directory, int64_t t_start, int64_t t_end,
+                          std::ostream& out, uint64_t* rows) {
+    using Type = ArrowStreamWriter::Type;
+    ArrowStreamWriter writer(out);
+    bool ok = writer.writeSchema({
+        {"time", Type::TIMESTAMP_MS},
+        {"kind", Type::DICTIONARY_UTF8},
+        {"aircraft1", Type::UTF8},
+        {"aircraft2", Type::UTF8},
+        {"horizontal_separation", Type::FLOAT64},
+        {"vertical_separation", Type::FLOAT64},
+        {"time_to_violation", Type::FLOAT64},
+        {"min_separation", Type::FLOAT64},
+        {"x", Type::FLOAT64}, {"y", Type::FLOAT64}, {"z", Type::FLOAT64}
+    });
+    ok = ok && writer.writeDictionary(KIND_FIELD, {
+        conflictKindName(ConflictKind::VIOLATION),
+        conflictKindName(ConflictKind::CRITICAL_WARNING),
+        conflictKindName(ConflictKind::MEDIUM_WARNING),
+        conflictKindName(ConflictKind::EARLY_WARNING)
+    });
+
+    // The conflict log is row-oriented; transpose one chunk at a time
+    uint64_t exported = 0;
+    std::vector<int64_t> timestamp;
+    std::vector<int32_t> kind;
+    std::vector<int32_t> offsets1, offsets2;
+    std::string chars1, chars2;
+    std::vector<double> horizontal, vertical, time_to_violation, min_separation, x, y, z;
+
+    readConflicts(directory, t_start, t_end, CONFLICT_BATCH_RECORDS,
+                  [&](const ConflictRecord* records, size_t count) {
+        timestamp.resize(count);
+        kind.resize(count);
+        horizontal.resize(count);
+        vertical.resize(count);
+        time_to_violation.resize(count);
+        min_separation.resize(count);
+        x.resize(count);
+        y.resize(count);
+        z.resize(count);
+        offsets1.assign(1, 0);
+        offsets2.assign(1, 0);
+        chars1.clear();
+        chars2.clear();
+
+        for (size_t i = 0; i < count; ++i) {
+            const ConflictRecord& record = records[i];
+            timestamp[i] = record.timestamp_ms;
+            kind[i] = record.kind;
+            appendText(record.aircraft1, ConflictRecord::CALLSIGN_LENGTH, chars1, offsets1);
+            appendText(record.aircraft2, ConflictRecord::CALLSIGN_LENGTH, chars2, offsets2);
+            horizontal[i] = record.horizontal_separation;
+            vertical[i] = record.vertical_separation;
+            time_to_violation[i] = record.time_to_violation;
+            min_separation[i] = record.min_separation;
+            x[i] = record.x;
+            y[i] = record.y;
+            z[i] = record.z;
+        }
+
+        ok = ok && writer.writeBatch(count, {
+            {timestamp.data(), nullptr},
+            {kind.data(), nullptr},
+            {chars1.data(), offsets1.data()},
+            {chars2.data(), offsets2.data()},
+            {horizontal.data(), nullptr}, {vertical.data(), nullptr},
+            {time_to_violation.data(), nullptr}, {min_separation.data(), nullptr},
+            {x.data(), nullptr}, {y.data(), nullptr}, {z.data(), nullptr}
+        });
+        exported += count;
+        return ok;
+    });
+
+    ok = writer.finish() && ok;
+    if (rows) *rows = exported;
+    return ok;
+}
+
+}
+} // namespace atc
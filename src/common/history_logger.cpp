@@ -1,17 +1,20 @@
 #include "common/history_logger.h"
 #include "common/constants.h"
 #include "common/logger.h"
+#include "common/timestamp.h"
 #include <iomanip>
 #include <sstream>
 #include <ctime>
 
 namespace atc {
 
-HistoryLogger::HistoryLogger(const std::string& filename)
+HistoryLogger::HistoryLogger(const std::string& filename, const std::string& store_directory)
     : PeriodicTask(std::chrono::milliseconds(constants::HISTORY_LOGGING_INTERVAL),
                    constants::LOGGING_PRIORITY)
     , filename_(filename)
-    , file_operational_(false) {
+    , file_operational_(false)
+    , store_(std::make_unique<HistoryWriter>(store_directory))
+    , rollup_(std::make_unique<HistoryRollupWriter>(store_directory)) {
 
     auto now = std::chrono::system_clock::now();
     auto in_time_t = std::chrono::system_clock::to_time_t(now);
@@ -22,19 +25,44 @@ HistoryLogger::HistoryLogger(const std::string& filename)
     if (history_file_.is_open()) {
         writeHeader();
         file_operational_ = true;
-        Logger::getInstance().log("History logger initialized: " + ss.str());
+        ATC_LOG_INFO("History logger initialized: " + ss.str());
     } else {
-        Logger::getInstance().log("Failed to initialize history logger");
+        ATC_LOG_ERROR("Failed to initialize history logger");
         file_operational_ = false;
     }
+
+    if (!store_->isOperational()) {
+        ATC_LOG_ERROR("Failed to initialize history store: " + store_directory);
+    }
 }
 
 HistoryLogger::~HistoryLogger() {
+    stop();
+    store_.reset();
+    rollup_.reset();
     if (history_file_.is_open()) {
         history_file_.close();
     }
 }
 
+void HistoryLogger::setCompressor(const std::shared_ptr<HistoryCompressor>& compressor) {
+    std::lock_guard<std::mutex> lock(file_mutex_);
+    std::vector<HistoryWriter*> writers = rollup_->getWriters();
+    writers.insert(writers.begin(), store_.get());
+
+    for (auto* writer : writers) {
+        writer->setSegmentClosedCallback([compressor](const std::string& path) {
+            compressor->enqueue(path);
+        });
+
+        for (const auto& path : history::listSegments(writer->getDirectory(), writer->getPrefix())) {
+            if (path != writer->getSegmentPath()) {
+                compressor->enqueue(path);
+            }
+        }
+    }
+}
+
 void HistoryLogger::writeHeader() {
     std::lock_guard<std::mutex> lock(file_mutex_);
     if (file_operational_) {
@@ -47,11 +75,7 @@ void HistoryLogger::writeHeader() {
 }
 
 std::string HistoryLogger::getTimestamp() const {
-    auto now = std::chrono::system_clock::now();
-    auto time = std::chrono::system_clock::to_time_t(now);
-    std::stringstream ss;
-    ss << std::put_time(std::localtime(&time), "%Y-%m-%d %H:%M:%S");
-    return ss.str();
+    return timestamp::now(false);
 }
 
 void HistoryLogger::updateAircraftStates(const std::vector<std::shared_ptr<Aircraft>>& aircraft) {
@@ -62,18 +86,20 @@ void HistoryLogger::updateAircraftStates(const std::vector<std::shared_ptr<Aircr
             current_states_.push_back(ac->getState());
         }
     }
+
+    auto now = std::chrono::steady_clock::now();
+    if (now - last_snapshot_ >= std::chrono::milliseconds(constants::HISTORY_SNAPSHOT_INTERVAL)) {
+        store_->append(current_states_);
+        rollup_->append(current_states_);
+        last_snapshot_ = now;
+    }
 }
 
 void HistoryLogger::writeStateEntry(const std::vector<AircraftState>& states) {
     if (!file_operational_) return;
 
-    auto now = std::chrono::system_clock::now();
-    auto time = std::chrono::system_clock::to_time_t(now);
-
     std::stringstream buffer;
-    buffer << "\n=== Airspace State at "
-           << std::put_time(std::localtime(&time), "%Y-%m-%d %H:%M:%S")
-           << " ===\n";
+    buffer << "\n=== Airspace State at " << timestamp::now(false) << " ===\n";
     buffer << "Active Aircraft: " << states.size() << "\n\n";
 
     for (const auto& state : states) {
@@ -119,14 +145,17 @@ void HistoryLogger::writeStateEntry(const std::vector<AircraftState>& states) {
 
     if (history_file_.fail()) {
         file_operational_ = false;
-        Logger::getInstance().log("Failed writing to history file");
+        ATC_LOG_ERROR("Failed writing to history file");
     }
 }
 
 void HistoryLogger::execute() {
     std::lock_guard<std::mutex> lock(file_mutex_);
+    store_->flush();
+    rollup_->flush();
+
     if (!file_operational_) {
-        Logger::getInstance().log("History logger not operational - attempting to reopen file");
+        ATC_LOG_WARNING("History logger not operational - attempting to reopen file");
         reopenFile();
         return;
     }
@@ -136,11 +165,11 @@ void HistoryLogger::execute() {
             writeStateEntry(current_states_);
 
             if (history_file_.fail()) {
-                Logger::getInstance().log("Failed to write to history file - attempting to recover");
+                ATC_LOG_ERROR("Failed to write to history file - attempting to recover");
                 reopenFile();
             }
         } catch (const std::exception& e) {
-            Logger::getInstance().log("Error writing history: " + std::string(e.what()));
+            ATC_LOG_ERROR("Error writing history: " + std::string(e.what()));
             file_operational_ = false;
         }
     }
@@ -156,11 +185,11 @@ void HistoryLogger::reopenFile() {
 
     if (history_file_.is_open()) {
         file_operational_ = true;
-        Logger::getInstance().log("Successfully reopened history file");
+        ATC_LOG_INFO("Successfully reopened history file");
         writeHeader();
     } else {
         file_operational_ = false;
-        Logger::getInstance().log("Failed to reopen history file");
+        ATC_LOG_ERROR("Failed to reopen history file");
     }
 }
 
@@ -0,0 +1,325 @@
+#include "common/history_rollup.h"
+#include "common/constants.h"
+#include "common/logger.h"
+#include <algorithm>
+#include <cstring>
+#include <limits>
+#include <unistd.h>
+
+namespace atc {
+
+namespace {
+
+constexpr char OCCUPANCY_MAGIC[8] = {'A', 'T', 'C', 'H', 'O', 'C', 'C', '1'};
+constexpr int64_t NO_BUCKET = std::numeric_limits<int64_t>::min();
+
+struct OccupancyHeader {
+    char magic[8];
+    uint32_t record_size;
+    uint32_t bucket_ms;
+};
+
+int64_t bucketStart(int64_t time_ms, int interval_ms) {
+    int64_t bucket = time_ms / interval_ms;
+    if (time_ms < 0 && time_ms % interval_ms != 0) {
+        --bucket;
+    }
+    return bucket * interval_ms;
+}
+
+bool readOccupancyHeader(std::ifstream& in) {
+    OccupancyHeader header;
+    if (!in.read(reinterpret_cast<char*>(&header), sizeof(header))) {
+        return false;
+    }
+    return std::memcmp(header.magic, OCCUPANCY_MAGIC, sizeof(header.magic)) == 0 &&
+           header.record_size == sizeof(SectorOccupancy) &&
+           header.bucket_ms == static_cast<uint32_t>(constants::HISTORY_OCCUPANCY_INTERVAL);
+}
+
+} // namespace
+
+// ---------------------------------------------------------------------------
+// HistoryRollupWriter
+
+HistoryRollupWriter::HistoryRollupWriter(const std::string& directory)
+    : directory_(directory)
+    , occupancy_bucket_(NO_BUCKET)
+    , last_written_bucket_(NO_BUCKET)
+    , sector_aircraft_(history::sectorCount()) {
+
+    for (int interval : {constants::HISTORY_ROLLUP_FINE_INTERVAL,
+                         constants::HISTORY_ROLLUP_COARSE_INTERVAL}) {
+        Level level;
+        level.interval_ms = interval;
+        level.current_bucket = NO_BUCKET;
+        level.writer = std::make_unique<HistoryWriter>(directory_, history::rollupPrefix(interval));
+        levels_.push_back(std::move(level));
+    }
+
+    openOccupancy();
+}
+
+HistoryRollupWriter::~HistoryRollupWriter() {
+    // The last bucket is partial; a restart within the same minute skips it
+    closeOccupancyBucket();
+}
+
+void HistoryRollupWriter::openOccupancy() {
+    std::string path = history::occupancyPath(directory_);
+
+    // Resume after the last complete record written by a previous run
+    std::ifstream existing(path, std::ios::binary | std::ios::ate);
+    if (existing) {
+        auto size = static_cast<int64_t>(existing.tellg());
+        existing.seekg(0);
+        if (size >= static_cast<int64_t>(sizeof(OccupancyHeader)) && readOccupancyHeader(existing)) {
+            int64_t records = (size - static_cast<int64_t>(sizeof(OccupancyHeader))) /
+                              static_cast<int64_t>(sizeof(SectorOccupancy));
+            int64_t valid_size = static_cast<int64_t>(sizeof(OccupancyHeader)) +
+                                 records * static_cast<int64_t>(sizeof(SectorOccupancy));
+            if (records > 0) {
+                SectorOccupancy last;
+                existing.seekg(valid_size - static_cast<int64_t>(sizeof(SectorOccupancy)));
+                if (existing.read(reinterpret_cast<char*>(&last), sizeof(last))) {
+                    last_written_bucket_ = last.bucket_ms;
+                }
+            }
+            existing.close();
+            if (valid_size != size && ::truncate(path.c_str(), valid_size) != 0) {
+                ATC_LOG_ERROR("Failed to truncate occupancy file: " + path);
+            }
+            occupancy_.open(path, std::ios::binary | std::ios::app);
+            return;
+        }
+        existing.close();
+    }
+
+    occupancy_.open(path, std::ios::binary | std::ios::trunc);
+    if (!occupancy_) {
+        ATC_LOG_ERROR("Failed to open occupancy file: " + path);
+        return;
+    }
+    OccupancyHeader header;
+    std::memcpy(header.magic, OCCUPANCY_MAGIC, sizeof(header.magic));
+    header.record_size = sizeof(SectorOccupancy);
+    header.bucket_ms = static_cast<uint32_t>(constants::HISTORY_OCCUPANCY_INTERVAL);
+    occupancy_.write(reinterpret_cast<const char*>(&header), sizeof(header));
+}
+
+void HistoryRollupWriter::append(const std::vector<AircraftState>& states) {
+    for (const auto& state : states) {
+        HistoryRecord record = HistoryRecord::fromState(state);
+
+        // First sample of each aircraft in every rollup interval
+        for (auto& level : levels_) {
+            int64_t bucket = bucketStart(record.timestamp_ms, level.interval_ms);
+            if (bucket > level.current_bucket) {
+                // Forget aircraft not seen since before the bucket just closed
+                for (auto old = level.last_bucket.begin(); old != level.last_bucket.end();) {
+                    old = old->second < level.current_bucket ? level.last_bucket.erase(old) : std::next(old);
+                }
+                level.current_bucket = bucket;
+            }
+            auto it = level.last_bucket.find(state.callsign);
+            if (it == level.last_bucket.end()) {
+                level.last_bucket.emplace(state.callsign, bucket);
+                level.writer->append(record);
+            } else if (bucket > it->second) {
+                it->second = bucket;
+                level.writer->append(record);
+            }
+        }
+
+        int64_t bucket = bucketStart(record.timestamp_ms, constants::HISTORY_OCCUPANCY_INTERVAL);
+        if (bucket > occupancy_bucket_) {
+            closeOccupancyBucket();
+            occupancy_bucket_ = bucket;
+        } else if (bucket < occupancy_bucket_) {
+            continue;
+        }
+        sector_aircraft_[history::sectorOf(record.x, record.y)].insert(state.callsign);
+    }
+}
+
+size_t HistoryRollupWriter::trackedAircraft() const {
+    size_t count = 0;
+    for (const auto& level : levels_) {
+        count += level.last_bucket.size();
+    }
+    return count;
+}
+
+void HistoryRollupWriter::closeOccupancyBucket() {
+    if (occupancy_bucket_ != NO_BUCKET && occupancy_bucket_ > last_written_bucket_ &&
+        occupancy_.is_open()) {
+        for (size_t sector = 0; sector < sector_aircraft_.size(); ++sector) {
+            if (sector_aircraft_[sector].empty()) continue;
+            SectorOccupancy record;
+            record.bucket_ms = occupancy_bucket_;
+            record.sector = static_cast<uint32_t>(sector);
+            record.aircraft = static_cast<uint32_t>(sector_aircraft_[sector].size());
+            occupancy_.write(reinterpret_cast<const char*>(&record), sizeof(record));
+        }
+        last_written_bucket_ = occupancy_bucket_;
+        if (occupancy_.fail()) {
+            ATC_LOG_ERROR("Failed writing sector occupancy to " +
+                          history::occupancyPath(directory_));
+        }
+    }
+
+    for (auto& aircraft : sector_aircraft_) {
+        aircraft.clear();
+    }
+}
+
+void HistoryRollupWriter::flush() {
+    for (auto& level : levels_) {
+        level.writer->flush();
+    }
+    occupancy_.flush();
+}
+
+std::vector<HistoryWriter*> HistoryRollupWriter::getWriters() const {
+    std::vector<HistoryWriter*> writers;
+    for (const auto& level : levels_) {
+        writers.push_back(level.writer.get());
+    }
+    return writers;
+}
+
+// ---------------------------------------------------------------------------
+// HistoryArchive
+
+HistoryArchive::HistoryArchive(const std::string& directory)
+    : directory_(directory) {
+    levels_.push_back({constants::HISTORY_SNAPSHOT_INTERVAL, HistoryReader(directory_)});
+    for (int interval : {constants::HISTORY_ROLLUP_FINE_INTERVAL,
+                         constants::HISTORY_ROLLUP_COARSE_INTERVAL}) {
+        levels_.push_back({interval, HistoryReader(directory_, history::rollupPrefix(interval))});
+    }
+}
+
+size_t HistoryArchive::refresh() {
+    size_t segments = 0;
+    for (auto& level : levels_) {
+        segments += level.reader.refresh();
+    }
+    return segments;
+}
+
+const HistoryArchive::Level& HistoryArchive::selectLevel(int resolution_ms, int64_t t_start) const {
+    const Level& base = levels_.front();
+    int64_t needed_from = std::max(t_start, base.reader.getStartTime());
+
+    // Rollups only help if they reach back as far as the query (or the raw data) does
+    for (auto it = levels_.rbegin(); it != levels_.rend(); ++it) {
+        if (it->interval_ms <= resolution_ms && it->reader.getSegmentCount() > 0 &&
+            it->reader.getStartTime() <= needed_from + it->interval_ms) {
+            return *it;
+        }
+    }
+    return base;
+}
+
+int HistoryArchive::selectResolution(int resolution_ms, int64_t t_start) const {
+    return selectLevel(resolution_ms, t_start).interval_ms;
+}
+
+std::vector<HistoryRecord> HistoryArchive::trajectory(const std::string& callsign, int64_t t_start,
+                                                      int64_t t_end, int resolution_ms) const {
+    return selectLevel(resolution_ms, t_start).reader.trajectory(callsign, t_start, t_end);
+}
+
+std::vector<HistoryRecord> HistoryArchive::window(int64_t t_start, int64_t t_end,
+                                                  const HistoryRegion& region,
+                                                  int resolution_ms) const {
+    return selectLevel(resolution_ms, t_start).reader.window(t_start, t_end, region);
+}
+
+std::vector<SectorOccupancy> HistoryArchive::sectorOccupancy(int64_t t_start, int64_t t_end) const {
+    std::vector<SectorOccupancy> result;
+    std::ifstream in(history::occupancyPath(directory_), std::ios::binary | std::ios::ate);
+    if (!in) {
+        return result;
+    }
+    auto size = static_cast<int64_t>(in.tellg());
+    in.seekg(0);
+    if (size < static_cast<int64_t>(sizeof(OccupancyHeader)) || !readOccupancyHeader(in)) {
+        return result;
+    }
+
+    int64_t count = (size - static_cast<int64_t>(sizeof(OccupancyHeader))) /
+                    static_cast<int64_t>(sizeof(SectorOccupancy));
+    auto recordAt = [&](int64_t index, SectorOccupancy& record) {
+        in.clear();
+        in.seekg(static_cast<std::streamoff>(sizeof(OccupancyHeader) + index * sizeof(SectorOccupancy)));
+        return static_cast<bool>(in.read(reinterpret_cast<char*>(&record), sizeof(record)));
+    };
+
+    // Records are appended in bucket order: binary search the first overlapping one
+    int64_t first_bucket = t_start - constants::HISTORY_OCCUPANCY_INTERVAL + 1;
+    int64_t low = 0;
+    int64_t high = count;
+    SectorOccupancy record;
+    while (low < high) {
+        int64_t mid = low + (high - low) / 2;
+        if (!recordAt(mid, record)) {
+            return result;
+        }
+        if (record.bucket_ms < first_bucket) {
+            low = mid + 1;
+        } else {
+            high = mid;
+        }
+    }
+
+    constexpr int64_t CHUNK_RECORDS = 4096;
+    std::vector<SectorOccupancy> chunk(CHUNK_RECORDS);
+    in.clear();
+    in.seekg(static_cast<std::streamoff>(sizeof(OccupancyHeader) + low * sizeof(SectorOccupancy)));
+    for (int64_t index = low; index < count; index += CHUNK_RECORDS) {
+        int64_t n = std::min(CHUNK_RECORDS, count - index);
+        if (!in.read(reinterpret_cast<char*>(chunk.data()), n * sizeof(SectorOccupancy))) {
+            break;
+        }
+        for (int64_t i = 0; i < n; ++i) {
+            if (chunk[i].bucket_ms > t_end) {
+                return result;
+            }
+            result.push_back(chunk[i]);
+        }
+    }
+    return result;
+}
+
+// ---------------------------------------------------------------------------
+// File naming and sector grid
+
+namespace history {
+
+std::string rollupPrefix(int interval_ms) {
+    return "history_r" + std::to_string(interval_ms / 1000);
+}
+
+std::string occupancyPath(const std::string& directory) {
+    return directory + "/sector_occupancy.dat";
+}
+
+uint32_t sectorCount() {
+    return static_cast<uint32_t>(constants::SECTOR_GRID_COLUMNS * constants::SECTOR_GRID_ROWS);
+}
+
+uint32_t sectorOf(double x, double y) {
+    double fx = (x - constants::AIRSPACE_X_MIN) / (constants::AIRSPACE_X_MAX - constants::AIRSPACE_X_MIN);
+    double fy = (y - constants::AIRSPACE_Y_MIN) / (constants::AIRSPACE_Y_MAX - constants::AIRSPACE_Y_MIN);
+    int column = std::min(std::max(static_cast<int>(fx * constants::SECTOR_GRID_COLUMNS), 0),
+                          constants::SECTOR_GRID_COLUMNS - 1);
+    int row = std::min(std::max(static_cast<int>(fy * constants::SECTOR_GRID_ROWS), 0),
+                       constants::SECTOR_GRID_ROWS - 1);
+    return static_cast<uint32_t>(row * constants::SECTOR_GRID_COLUMNS + column);
+}
+
+}
+
+} // namespace atc
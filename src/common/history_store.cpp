@@ -0,0 +1,703 @@
+#include "common/history_store.h"
+#include "common/history_codec.h"
+#include "common/constants.h"
+#include "common/logger.h"
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <dirent.h>
+#include <sys/stat.h>
+
+namespace atc {
+
+namespace {
+
+constexpr char SEGMENT_MAGIC[8] = {'A', 'T', 'C', 'H', 'S', 'E', 'G', '1'};
+constexpr char INDEX_MAGIC[8] = {'A', 'T', 'C', 'H', 'I', 'D', 'X', '1'};
+constexpr uint32_t BLOCK_MAGIC = 0x314B4C42;  // "BLK1"
+constexpr uint32_t FORMAT_VERSION = 1;
+
+struct SegmentHeader {
+    char magic[8];
+    uint32_t version;
+    uint32_t record_size;
+};
+
+struct BlockHeader {
+    uint32_t magic;
+    uint32_t record_count;
+    uint32_t stored_bytes;
+    uint32_t codec;  // codec::BlockCodec
+    int64_t t_min;
+    int64_t t_max;
+};
+
+struct IndexHeader {
+    char magic[8];
+    uint32_t block_count;
+    uint32_t callsign_count;
+    int64_t t_min;
+    int64_t t_max;
+};
+
+size_t bitmapWords(size_t block_count) {
+    return (block_count + 63) / 64;
+}
+
+bool testBit(const std::vector<uint64_t>& bitmap, size_t bit) {
+    size_t word = bit / 64;
+    return word < bitmap.size() && (bitmap[word] >> (bit % 64)) & 1u;
+}
+
+bool overlaps(const HistoryBlockInfo& block, int64_t t_start, int64_t t_end) {
+    return block.t_max >= t_start && block.t_min <= t_end;
+}
+
+void sortByTime(std::vector<HistoryRecord>& records) {
+    std::stable_sort(records.begin(), records.end(),
+        [](const HistoryRecord& a, const HistoryRecord& b) {
+            return a.timestamp_ms < b.timestamp_ms;
+        });
+}
+
+} // namespace
+
+HistoryRecord HistoryRecord::fromState(const AircraftState& state) {
+    HistoryRecord record;
+    std::memset(&record, 0, sizeof(record));
+    record.timestamp_ms = static_cast<int64_t>(state.timestamp);
+    std::strncpy(record.callsign, state.callsign.c_str(), CALLSIGN_LENGTH - 1);
+    record.x = state.position.x;
+    record.y = state.position.y;
+    record.z = state.position.z;
+    record.vx = state.velocity.vx;
+    record.vy = state.velocity.vy;
+    record.vz = state.velocity.vz;
+    record.heading = state.heading;
+    record.status = static_cast<uint8_t>(state.status);
+    return record;
+}
+
+AircraftState HistoryRecord::toState() const {
+    AircraftState state;
+    state.callsign = getCallsign();
+    state.position = {x, y, z};
+    state.velocity = {vx, vy, vz};
+    state.heading = heading;
+    state.status = static_cast<AircraftStatus>(status);
+    state.timestamp = static_cast<double>(timestamp_ms);
+    return state;
+}
+
+std::string HistoryRecord::getCallsign() const {
+    return std::string(callsign, strnlen(callsign, CALLSIGN_LENGTH));
+}
+
+HistoryRegion HistoryRegion::everything() {
+    return {constants::AIRSPACE_X_MIN, constants::AIRSPACE_X_MAX,
+            constants::AIRSPACE_Y_MIN, constants::AIRSPACE_Y_MAX,
+            constants::AIRSPACE_Z_MIN, constants::AIRSPACE_Z_MAX};
+}
+
+bool HistoryRegion::contains(const HistoryRecord& record) const {
+    return record.x >= x_min && record.x <= x_max &&
+           record.y >= y_min && record.y <= y_max &&
+           record.z >= z_min && record.z <= z_max;
+}
+
+// ---------------------------------------------------------------------------
+// HistorySegmentIndex
+
+void HistorySegmentIndex::addBlock(const HistoryBlockInfo& block,
+                                   const std::vector<HistoryRecord>& records) {
+    size_t block_number = blocks_.size();
+    if (blocks_.empty()) {
+        t_min_ = block.t_min;
+        t_max_ = block.t_max;
+    } else {
+        t_min_ = std::min(t_min_, block.t_min);
+        t_max_ = std::max(t_max_, block.t_max);
+    }
+    blocks_.push_back(block);
+
+    size_t words = bitmapWords(blocks_.size());
+    for (const auto& record : records) {
+        auto& bitmap = callsign_blocks_[record.getCallsign()];
+        if (bitmap.size() < words) {
+            bitmap.resize(words, 0);
+        }
+        bitmap[block_number / 64] |= uint64_t(1) << (block_number % 64);
+    }
+}
+
+bool HistorySegmentIndex::save(const std::string& path) const {
+    std::string tmp_path = path + ".tmp";
+    std::ofstream out(tmp_path, std::ios::binary | std::ios::trunc);
+    if (!out) {
+        return false;
+    }
+
+    IndexHeader header;
+    std::memcpy(header.magic, INDEX_MAGIC, sizeof(header.magic));
+    header.block_count = static_cast<uint32_t>(blocks_.size());
+    header.callsign_count = static_cast<uint32_t>(callsign_blocks_.size());
+    header.t_min = t_min_;
+    header.t_max = t_max_;
+    out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    out.write(reinterpret_cast<const char*>(blocks_.data()),
+              blocks_.size() * sizeof(HistoryBlockInfo));
+
+    std::vector<uint64_t> bitmap;
+    for (const auto& [callsign, blocks] : callsign_blocks_) {
+        char name[HistoryRecord::CALLSIGN_LENGTH] = {};
+        std::strncpy(name, callsign.c_str(), sizeof(name) - 1);
+        out.write(name, sizeof(name));
+
+        bitmap.assign(bitmapWords(blocks_.size()), 0);
+        std::copy(blocks.begin(), blocks.end(), bitmap.begin());
+        out.write(reinterpret_cast<const char*>(bitmap.data()),
+                  bitmap.size() * sizeof(uint64_t));
+    }
+
+    out.close();
+    if (out.fail()) {
+        return false;
+    }
+    return std::rename(tmp_path.c_str(), path.c_str()) == 0;
+}
+
+bool HistorySegmentIndex::load(const std::string& path) {
+    std::ifstream in(path, std::ios::binary);
+    if (!in) {
+        return false;
+    }
+
+    IndexHeader header;
+    if (!in.read(reinterpret_cast<char*>(&header), sizeof(header)) ||
+        std::memcmp(header.magic, INDEX_MAGIC, sizeof(header.magic)) != 0) {
+        return false;
+    }
+
+    // Counts from a truncated or corrupt index must fit in what is left of the file
+    std::streamoff start = in.tellg();
+    in.seekg(0, std::ios::end);
+    uint64_t remaining = static_cast<uint64_t>(in.tellg() - start);
+    in.seekg(start);
+    size_t words = bitmapWords(header.block_count);
+    uint64_t block_bytes = uint64_t{header.block_count} * sizeof(HistoryBlockInfo);
+    uint64_t callsign_bytes = uint64_t{header.callsign_count} *
+                              (HistoryRecord::CALLSIGN_LENGTH + words * sizeof(uint64_t));
+    if (!in || block_bytes > remaining || callsign_bytes > remaining - block_bytes) {
+        return false;
+    }
+
+    blocks_.resize(header.block_count);
+    in.read(reinterpret_cast<char*>(blocks_.data()),
+            blocks_.size() * sizeof(HistoryBlockInfo));
+
+    callsign_blocks_.clear();
+    for (uint32_t i = 0; i < header.callsign_count && in; ++i) {
+        char name[HistoryRecord::CALLSIGN_LENGTH];
+        in.read(name, sizeof(name));
+        std::vector<uint64_t> bitmap(words);
+        in.read(reinterpret_cast<char*>(bitmap.data()), words * sizeof(uint64_t));
+        callsign_blocks_[std::string(name, strnlen(name, sizeof(name)))] = std::move(bitmap);
+    }
+
+    t_min_ = header.t_min;
+    t_max_ = header.t_max;
+    return static_cast<bool>(in);
+}
+
+bool HistorySegmentIndex::scan(const std::string& segment_path) {
+    std::ifstream in(segment_path, std::ios::binary);
+    if (!in) {
+        return false;
+    }
+
+    uint64_t offset = sizeof(SegmentHeader);
+    if (blocks_.empty()) {
+        SegmentHeader segment_header;
+        if (!in.read(reinterpret_cast<char*>(&segment_header), sizeof(segment_header)) ||
+            std::memcmp(segment_header.magic, SEGMENT_MAGIC, sizeof(segment_header.magic)) != 0) {
+            return false;
+        }
+    } else {
+        const auto& last = blocks_.back();
+        offset = last.offset + sizeof(BlockHeader) + last.stored_bytes;
+        in.seekg(static_cast<std::streamoff>(offset));
+    }
+
+    // Walk block headers; a truncated trailing block is ignored
+    std::vector<HistoryRecord> records;
+    BlockHeader header;
+    while (in.read(reinterpret_cast<char*>(&header), sizeof(header)) &&
+           header.magic == BLOCK_MAGIC) {
+        HistoryBlockInfo info{offset, header.record_count, header.stored_bytes,
+                              header.codec, 0, header.t_min, header.t_max};
+        if (!history::readBlock(in, info, records)) {
+            break;
+        }
+        addBlock(info, records);
+        offset += sizeof(header) + header.stored_bytes;
+        in.clear();
+        in.seekg(static_cast<std::streamoff>(offset));
+    }
+    return true;
+}
+
+std::vector<size_t> HistorySegmentIndex::findBlocks(int64_t t_start, int64_t t_end) const {
+    std::vector<size_t> result;
+    if (blocks_.empty() || t_end < t_min_ || t_start > t_max_) {
+        return result;
+    }
+    for (size_t i = 0; i < blocks_.size(); ++i) {
+        if (overlaps(blocks_[i], t_start, t_end)) {
+            result.push_back(i);
+        }
+    }
+    return result;
+}
+
+std::vector<size_t> HistorySegmentIndex::findBlocks(const std::string& callsign,
+                                                    int64_t t_start, int64_t t_end) const {
+    std::vector<size_t> result;
+    auto it = callsign_blocks_.find(callsign);
+    if (it == callsign_blocks_.end() || t_end < t_min_ || t_start > t_max_) {
+        return result;
+    }
+    for (size_t i = 0; i < blocks_.size(); ++i) {
+        if (testBit(it->second, i) && overlaps(blocks_[i], t_start, t_end)) {
+            result.push_back(i);
+        }
+    }
+    return result;
+}
+
+// ---------------------------------------------------------------------------
+// HistoryWriter
+
+HistoryWriter::HistoryWriter(const std::string& directory, const std::string& prefix)
+    : directory_(directory)
+    , prefix_(prefix)
+    , segment_offset_(0)
+    , segment_sequence_(0)
+    , operational_(false) {
+
+    ::mkdir(directory_.c_str(), 0755);
+
+    // Continue numbering after any segments left by a previous run
+    auto existing = history::listSegments(directory_, prefix_);
+    if (!existing.empty()) {
+        const auto& last = existing.back();
+        segment_sequence_ = static_cast<uint32_t>(
+            std::strtoul(last.substr(last.size() - 10, 6).c_str(), nullptr, 10));
+    }
+    block_.reserve(constants::HISTORY_BLOCK_RECORDS);
+
+    operational_ = openSegment();
+}
+
+HistoryWriter::~HistoryWriter() {
+    closeSegment();
+}
+
+bool HistoryWriter::openSegment() {
+    segment_path_ = history::segmentPath(directory_, prefix_, ++segment_sequence_);
+    segment_.open(segment_path_, std::ios::binary | std::ios::trunc);
+    if (!segment_) {
+        ATC_LOG_ERROR("Failed to open history segment: " + segment_path_);
+        return false;
+    }
+
+    SegmentHeader header;
+    std::memcpy(header.magic, SEGMENT_MAGIC, sizeof(header.magic));
+    header.version = FORMAT_VERSION;
+    header.record_size = sizeof(HistoryRecord);
+    segment_.write(reinterpret_cast<const char*>(&header), sizeof(header));
+
+    segment_offset_ = sizeof(header);
+    index_ = HistorySegmentIndex();
+    return true;
+}
+
+void HistoryWriter::closeSegment() {
+    if (!segment_.is_open()) {
+        return;
+    }
+    writeBlock();
+    segment_.close();
+    if (!index_.save(history::indexPath(segment_path_))) {
+        ATC_LOG_ERROR("Failed to write history index for " + segment_path_);
+    } else if (on_segment_closed_ && !index_.empty()) {
+        on_segment_closed_(segment_path_);
+    }
+}
+
+void HistoryWriter::setSegmentClosedCallback(std::function<void(const std::string&)> callback) {
+    on_segment_closed_ = std::move(callback);
+}
+
+void HistoryWriter::append(const std::vector<AircraftState>& states) {
+    for (const auto& state : states) {
+        append(HistoryRecord::fromState(state));
+    }
+}
+
+void HistoryWriter::append(const HistoryRecord& record) {
+    if (!operational_) return;
+
+    block_.push_back(record);
+    if (block_.size() >= static_cast<size_t>(constants::HISTORY_BLOCK_RECORDS)) {
+        writeBlock();
+    }
+
+    if (index_.blocks().size() >= static_cast<size_t>(constants::HISTORY_SEGMENT_BLOCKS)) {
+        closeSegment();
+        operational_ = openSegment();
+    }
+}
+
+void HistoryWriter::writeBlock() {
+    if (block_.empty() || !segment_.is_open()) return;
+
+    BlockHeader header;
+    header.magic = BLOCK_MAGIC;
+    header.record_count = static_cast<uint32_t>(block_.size());
+    header.stored_bytes = static_cast<uint32_t>(block_.size() * sizeof(HistoryRecord));
+    header.codec = codec::RAW_RECORDS;
+    header.t_min = block_.front().timestamp_ms;
+    header.t_max = block_.front().timestamp_ms;
+    for (const auto& record : block_) {
+        header.t_min = std::min(header.t_min, record.timestamp_ms);
+        header.t_max = std::max(header.t_max, record.timestamp_ms);
+    }
+
+    segment_.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    segment_.write(reinterpret_cast<const char*>(block_.data()), header.stored_bytes);
+    if (segment_.fail()) {
+        ATC_LOG_ERROR("Failed writing history block to " + segment_path_);
+        operational_ = false;
+        return;
+    }
+
+    index_.addBlock({segment_offset_, header.record_count, header.stored_bytes,
+                     header.codec, 0, header.t_min, header.t_max}, block_);
+    segment_offset_ += sizeof(header) + header.stored_bytes;
+    block_.clear();
+}
+
+void HistoryWriter::flush() {
+    if (!segment_.is_open()) return;
+
+    // Make buffered records and the index of the open segment visible to readers
+    writeBlock();
+    segment_.flush();
+    if (!index_.save(history::indexPath(segment_path_))) {
+        ATC_LOG_ERROR("Failed to write history index for " + segment_path_);
+    }
+}
+
+// ---------------------------------------------------------------------------
+// HistoryReader
+
+HistoryReader::HistoryReader(const std::string& directory, const std::string& prefix)
+    : directory_(directory)
+    , prefix_(prefix) {
+    refresh();
+}
+
+size_t HistoryReader::refresh() {
+    segments_.clear();
+    for (const auto& path : history::listSegments(directory_, prefix_)) {
+        Segment segment;
+        segment.path = path;
+
+        // The index of the open segment may lag behind its last blocks
+        if (!segment.index.load(history::indexPath(path))) {
+            segment.index = HistorySegmentIndex();
+        }
+        if (!segment.index.scan(path)) {
+            continue;
+        }
+        if (!segment.index.empty()) {
+            segments_.push_back(std::move(segment));
+        }
+    }
+    return segments_.size();
+}
+
+int64_t HistoryReader::getStartTime() const {
+    if (segments_.empty()) {
+        return 0;
+    }
+    int64_t start = segments_.front().index.getStartTime();
+    for (const auto& segment : segments_) {
+        start = std::min(start, segment.index.getStartTime());
+    }
+    return start;
+}
+
+int64_t HistoryReader::getEndTime() const {
+    int64_t end = 0;
+    for (const auto& segment : segments_) {
+        end = std::max(end, segment.index.getEndTime());
+    }
+    return end;
+}
+
+std::vector<HistoryRecord> HistoryReader::trajectory(const std::string& callsign,
+                                                     int64_t t_start, int64_t t_end) const {
+    std::vector<HistoryRecord> result;
+    std::vector<HistoryRecord> block_records;
+
+    for (const auto& segment : segments_) {
+        auto blocks = segment.index.findBlocks(callsign, t_start, t_end);
+        if (blocks.empty()) continue;
+
+        std::ifstream in(segment.path, std::ios::binary);
+        for (size_t block : blocks) {
+            if (!history::readBlock(in, segment.index.blocks()[block], block_records)) {
+                continue;
+            }
+            for (const auto& record : block_records) {
+                if (record.timestamp_ms >= t_start && record.timestamp_ms <= t_end &&
+                    std::strncmp(record.callsign, callsign.c_str(),
+                                 HistoryRecord::CALLSIGN_LENGTH) == 0) {
+                    result.push_back(record);
+                }
+            }
+        }
+    }
+
+    sortByTime(result);
+    return result;
+}
+
+std::vector<HistoryRecord> HistoryReader::window(int64_t t_start, int64_t t_end,
+                                                 const HistoryRegion& region) const {
+    std::vector<HistoryRecord> result;
+    std::vector<HistoryRecord> block_records;
+
+    for (const auto& segment : segments_) {
+        auto blocks = segment.index.findBlocks(t_start, t_end);
+        if (blocks.empty()) continue;
+
+        std::ifstream in(segment.path, std::ios::binary);
+        for (size_t block : blocks) {
+            if (!history::readBlock(in, segment.index.blocks()[block], block_records)) {
+                continue;
+            }
+            for (const auto& record : block_records) {
+                if (record.timestamp_ms >= t_start && record.timestamp_ms <= t_end &&
+                    region.contains(record)) {
+                    result.push_back(record);
+                }
+            }
+        }
+    }
+
+    sortByTime(result);
+    return result;
+}
+
+bool HistoryReader::forEachBlock(int64_t t_start, int64_t t_end,
+                                 const std::function<bool(const HistoryColumns&)>& visit) const {
+    HistoryColumns columns;
+    for (const auto& segment : segments_) {
+        auto blocks = segment.index.findBlocks(t_start, t_end);
+        if (blocks.empty()) continue;
+
+        std::ifstream in(segment.path, std::ios::binary);
+        for (size_t block : blocks) {
+            if (!history::readBlock(in, segment.index.blocks()[block], columns)) {
+                ATC_LOG_ERROR("Skipping unreadable history block in " + segment.path);
+                continue;
+            }
+            if (!visit(columns)) {
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+// ---------------------------------------------------------------------------
+// File naming helpers
+
+namespace history {
+
+std::string segmentPath(const std::string& directory, const std::string& prefix, uint32_t sequence) {
+    char name[32];
+    std::snprintf(name, sizeof(name), "_%06u.seg", sequence);
+    return directory + "/" + prefix + name;
+}
+
+std::string indexPath(const std::string& segment_path) {
+    return segment_path.substr(0, segment_path.size() - 4) + ".idx";
+}
+
+std::vector<std::string> listSegments(const std::string& directory, const std::string& prefix) {
+    std::vector<std::string> segments;
+    DIR* dir = ::opendir(directory.c_str());
+    if (!dir) {
+        return segments;
+    }
+
+    std::string name_prefix = prefix + "_";
+    while (dirent* entry = ::readdir(dir)) {
+        std::string name = entry->d_name;
+        if (name.size() == name_prefix.size() + 10 &&
+            name.compare(0, name_prefix.size(), name_prefix) == 0 &&
+            name.compare(name.size() - 4, 4, ".seg") == 0) {
+            segments.push_back(directory + "/" + name);
+        }
+    }
+    ::closedir(dir);
+
+    // Zero-padded sequence numbers sort chronologically
+    std::sort(segments.begin(), segments.end());
+    return segments;
+}
+
+namespace {
+
+bool readPayload(std::ifstream& in, const HistoryBlockInfo& info, std::vector<uint8_t>& payload) {
+    in.clear();
+    if (!in.seekg(static_cast<std::streamoff>(info.offset))) {
+        return false;
+    }
+
+    // The header must agree with the index so a stale index is never trusted
+    BlockHeader header;
+    if (!in.read(reinterpret_cast<char*>(&header), sizeof(header)) ||
+        header.magic != BLOCK_MAGIC || header.codec != info.codec ||
+        header.record_count != info.record_count ||
+        header.stored_bytes != info.stored_bytes) {
+        return false;
+    }
+
+    payload.resize(header.stored_bytes);
+    return static_cast<bool>(in.read(reinterpret_cast<char*>(payload.data()), payload.size()));
+}
+
+}
+
+bool readBlock(std::ifstream& in, const HistoryBlockInfo& info, std::vector<HistoryRecord>& records) {
+    if (info.codec == codec::RAW_RECORDS) {
+        if (info.stored_bytes != info.record_count * sizeof(HistoryRecord)) {
+            return false;
+        }
+        std::vector<uint8_t> payload;
+        if (!readPayload(in, info, payload)) {
+            return false;
+        }
+        records.resize(info.record_count);
+        std::memcpy(records.data(), payload.data(), payload.size());
+        return true;
+    }
+
+    HistoryColumns columns;
+    if (!readBlock(in, info, columns)) {
+        return false;
+    }
+    columns.toRecords(records);
+    return true;
+}
+
+bool readBlock(std::ifstream& in, const HistoryBlockInfo& info, HistoryColumns& columns) {
+    if (info.codec == codec::RAW_RECORDS) {
+        std::vector<HistoryRecord> records;
+        if (!readBlock(in, info, records)) {
+            return false;
+        }
+        columns.fromRecords(records);
+        return true;
+    }
+
+    std::vector<uint8_t> payload;
+    return info.codec == codec::PACKED_LZ &&
+           readPayload(in, info, payload) &&
+           codec::decompressBlock(payload.data(), payload.size(), info.record_count, columns);
+}
+
+bool compressSegment(const std::string& segment_path, uint64_t* raw_bytes,
+                     uint64_t* compressed_bytes) {
+    HistorySegmentIndex index;
+    std::string index_path = indexPath(segment_path);
+    if (!index.load(index_path)) {
+        index = HistorySegmentIndex();
+    }
+    if (!index.scan(segment_path)) {
+        return false;
+    }
+    if (std::all_of(index.blocks().begin(), index.blocks().end(),
+                    [](const HistoryBlockInfo& info) { return info.codec == codec::PACKED_LZ; })) {
+        return true;
+    }
+
+    std::ifstream in(segment_path, std::ios::binary);
+    SegmentHeader segment_header;
+    if (!in.read(reinterpret_cast<char*>(&segment_header), sizeof(segment_header))) {
+        return false;
+    }
+
+    std::string tmp_path = segment_path + ".tmp";
+    std::ofstream out(tmp_path, std::ios::binary | std::ios::trunc);
+    out.write(reinterpret_cast<const char*>(&segment_header), sizeof(segment_header));
+
+    HistorySegmentIndex compressed_index;
+    HistoryColumns columns;
+    std::vector<HistoryRecord> records;
+    std::vector<uint8_t> payload;
+    uint64_t offset = sizeof(segment_header);
+    uint64_t raw_total = 0;
+
+    for (const auto& info : index.blocks()) {
+        if (!readBlock(in, info, columns)) {
+            std::remove(tmp_path.c_str());
+            return false;
+        }
+        codec::compressBlock(columns, payload);
+        columns.toRecords(records);
+
+        BlockHeader header;
+        header.magic = BLOCK_MAGIC;
+        header.record_count = info.record_count;
+        header.stored_bytes = static_cast<uint32_t>(payload.size());
+        header.codec = codec::PACKED_LZ;
+        header.t_min = info.t_min;
+        header.t_max = info.t_max;
+        out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+        out.write(reinterpret_cast<const char*>(payload.data()), payload.size());
+
+        compressed_index.addBlock({offset, header.record_count, header.stored_bytes,
+                                   header.codec, 0, header.t_min, header.t_max}, records);
+        offset += sizeof(header) + header.stored_bytes;
+        raw_total += info.record_count * sizeof(HistoryRecord);
+    }
+
+    out.close();
+    if (out.fail()) {
+        std::remove(tmp_path.c_str());
+        return false;
+    }
+
+    // Readers validate block headers against the index, so swapping the two
+    // files one after the other never yields wrong records
+    std::string next_index_path = index_path + ".next";
+    if (!compressed_index.save(next_index_path) ||
+        std::rename(tmp_path.c_str(), segment_path.c_str()) != 0 ||
+        std::rename(next_index_path.c_str(), index_path.c_str()) != 0) {
+        return false;
+    }
+
+    if (raw_bytes) *raw_bytes = raw_total;
+    if (compressed_bytes) *compressed_bytes = offset;
+    return true;
+}
+
+}
+
+} // namespace atc
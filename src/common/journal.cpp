@@ -0,0 +1,300 @@
+#include "common/journal.h"
+#include "common/logger.h"
+#include <cstring>
+
+namespace atc {
+
+namespace {
+
+constexpr char JOURNAL_MAGIC[4] = {'A', 'T', 'C', 'J'};
+constexpr uint32_t JOURNAL_VERSION = 1;
+constexpr size_t RECORD_HEADER_SIZE = 1 + 2 * sizeof(uint32_t);
+constexpr uint32_t MAX_RECORD_SIZE = 1 << 24;   // anything larger is a corrupt length
+
+template <typename T>
+void put(std::string& out, T value) {
+    out.append(reinterpret_cast<const char*>(&value), sizeof(value));
+}
+
+void putString(std::string& out, const std::string& value) {
+    put(out, static_cast<uint32_t>(value.size()));
+    out.append(value);
+}
+
+class PayloadReader {
+public:
+    explicit PayloadReader(const std::string& payload)
+        : data_(payload.data()), size_(payload.size()) {}
+
+    template <typename T>
+    bool get(T& value) {
+        if (size_ - offset_ < sizeof(T)) return false;
+        std::memcpy(&value, data_ + offset_, sizeof(T));
+        offset_ += sizeof(T);
+        return true;
+    }
+
+    bool getString(std::string& value) {
+        uint32_t length;
+        if (!get(length) || size_ - offset_ < length) return false;
+        value.assign(data_ + offset_, length);
+        offset_ += length;
+        return true;
+    }
+
+    bool atEnd() const { return offset_ == size_; }
+
+private:
+    const char* data_;
+    size_t size_;
+    size_t offset_ = 0;
+};
+
+// Payload alternatives in std::variant order
+enum PayloadIndex : uint8_t {
+    STATE_PAYLOAD = 0,
+    COMMAND_PAYLOAD = 1,
+    ALERT_PAYLOAD = 2,
+    FLIGHT_PLAN_PAYLOAD = 3
+};
+
+void encodeMessage(const comm::Message& message, std::string& out) {
+    put(out, static_cast<uint8_t>(message.type));
+    put(out, message.timestamp);
+    putString(out, message.sender_id);
+    put(out, static_cast<uint8_t>(message.payload.index()));
+
+    if (const auto* state = std::get_if<AircraftState>(&message.payload)) {
+        putString(out, state->callsign);
+        put(out, state->position.x);
+        put(out, state->position.y);
+        put(out, state->position.z);
+        put(out, state->velocity.vx);
+        put(out, state->velocity.vy);
+        put(out, state->velocity.vz);
+        put(out, state->heading);
+        put(out, static_cast<uint8_t>(state->status));
+        put(out, state->timestamp);
+    } else if (const auto* command = std::get_if<comm::CommandData>(&message.payload)) {
+        putString(out, command->target_id);
+        putString(out, command->command);
+        put(out, static_cast<uint32_t>(command->params.size()));
+        for (const auto& param : command->params) {
+            putString(out, param);
+        }
+    } else if (const auto* alert = std::get_if<comm::AlertData>(&message.payload)) {
+        put(out, alert->level);
+        putString(out, alert->description);
+    } else if (const auto* plan = std::get_if<comm::FlightPlanData>(&message.payload)) {
+        putString(out, plan->callsign);
+        put(out, plan->cruise_speed);
+        put(out, static_cast<uint32_t>(plan->waypoints.size()));
+        for (const auto& waypoint : plan->waypoints) {
+            put(out, waypoint.x);
+            put(out, waypoint.y);
+            put(out, waypoint.z);
+        }
+        put(out, static_cast<uint8_t>(plan->wake_category));
+    }
+}
+
+}
+
+JournalWriter::JournalWriter(const std::string& path) : path_(path) {}
+
+JournalWriter::~JournalWriter() {
+    if (operational_) {
+        flush();
+    }
+}
+
+bool JournalWriter::open(uint64_t seed, std::chrono::system_clock::time_point epoch) {
+    file_.open(path_, std::ios::binary | std::ios::trunc);
+    if (!file_) {
+        ATC_LOG_ERROR("Failed to create journal: " + path_);
+        return false;
+    }
+
+    std::string header(JOURNAL_MAGIC, sizeof(JOURNAL_MAGIC));
+    put(header, JOURNAL_VERSION);
+    put(header, seed);
+    put(header, static_cast<int64_t>(std::chrono::duration_cast<std::chrono::microseconds>(
+        epoch.time_since_epoch()).count()));
+    file_.write(header.data(), static_cast<std::streamsize>(header.size()));
+    operational_ = static_cast<bool>(file_);
+    return operational_;
+}
+
+void JournalWriter::writeScenarioRow(std::chrono::milliseconds at, const std::string& row) {
+    write(JournalKind::SCENARIO_ROW, at, row);
+}
+
+void JournalWriter::writeMessage(std::chrono::milliseconds at, const comm::Message& message) {
+    std::string payload;
+    encodeMessage(message, payload);
+    write(JournalKind::CHANNEL_MESSAGE, at, payload);
+}
+
+void JournalWriter::writeAlert(std::chrono::milliseconds at, const std::string& text) {
+    write(JournalKind::ALERT, at, text);
+}
+
+void JournalWriter::write(JournalKind kind, std::chrono::milliseconds at, const std::string& payload) {
+    if (!operational_) return;
+    put(buffer_, static_cast<uint8_t>(kind));
+    put(buffer_, static_cast<uint32_t>(at.count()));
+    put(buffer_, static_cast<uint32_t>(payload.size()));
+    buffer_.append(payload);
+}
+
+void JournalWriter::flush() {
+    if (!operational_ || buffer_.empty()) return;
+    file_.write(buffer_.data(), static_cast<std::streamsize>(buffer_.size()));
+    file_.flush();
+    buffer_.clear();
+    if (!file_) {
+        ATC_LOG_ERROR("Failed to write journal " + path_ + " - recording stopped");
+        operational_ = false;
+    }
+}
+
+void JournalWriter::close(std::chrono::milliseconds at) {
+    write(JournalKind::END, at, std::string());
+    flush();
+    operational_ = false;
+    file_.close();
+}
+
+bool JournalReader::open(const std::string& path) {
+    file_.open(path, std::ios::binary);
+    if (!file_) {
+        ATC_LOG_ERROR("Cannot open journal: " + path);
+        return false;
+    }
+
+    char magic[sizeof(JOURNAL_MAGIC)];
+    uint32_t version = 0;
+    int64_t epoch_us = 0;
+    file_.read(magic, sizeof(magic));
+    file_.read(reinterpret_cast<char*>(&version), sizeof(version));
+    file_.read(reinterpret_cast<char*>(&seed_), sizeof(seed_));
+    file_.read(reinterpret_cast<char*>(&epoch_us), sizeof(epoch_us));
+    if (!file_ || std::memcmp(magic, JOURNAL_MAGIC, sizeof(magic)) != 0) {
+        ATC_LOG_ERROR("Not a journal: " + path);
+        return false;
+    }
+    if (version != JOURNAL_VERSION) {
+        ATC_LOG_ERROR("Unsupported journal version " + std::to_string(version) + ": " + path);
+        return false;
+    }
+    epoch_ = std::chrono::system_clock::time_point(std::chrono::microseconds(epoch_us));
+    return true;
+}
+
+bool JournalReader::next(JournalEntry& entry) {
+    char header[RECORD_HEADER_SIZE];
+    if (!file_.read(header, sizeof(header))) {
+        return false;
+    }
+
+    uint8_t kind;
+    uint32_t at;
+    uint32_t length;
+    std::memcpy(&kind, header, sizeof(kind));
+    std::memcpy(&at, header + 1, sizeof(at));
+    std::memcpy(&length, header + 1 + sizeof(at), sizeof(length));
+    if (kind < static_cast<uint8_t>(JournalKind::SCENARIO_ROW) ||
+        kind > static_cast<uint8_t>(JournalKind::END) || length > MAX_RECORD_SIZE) {
+        ATC_LOG_WARNING("Journal record " + std::to_string(kind) + " is corrupt - stopping there");
+        return false;
+    }
+
+    entry.kind = static_cast<JournalKind>(kind);
+    entry.at = std::chrono::milliseconds(at);
+    entry.payload.resize(length);
+    return length == 0 || static_cast<bool>(file_.read(&entry.payload[0], length));
+}
+
+bool JournalReader::decodeMessage(const std::string& payload, comm::Message& message) {
+    PayloadReader reader(payload);
+    uint8_t type;
+    uint8_t index;
+    if (!reader.get(type) || type > static_cast<uint8_t>(comm::MessageType::AIRCRAFT_EXIT) ||
+        !reader.get(message.timestamp) || !reader.getString(message.sender_id) ||
+        !reader.get(index)) {
+        return false;
+    }
+    message.type = static_cast<comm::MessageType>(type);
+
+    switch (index) {
+        case STATE_PAYLOAD: {
+            AircraftState state;
+            uint8_t status;
+            if (!reader.getString(state.callsign) ||
+                !reader.get(state.position.x) || !reader.get(state.position.y) ||
+                !reader.get(state.position.z) || !reader.get(state.velocity.vx) ||
+                !reader.get(state.velocity.vy) || !reader.get(state.velocity.vz) ||
+                !reader.get(state.heading) || !reader.get(status) ||
+                status > static_cast<uint8_t>(AircraftStatus::EMERGENCY) ||
+                !reader.get(state.timestamp)) {
+                return false;
+            }
+            state.status = static_cast<AircraftStatus>(status);
+            message.payload = state;
+            break;
+        }
+        case COMMAND_PAYLOAD: {
+            comm::CommandData command;
+            uint32_t count;
+            if (!reader.getString(command.target_id) || !reader.getString(command.command) ||
+                !reader.get(count)) {
+                return false;
+            }
+            for (uint32_t i = 0; i < count; ++i) {
+                std::string param;
+                if (!reader.getString(param)) return false;
+                command.params.push_back(std::move(param));
+            }
+            message.payload = command;
+            break;
+        }
+        case ALERT_PAYLOAD: {
+            comm::AlertData alert;
+            if (!reader.get(alert.level) || !reader.getString(alert.description)) {
+                return false;
+            }
+            message.payload = alert;
+            break;
+        }
+        case FLIGHT_PLAN_PAYLOAD: {
+            comm::FlightPlanData plan;
+            uint32_t count;
+            if (!reader.getString(plan.callsign) || !reader.get(plan.cruise_speed) ||
+                !reader.get(count)) {
+                return false;
+            }
+            for (uint32_t i = 0; i < count; ++i) {
+                Position waypoint;
+                if (!reader.get(waypoint.x) || !reader.get(waypoint.y) || !reader.get(waypoint.z)) {
+                    return false;
+                }
+                plan.waypoints.push_back(waypoint);
+            }
+            // Absent from plans journaled before wake categories, which stay MEDIUM
+            uint8_t wake;
+            if (!reader.atEnd()) {
+                if (!reader.get(wake) || wake > static_cast<uint8_t>(WakeCategory::SUPER)) {
+                    return false;
+                }
+                plan.wake_category = static_cast<WakeCategory>(wake);
+            }
+            message.payload = plan;
+            break;
+        }
+        default:
+            return false;
+    }
+    return reader.atEnd();
+}
+
+}
@@ -0,0 +1,21 @@
+#include "common/log_flusher.h"
+#include "common/constants.h"
+#include "common/logger.h"
+
+namespace atc {
+
+LogFlusher::LogFlusher()
+    : PeriodicTask(std::chrono::milliseconds(constants::LOG_FLUSH_INTERVAL),
+                   constants::LOGGING_PRIORITY) {
+}
+
+LogFlusher::~LogFlusher() {
+    stop();
+    Logger::getInstance().flushAll();
+}
+
+void LogFlusher::execute() {
+    Logger::getInstance().flushAll();
+}
+
+}
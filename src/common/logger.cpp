@@ -1,11 +1,49 @@
+
 #include "common/logger.h"
+#include "common/constants.h"
+#include "common/timestamp.h"
+#include <algorithm>
 #include <iostream>
-#include <chrono>
-#include <ctime>
 
 namespace atc {
 
+std::atomic<int> Logger::runtime_level_{static_cast<int>(LogLevel::INFO)};
+
+namespace {
+
+struct EventRegistry {
+    std::mutex mutex;
+    std::vector<LogEvent*> events;
+};
+
+EventRegistry& eventRegistry() {
+    static EventRegistry registry;
+    return registry;
+}
+
+void appendLine(std::string& lines, std::chrono::system_clock::time_point time,
+                LogLevel level, const std::string& message) {
+    char text[timestamp::MICROS_LENGTH];
+    lines.append(text, timestamp::format(time, text));
+    lines += " [";
+    lines += Logger::getLevelName(level);
+    lines += "] ";
+    lines += message;
+    lines += '\n';
+}
+
+} // namespace
+
+struct Logger::StagingBuffer {
+    std::mutex mutex;
+    std::string lines;
+    std::chrono::steady_clock::time_point first_staged;
+};
+
 Logger::Logger() {
+    // Constructed first so it outlives the logger's final flush
+    eventRegistry();
+
     log_file_.open("system.log", std::ios::out | std::ios::app);
     if (!log_file_) {
         std::cerr << "Failed to open log file" << std::endl;
@@ -13,6 +51,7 @@ Logger::Logger() {
 }
 
 Logger::~Logger() {
+    flushAll();
     if (log_file_.is_open()) {
         log_file_.close();
     }
@@ -23,15 +62,157 @@ Logger& Logger::getInstance() {
     return instance;
 }
 
+void Logger::setLevel(LogLevel level) {
+    runtime_level_.store(static_cast<int>(level), std::memory_order_relaxed);
+}
+
+LogLevel Logger::getLevel() {
+    return static_cast<LogLevel>(runtime_level_.load(std::memory_order_relaxed));
+}
+
+bool Logger::parseLevel(const std::string& name, LogLevel& level) {
+    static const LogLevel levels[] = {
+        LogLevel::DEBUG, LogLevel::INFO, LogLevel::WARNING, LogLevel::ERROR, LogLevel::OFF
+    };
+    for (LogLevel candidate : levels) {
+        if (name == getLevelName(candidate)) {
+            level = candidate;
+            return true;
+        }
+    }
+    return false;
+}
+
+const char* Logger::getLevelName(LogLevel level) {
+    switch (level) {
+        case LogLevel::DEBUG: return "DEBUG";
+        case LogLevel::INFO: return "INFO";
+        case LogLevel::WARNING: return "WARNING";
+        case LogLevel::ERROR: return "ERROR";
+        case LogLevel::OFF: return "OFF";
+    }
+    return "UNKNOWN";
+}
+
 void Logger::log(const std::string& message) {
+    log(LogLevel::INFO, message);
+}
+
+void Logger::log(LogLevel level, const std::string& message) {
+    stage(threadBuffer(), level, message);
+}
+
+void Logger::flush() {
+    StagingBuffer& buffer = threadBuffer();
+    std::lock_guard<std::mutex> lock(buffer.mutex);
+    writeStaged(buffer);
+}
+
+void Logger::flushAll() {
+    std::string lines;
+    {
+        auto& registry = eventRegistry();
+        std::lock_guard<std::mutex> lock(registry.mutex);
+        auto wall = std::chrono::system_clock::now();
+        auto now = std::chrono::steady_clock::now();
+        for (LogEvent* event : registry.events) {
+            uint64_t count = event->count_.exchange(0, std::memory_order_relaxed);
+            auto elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(
+                now - event->last_report_).count();
+            event->last_report_ = now;
+            if (count > 0) {
+                appendLine(lines, wall, event->level_,
+                           std::to_string(count) + " " + event->name_ + " in last " +
+                           std::to_string(elapsed) + " ms");
+            }
+        }
+    }
+
+    std::lock_guard<std::mutex> lock(buffers_mutex_);
+    for (StagingBuffer* buffer : buffers_) {
+        std::lock_guard<std::mutex> buffer_lock(buffer->mutex);
+        writeStaged(*buffer);
+    }
+    if (!lines.empty()) {
+        std::lock_guard<std::mutex> file_lock(log_mutex_);
+        if (log_file_.is_open()) {
+            log_file_ << lines;
+            log_file_.flush();
+        }
+    }
+}
+
+Logger::StagingBuffer& Logger::threadBuffer() {
+    // Owns this thread's buffer and hands what is left to the file at thread exit
+    struct Handle {
+        StagingBuffer* buffer = nullptr;
+        ~Handle() {
+            if (buffer) Logger::getInstance().release(buffer);
+        }
+    };
+    thread_local Handle handle;
+
+    if (!handle.buffer) {
+        handle.buffer = new StagingBuffer();
+        std::lock_guard<std::mutex> lock(buffers_mutex_);
+        buffers_.push_back(handle.buffer);
+    }
+    return *handle.buffer;
+}
+
+void Logger::release(StagingBuffer* buffer) {
+    std::lock_guard<std::mutex> lock(buffers_mutex_);
+    buffers_.erase(std::remove(buffers_.begin(), buffers_.end(), buffer), buffers_.end());
+    {
+        std::lock_guard<std::mutex> buffer_lock(buffer->mutex);
+        writeStaged(*buffer);
+    }
+    delete buffer;
+}
+
+void Logger::stage(StagingBuffer& buffer, LogLevel level, const std::string& message) {
+    auto wall = std::chrono::system_clock::now();
+    auto now = std::chrono::steady_clock::now();
+
+    std::lock_guard<std::mutex> lock(buffer.mutex);
+    if (buffer.lines.empty()) {
+        buffer.first_staged = now;
+    }
+    appendLine(buffer.lines, wall, level, message);
+
+    if (level >= LogLevel::WARNING ||
+        buffer.lines.size() >= static_cast<size_t>(constants::LOG_STAGING_BUFFER_SIZE) ||
+        now - buffer.first_staged >= std::chrono::milliseconds(constants::LOG_FLUSH_INTERVAL)) {
+        writeStaged(buffer);
+    }
+}
+
+// Caller holds buffer.mutex, which keeps each thread's lines in order
+void Logger::writeStaged(StagingBuffer& buffer) {
+    if (buffer.lines.empty()) return;
+
     std::lock_guard<std::mutex> lock(log_mutex_);
     if (log_file_.is_open()) {
-        // Get current time
-        auto now = std::chrono::system_clock::now();
-        auto time = std::chrono::system_clock::to_time_t(now);
-        log_file_ << std::ctime(&time) << ": " << message << std::endl;
+        log_file_ << buffer.lines;
+        log_file_.flush();
     }
+    buffer.lines.clear();
 }
 
-} // namespace atc
+LogEvent::LogEvent(std::string name, LogLevel level)
+    : name_(std::move(name))
+    , level_(level)
+    , last_report_(std::chrono::steady_clock::now()) {
+    auto& registry = eventRegistry();
+    std::lock_guard<std::mutex> lock(registry.mutex);
+    registry.events.push_back(this);
+}
 
+LogEvent::~LogEvent() {
+    auto& registry = eventRegistry();
+    std::lock_guard<std::mutex> lock(registry.mutex);
+    registry.events.erase(std::remove(registry.events.begin(), registry.events.end(), this),
+                          registry.events.end());
+}
+
+} // namespace atc
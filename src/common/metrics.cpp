@@ -0,0 +1,213 @@
+#include "common/metrics.h"
+#include "common/logger.h"
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <fstream>
+
+namespace atc {
+namespace metrics {
+
+namespace {
+
+std::atomic<size_t> next_shard{0};
+
+std::string formatValue(double value) {
+    if (std::isnan(value)) return "NaN";
+    if (std::isinf(value)) return value > 0 ? "+Inf" : "-Inf";
+    char text[32];
+    std::snprintf(text, sizeof(text), "%.12g", value);
+    return text;
+}
+
+// HELP text escapes backslashes and newlines, label values quotes as well
+void appendEscaped(std::string& out, const std::string& text, bool quotes) {
+    for (char c : text) {
+        if (c == '\\') out += "\\\\";
+        else if (c == '\n') out += "\\n";
+        else if (c == '"' && quotes) out += "\\\"";
+        else out += c;
+    }
+}
+
+void appendHeader(std::string& out, const Metric& metric) {
+    out += "# HELP " + metric.getName() + " ";
+    appendEscaped(out, metric.getHelp(), false);
+    out += "\n# TYPE " + metric.getName() + " " + metric.type() + "\n";
+}
+
+// Lock-free add on a double: there is no fetch_add for atomic<double> before C++20
+void addTo(std::atomic<double>& total, double value) {
+    double current = total.load(std::memory_order_relaxed);
+    while (!total.compare_exchange_weak(current, current + value, std::memory_order_relaxed)) {
+    }
+}
+
+} // namespace
+
+size_t shardIndex() {
+    thread_local size_t index = next_shard.fetch_add(1, std::memory_order_relaxed) % SHARDS;
+    return index;
+}
+
+Metric::Metric(std::string name, std::string help, const Labels& labels)
+    : name_(std::move(name))
+    , help_(std::move(help)) {
+    for (const auto& label : labels) {
+        if (!labels_.empty()) labels_ += ',';
+        labels_ += label.first + "=\"";
+        appendEscaped(labels_, label.second, true);
+        labels_ += '"';
+    }
+    MetricsRegistry::getInstance().add(this);
+}
+
+Metric::~Metric() {
+    MetricsRegistry::getInstance().remove(this);
+}
+
+std::string Metric::series(const char* suffix, const std::string& extra) const {
+    std::string text = name_ + suffix;
+    if (!labels_.empty() || !extra.empty()) {
+        text += '{' + labels_ + (labels_.empty() || extra.empty() ? "" : ",") + extra + '}';
+    }
+    return text + ' ';
+}
+
+uint64_t Counter::count() const {
+    uint64_t total = 0;
+    for (const auto& shard : shards_) {
+        total += shard.value.load(std::memory_order_relaxed);
+    }
+    return total;
+}
+
+void Counter::expose(std::string& out) const {
+    out += series() + std::to_string(count()) + "\n";
+}
+
+void Gauge::expose(std::string& out) const {
+    out += series() + formatValue(value()) + "\n";
+}
+
+Histogram::Histogram(std::string name, std::string help, std::vector<double> bounds, const Labels& labels)
+    : Metric(std::move(name), std::move(help), labels)
+    , bounds_(std::move(bounds)) {
+    for (auto& shard : shards_) {
+        shard.buckets.reset(new std::atomic<uint64_t>[bounds_.size() + 1]);
+        for (size_t i = 0; i <= bounds_.size(); ++i) {
+            shard.buckets[i].store(0, std::memory_order_relaxed);
+        }
+    }
+}
+
+void Histogram::observe(double value) {
+    // First bucket whose upper bound holds the value, or +Inf
+    size_t bucket = std::lower_bound(bounds_.begin(), bounds_.end(), value) - bounds_.begin();
+    Shard& shard = shards_[shardIndex()];
+    shard.buckets[bucket].fetch_add(1, std::memory_order_relaxed);
+    addTo(shard.sum, value);
+}
+
+std::vector<uint64_t> Histogram::bucketCounts() const {
+    std::vector<uint64_t> counts(bounds_.size() + 1, 0);
+    for (const auto& shard : shards_) {
+        for (size_t i = 0; i < counts.size(); ++i) {
+            counts[i] += shard.buckets[i].load(std::memory_order_relaxed);
+        }
+    }
+    return counts;
+}
+
+double Histogram::sum() const {
+    double total = 0.0;
+    for (const auto& shard : shards_) {
+        total += shard.sum.load(std::memory_order_relaxed);
+    }
+    return total;
+}
+
+double Histogram::value() const {
+    uint64_t total = 0;
+    for (uint64_t count : bucketCounts()) {
+        total += count;
+    }
+    return static_cast<double>(total);
+}
+
+// The count is the sum of the buckets read, so +Inf and _count always agree
+void Histogram::expose(std::string& out) const {
+    auto counts = bucketCounts();
+    uint64_t cumulative = 0;
+    for (size_t i = 0; i < counts.size(); ++i) {
+        cumulative += counts[i];
+        std::string le = i < bounds_.size() ? formatValue(bounds_[i]) : "+Inf";
+        out += series("_bucket", "le=\"" + le + "\"") + std::to_string(cumulative) + "\n";
+    }
+    out += series("_sum") + formatValue(sum()) + "\n";
+    out += series("_count") + std::to_string(cumulative) + "\n";
+}
+
+std::vector<double> Histogram::latencyBounds() {
+    return {0.00001, 0.000025, 0.00005, 0.0001, 0.00025, 0.0005, 0.001, 0.0025,
+            0.005, 0.01, 0.025, 0.05, 0.1, 0.25, 0.5, 1.0, 2.5, 5.0, 10.0};
+}
+
+MetricsRegistry& MetricsRegistry::getInstance() {
+    static MetricsRegistry registry;
+    return registry;
+}
+
+void MetricsRegistry::add(Metric* metric) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    metrics_.push_back(metric);
+}
+
+void MetricsRegistry::remove(Metric* metric) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    metrics_.erase(std::remove(metrics_.begin(), metrics_.end(), metric), metrics_.end());
+}
+
+std::string MetricsRegistry::expose() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    std::vector<const Metric*> sorted(metrics_.begin(), metrics_.end());
+    std::sort(sorted.begin(), sorted.end(), [](const Metric* a, const Metric* b) {
+        return a->getName() != b->getName() ? a->getName() < b->getName() : a->getLabels() < b->getLabels();
+    });
+
+    // One HELP and TYPE per name, then every labelled series of it
+    std::string out;
+    for (size_t i = 0; i < sorted.size(); ++i) {
+        if (i == 0 || sorted[i]->getName() != sorted[i - 1]->getName()) {
+            appendHeader(out, *sorted[i]);
+        }
+        sorted[i]->expose(out);
+    }
+    return out;
+}
+
+bool MetricsRegistry::writeFile(const std::string& path) const {
+    std::string tmp_path = path + ".tmp";
+    std::ofstream out(tmp_path, std::ios::trunc);
+    out << expose();
+    out.close();
+    if (out.fail() || std::rename(tmp_path.c_str(), path.c_str()) != 0) {
+        ATC_LOG_ERROR("Failed to write metrics to " + path);
+        return false;
+    }
+    return true;
+}
+
+double MetricsRegistry::value(const std::string& name) const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    double total = 0.0;
+    for (const Metric* metric : metrics_) {
+        if (metric->getName() == name) {
+            total += metric->value();
+        }
+    }
+    return total;
+}
+
+} // namespace metrics
+} // namespace atc
@@ -0,0 +1,279 @@
+#include "common/perf_counters.h"
+#include "common/logger.h"
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+#include <cxxabi.h>
+#include <iomanip>
+#include <map>
+#include <mutex>
+#include <sstream>
+#include <vector>
+
+#ifdef __linux__
+#include <cerrno>
+#include <linux/perf_event.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+namespace atc {
+
+std::atomic<bool> PerfCounters::enabled_{false};
+
+namespace {
+
+struct KernelRegistry {
+    std::mutex mutex;
+    std::vector<PerfKernel*> kernels;
+    std::map<std::string, PerfKernel*> tasks;   // never freed, tasks come and go
+};
+
+KernelRegistry& kernelRegistry() {
+    static KernelRegistry registry;
+    return registry;
+}
+
+#ifdef __linux__
+
+constexpr uint64_t EVENTS[] = {
+    PERF_COUNT_HW_CPU_CYCLES,
+    PERF_COUNT_HW_INSTRUCTIONS,
+    PERF_COUNT_HW_CACHE_MISSES,
+    PERF_COUNT_HW_BRANCH_MISSES,
+};
+constexpr size_t EVENT_COUNT = sizeof(EVENTS) / sizeof(EVENTS[0]);
+
+// Layout of a PERF_FORMAT_GROUP read with both times
+struct GroupReading {
+    uint64_t nr;
+    uint64_t time_enabled;
+    uint64_t time_running;
+    uint64_t values[EVENT_COUNT];
+};
+
+// One counter group per thread, opened on the thread's first read. A forked
+// child's thread opens its own; the inherited group counts the parent.
+class ThreadCounters {
+public:
+    ~ThreadCounters() {
+        close();
+    }
+
+    bool read(PerfSample& sample) {
+        if (owner_ != ::getpid()) {
+            close();
+            owner_ = ::getpid();
+            open();
+        }
+        if (fds_[0] < 0) return false;
+
+        GroupReading reading;
+        if (::read(fds_[0], &reading, sizeof(reading)) != static_cast<ssize_t>(sizeof(reading)) ||
+            reading.nr != EVENT_COUNT) {
+            return false;
+        }
+        // The group shared the PMU with others for part of the time
+        double scale = reading.time_running > 0 && reading.time_running < reading.time_enabled
+                       ? static_cast<double>(reading.time_enabled) / reading.time_running : 1.0;
+        auto scaled = [scale](uint64_t value) { return static_cast<uint64_t>(value * scale); };
+        sample.cycles = scaled(reading.values[0]);
+        sample.instructions = scaled(reading.values[1]);
+        sample.cache_misses = scaled(reading.values[2]);
+        sample.branch_misses = scaled(reading.values[3]);
+        return true;
+    }
+
+    int error() const { return error_; }
+
+private:
+    void open() {
+        for (size_t i = 0; i < EVENT_COUNT; ++i) {
+            perf_event_attr attr;
+            std::memset(&attr, 0, sizeof(attr));
+            attr.size = sizeof(attr);
+            attr.type = PERF_TYPE_HARDWARE;
+            attr.config = EVENTS[i];
+            attr.exclude_kernel = 1;
+            attr.exclude_hv = 1;
+            attr.read_format = PERF_FORMAT_GROUP | PERF_FORMAT_TOTAL_TIME_ENABLED |
+                               PERF_FORMAT_TOTAL_TIME_RUNNING;
+            // This thread on any CPU, all events in the leader's group
+            int fd = static_cast<int>(::syscall(SYS_perf_event_open, &attr, 0, -1,
+                                                i == 0 ? -1 : fds_[0], PERF_FLAG_FD_CLOEXEC));
+            if (fd < 0) {
+                error_ = errno;
+                close();
+                return;
+            }
+            fds_[i] = fd;
+        }
+    }
+
+    void close() {
+        for (int& fd : fds_) {
+            if (fd >= 0) ::close(fd);
+            fd = -1;
+        }
+    }
+
+    pid_t owner_ = 0;
+    int error_ = 0;
+    int fds_[EVENT_COUNT] = {-1, -1, -1, -1};
+};
+
+ThreadCounters& threadCounters() {
+    thread_local ThreadCounters counters;
+    return counters;
+}
+
+#endif
+
+PerfSample difference(const PerfSample& end, const PerfSample& start) {
+    // A rescaled total can step back slightly; never report a negative count
+    auto delta = [](uint64_t a, uint64_t b) { return a > b ? a - b : 0; };
+    PerfSample sample;
+    sample.cycles = delta(end.cycles, start.cycles);
+    sample.instructions = delta(end.instructions, start.instructions);
+    sample.cache_misses = delta(end.cache_misses, start.cache_misses);
+    sample.branch_misses = delta(end.branch_misses, start.branch_misses);
+    return sample;
+}
+
+} // namespace
+
+bool PerfCounters::enable() {
+#ifdef __linux__
+    PerfSample sample;
+    if (!threadCounters().read(sample)) {
+        int error = threadCounters().error();
+        ATC_LOG_WARNING("Hardware counters unavailable: " + std::string(std::strerror(error)) +
+                        (error == EACCES || error == EPERM ? " (check /proc/sys/kernel/perf_event_paranoid)"
+                                                           : " (no hardware PMU events here)"));
+        return false;
+    }
+    enabled_ = true;
+    ATC_LOG_INFO("Hardware counter instrumentation enabled");
+    return true;
+#else
+    ATC_LOG_WARNING("Hardware counters are not supported on this platform");
+    return false;
+#endif
+}
+
+bool PerfCounters::read(PerfSample& sample) {
+#ifdef __linux__
+    return threadCounters().read(sample);
+#else
+    (void)sample;
+    return false;
+#endif
+}
+
+std::string PerfCounters::report() {
+    auto& registry = kernelRegistry();
+    std::lock_guard<std::mutex> lock(registry.mutex);
+    std::vector<PerfKernel*> kernels = registry.kernels;
+    std::sort(kernels.begin(), kernels.end(), [](const PerfKernel* a, const PerfKernel* b) {
+        return a->getScope() < b->getScope();
+    });
+
+    std::ostringstream oss;
+    oss << "\n=== Hardware Counters (per run) ===\n"
+        << std::left << std::setw(22) << "Scope" << std::right
+        << std::setw(10) << "Runs" << std::setw(14) << "Cycles" << std::setw(14) << "Instructions"
+        << std::setw(7) << "IPC" << std::setw(14) << "Cache Misses" << std::setw(15) << "Branch Misses" << "\n";
+    for (const PerfKernel* kernel : kernels) {
+        uint64_t runs = kernel->getRuns();
+        if (runs == 0) continue;
+        PerfSample totals = kernel->getTotals();
+        double ipc = totals.cycles > 0 ? static_cast<double>(totals.instructions) / totals.cycles : 0.0;
+        oss << std::left << std::setw(22) << kernel->getScope() << std::right
+            << std::setw(10) << runs
+            << std::setw(14) << totals.cycles / runs
+            << std::setw(14) << totals.instructions / runs
+            << std::setw(7) << std::fixed << std::setprecision(2) << ipc
+            << std::setw(14) << totals.cache_misses / runs
+            << std::setw(15) << totals.branch_misses / runs << "\n";
+    }
+    oss << "===================================\n";
+    return oss.str();
+}
+
+PerfKernel::PerfKernel(const std::string& scope)
+    : scope_(scope)
+    , runs_("atc_perf_runs_total", "Measured runs of an instrumented scope", {{"scope", scope}})
+    , cycles_("atc_perf_cycles_total", "CPU cycles spent in an instrumented scope", {{"scope", scope}})
+    , instructions_("atc_perf_instructions_total", "Instructions retired in an instrumented scope",
+                    {{"scope", scope}})
+    , cache_misses_("atc_perf_cache_misses_total", "Last-level cache misses in an instrumented scope",
+                    {{"scope", scope}})
+    , branch_misses_("atc_perf_branch_misses_total", "Mispredicted branches in an instrumented scope",
+                     {{"scope", scope}}) {
+    auto& registry = kernelRegistry();
+    std::lock_guard<std::mutex> lock(registry.mutex);
+    registry.kernels.push_back(this);
+}
+
+PerfKernel::~PerfKernel() {
+    auto& registry = kernelRegistry();
+    std::lock_guard<std::mutex> lock(registry.mutex);
+    registry.kernels.erase(std::remove(registry.kernels.begin(), registry.kernels.end(), this),
+                           registry.kernels.end());
+}
+
+PerfKernel& PerfKernel::forTask(const std::type_info& type) {
+    int status = 0;
+    char* demangled = abi::__cxa_demangle(type.name(), nullptr, nullptr, &status);
+    std::string scope = status == 0 && demangled ? demangled : type.name();
+    std::free(demangled);
+    if (scope.compare(0, 5, "atc::") == 0) {
+        scope.erase(0, 5);
+    }
+
+    auto& registry = kernelRegistry();
+    {
+        std::lock_guard<std::mutex> lock(registry.mutex);
+        auto it = registry.tasks.find(scope);
+        if (it != registry.tasks.end()) {
+            return *it->second;
+        }
+    }
+    // The constructor and destructor take the registry lock themselves
+    auto kernel = new PerfKernel(scope);
+    PerfKernel* shared;
+    {
+        std::lock_guard<std::mutex> lock(registry.mutex);
+        shared = registry.tasks.emplace(scope, kernel).first->second;
+    }
+    if (shared != kernel) {
+        delete kernel;   // another thread got there first
+    }
+    return *shared;
+}
+
+void PerfKernel::add(const PerfSample& delta) {
+    runs_.increment();
+    cycles_.increment(delta.cycles);
+    instructions_.increment(delta.instructions);
+    cache_misses_.increment(delta.cache_misses);
+    branch_misses_.increment(delta.branch_misses);
+}
+
+PerfSample PerfKernel::getTotals() const {
+    PerfSample totals;
+    totals.cycles = cycles_.count();
+    totals.instructions = instructions_.count();
+    totals.cache_misses = cache_misses_.count();
+    totals.branch_misses = branch_misses_.count();
+    return totals;
+}
+
+PerfScope::~PerfScope() {
+    PerfSample end;
+    if (kernel_ && PerfCounters::read(end)) {
+        kernel_->add(difference(end, start_));
+    }
+}
+
+}
@@ -0,0 +1,179 @@
+#include "common/process_supervisor.h"
+#include "common/constants.h"
+#include "common/logger.h"
+#include <cerrno>
+#include <csignal>
+#include <cstring>
+#include <sys/wait.h>
+#include <thread>
+#include <unistd.h>
+
+namespace atc {
+
+namespace {
+
+std::string describeExit(int status) {
+    if (WIFSIGNALED(status)) {
+        return "killed by signal " + std::to_string(WTERMSIG(status));
+    }
+    return "exited with status " + std::to_string(WEXITSTATUS(status));
+}
+
+}
+
+ProcessSupervisor::ProcessSupervisor(std::chrono::milliseconds restart_delay, int max_restarts)
+    : restart_delay_(restart_delay)
+    , max_restarts_(max_restarts) {
+}
+
+ProcessSupervisor::ProcessSupervisor()
+    : ProcessSupervisor(std::chrono::milliseconds(constants::SUPERVISOR_RESTART_DELAY),
+                        constants::SUPERVISOR_MAX_RESTARTS) {
+}
+
+ProcessSupervisor::~ProcessSupervisor() {
+    stop();
+}
+
+void ProcessSupervisor::addProcess(const std::string& name, Entry entry, bool critical) {
+    Process process;
+    process.name = name;
+    process.entry = std::move(entry);
+    process.critical = critical;
+    processes_.push_back(std::move(process));
+}
+
+bool ProcessSupervisor::start() {
+    for (auto& process : processes_) {
+        if (!launch(process)) {
+            stop();
+            return false;
+        }
+    }
+    return true;
+}
+
+bool ProcessSupervisor::launch(Process& process) {
+    // Anything staged now would otherwise be written once by each child as well
+    Logger::getInstance().flushAll();
+
+    pid_t pid = ::fork();
+    if (pid < 0) {
+        ATC_LOG_ERROR("Failed to start process " + process.name + ": " + std::strerror(errno));
+        return false;
+    }
+    if (pid == 0) {
+        int status = process.entry();
+        Logger::getInstance().flushAll();
+        ::_exit(status);
+    }
+
+    process.pid = pid;
+    process.restart_pending = false;
+    ATC_LOG_INFO("Started process " + process.name + " (pid " + std::to_string(pid) + ")");
+    return true;
+}
+
+void ProcessSupervisor::handleExit(Process& process, int status) {
+    process.pid = -1;
+    if (process.critical) {
+        ATC_LOG_ERROR("Critical process " + process.name + " " + describeExit(status) +
+                      " - stopping the deployment");
+        critical_failed_ = true;
+        return;
+    }
+    if (process.restarts >= max_restarts_) {
+        ATC_LOG_ERROR("Process " + process.name + " " + describeExit(status) + " after " +
+                      std::to_string(process.restarts) + " restarts - leaving it down");
+        return;
+    }
+    ATC_LOG_WARNING("Process " + process.name + " " + describeExit(status) + " - restarting");
+    process.restart_pending = true;
+    process.restart_at = std::chrono::steady_clock::now() + restart_delay_;
+}
+
+bool ProcessSupervisor::poll() {
+    int status;
+    pid_t pid;
+    while ((pid = ::waitpid(-1, &status, WNOHANG)) > 0) {
+        for (auto& process : processes_) {
+            if (process.pid == pid) {
+                handleExit(process, status);
+                break;
+            }
+        }
+    }
+    if (critical_failed_) {
+        return false;
+    }
+
+    auto now = std::chrono::steady_clock::now();
+    for (auto& process : processes_) {
+        if (process.restart_pending && now >= process.restart_at) {
+            ++process.restarts;
+            if (!launch(process)) {
+                process.restart_pending = true;
+                process.restart_at = now + restart_delay_;
+            }
+        }
+    }
+    return true;
+}
+
+int ProcessSupervisor::run(const std::atomic<bool>& running) {
+    bool healthy = true;
+    while (running && (healthy = poll())) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(100));
+    }
+    stop();
+    return healthy ? 0 : 1;
+}
+
+void ProcessSupervisor::stop() {
+    for (auto& process : processes_) {
+        process.restart_pending = false;
+        if (process.pid > 0) {
+            ::kill(process.pid, SIGTERM);
+        }
+    }
+
+    auto deadline = std::chrono::steady_clock::now() +
+                    std::chrono::milliseconds(constants::SUPERVISOR_STOP_TIMEOUT);
+    for (auto& process : processes_) {
+        while (process.pid > 0) {
+            int status;
+            pid_t result = ::waitpid(process.pid, &status, WNOHANG);
+            if (result == process.pid || (result < 0 && errno == ECHILD)) {
+                process.pid = -1;
+            } else if (std::chrono::steady_clock::now() >= deadline) {
+                ATC_LOG_WARNING("Process " + process.name + " ignored SIGTERM - killing it");
+                ::kill(process.pid, SIGKILL);
+                ::waitpid(process.pid, &status, 0);
+                process.pid = -1;
+            } else {
+                std::this_thread::sleep_for(std::chrono::milliseconds(10));
+            }
+        }
+    }
+}
+
+pid_t ProcessSupervisor::getPid(const std::string& name) const {
+    const Process* process = find(name);
+    return process ? process->pid : -1;
+}
+
+int ProcessSupervisor::getRestartCount(const std::string& name) const {
+    const Process* process = find(name);
+    return process ? process->restarts : 0;
+}
+
+const ProcessSupervisor::Process* ProcessSupervisor::find(const std::string& name) const {
+    for (const auto& process : processes_) {
+        if (process.name == name) {
+            return &process;
+        }
+    }
+    return nullptr;
+}
+
+}
@@ -0,0 +1,219 @@
+#include "common/snapshot_delta.h"
+#include <algorithm>
+#include <cstring>
+
+namespace atc {
+
+namespace {
+
+constexpr char SNAPSHOT_MAGIC[4] = {'A', 'T', 'C', 'S'};
+constexpr uint8_t SNAPSHOT_VERSION = 1;
+constexpr uint8_t FRAME_KEY = 0x01;
+constexpr size_t HEADER_SIZE = 40;
+constexpr size_t TRACK_FIELDS_SIZE = 5 * sizeof(float) + 2;
+constexpr size_t MAX_CALLSIGN = 255;
+
+// Frames are little-endian, which is also the byte order of every target
+template <typename T>
+void put(std::string& out, T value) {
+    out.append(reinterpret_cast<const char*>(&value), sizeof(value));
+}
+
+void putCallsign(std::string& out, const std::string& callsign) {
+    size_t length = std::min(callsign.size(), MAX_CALLSIGN);
+    out.push_back(static_cast<char>(length));
+    out.append(callsign, 0, length);
+}
+
+void putTrack(std::string& out, const SnapshotTrack& track) {
+    putCallsign(out, track.callsign);
+    put(out, track.x);
+    put(out, track.y);
+    put(out, track.z);
+    put(out, track.heading);
+    put(out, track.speed);
+    put(out, track.status);
+    put(out, track.flags);
+}
+
+class FrameReader {
+public:
+    FrameReader(const char* data, size_t size) : data_(data), size_(size) {}
+
+    template <typename T>
+    bool get(T& value) {
+        if (size_ - offset_ < sizeof(T)) return false;
+        std::memcpy(&value, data_ + offset_, sizeof(T));
+        offset_ += sizeof(T);
+        return true;
+    }
+
+    bool getCallsign(std::string& callsign) {
+        uint8_t length;
+        if (!get(length) || size_ - offset_ < length) return false;
+        callsign.assign(data_ + offset_, length);
+        offset_ += length;
+        return true;
+    }
+
+    bool getTrack(SnapshotTrack& track) {
+        return getCallsign(track.callsign) && size_ - offset_ >= TRACK_FIELDS_SIZE &&
+               get(track.x) && get(track.y) && get(track.z) && get(track.heading) &&
+               get(track.speed) && get(track.status) && get(track.flags);
+    }
+
+    bool atEnd() const { return offset_ == size_; }
+
+private:
+    const char* data_;
+    size_t size_;
+    size_t offset_ = 0;
+};
+
+bool byCallsign(const SnapshotTrack& a, const SnapshotTrack& b) {
+    return a.callsign < b.callsign;
+}
+
+} // namespace
+
+Snapshot makeSnapshot(const std::vector<AircraftState>& states, uint64_t sequence,
+                      int64_t timestamp_ms) {
+    Snapshot snapshot;
+    snapshot.sequence = sequence;
+    snapshot.timestamp_ms = timestamp_ms;
+    snapshot.tracks.reserve(states.size());
+    for (const auto& state : states) {
+        snapshot.tracks.push_back({
+            state.callsign,
+            static_cast<float>(state.position.x),
+            static_cast<float>(state.position.y),
+            static_cast<float>(state.position.z),
+            static_cast<float>(state.heading),
+            static_cast<float>(state.getSpeed()),
+            static_cast<uint8_t>(state.status),
+            0
+        });
+    }
+    std::sort(snapshot.tracks.begin(), snapshot.tracks.end(), byCallsign);
+    return snapshot;
+}
+
+void encodeSnapshotDelta(const Snapshot* base, const Snapshot& current, std::string& out) {
+    static const std::vector<SnapshotTrack> empty;
+    const auto& previous = base ? base->tracks : empty;
+
+    out.clear();
+    out.append(SNAPSHOT_MAGIC, sizeof(SNAPSHOT_MAGIC));
+    put(out, SNAPSHOT_VERSION);
+    put(out, static_cast<uint8_t>(base ? 0 : FRAME_KEY));
+    put(out, static_cast<uint16_t>(0));
+    put(out, current.sequence);
+    put(out, static_cast<uint64_t>(base ? base->sequence : 0));
+    put(out, current.timestamp_ms);
+    size_t counts_offset = out.size();
+    put(out, static_cast<uint32_t>(0));
+    put(out, static_cast<uint32_t>(0));
+
+    // Both track lists are sorted, so one merge pass finds changes and removals
+    uint32_t upserts = 0;
+    std::vector<const std::string*> removed;
+    auto old_it = previous.begin();
+    for (const auto& track : current.tracks) {
+        while (old_it != previous.end() && old_it->callsign < track.callsign) {
+            removed.push_back(&old_it->callsign);
+            ++old_it;
+        }
+        bool unchanged = old_it != previous.end() && old_it->callsign == track.callsign &&
+                         *old_it == track;
+        if (old_it != previous.end() && old_it->callsign == track.callsign) {
+            ++old_it;
+        }
+        if (!unchanged) {
+            putTrack(out, track);
+            ++upserts;
+        }
+    }
+    for (; old_it != previous.end(); ++old_it) {
+        removed.push_back(&old_it->callsign);
+    }
+    for (const std::string* callsign : removed) {
+        putCallsign(out, *callsign);
+    }
+
+    auto removals = static_cast<uint32_t>(removed.size());
+    std::memcpy(&out[counts_offset], &upserts, sizeof(upserts));
+    std::memcpy(&out[counts_offset + sizeof(upserts)], &removals, sizeof(removals));
+}
+
+bool applySnapshotDelta(Snapshot& state, const char* data, size_t size) {
+    if (size < HEADER_SIZE || std::memcmp(data, SNAPSHOT_MAGIC, sizeof(SNAPSHOT_MAGIC)) != 0) {
+        return false;
+    }
+
+    FrameReader reader(data + sizeof(SNAPSHOT_MAGIC), size - sizeof(SNAPSHOT_MAGIC));
+    uint8_t version, frame_flags;
+    uint16_t reserved;
+    uint64_t sequence, base_sequence;
+    int64_t timestamp_ms;
+    uint32_t upsert_count, removal_count;
+    reader.get(version);
+    reader.get(frame_flags);
+    reader.get(reserved);
+    reader.get(sequence);
+    reader.get(base_sequence);
+    reader.get(timestamp_ms);
+    reader.get(upsert_count);
+    reader.get(removal_count);
+
+    bool key = (frame_flags & FRAME_KEY) != 0;
+    if (version != SNAPSHOT_VERSION || (!key && base_sequence != state.sequence)) {
+        return false;
+    }
+
+    std::vector<SnapshotTrack> upserts(upsert_count);
+    for (auto& track : upserts) {
+        if (!reader.getTrack(track)) return false;
+    }
+    std::vector<std::string> removals(removal_count);
+    for (auto& callsign : removals) {
+        if (!reader.getCallsign(callsign)) return false;
+    }
+    if (!reader.atEnd() ||
+        !std::is_sorted(upserts.begin(), upserts.end(), byCallsign) ||
+        !std::is_sorted(removals.begin(), removals.end())) {
+        return false;
+    }
+
+    // Merge the sorted changes into the sorted track list
+    std::vector<SnapshotTrack> merged;
+    merged.reserve(state.tracks.size() + upserts.size());
+    static const std::vector<SnapshotTrack> empty;
+    const auto& previous = key ? empty : state.tracks;
+    auto old_it = previous.begin();
+    auto up_it = upserts.begin();
+    auto rm_it = removals.begin();
+    while (old_it != previous.end() || up_it != upserts.end()) {
+        if (up_it != upserts.end() &&
+            (old_it == previous.end() || up_it->callsign <= old_it->callsign)) {
+            if (old_it != previous.end() && old_it->callsign == up_it->callsign) {
+                ++old_it;
+            }
+            merged.push_back(std::move(*up_it++));
+            continue;
+        }
+        while (rm_it != removals.end() && *rm_it < old_it->callsign) {
+            ++rm_it;
+        }
+        if (rm_it == removals.end() || *rm_it != old_it->callsign) {
+            merged.push_back(*old_it);
+        }
+        ++old_it;
+    }
+
+    state.sequence = sequence;
+    state.timestamp_ms = timestamp_ms;
+    state.tracks = std::move(merged);
+    return true;
+}
+
+}
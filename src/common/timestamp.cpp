@@ -0,0 +1,100 @@
+#include "common/timestamp.h"
+#include <cstdint>
+#include <cstring>
+#include <ctime>
+
+namespace atc {
+namespace timestamp {
+
+namespace {
+
+// "00".."99" for two digits per lookup
+constexpr char DIGIT_PAIRS[] =
+    "00010203040506070809"
+    "10111213141516171819"
+    "20212223242526272829"
+    "30313233343536373839"
+    "40414243444546474849"
+    "50515253545556575859"
+    "60616263646566676869"
+    "70717273747576777879"
+    "80818283848586878889"
+    "90919293949596979899";
+
+struct SecondCache {
+    int64_t second = INT64_MIN;
+    char text[SECONDS_LENGTH];
+};
+
+thread_local SecondCache cache;
+
+void writePair(char* out, int value) {
+    std::memcpy(out, DIGIT_PAIRS + 2 * value, 2);
+}
+
+void formatSecond(int64_t second, char* out) {
+    std::time_t time = static_cast<std::time_t>(second);
+    std::tm tm;
+    localtime_r(&time, &tm);
+
+    int year = tm.tm_year + 1900;
+    writePair(out, (year / 100) % 100);
+    writePair(out + 2, year % 100);
+    out[4] = '-';
+    writePair(out + 5, tm.tm_mon + 1);
+    out[7] = '-';
+    writePair(out + 8, tm.tm_mday);
+    out[10] = ' ';
+    writePair(out + 11, tm.tm_hour);
+    out[13] = ':';
+    writePair(out + 14, tm.tm_min);
+    out[16] = ':';
+    writePair(out + 17, tm.tm_sec);
+}
+
+} // namespace
+
+size_t format(std::chrono::system_clock::time_point time, char* out, bool micros) {
+    int64_t total = std::chrono::duration_cast<std::chrono::microseconds>(
+        time.time_since_epoch()).count();
+    int64_t second = total / 1000000;
+    int64_t fraction = total % 1000000;
+    if (fraction < 0) {
+        fraction += 1000000;
+        --second;
+    }
+
+    if (cache.second != second) {
+        formatSecond(second, cache.text);
+        cache.second = second;
+    }
+    std::memcpy(out, cache.text, SECONDS_LENGTH);
+    if (!micros) {
+        return SECONDS_LENGTH;
+    }
+
+    int value = static_cast<int>(fraction);
+    out[SECONDS_LENGTH] = '.';
+    writePair(out + SECONDS_LENGTH + 1, value / 10000);
+    writePair(out + SECONDS_LENGTH + 3, (value / 100) % 100);
+    writePair(out + SECONDS_LENGTH + 5, value % 100);
+    return MICROS_LENGTH;
+}
+
+std::string format(std::chrono::system_clock::time_point time, bool micros) {
+    char buffer[MICROS_LENGTH];
+    return std::string(buffer, format(time, buffer, micros));
+}
+
+std::string now(bool micros) {
+    return format(std::chrono::system_clock::now(), micros);
+}
+
+std::chrono::system_clock::time_point toSystem(std::chrono::steady_clock::time_point time) {
+    auto age = std::chrono::steady_clock::now() - time;
+    return std::chrono::system_clock::now() -
+           std::chrono::duration_cast<std::chrono::system_clock::duration>(age);
+}
+
+}
+} // namespace atc
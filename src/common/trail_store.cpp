@@ -0,0 +1,209 @@
+#include "common/trail_store.h"
+#include "common/constants.h"
+#include "common/logger.h"
+#include <algorithm>
+#include <cmath>
+#include <functional>
+
+namespace atc {
+
+TrailStore::TrailStore(size_t max_tracks, size_t length, int sample_interval_ms)
+    : length_(std::max<size_t>(length, 1))
+    , sample_interval_ms_(sample_interval_ms)
+    , x_(max_tracks * length_)
+    , y_(max_tracks * length_)
+    , z_(max_tracks * length_)
+    , t_(max_tracks * length_)
+    , slot_info_(max_tracks) {
+
+    free_slots_.reserve(max_tracks);
+    for (size_t slot = max_tracks; slot > 0; --slot) {
+        free_slots_.push_back(static_cast<uint32_t>(slot - 1));
+    }
+    size_t buckets = 2;
+    while (buckets < 2 * max_tracks) {
+        buckets *= 2;
+    }
+    table_.assign(buckets, NO_SLOT);
+}
+
+TrailStore::TrailStore()
+    : TrailStore(static_cast<size_t>(constants::TRAIL_MAX_TRACKS),
+                 static_cast<size_t>(constants::TRAIL_LENGTH),
+                 constants::TRAIL_SAMPLE_INTERVAL) {
+}
+
+size_t TrailStore::index(uint32_t slot, uint32_t offset) const {
+    return static_cast<size_t>(slot) * length_ + offset;
+}
+
+uint32_t TrailStore::findSlot(const std::string& callsign, size_t hash) const {
+    size_t mask = table_.size() - 1;
+    for (size_t bucket = hash & mask; table_[bucket] != NO_SLOT; bucket = (bucket + 1) & mask) {
+        const Slot& info = slot_info_[table_[bucket]];
+        if (info.hash == hash && info.callsign == callsign) {
+            return table_[bucket];
+        }
+    }
+    return NO_SLOT;
+}
+
+void TrailStore::insertSlot(uint32_t slot) {
+    size_t mask = table_.size() - 1;
+    size_t bucket = slot_info_[slot].hash & mask;
+    while (table_[bucket] != NO_SLOT) {
+        bucket = (bucket + 1) & mask;
+    }
+    table_[bucket] = slot;
+}
+
+void TrailStore::eraseSlot(uint32_t slot) {
+    size_t mask = table_.size() - 1;
+    size_t hole = slot_info_[slot].hash & mask;
+    while (table_[hole] != slot) {
+        hole = (hole + 1) & mask;
+    }
+    // Shift later entries of the probe run back so none is cut off from its home bucket
+    for (size_t bucket = (hole + 1) & mask; table_[bucket] != NO_SLOT; bucket = (bucket + 1) & mask) {
+        size_t home = slot_info_[table_[bucket]].hash & mask;
+        if (((bucket - home) & mask) >= ((bucket - hole) & mask)) {
+            table_[hole] = table_[bucket];
+            hole = bucket;
+        }
+    }
+    table_[hole] = NO_SLOT;
+}
+
+void TrailStore::update(const std::vector<AircraftState>& states) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    ++generation_;
+
+    for (const auto& state : states) {
+        size_t hash = std::hash<std::string>()(state.callsign);
+        uint32_t slot = findSlot(state.callsign, hash);
+        if (slot == NO_SLOT) {
+            if (free_slots_.empty()) {
+                if (dropped_++ == 0) {
+                    ATC_LOG_WARNING("Trail store full; not tracking " + state.callsign);
+                }
+                continue;
+            }
+            slot = free_slots_.back();
+            free_slots_.pop_back();
+            Slot& info = slot_info_[slot];
+            info.head = 0;
+            info.count = 0;
+            info.used = true;
+            info.hash = hash;
+            info.callsign.assign(state.callsign);
+            insertSlot(slot);
+            ++track_count_;
+        }
+
+        Slot& info = slot_info_[slot];
+        info.seen = generation_;
+
+        auto timestamp = static_cast<int64_t>(state.timestamp);
+        if (info.count > 0) {
+            uint32_t newest = (info.head + static_cast<uint32_t>(length_) - 1) % length_;
+            if (timestamp - t_[index(slot, newest)] < sample_interval_ms_) {
+                continue;
+            }
+        }
+
+        size_t i = index(slot, info.head);
+        x_[i] = state.position.x;
+        y_[i] = state.position.y;
+        z_[i] = state.position.z;
+        t_[i] = timestamp;
+        info.head = (info.head + 1) % length_;
+        info.count = std::min<uint32_t>(info.count + 1, static_cast<uint32_t>(length_));
+    }
+
+    // Tracks absent from this pass have left the airspace
+    for (uint32_t slot = 0; slot < slot_info_.size(); ++slot) {
+        Slot& info = slot_info_[slot];
+        if (info.used && info.seen != generation_) {
+            eraseSlot(slot);
+            info.used = false;
+            free_slots_.push_back(slot);
+            --track_count_;
+        }
+    }
+}
+
+void TrailStore::copySlot(uint32_t slot, std::vector<TrailPoint>& out) const {
+    const Slot& info = slot_info_[slot];
+    uint32_t first = (info.head + static_cast<uint32_t>(length_) - info.count) % length_;
+    out.clear();
+    for (uint32_t n = 0; n < info.count; ++n) {
+        size_t i = index(slot, (first + n) % length_);
+        out.push_back({x_[i], y_[i], z_[i], t_[i]});
+    }
+}
+
+size_t TrailStore::copyTrail(const std::string& callsign, std::vector<TrailPoint>& out) const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    uint32_t slot = findSlot(callsign, std::hash<std::string>()(callsign));
+    if (slot == NO_SLOT) {
+        out.clear();
+        return 0;
+    }
+    copySlot(slot, out);
+    return out.size();
+}
+
+bool TrailStore::smoothness(const std::string& callsign, TrailSmoothness& out) const {
+    std::vector<TrailPoint> points;
+    if (copyTrail(callsign, points) < 3) {
+        return false;
+    }
+
+    out = TrailSmoothness();
+    out.samples = points.size();
+    double turn_sum = 0.0;
+    double accel_sum = 0.0;
+    size_t legs = 0;
+
+    for (size_t i = 2; i < points.size(); ++i) {
+        const TrailPoint& a = points[i - 2];
+        const TrailPoint& b = points[i - 1];
+        const TrailPoint& c = points[i];
+        double dt1 = (b.timestamp_ms - a.timestamp_ms) / 1000.0;
+        double dt2 = (c.timestamp_ms - b.timestamp_ms) / 1000.0;
+        if (dt1 <= 0.0 || dt2 <= 0.0) continue;
+
+        double heading1 = std::atan2(b.y - a.y, b.x - a.x);
+        double heading2 = std::atan2(c.y - b.y, c.x - b.x);
+        double turn = std::abs(heading2 - heading1) * 180.0 / M_PI;
+        if (turn > 180.0) turn = 360.0 - turn;
+
+        // Change of velocity between the two legs
+        double ax = ((c.x - b.x) / dt2 - (b.x - a.x) / dt1) / ((dt1 + dt2) / 2.0);
+        double ay = ((c.y - b.y) / dt2 - (b.y - a.y) / dt1) / ((dt1 + dt2) / 2.0);
+        double az = ((c.z - b.z) / dt2 - (b.z - a.z) / dt1) / ((dt1 + dt2) / 2.0);
+
+        turn_sum += turn;
+        out.max_turn = std::max(out.max_turn, turn);
+        accel_sum += ax * ax + ay * ay + az * az;
+        ++legs;
+    }
+
+    if (legs > 0) {
+        out.mean_turn = turn_sum / legs;
+        out.rms_acceleration = std::sqrt(accel_sum / legs);
+    }
+    return true;
+}
+
+size_t TrailStore::getTrackCount() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return track_count_;
+}
+
+uint64_t TrailStore::getDroppedCount() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return dropped_;
+}
+
+}
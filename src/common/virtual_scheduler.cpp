@@ -0,0 +1,48 @@
+#include "common/virtual_scheduler.h"
+#include "common/sim_clock.h"
+#include <algorithm>
+#include <thread>
+
+namespace atc {
+
+VirtualScheduler::VirtualScheduler(bool paced) : paced_(paced) {}
+
+void VirtualScheduler::addPeriodic(std::chrono::milliseconds first, Action action, Period period) {
+    events_.push_back({std::move(action), std::move(period)});
+    queue_.push({first, events_.size() - 1});
+}
+
+void VirtualScheduler::addTask(const std::shared_ptr<PeriodicTask>& task) {
+    task->startScheduled();
+    addPeriodic(now_, [task] { return task->runOnce(); },
+                [task] { return task->getPeriod(); });
+}
+
+bool VirtualScheduler::runUntil(std::chrono::milliseconds until, const std::atomic<bool>& running) {
+    if (!started_) {
+        wall_start_ = std::chrono::steady_clock::now();
+        started_ = true;
+    }
+
+    while (!queue_.empty() && queue_.top().at <= until) {
+        Due due = queue_.top();
+        if (due.at != now_) {
+            if (!running) return false;
+            if (paced_) {
+                std::this_thread::sleep_until(wall_start_ + due.at);
+            }
+            now_ = due.at;
+            sim_clock::setElapsed(now_);
+        }
+        queue_.pop();
+
+        Event& event = events_[due.event];
+        if (!event.action()) continue;
+        // Never schedule into the past, even for a zero period
+        auto period = std::max(event.period(), std::chrono::milliseconds(1));
+        queue_.push({now_ + period, due.event});
+    }
+    return true;
+}
+
+}
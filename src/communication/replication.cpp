@@ -0,0 +1,344 @@
+#include "communication/replication.h"
+#include "common/constants.h"
+#include "common/logger.h"
+#include <algorithm>
+#include <cstring>
+
+namespace atc {
+namespace comm {
+
+namespace {
+
+LogEvent over_budget("replication cycles over budget", LogLevel::WARNING);
+LogEvent rejected_records("replication records rejected while out of sync", LogLevel::WARNING);
+
+constexpr uint8_t DELTA_KEY = 0x01;
+constexpr size_t MAX_STRING = 255;
+constexpr size_t STATE_FIELDS_SIZE = 8 * sizeof(double) + 1;
+constexpr auto RECONNECT_INTERVAL = std::chrono::seconds(1);
+
+template <typename T>
+void put(std::string& out, T value) {
+    out.append(reinterpret_cast<const char*>(&value), sizeof(value));
+}
+
+void putString(std::string& out, const std::string& value) {
+    size_t length = std::min(value.size(), MAX_STRING);
+    out.push_back(static_cast<char>(length));
+    out.append(value, 0, length);
+}
+
+void putState(std::string& out, const AircraftState& state) {
+    putString(out, state.callsign);
+    put(out, state.position.x);
+    put(out, state.position.y);
+    put(out, state.position.z);
+    put(out, state.velocity.vx);
+    put(out, state.velocity.vy);
+    put(out, state.velocity.vz);
+    put(out, state.heading);
+    put(out, static_cast<uint8_t>(state.status));
+    put(out, state.timestamp);
+}
+
+bool sameState(const AircraftState& a, const AircraftState& b) {
+    return a.position.x == b.position.x && a.position.y == b.position.y &&
+           a.position.z == b.position.z && a.velocity.vx == b.velocity.vx &&
+           a.velocity.vy == b.velocity.vy && a.velocity.vz == b.velocity.vz &&
+           a.heading == b.heading && a.status == b.status && a.timestamp == b.timestamp;
+}
+
+class RecordReader {
+public:
+    explicit RecordReader(const std::string& record) : data_(record.data()), size_(record.size()) {}
+
+    template <typename T>
+    bool get(T& value) {
+        if (size_ - offset_ < sizeof(T)) return false;
+        std::memcpy(&value, data_ + offset_, sizeof(T));
+        offset_ += sizeof(T);
+        return true;
+    }
+
+    bool getString(std::string& value) {
+        uint8_t length;
+        if (!get(length) || size_ - offset_ < length) return false;
+        value.assign(data_ + offset_, length);
+        offset_ += length;
+        return true;
+    }
+
+    bool getState(AircraftState& state) {
+        uint8_t status = 0;
+        if (!getString(state.callsign) || size_ - offset_ < STATE_FIELDS_SIZE) return false;
+        get(state.position.x);
+        get(state.position.y);
+        get(state.position.z);
+        get(state.velocity.vx);
+        get(state.velocity.vy);
+        get(state.velocity.vz);
+        get(state.heading);
+        get(status);
+        get(state.timestamp);
+        if (status > static_cast<uint8_t>(AircraftStatus::EMERGENCY)) return false;
+        state.status = static_cast<AircraftStatus>(status);
+        return true;
+    }
+
+    bool atEnd() const { return offset_ == size_; }
+
+private:
+    const char* data_;
+    size_t size_;
+    size_t offset_ = 0;
+};
+
+}
+
+ReplicationWriter::ReplicationWriter(const std::string& ring_name, int key_frame_interval,
+                                     std::chrono::microseconds cycle_budget)
+    : ring_name_(ring_name)
+    , key_frame_interval_(key_frame_interval)
+    , cycle_budget_(cycle_budget) {
+}
+
+ReplicationWriter::ReplicationWriter(const std::string& ring_name)
+    : ReplicationWriter(ring_name, constants::REPLICATION_KEY_FRAME_INTERVAL,
+                        std::chrono::microseconds(constants::REPLICATION_CYCLE_BUDGET)) {
+}
+
+bool ReplicationWriter::connect() {
+    if (ring_) return true;
+
+    // Standby not running yet: retry now and then rather than every cycle
+    auto now = std::chrono::steady_clock::now();
+    if (now - last_connect_attempt_ < RECONNECT_INTERVAL) return false;
+    last_connect_attempt_ = now;
+
+    auto ring = std::make_unique<ShmRing>(ring_name_);
+    if (!ring->open()) return false;
+    ring_ = std::move(ring);
+    force_key_ = true;
+    consecutive_drops_ = 0;
+    ATC_LOG_INFO("Replication stream connected to standby via " + ring_name_);
+    return true;
+}
+
+void ReplicationWriter::appendStates(const std::vector<AircraftState>& states) {
+    auto start = std::chrono::steady_clock::now();
+    if (!connect()) return;
+
+    // Only tracks that changed since the last delta are sent, except in key frames
+    ++cycle_;
+    bool key = force_key_ || frames_since_key_ + 1 >= key_frame_interval_;
+    frame_.clear();
+    put(frame_, static_cast<uint8_t>(ReplicationKind::STATE_DELTA));
+    put(frame_, static_cast<uint8_t>(key ? DELTA_KEY : 0));
+    put(frame_, sequence_ + 1);
+    put(frame_, sequence_);
+    size_t counts_offset = frame_.size();
+    put(frame_, static_cast<uint32_t>(0));
+    put(frame_, static_cast<uint32_t>(0));
+
+    uint32_t upserts = 0;
+    for (const auto& state : states) {
+        auto it = sent_.find(state.callsign);
+        bool changed = key;
+        if (it == sent_.end()) {
+            it = sent_.emplace(state.callsign, SentState{state, cycle_}).first;
+            changed = true;
+        } else {
+            changed = changed || !sameState(it->second.state, state);
+            it->second.state = state;
+            it->second.cycle = cycle_;
+        }
+        if (changed) {
+            putState(frame_, state);
+            ++upserts;
+        }
+    }
+
+    // Tracks not in this batch have left; a key frame implies their removal
+    uint32_t removals = 0;
+    for (auto it = sent_.begin(); it != sent_.end();) {
+        if (it->second.cycle == cycle_) {
+            ++it;
+            continue;
+        }
+        if (!key) {
+            putString(frame_, it->first);
+            ++removals;
+        }
+        it = sent_.erase(it);
+    }
+    std::memcpy(&frame_[counts_offset], &upserts, sizeof(upserts));
+    std::memcpy(&frame_[counts_offset + sizeof(upserts)], &removals, sizeof(removals));
+
+    ++sequence_;
+    frames_since_key_ = key ? 0 : frames_since_key_ + 1;
+    if (send(start) && key) {
+        force_key_ = false;
+        ++stats_.key_frames;
+    }
+
+    auto cost = std::chrono::steady_clock::now() - start;
+    if (cost > cycle_budget_) {
+        ++stats_.over_budget;
+        if (over_budget.record()) {
+            ATC_LOG_WARNING("Replicating " + std::to_string(states.size()) + " tracks took " +
+                            std::to_string(std::chrono::duration_cast<std::chrono::microseconds>(cost).count()) +
+                            " us");
+        }
+    }
+}
+
+void ReplicationWriter::appendAlert(const std::string& text) {
+    auto start = std::chrono::steady_clock::now();
+    if (!connect()) return;
+    frame_.clear();
+    put(frame_, static_cast<uint8_t>(ReplicationKind::ALERT));
+    frame_.append(text);
+    send(start);
+}
+
+void ReplicationWriter::appendCommand(const CommandData& command) {
+    auto start = std::chrono::steady_clock::now();
+    if (!connect()) return;
+    frame_.clear();
+    put(frame_, static_cast<uint8_t>(ReplicationKind::COMMAND));
+    putString(frame_, command.target_id);
+    putString(frame_, command.command);
+    size_t params = std::min(command.params.size(), MAX_STRING);
+    put(frame_, static_cast<uint8_t>(params));
+    for (size_t i = 0; i < params; ++i) {
+        putString(frame_, command.params[i]);
+    }
+    send(start);
+}
+
+bool ReplicationWriter::send(std::chrono::steady_clock::time_point start) {
+    bool written = ring_->write(frame_.data(), frame_.size());
+    if (written) {
+        ++stats_.frames;
+        stats_.bytes += frame_.size();
+        consecutive_drops_ = 0;
+    } else {
+        // The standby missed a delta, so it needs a key frame to resynchronise
+        ++stats_.dropped;
+        force_key_ = true;
+        if (++consecutive_drops_ >= constants::REPLICATION_RECONNECT_DROPS) {
+            ATC_LOG_WARNING("Replication ring " + ring_name_ + " is not being drained - reconnecting");
+            ring_.reset();
+        }
+    }
+
+    uint64_t cost = static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now() - start).count());
+    stats_.total_cost_ns += cost;
+    stats_.max_cost_ns = std::max(stats_.max_cost_ns, cost);
+    return written;
+}
+
+bool ReplicaState::apply(const std::string& record) {
+    // Any record, applied or not, shows the primary is alive
+    last_record_ = std::chrono::steady_clock::now();
+    if (record.empty()) return false;
+
+    switch (static_cast<ReplicationKind>(record[0])) {
+        case ReplicationKind::STATE_DELTA:
+            return applyStates(record);
+
+        case ReplicationKind::ALERT:
+            recent_alerts_.emplace_back(record, 1);
+            return true;
+
+        case ReplicationKind::COMMAND: {
+            RecordReader reader(record);
+            uint8_t kind, params;
+            CommandData command;
+            reader.get(kind);
+            if (!reader.getString(command.target_id) || !reader.getString(command.command) ||
+                !reader.get(params)) {
+                return false;
+            }
+            command.params.resize(params);
+            for (auto& param : command.params) {
+                if (!reader.getString(param)) return false;
+            }
+            if (!reader.atEnd()) return false;
+            pending_commands_.push_back(std::move(command));
+            return true;
+        }
+    }
+    return false;
+}
+
+bool ReplicaState::applyStates(const std::string& record) {
+    RecordReader reader(record);
+    uint8_t kind, flags;
+    uint64_t sequence, base_sequence;
+    uint32_t upsert_count, removal_count;
+    if (!reader.get(kind) || !reader.get(flags) || !reader.get(sequence) ||
+        !reader.get(base_sequence) || !reader.get(upsert_count) || !reader.get(removal_count)) {
+        return false;
+    }
+
+    bool key = (flags & DELTA_KEY) != 0;
+    if (!key && (!synchronised_ || base_sequence != sequence_)) {
+        if (synchronised_ || rejected_records.record()) {
+            ATC_LOG_WARNING("Replication delta " + std::to_string(sequence) +
+                            " does not follow " + std::to_string(sequence_) +
+                            " - waiting for a key frame");
+        }
+        synchronised_ = false;
+        return false;
+    }
+
+    // Decode everything before touching the replica so a bad record changes nothing
+    std::vector<AircraftState> upserts(upsert_count);
+    for (auto& state : upserts) {
+        if (!reader.getState(state)) return false;
+    }
+    std::vector<std::string> removals(removal_count);
+    for (auto& callsign : removals) {
+        if (!reader.getString(callsign)) return false;
+    }
+    if (!reader.atEnd()) return false;
+
+    if (key) {
+        states_.clear();
+    }
+    for (auto& state : upserts) {
+        std::string callsign = state.callsign;
+        states_[callsign] = std::move(state);
+    }
+    for (const auto& callsign : removals) {
+        states_.erase(callsign);
+    }
+
+    sequence_ = sequence;
+    synchronised_ = true;
+    seeded_ = true;
+    pending_commands_.clear();
+    recent_alerts_.clear();
+    return true;
+}
+
+std::vector<AircraftState> ReplicaState::getStates() const {
+    std::vector<AircraftState> states;
+    states.reserve(states_.size());
+    for (const auto& entry : states_) {
+        states.push_back(entry.second);
+    }
+    std::sort(states.begin(), states.end(),
+              [](const AircraftState& a, const AircraftState& b) { return a.callsign < b.callsign; });
+    return states;
+}
+
+bool ReplicaState::primaryLost(std::chrono::steady_clock::time_point now,
+                               std::chrono::milliseconds timeout) const {
+    return seeded_ && now - last_record_ > timeout;
+}
+
+}
+}
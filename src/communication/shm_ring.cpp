@@ -0,0 +1,265 @@
+#include "communication/shm_ring.h"
+#include "common/constants.h"
+#include "common/logger.h"
+#include <atomic>
+#include <cerrno>
+#include <chrono>
+#include <cstring>
+#include <ctime>
+#include <fcntl.h>
+#include <new>
+#include <semaphore.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace atc {
+namespace comm {
+
+namespace {
+
+constexpr uint32_t RING_MAGIC = 0x41544352;  // "ATCR"
+constexpr uint32_t RING_VERSION = 1;
+constexpr uint32_t RECORD_PADDING = 1;       // filler up to the end of the buffer
+constexpr size_t RECORD_HEADER_SIZE = 8;
+constexpr size_t MIN_CAPACITY = 4096;
+
+struct RecordHeader {
+    uint32_t size;
+    uint32_t flags;
+};
+
+size_t alignRecord(size_t size) {
+    return (size + 7) & ~static_cast<size_t>(7);
+}
+
+}
+
+// Producer and consumer indexes sit on their own cache lines so the two
+// processes do not invalidate each other's line on every record
+struct ShmRingHeader {
+    uint32_t magic;
+    uint32_t version;
+    uint64_t capacity;
+    alignas(64) std::atomic<uint64_t> head;      // bytes written
+    std::atomic<uint64_t> dropped;
+    alignas(64) std::atomic<uint64_t> tail;      // bytes consumed
+    std::atomic<uint32_t> reader_waiting;
+    sem_t wakeup;
+};
+
+static_assert(std::atomic<uint64_t>::is_always_lock_free,
+              "ring indexes must be lock-free to be shared between processes");
+
+namespace {
+constexpr size_t DATA_OFFSET = (sizeof(ShmRingHeader) + 63) & ~static_cast<size_t>(63);
+}
+
+ShmRing::ShmRing(const std::string& name) : name_(name) {}
+
+ShmRing::~ShmRing() {
+    unmap();
+    if (owner_) {
+        ::shm_unlink(name_.c_str());
+    }
+}
+
+bool ShmRing::create(size_t capacity) {
+    size_t rounded = MIN_CAPACITY;
+    while (rounded < capacity) {
+        rounded <<= 1;
+    }
+    ::shm_unlink(name_.c_str());
+    if (!map(rounded, true)) {
+        return false;
+    }
+
+    header_->magic = RING_MAGIC;
+    header_->version = RING_VERSION;
+    header_->capacity = rounded;
+    new (&header_->head) std::atomic<uint64_t>(0);
+    new (&header_->dropped) std::atomic<uint64_t>(0);
+    new (&header_->tail) std::atomic<uint64_t>(0);
+    new (&header_->reader_waiting) std::atomic<uint32_t>(0);
+    if (::sem_init(&header_->wakeup, 1, 0) != 0) {
+        ATC_LOG_ERROR("Failed to initialise wakeup semaphore for ring " + name_ + ": " +
+                      std::strerror(errno));
+        unmap();
+        ::shm_unlink(name_.c_str());
+        return false;
+    }
+    owner_ = true;
+    return true;
+}
+
+bool ShmRing::open() {
+    return map(0, false);
+}
+
+bool ShmRing::map(size_t capacity, bool create) {
+    unmap();
+    int fd = create ? ::shm_open(name_.c_str(), O_RDWR | O_CREAT | O_EXCL, 0600)
+                    : ::shm_open(name_.c_str(), O_RDWR, 0);
+    if (fd < 0) {
+        // A missing ring is expected while its peer is not running; callers decide how loud to be
+        if (errno == ENOENT) {
+            ATC_LOG_DEBUG("Shared memory ring " + name_ + " does not exist");
+        } else {
+            ATC_LOG_ERROR("Failed to open shared memory ring " + name_ + ": " + std::strerror(errno));
+        }
+        return false;
+    }
+
+    size_t size = DATA_OFFSET + capacity;
+    if (create) {
+        if (::ftruncate(fd, static_cast<off_t>(size)) != 0) {
+            ATC_LOG_ERROR("Failed to size shared memory ring " + name_ + ": " + std::strerror(errno));
+            ::close(fd);
+            ::shm_unlink(name_.c_str());
+            return false;
+        }
+    } else {
+        struct stat info;
+        if (::fstat(fd, &info) != 0 || static_cast<size_t>(info.st_size) < DATA_OFFSET + MIN_CAPACITY) {
+            ATC_LOG_ERROR("Shared memory ring " + name_ + " is not initialised");
+            ::close(fd);
+            return false;
+        }
+        size = static_cast<size_t>(info.st_size);
+    }
+
+    void* address = ::mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    ::close(fd);
+    if (address == MAP_FAILED) {
+        ATC_LOG_ERROR("Failed to map shared memory ring " + name_ + ": " + std::strerror(errno));
+        if (create) {
+            ::shm_unlink(name_.c_str());
+        }
+        return false;
+    }
+
+    header_ = static_cast<ShmRingHeader*>(address);
+    data_ = static_cast<char*>(address) + DATA_OFFSET;
+    mapped_size_ = size;
+
+    if (!create && (header_->magic != RING_MAGIC || header_->version != RING_VERSION ||
+                    DATA_OFFSET + header_->capacity != size)) {
+        ATC_LOG_ERROR("Shared memory ring " + name_ + " has an unexpected layout");
+        unmap();
+        return false;
+    }
+    return true;
+}
+
+void ShmRing::unmap() {
+    if (header_) {
+        ::munmap(header_, mapped_size_);
+        header_ = nullptr;
+        data_ = nullptr;
+        mapped_size_ = 0;
+    }
+}
+
+bool ShmRing::write(const void* data, size_t size) {
+    if (!header_) return false;
+    if (size > getMaxRecordSize()) {
+        header_->dropped.fetch_add(1, std::memory_order_relaxed);
+        return false;
+    }
+
+    const uint64_t capacity = header_->capacity;
+    uint64_t head = header_->head.load(std::memory_order_relaxed);
+    uint64_t tail = header_->tail.load(std::memory_order_acquire);
+
+    // A record never straddles the end of the buffer; the remainder is padded instead
+    size_t total = RECORD_HEADER_SIZE + alignRecord(size);
+    size_t offset = head & (capacity - 1);
+    size_t contiguous = capacity - offset;
+    size_t needed = total + (contiguous < total ? contiguous : 0);
+    if (capacity - (head - tail) < needed) {
+        header_->dropped.fetch_add(1, std::memory_order_relaxed);
+        return false;
+    }
+
+    if (contiguous < total) {
+        RecordHeader padding{static_cast<uint32_t>(contiguous - RECORD_HEADER_SIZE), RECORD_PADDING};
+        std::memcpy(data_ + offset, &padding, sizeof(padding));
+        head += contiguous;
+        offset = 0;
+    }
+    RecordHeader record{static_cast<uint32_t>(size), 0};
+    std::memcpy(data_ + offset, &record, sizeof(record));
+    std::memcpy(data_ + offset + RECORD_HEADER_SIZE, data, size);
+    header_->head.store(head + total, std::memory_order_release);
+
+    // Pairs with the fence in read(): either the reader sees the new head or we see it waiting
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    if (header_->reader_waiting.load(std::memory_order_relaxed)) {
+        ::sem_post(&header_->wakeup);
+    }
+    return true;
+}
+
+bool ShmRing::read(std::string& out, int64_t timeout_us) {
+    if (!header_) return false;
+
+    const uint64_t mask = header_->capacity - 1;
+    auto tryRead = [this, mask, &out]() {
+        uint64_t tail = header_->tail.load(std::memory_order_relaxed);
+        uint64_t head = header_->head.load(std::memory_order_acquire);
+        while (tail != head) {
+            RecordHeader record;
+            std::memcpy(&record, data_ + (tail & mask), sizeof(record));
+            uint64_t next = tail + RECORD_HEADER_SIZE + alignRecord(record.size);
+            if (record.flags & RECORD_PADDING) {
+                tail = next;
+                header_->tail.store(tail, std::memory_order_release);
+                continue;
+            }
+            out.assign(data_ + (tail & mask) + RECORD_HEADER_SIZE, record.size);
+            header_->tail.store(next, std::memory_order_release);
+            return true;
+        }
+        return false;
+    };
+
+    auto start = std::chrono::steady_clock::now();
+    auto deadline = start + std::chrono::microseconds(timeout_us);
+    auto spin_until = start + std::chrono::microseconds(constants::SHM_RING_SPIN_TIME);
+    while (true) {
+        if (tryRead()) return true;
+        auto now = std::chrono::steady_clock::now();
+        if (now >= deadline) return false;
+        if (now < spin_until) continue;
+
+        header_->reader_waiting.store(1, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        if (header_->head.load(std::memory_order_relaxed) ==
+            header_->tail.load(std::memory_order_relaxed)) {
+            auto remaining = std::chrono::duration_cast<std::chrono::nanoseconds>(deadline - now);
+            timespec wake;
+            ::clock_gettime(CLOCK_REALTIME, &wake);
+            int64_t nanos = wake.tv_nsec + remaining.count();
+            wake.tv_sec += static_cast<time_t>(nanos / 1000000000);
+            wake.tv_nsec = static_cast<long>(nanos % 1000000000);
+            while (::sem_timedwait(&header_->wakeup, &wake) != 0 && errno == EINTR) {
+            }
+        }
+        header_->reader_waiting.store(0, std::memory_order_relaxed);
+    }
+}
+
+size_t ShmRing::getCapacity() const {
+    return header_ ? header_->capacity : 0;
+}
+
+size_t ShmRing::getMaxRecordSize() const {
+    return header_ ? header_->capacity / 2 - RECORD_HEADER_SIZE : 0;
+}
+
+uint64_t ShmRing::getDroppedCount() const {
+    return header_ ? header_->dropped.load(std::memory_order_relaxed) : 0;
+}
+
+}
+}
@@ -0,0 +1,122 @@
+#include "communication/situation_frames.h"
+#include <algorithm>
+#include <cstring>
+
+namespace atc {
+namespace comm {
+
+namespace {
+
+constexpr size_t MAX_CALLSIGN = 255;
+constexpr size_t STATE_FIELDS_SIZE = 8 * sizeof(double) + 1;   // after the callsign
+
+template <typename T>
+void put(std::string& out, T value) {
+    out.append(reinterpret_cast<const char*>(&value), sizeof(value));
+}
+
+class FrameReader {
+public:
+    explicit FrameReader(const std::string& frame) : data_(frame.data()), size_(frame.size()) {}
+
+    template <typename T>
+    bool get(T& value) {
+        if (size_ - offset_ < sizeof(T)) return false;
+        std::memcpy(&value, data_ + offset_, sizeof(T));
+        offset_ += sizeof(T);
+        return true;
+    }
+
+    bool getString(std::string& value, size_t length) {
+        if (size_ - offset_ < length) return false;
+        value.assign(data_ + offset_, length);
+        offset_ += length;
+        return true;
+    }
+
+    size_t remaining() const { return size_ - offset_; }
+
+private:
+    const char* data_;
+    size_t size_;
+    size_t offset_ = 0;
+};
+
+}
+
+void encodeTrackStates(const std::vector<AircraftState>& states, std::string& out) {
+    out.clear();
+    put(out, static_cast<uint8_t>(FrameKind::TRACK_STATES));
+    put(out, static_cast<uint32_t>(states.size()));
+    for (const auto& state : states) {
+        size_t length = std::min(state.callsign.size(), MAX_CALLSIGN);
+        put(out, static_cast<uint8_t>(length));
+        out.append(state.callsign, 0, length);
+        put(out, state.position.x);
+        put(out, state.position.y);
+        put(out, state.position.z);
+        put(out, state.velocity.vx);
+        put(out, state.velocity.vy);
+        put(out, state.velocity.vz);
+        put(out, state.heading);
+        put(out, static_cast<uint8_t>(state.status));
+        put(out, state.timestamp);
+    }
+}
+
+void encodeAlert(const std::string& text, std::string& out) {
+    out.clear();
+    put(out, static_cast<uint8_t>(FrameKind::ALERT));
+    out.append(text);
+}
+
+bool frameKind(const std::string& frame, FrameKind& kind) {
+    if (frame.empty()) return false;
+    uint8_t value = static_cast<uint8_t>(frame[0]);
+    if (value != static_cast<uint8_t>(FrameKind::TRACK_STATES) &&
+        value != static_cast<uint8_t>(FrameKind::ALERT)) {
+        return false;
+    }
+    kind = static_cast<FrameKind>(value);
+    return true;
+}
+
+bool decodeTrackStates(const std::string& frame, std::vector<AircraftState>& states) {
+    FrameReader reader(frame);
+    uint8_t kind;
+    uint32_t count;
+    if (!reader.get(kind) || kind != static_cast<uint8_t>(FrameKind::TRACK_STATES) ||
+        !reader.get(count) || count > reader.remaining() / (1 + STATE_FIELDS_SIZE)) {
+        return false;
+    }
+
+    states.clear();
+    states.reserve(count);
+    for (uint32_t i = 0; i < count; ++i) {
+        AircraftState state;
+        uint8_t length = 0;
+        uint8_t status = 0;
+        if (!reader.get(length) || !reader.getString(state.callsign, length) ||
+            !reader.get(state.position.x) || !reader.get(state.position.y) ||
+            !reader.get(state.position.z) || !reader.get(state.velocity.vx) ||
+            !reader.get(state.velocity.vy) || !reader.get(state.velocity.vz) ||
+            !reader.get(state.heading) || !reader.get(status) || !reader.get(state.timestamp) ||
+            status > static_cast<uint8_t>(AircraftStatus::EMERGENCY)) {
+            return false;
+        }
+        state.status = static_cast<AircraftStatus>(status);
+        states.push_back(std::move(state));
+    }
+    return reader.remaining() == 0;
+}
+
+bool decodeAlert(const std::string& frame, std::string& text) {
+    if (frame.empty() || static_cast<uint8_t>(frame[0]) != static_cast<uint8_t>(FrameKind::ALERT)) {
+        return false;
+    }
+    text.assign(frame, 1, std::string::npos);
+    return true;
+}
+
+}
+}
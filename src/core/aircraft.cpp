@@ -1,18 +1,32 @@
 #include "core/aircraft.h"
 #include "common/constants.h"
 #include "common/logger.h"
+#include "common/metrics.h"
+#include <atomic>
+#include <cmath>
 #include <sstream>
 #include <iostream>
 #include <iomanip>
 #include <stdexcept>
+#include <limits>
 
 namespace atc {
 
+namespace {
+LogEvent periodic_updates("aircraft periodic updates", LogLevel::DEBUG);
+
+metrics::Counter position_updates("atc_aircraft_position_updates_total", "Aircraft position updates");
+
+// Shared by all aircraft, so one's version never matches another's
+std::atomic<uint64_t> last_velocity_version{0};
+}
+
 Aircraft::Aircraft(const std::string& callsign,
                    const Position& initial_pos,
                    const Velocity& initial_vel)
     : PeriodicTask(std::chrono::milliseconds(constants::POSITION_UPDATE_INTERVAL),
-                   constants::AIRCRAFT_UPDATE_PRIORITY) {
+                   constants::AIRCRAFT_UPDATE_PRIORITY)
+    , callsign_(callsign) {
 
     if (!initial_pos.isValid()) {
         throw std::invalid_argument("Initial position outside valid airspace");
@@ -24,12 +38,17 @@ Aircraft::Aircraft(const std::string& callsign,
     state_.updateHeading();
     state_.updateTimestamp();
     state_.status = AircraftStatus::ENTERING;
+    followLine();
 
     // Log initial state
     logState("Aircraft initialized", state_);
 }
 
-void Aircraft::logState(const std::string& event, const AircraftState& state) {
+void Aircraft::logState(const std::string& event, const AircraftState& state, LogLevel level) {
+    if (static_cast<int>(level) < ATC_LOG_MIN_LEVEL || !Logger::isEnabled(level)) {
+        return;
+    }
+
     std::ostringstream oss;
     oss << "\n=== " << event << " ===\n";
     oss << "Aircraft: " << state.callsign << "\n"
@@ -41,7 +60,7 @@ void Aircraft::logState(const std::string& event, const AircraftState& state) {
         << "Heading: " << state.heading << " degrees\n"
         << "Status: " << getStatusString(state.status) << "\n"
         << "Timestamp: " << state.timestamp;
-    Logger::getInstance().log(oss.str());
+    Logger::getInstance().log(level, oss.str());
 }
 
 std::string Aircraft::getStatusString(AircraftStatus status) {
@@ -58,23 +77,23 @@ std::string Aircraft::getStatusString(AircraftStatus status) {
 void Aircraft::execute() {
     try {
         updatePosition();
+        position_updates.increment();
 
-        // Log periodic state update
-        std::lock_guard<std::mutex> lock(state_mutex_);
-        static int update_count = 0;
-        if (++update_count % 5 == 0) {  // Log every 5th update to avoid excessive logging
-            logState("Periodic Update", state_);
+        // Counted across all aircraft; one state is sampled per reporting interval
+        if (periodic_updates.record()) {
+            std::lock_guard<std::mutex> lock(state_mutex_);
+            logState("Periodic Update", state_, LogLevel::DEBUG);
         }
     } catch (const std::exception& e) {
-        Logger::getInstance().log("Error updating aircraft " + state_.callsign +
-                                  " position: " + e.what());
+        ATC_LOG_ERROR("Error updating aircraft " + state_.callsign +
+                      " position: " + e.what());
         declareEmergency();
     }
 }
 
 bool Aircraft::updateSpeed(double new_speed) {
     if (!validateSpeed(new_speed)) {
-        Logger::getInstance().log("Invalid speed value: " + std::to_string(new_speed));
+        ATC_LOG_WARNING("Invalid speed value: " + std::to_string(new_speed));
         return false;
     }
 
@@ -83,17 +102,19 @@ bool Aircraft::updateSpeed(double new_speed) {
         double heading = state_.heading;
         state_.velocity.setFromSpeedAndHeading(new_speed, heading);
         state_.updateTimestamp();
+        ++route_.intent_version;
+        followLine();
         logState("Speed Updated", state_);
         return true;
     } catch (const std::exception& e) {
-        Logger::getInstance().log("Error updating speed: " + std::string(e.what()));
+        ATC_LOG_ERROR("Error updating speed: " + std::string(e.what()));
         return false;
     }
 }
 
 bool Aircraft::updateHeading(double new_heading) {
     if (new_heading < 0 || new_heading >= 360) {
-        Logger::getInstance().log("Invalid heading value: " + std::to_string(new_heading));
+        ATC_LOG_WARNING("Invalid heading value: " + std::to_string(new_heading));
         return false;
     }
 
@@ -103,17 +124,23 @@ bool Aircraft::updateHeading(double new_heading) {
         state_.velocity.setFromSpeedAndHeading(speed, new_heading);
         state_.heading = new_heading;
         state_.updateTimestamp();
+        if (route_.route) {
+            route_.route.reset();
+            ATC_LOG_INFO("Aircraft " + callsign_ + " vectored off its route");
+        }
+        ++route_.intent_version;
+        followLine();
         logState("Heading Updated", state_);
         return true;
     } catch (const std::exception& e) {
-        Logger::getInstance().log("Error updating heading: " + std::string(e.what()));
+        ATC_LOG_ERROR("Error updating heading: " + std::string(e.what()));
         return false;
     }
 }
 
 bool Aircraft::updateAltitude(double new_altitude) {
     if (!validateAltitude(new_altitude)) {
-        Logger::getInstance().log("Invalid altitude value: " + std::to_string(new_altitude));
+        ATC_LOG_WARNING("Invalid altitude value: " + std::to_string(new_altitude));
         return false;
     }
 
@@ -121,26 +148,44 @@ bool Aircraft::updateAltitude(double new_altitude) {
         std::lock_guard<std::mutex> lock(state_mutex_);
         state_.position.z = new_altitude;
         state_.updateTimestamp();
+        route_.cleared_altitude = new_altitude;
+        ++route_.intent_version;
+        followLine();
         logState("Altitude Updated", state_);
         return true;
     } catch (const std::exception& e) {
-        Logger::getInstance().log("Error updating altitude: " + std::string(e.what()));
+        ATC_LOG_ERROR("Error updating altitude: " + std::string(e.what()));
         return false;
     }
 }
 
+void Aircraft::setRoute(const std::shared_ptr<const Route>& route) {
+    std::lock_guard<std::mutex> lock(state_mutex_);
+    route_.route = route;
+    route_.next_waypoint = 0;
+    route_.cleared_altitude = std::numeric_limits<double>::quiet_NaN();
+    ++route_.intent_version;
+    if (validateSpeed(route->cruise_speed)) {
+        state_.velocity.setFromSpeedAndHeading(route->cruise_speed, state_.heading);
+    }
+    state_.updateTimestamp();
+    followLine();
+    ATC_LOG_INFO("Aircraft " + callsign_ + " following a route of " +
+                 std::to_string(route->waypoints.size()) + " fixes");
+}
+
 void Aircraft::declareEmergency() {
     std::lock_guard<std::mutex> lock(state_mutex_);
     state_.status = AircraftStatus::EMERGENCY;
     logState("Emergency Declared", state_);
-    Logger::getInstance().log("Aircraft " + state_.callsign + " declaring emergency!");
+    ATC_LOG_INFO("Aircraft " + state_.callsign + " declaring emergency!");
 }
 
 void Aircraft::cancelEmergency() {
     std::lock_guard<std::mutex> lock(state_mutex_);
     state_.status = AircraftStatus::CRUISING;
     logState("Emergency Cancelled", state_);
-    Logger::getInstance().log("Aircraft " + state_.callsign + " emergency cancelled.");
+    ATC_LOG_INFO("Aircraft " + state_.callsign + " emergency cancelled.");
 }
 
 AircraftState Aircraft::getState() const {
@@ -148,6 +193,18 @@ AircraftState Aircraft::getState() const {
     return state_;
 }
 
+RouteProgress Aircraft::getRouteProgress(AircraftState& state) const {
+    std::lock_guard<std::mutex> lock(state_mutex_);
+    state = state_;
+    return route_;
+}
+
+void Aircraft::setState(const AircraftState& state) {
+    std::lock_guard<std::mutex> lock(state_mutex_);
+    state_ = state;
+    followLine();
+}
+
 void Aircraft::updatePosition() {
     std::lock_guard<std::mutex> lock(state_mutex_);
 
@@ -159,9 +216,25 @@ void Aircraft::updatePosition() {
         state_.position.z + state_.velocity.vz * dt
     };
 
+    // Along a route the leg, and so the velocity, can change within the step
+    AircraftState routed;
+    RouteProgress progress;
+    if (route_.route) {
+        routed = state_;
+        progress = route_;
+        flyRoute(routed, progress, dt);
+        new_pos = routed.position;
+    }
+
     if (new_pos.isValid()) {
         state_.position = new_pos;
+        if (route_.route) {
+            state_.velocity = routed.velocity;
+            state_.heading = routed.heading;
+            route_.next_waypoint = progress.next_waypoint;
+        }
         state_.updateTimestamp();
+        followLine();
 
         // Update status if needed
         if (state_.status == AircraftStatus::ENTERING) {
@@ -175,6 +248,23 @@ void Aircraft::updatePosition() {
     }
 }
 
+void Aircraft::followLine() {
+    double time = state_.timestamp / 1000.0;
+    double elapsed = time - line_.time;
+    const Velocity& velocity = state_.velocity;
+    bool on_line = route_.velocity_version != 0 && time >= line_.latest &&
+        velocity.vx == line_.velocity.vx && velocity.vy == line_.velocity.vy && velocity.vz == line_.velocity.vz &&
+        std::hypot(state_.position.x - (line_.origin.x + velocity.vx * elapsed),
+                   state_.position.y - (line_.origin.y + velocity.vy * elapsed)) <= constants::VELOCITY_LINE_TOLERANCE &&
+        std::abs(state_.position.z - (line_.origin.z + velocity.vz * elapsed)) <= constants::VELOCITY_LINE_TOLERANCE;
+    if (on_line) {
+        line_.latest = time;
+        return;
+    }
+    route_.velocity_version = ++last_velocity_version;
+    line_ = {state_.position, velocity, time, time};
+}
+
 bool Aircraft::validateSpeed(double speed) const {
     return speed >= constants::MIN_SPEED && speed <= constants::MAX_SPEED;
 }
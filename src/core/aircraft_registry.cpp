@@ -0,0 +1,40 @@
+#include "core/aircraft_registry.h"
+
+namespace atc {
+
+bool AircraftRegistry::add(const std::shared_ptr<Aircraft>& aircraft) {
+    if (!index_.emplace(aircraft->getCallsign(), aircraft_.size()).second) {
+        return false;
+    }
+    aircraft_.push_back(aircraft);
+    return true;
+}
+
+std::shared_ptr<Aircraft> AircraftRegistry::remove(const std::string& callsign) {
+    auto it = index_.find(callsign);
+    if (it == index_.end()) {
+        return nullptr;
+    }
+
+    size_t slot = it->second;
+    index_.erase(it);
+    std::shared_ptr<Aircraft> removed = std::move(aircraft_[slot]);
+    if (slot + 1 != aircraft_.size()) {
+        aircraft_[slot] = std::move(aircraft_.back());
+        index_[aircraft_[slot]->getCallsign()] = slot;
+    }
+    aircraft_.pop_back();
+    return removed;
+}
+
+std::shared_ptr<Aircraft> AircraftRegistry::find(const std::string& callsign) const {
+    auto it = index_.find(callsign);
+    return it == index_.end() ? nullptr : aircraft_[it->second];
+}
+
+void AircraftRegistry::clear() {
+    aircraft_.clear();
+    index_.clear();
+}
+
+}
@@ -0,0 +1,163 @@
+#include "core/arrival_sequencer.h"
+#include "common/constants.h"
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <unordered_set>
+
+namespace atc {
+
+namespace {
+
+// Seconds a follower (column) lands behind a leader (row): LIGHT, MEDIUM, HEAVY, SUPER
+constexpr double WAKE_SPACING[4][4] = {
+    { 60.0,  60.0,  60.0,  60.0},
+    {120.0,  60.0,  60.0,  60.0},
+    {150.0, 120.0,  90.0,  90.0},
+    {180.0, 150.0, 120.0, 120.0},
+};
+
+constexpr double NO_LEADER = -std::numeric_limits<double>::infinity();
+
+double landing(const ArrivalSequencer::Slot& slot, double leader_time, WakeCategory leader_wake) {
+    if (leader_time == NO_LEADER) return slot.eta;
+    return std::max(slot.eta, leader_time + ArrivalSequencer::spacing(leader_wake, slot.wake));
+}
+
+}
+
+ArrivalSequencer::ArrivalSequencer(const Position& runway_fix) : runway_fix_(runway_fix) {}
+
+double ArrivalSequencer::spacing(WakeCategory leader, WakeCategory follower) {
+    return WAKE_SPACING[static_cast<int>(leader)][static_cast<int>(follower)];
+}
+
+bool ArrivalSequencer::update(const std::string& callsign, const Route& route,
+                              const std::shared_ptr<const Trajectory>& trajectory) {
+    double eta = std::numeric_limits<double>::infinity();
+    if (!route.waypoints.empty()) {
+        Position last = route.fixes->position(route.waypoints.back());
+        if (std::hypot(last.x - runway_fix_.x, last.y - runway_fix_.y) <= 1.0) {
+            eta = trajectory->timeOver(last);
+        }
+    }
+    // Not bound for the runway, or already past the fix
+    if (std::isinf(eta)) {
+        remove(callsign);
+        return false;
+    }
+
+    const Velocity& velocity = trajectory->segments().front().velocity;
+    auto it = inbound_.find(callsign);
+    if (it == inbound_.end()) {
+        it = inbound_.emplace(callsign, Inbound{route.wake, eta, 0.0, 0.0, false}).first;
+    }
+    it->second.wake = route.wake;
+    it->second.eta = eta;
+    it->second.speed = std::hypot(velocity.vx, velocity.vy);
+    return true;
+}
+
+void ArrivalSequencer::remove(const std::string& callsign) {
+    inbound_.erase(callsign);
+}
+
+std::vector<ArrivalSequencer::Slot> ArrivalSequencer::resequence(double now) {
+    // Aircraft over the fix have landed
+    for (auto it = inbound_.begin(); it != inbound_.end(); ) {
+        it = it->second.eta < now ? inbound_.erase(it) : std::next(it);
+    }
+
+    // Slots due within the freeze time keep their order from the last pass
+    std::vector<Slot> sequence;
+    std::unordered_set<std::string> frozen;
+    for (const auto& slot : sequence_) {
+        if (slot.scheduled - now > constants::ARRIVAL_FREEZE_TIME) break;
+        auto it = inbound_.find(slot.callsign);
+        if (it == inbound_.end()) continue;
+        sequence.push_back({slot.callsign, it->second.wake, it->second.eta, 0.0, 0.0, false});
+        frozen.insert(slot.callsign);
+    }
+    size_t frozen_count = sequence.size();
+
+    // The rest first come, first served
+    for (const auto& entry : inbound_) {
+        if (!frozen.count(entry.first)) {
+            sequence.push_back({entry.first, entry.second.wake, entry.second.eta, 0.0, 0.0, false});
+        }
+    }
+    std::sort(sequence.begin() + static_cast<std::ptrdiff_t>(frozen_count), sequence.end(),
+              [](const Slot& a, const Slot& b) {
+                  return a.eta != b.eta ? a.eta < b.eta : a.callsign < b.callsign;
+              });
+    sequence_.swap(sequence);
+
+    double leader_time = NO_LEADER;
+    WakeCategory leader_wake = WakeCategory::LIGHT;
+    for (size_t i = 0; i < frozen_count; ++i) {
+        leader_time = landing(sequence_[i], leader_time, leader_wake);
+        leader_wake = sequence_[i].wake;
+    }
+    improveOrder(frozen_count, leader_time, leader_wake);
+    schedule(0, NO_LEADER, WakeCategory::LIGHT);
+
+    // Absorb each delay by slowing down over the remaining distance
+    std::vector<Slot> changed;
+    for (auto& slot : sequence_) {
+        Inbound& inbound = inbound_[slot.callsign];
+        double to_go = slot.eta - now;
+        if (slot.scheduled > slot.eta && to_go > 0.0) {
+            double speed = std::floor(inbound.speed * to_go / (slot.scheduled - now));
+            if (speed < constants::MIN_SPEED) {
+                slot.hold = true;
+            } else if (inbound.speed - speed >= constants::ARRIVAL_ADVISORY_STEP) {
+                slot.advised_speed = speed;
+            }
+        }
+        if (slot.hold != inbound.hold ||
+            std::abs(slot.advised_speed - inbound.advised_speed) >= constants::ARRIVAL_ADVISORY_STEP) {
+            inbound.hold = slot.hold;
+            inbound.advised_speed = slot.advised_speed;
+            changed.push_back(slot);
+        }
+    }
+    return changed;
+}
+
+void ArrivalSequencer::schedule(size_t from, double leader_time, WakeCategory leader_wake) {
+    for (size_t i = from; i < sequence_.size(); ++i) {
+        sequence_[i].scheduled = landing(sequence_[i], leader_time, leader_wake);
+        leader_time = sequence_[i].scheduled;
+        leader_wake = sequence_[i].wake;
+    }
+}
+
+// Constrained position shifting: each aircraft moves at most one place from
+// its first come, first served position, and only if the pair's total delay
+// drops without the second of them landing later
+void ArrivalSequencer::improveOrder(size_t from, double leader_time, WakeCategory leader_wake) {
+    size_t i = from;
+    while (i + 1 < sequence_.size()) {
+        const Slot& a = sequence_[i];
+        const Slot& b = sequence_[i + 1];
+        double a_first = landing(a, leader_time, leader_wake);
+        double b_second = std::max(b.eta, a_first + spacing(a.wake, b.wake));
+        double b_first = landing(b, leader_time, leader_wake);
+        double a_second = std::max(a.eta, b_first + spacing(b.wake, a.wake));
+
+        double kept_delay = (a_first - a.eta) + (b_second - b.eta);
+        double swapped_delay = (b_first - b.eta) + (a_second - a.eta);
+        if (swapped_delay < kept_delay && a_second <= b_second) {
+            leader_time = a_second;
+            leader_wake = a.wake;
+            std::swap(sequence_[i], sequence_[i + 1]);
+            i += 2;
+        } else {
+            leader_time = a_first;
+            leader_wake = a.wake;
+            i += 1;
+        }
+    }
+}
+
+}
@@ -0,0 +1,298 @@
+#include "core/kinetic_schedule.h"
+#include "common/constants.h"
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+namespace atc {
+
+namespace {
+
+constexpr double NEVER = std::numeric_limits<double>::infinity();
+
+// Earliest s > 0 with a s^2 + b s + c = 0, a >= 0, or NEVER
+double firstRoot(double a, double b, double c) {
+    if (a == 0.0) {
+        if (b == 0.0) return NEVER;
+        double s = -c / b;
+        return s > 0.0 ? s : NEVER;
+    }
+    double discriminant = b * b - 4.0 * a * c;
+    if (discriminant < 0.0) return NEVER;
+    // The form without cancellation between b and the root
+    double q = -0.5 * (b + std::copysign(std::sqrt(discriminant), b));
+    double roots[2] = {q / a, q != 0.0 ? c / q : 0.0};
+    if (roots[0] > roots[1]) std::swap(roots[0], roots[1]);
+    if (roots[0] > 0.0) return roots[0];
+    if (roots[1] > 0.0) return roots[1];
+    return NEVER;
+}
+
+// When a distance of sqrt(a s^2 + b s + c) after s seconds first comes within
+// margin of threshold; 0 if it is already
+double horizontalEntry(double a, double b, double c, double threshold, double margin) {
+    double distance = std::sqrt(c);
+    if (std::abs(distance - threshold) <= margin) return 0.0;
+    double edge = distance > threshold ? threshold + margin : threshold - margin;
+    return firstRoot(a, b, c - edge * edge);
+}
+
+// The same for a distance of |z + vz s|
+double verticalEntry(double z, double vz, double threshold, double margin) {
+    double distance = std::abs(z);
+    if (std::abs(distance - threshold) <= margin) return 0.0;
+    if (vz == 0.0) return NEVER;
+    double edge = distance > threshold ? threshold + margin : threshold - margin;
+    double first = (edge - z) / vz;
+    double second = (-edge - z) / vz;
+    double entry = NEVER;
+    if (first > 0.0) entry = first;
+    if (second > 0.0) entry = std::min(entry, second);
+    return entry;
+}
+
+} // namespace
+
+uint64_t KineticSchedule::pairKey(uint32_t first, uint32_t second) {
+    if (first > second) std::swap(first, second);
+    return (static_cast<uint64_t>(first) << 32) | second;
+}
+
+const std::vector<std::pair<size_t, size_t>>& KineticSchedule::due(const std::vector<Track>& tracks,
+                                                                   double now, double lookahead) {
+    // Events were solved for the old window or a clock that has since gone back
+    if (now < now_ || lookahead != lookahead_) {
+        reset();
+    }
+    now_ = now;
+    lookahead_ = lookahead;
+    ++pass_;
+
+    track_slots_.resize(tracks.size());
+    moved_.clear();
+    for (size_t i = 0; i < tracks.size(); ++i) {
+        const AircraftState& state = *tracks[i].state;
+        auto [it, added] = by_callsign_.emplace(state.callsign, 0);
+        if (added) {
+            it->second = acquire(state.callsign);
+        }
+        Slot& slot = slots_[it->second];
+        slot.index = i;
+        slot.seen = pass_;
+        slot.moved = added || !follows(slot.model, tracks[i]);
+        if (slot.moved) {
+            slot.model = {state.position, state.velocity, state.timestamp / 1000.0, tracks[i].intent_version};
+            moved_.push_back(it->second);
+        }
+        track_slots_[i] = it->second;
+    }
+    for (uint32_t slot = 0; slot < slots_.size(); ++slot) {
+        if (slots_[slot].live && slots_[slot].seen != pass_) {
+            release(slot);
+        }
+    }
+
+    due_.clear();
+    // Every pair of an aircraft off its line, once even if both are
+    for (uint32_t moved : moved_) {
+        for (uint32_t other = 0; other < slots_.size(); ++other) {
+            if (other == moved || !slots_[other].live) continue;
+            if (slots_[other].moved && other < moved) continue;
+            addDue(moved, other);
+        }
+    }
+    while (!events_.empty() && events_.top().time <= now) {
+        Event event = events_.top();
+        events_.pop();
+        auto it = generations_.find(pairKey(event.first, event.second));
+        if (it == generations_.end() || it->second != event.generation) continue;   // superseded
+        generations_.erase(it);
+        if (!slots_[event.first].moved && !slots_[event.second].moved) {
+            addDue(event.first, event.second);
+        }
+    }
+    // Superseded events pile up when aircraft keep moving off their lines
+    if (events_.size() > 2 * generations_.size() + 1024) {
+        std::vector<Event> current;
+        while (!events_.empty()) {
+            const Event& event = events_.top();
+            auto it = generations_.find(pairKey(event.first, event.second));
+            if (it != generations_.end() && it->second == event.generation) {
+                current.push_back(event);
+            }
+            events_.pop();
+        }
+        events_ = decltype(events_)(std::greater<Event>(), std::move(current));
+    }
+
+    // The order a full scan would check them in
+    std::sort(due_.begin(), due_.end());
+    return due_;
+}
+
+void KineticSchedule::checked(size_t first, size_t second, bool conflict) {
+    uint32_t slot1 = track_slots_[first];
+    uint32_t slot2 = track_slots_[second];
+    // A pair in conflict is checked again next pass, as is one already near a threshold
+    double time = conflict ? now_ : std::max(now_, nextChange(slots_[slot1].model, slots_[slot2].model));
+
+    uint64_t key = pairKey(slot1, slot2);
+    if (time == NEVER) {
+        generations_.erase(key);
+        return;
+    }
+    uint64_t generation = ++generation_;
+    generations_[key] = generation;
+    events_.push({time, slot1, slot2, generation});
+}
+
+void KineticSchedule::reset() {
+    slots_.clear();
+    free_slots_.clear();
+    by_callsign_.clear();
+    generations_.clear();
+    events_ = {};
+    now_ = 0.0;
+}
+
+bool KineticSchedule::follows(const Model& model, const Track& track) const {
+    const AircraftState& state = *track.state;
+    if (track.routed || track.intent_version != model.intent_version ||
+        state.velocity.vx != model.velocity.vx || state.velocity.vy != model.velocity.vy ||
+        state.velocity.vz != model.velocity.vz) {
+        return false;
+    }
+    double time = state.timestamp / 1000.0;
+    if (time < model.time || now_ - time > constants::KINETIC_MAX_REPORT_AGE) {
+        return false;
+    }
+    double elapsed = time - model.time;
+    double dx = state.position.x - (model.position.x + model.velocity.vx * elapsed);
+    double dy = state.position.y - (model.position.y + model.velocity.vy * elapsed);
+    double dz = state.position.z - (model.position.z + model.velocity.vz * elapsed);
+    return std::hypot(dx, dy) <= constants::KINETIC_DRIFT_TOLERANCE &&
+           std::abs(dz) <= constants::KINETIC_DRIFT_TOLERANCE;
+}
+
+double KineticSchedule::nextChange(const Model& first, const Model& second) const {
+    // Relative position and velocity of the lines now
+    double elapsed1 = now_ - first.time;
+    double elapsed2 = now_ - second.time;
+    double x = (second.position.x + second.velocity.vx * elapsed2) - (first.position.x + first.velocity.vx * elapsed1);
+    double y = (second.position.y + second.velocity.vy * elapsed2) - (first.position.y + first.velocity.vy * elapsed1);
+    double z = (second.position.z + second.velocity.vz * elapsed2) - (first.position.z + first.velocity.vz * elapsed1);
+    double vx = second.velocity.vx - first.velocity.vx;
+    double vy = second.velocity.vy - first.velocity.vy;
+    double vz = second.velocity.vz - first.velocity.vz;
+
+    // A report lags its line by up to the oldest age allowed, plus the drift allowed
+    double age = constants::KINETIC_MAX_REPORT_AGE;
+    double drift = 2.0 * constants::KINETIC_DRIFT_TOLERANCE;
+    double horizontal_margin = drift + age * (std::hypot(first.velocity.vx, first.velocity.vy) +
+                                              std::hypot(second.velocity.vx, second.velocity.vy));
+    double vertical_margin = drift + age * (std::abs(first.velocity.vz) + std::abs(second.velocity.vz));
+
+    double closing = vx * vx + vy * vy;
+    double next = NEVER;
+    for (double threshold : {constants::MIN_HORIZONTAL_SEPARATION, 2.0 * constants::MIN_HORIZONTAL_SEPARATION}) {
+        next = std::min(next, horizontalEntry(closing, 2.0 * (x * vx + y * vy), x * x + y * y,
+                                              threshold, horizontal_margin));
+    }
+    for (double threshold : {constants::MIN_VERTICAL_SEPARATION, 2.0 * constants::MIN_VERTICAL_SEPARATION}) {
+        next = std::min(next, verticalEntry(z, vz, threshold, vertical_margin));
+    }
+
+    // The closest approach comes into the lookahead window. Slower than the
+    // detector's parallel-track cutoff it is taken as now, which never changes.
+    if (closing >= 1e-6) {
+        double entry = -(x * vx + y * vy) / closing - lookahead_;
+        double slack = drift / std::sqrt(closing);
+        if (entry + slack > 0.0) {
+            next = std::min(next, std::max(0.0, entry - slack));
+        }
+    }
+    return now_ + next;
+}
+
+uint32_t KineticSchedule::acquire(const std::string& callsign) {
+    uint32_t slot;
+    if (free_slots_.empty()) {
+        slot = static_cast<uint32_t>(slots_.size());
+        slots_.emplace_back();
+    } else {
+        slot = free_slots_.back();
+        free_slots_.pop_back();
+    }
+    slots_[slot].callsign = callsign;
+    slots_[slot].live = true;
+    return slot;
+}
+
+void KineticSchedule::release(uint32_t slot) {
+    for (uint32_t other = 0; other < slots_.size(); ++other) {
+        if (other != slot && slots_[other].live) {
+            generations_.erase(pairKey(slot, other));
+        }
+    }
+    by_callsign_.erase(slots_[slot].callsign);
+    slots_[slot].live = false;
+    free_slots_.push_back(slot);
+}
+
+void KineticSchedule::addDue(uint32_t first, uint32_t second) {
+    size_t index1 = slots_[first].index;
+    size_t index2 = slots_[second].index;
+    due_.emplace_back(std::min(index1, index2), std::max(index1, index2));
+}
+
+void PairCertificates::certify(size_t first, size_t second, const Track& track1, const Track& track2) {
+    if (std::abs(track1.time - track2.time) > constants::CERTIFICATE_MAX_REPORT_SKEW) return;
+    const AircraftState& state1 = *track1.state;
+    const AircraftState& state2 = *track2.state;
+
+    // Relative position of the two lines at the later report, and relative velocity
+    double time = std::max(track1.time, track2.time);
+    double elapsed1 = time - track1.time;
+    double elapsed2 = time - track2.time;
+    double x = (state2.position.x + state2.velocity.vx * elapsed2) - (state1.position.x + state1.velocity.vx * elapsed1);
+    double y = (state2.position.y + state2.velocity.vy * elapsed2) - (state1.position.y + state1.velocity.vy * elapsed1);
+    double z = (state2.position.z + state2.velocity.vz * elapsed2) - (state1.position.z + state1.velocity.vz * elapsed1);
+    double vx = state2.velocity.vx - state1.velocity.vx;
+    double vy = state2.velocity.vy - state1.velocity.vy;
+    double vz = state2.velocity.vz - state1.velocity.vz;
+
+    // Both reports now and later ones may be off the line either way, plus rounding;
+    // a later report may trail the other by the skew allowed
+    double skew = constants::CERTIFICATE_MAX_REPORT_SKEW;
+    double line = 4.0 * constants::VELOCITY_LINE_TOLERANCE + 1.0;
+    double horizontal_margin = line + skew * (std::hypot(state1.velocity.vx, state1.velocity.vy) +
+                                              std::hypot(state2.velocity.vx, state2.velocity.vy));
+    double vertical_margin = line + skew * (std::abs(state1.velocity.vz) + std::abs(state2.velocity.vz));
+
+    double a = vx * vx + vy * vy;
+    double b = 2.0 * (x * vx + y * vy);
+    double c = x * x + y * y;
+    double horizontal = std::sqrt(c);
+    double vertical = std::abs(z);
+    double minimum_horizontal = constants::MIN_HORIZONTAL_SEPARATION;
+    double minimum_vertical = constants::MIN_VERTICAL_SEPARATION;
+
+    // The thresholds the pair must stay on the same side of
+    bool level = horizontal > minimum_horizontal + horizontal_margin && vertical < minimum_vertical - vertical_margin;
+    bool stacked = horizontal < minimum_horizontal - horizontal_margin && vertical > minimum_vertical + vertical_margin;
+    double scale;
+    if (level || stacked) {
+        scale = 1.0;
+    } else if (horizontal > 2.0 * minimum_horizontal + horizontal_margin &&
+               vertical > 2.0 * minimum_vertical + vertical_margin) {
+        scale = 2.0;    // outside the warning range
+    } else {
+        return;
+    }
+    double until = time + std::min(horizontalEntry(a, b, c, scale * minimum_horizontal, horizontal_margin),
+                                   verticalEntry(z, vz, scale * minimum_vertical, vertical_margin));
+
+    certificates_(first, second) = {track1.velocity_version, track2.velocity_version, until};
+}
+
+}
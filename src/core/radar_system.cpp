@@ -1,6 +1,9 @@
 #include "core/radar_system.h"
 #include "common/logger.h"
+#include "common/metrics.h"
+#include "common/perf_counters.h"
 #include "common/constants.h"
+#include "common/sim_clock.h"
 #include <sstream>
 #include <iomanip>
 #include <cmath>
@@ -10,43 +13,63 @@
 
 namespace atc {
 
+namespace {
+LogEvent primary_scans("primary radar scans", LogLevel::DEBUG);
+LogEvent secondary_interrogations("secondary radar interrogations", LogLevel::DEBUG);
+LogEvent track_updates("radar track updates", LogLevel::DEBUG);
+
+metrics::Counter radar_track_updates("atc_radar_track_updates_total", "Radar track table updates");
+
+// Matching returns and replies to tracks in both scans
+PerfKernel radar_association("radar_association");
+}
+
 RadarSystem::RadarSystem(std::shared_ptr<comm::QnxChannel> channel)
     : PeriodicTask(std::chrono::milliseconds(SSR_INTERROGATION_INTERVAL),
                    constants::RADAR_PRIORITY)
     , channel_(channel)
-    , last_primary_scan_(std::chrono::steady_clock::now())
-    , last_secondary_scan_(std::chrono::steady_clock::now()) {
+    , last_primary_scan_(sim_clock::steadyNow())
+    , last_secondary_scan_(sim_clock::steadyNow()) {
 
-    Logger::getInstance().log("Radar system initialized");
+    ATC_LOG_INFO("Radar system initialized");
 }
 
 void RadarSystem::addAircraft(const std::shared_ptr<Aircraft>& aircraft) {
     std::lock_guard<std::mutex> lock(radar_mutex_);
-    aircraft_.push_back(aircraft);
-    Logger::getInstance().log("Added aircraft to radar tracking: " +
-                            aircraft->getState().callsign);
+    aircraft_.add(aircraft);
+    ATC_LOG_INFO("Added aircraft to radar tracking: " +
+                 aircraft->getCallsign());
 }
 
 void RadarSystem::removeAircraft(const std::string& callsign) {
     std::lock_guard<std::mutex> lock(radar_mutex_);
 
     // Remove from tracked aircraft
-    aircraft_.erase(
-        std::remove_if(aircraft_.begin(), aircraft_.end(),
-            [&callsign](const auto& aircraft) {
-                return aircraft->getState().callsign == callsign;
-            }),
-        aircraft_.end()
-    );
+    aircraft_.remove(callsign);
 
     // Remove from tracks
     if (tracks_.erase(callsign) > 0) {
-        Logger::getInstance().log("Removed aircraft from radar tracking: " + callsign);
+        ATC_LOG_INFO("Removed aircraft from radar tracking: " + callsign);
+    }
+}
+
+void RadarSystem::addAircraft(const std::vector<std::shared_ptr<Aircraft>>& aircraft) {
+    std::lock_guard<std::mutex> lock(radar_mutex_);
+    for (const auto& entry : aircraft) {
+        aircraft_.add(entry);
+    }
+}
+
+void RadarSystem::removeAircraft(const std::vector<std::string>& callsigns) {
+    std::lock_guard<std::mutex> lock(radar_mutex_);
+    for (const auto& callsign : callsigns) {
+        aircraft_.remove(callsign);
+        tracks_.erase(callsign);
     }
 }
 
 void RadarSystem::execute() {
-    auto now = std::chrono::steady_clock::now();
+    auto now = sim_clock::steadyNow();
 
     // Perform primary radar scan every PSR_SCAN_INTERVAL
     if (std::chrono::duration_cast<std::chrono::milliseconds>(
@@ -68,6 +91,7 @@ void RadarSystem::execute() {
 
 void RadarSystem::performPrimaryScan() {
     std::lock_guard<std::mutex> lock(radar_mutex_);
+    PerfScope perf(radar_association);
     primary_scan_count_++;
 
     for (const auto& aircraft : aircraft_) {
@@ -84,21 +108,21 @@ void RadarSystem::performPrimaryScan() {
             if (validateRadarReturn(detected_pos)) {
                 auto& track = tracks_[state.callsign];
                 track.state.position = detected_pos;
-                track.last_update = std::chrono::steady_clock::now();
+                track.last_update = sim_clock::steadyNow();
                 track.track_quality = std::min(100, track.track_quality + 10);
             }
         } catch (const std::exception& e) {
-            Logger::getInstance().log("Error in primary radar scan: " +
-                                    std::string(e.what()));
+            ATC_LOG_ERROR("Error in primary radar scan: " +
+                          std::string(e.what()));
         }
     }
 
-    Logger::getInstance().log("Completed primary radar scan #" +
-                            std::to_string(primary_scan_count_));
+    primary_scans.record();
 }
 
 void RadarSystem::performSecondaryInterrogation() {
     std::lock_guard<std::mutex> lock(radar_mutex_);
+    PerfScope perf(radar_association);
     secondary_scan_count_++;
 
     for (const auto& aircraft : aircraft_) {
@@ -109,13 +133,14 @@ void RadarSystem::performSecondaryInterrogation() {
             // Update track with precise information from transponder
             track.state = state;
             track.has_transponder_response = true;
-            track.last_update = std::chrono::steady_clock::now();
+            track.last_update = sim_clock::steadyNow();
             track.track_quality = 100;  // Full confidence with transponder data
         } catch (const std::exception& e) {
-            Logger::getInstance().log("Error in secondary radar interrogation: " +
-                                    std::string(e.what()));
+            ATC_LOG_ERROR("Error in secondary radar interrogation: " +
+                          std::string(e.what()));
         }
     }
+    secondary_interrogations.record();
 
     // Send radar update message through communication channel
     if (channel_) {
@@ -130,9 +155,10 @@ void RadarSystem::performSecondaryInterrogation() {
 void RadarSystem::updateTracks() {
     std::lock_guard<std::mutex> lock(radar_mutex_);
     track_updates_++;
+    radar_track_updates.increment();
 
     for (auto& [callsign, track] : tracks_) {
-        auto now = std::chrono::steady_clock::now();
+        auto now = sim_clock::steadyNow();
         auto age = std::chrono::duration_cast<std::chrono::milliseconds>(
             now - track.last_update).count();
 
@@ -142,14 +168,15 @@ void RadarSystem::updateTracks() {
         }
     }
 
-    if (track_updates_ % 10 == 0) {  // Log every 10th update
+    // Full track table once per reporting interval
+    if (track_updates.record()) {
         logTrackUpdates();
     }
 }
 
 void RadarSystem::cleanupStaleTracks() {
     std::lock_guard<std::mutex> lock(radar_mutex_);
-    auto now = std::chrono::steady_clock::now();
+    auto now = sim_clock::steadyNow();
 
     auto it = tracks_.begin();
     while (it != tracks_.end()) {
@@ -157,7 +184,7 @@ void RadarSystem::cleanupStaleTracks() {
             now - it->second.last_update).count();
 
         if (age > MAX_TRACK_AGE_MS || it->second.track_quality < MIN_TRACK_QUALITY) {
-            Logger::getInstance().log("Removing stale track: " + it->first);
+            ATC_LOG_WARNING("Removing stale track: " + it->first);
             it = tracks_.erase(it);
         } else {
             ++it;
@@ -171,6 +198,8 @@ bool RadarSystem::validateRadarReturn(const Position& pos) const {
 }
 
 void RadarSystem::logTrackUpdates() const {
+    if (!ATC_LOG_ENABLED(DEBUG)) return;
+
     std::ostringstream oss;
     oss << "\n=== Radar Track Update #" << track_updates_ << " ===\n"
         << "Active Tracks: " << tracks_.size() << "\n"
@@ -190,7 +219,7 @@ void RadarSystem::logTrackUpdates() const {
             << "\n";
     }
 
-    Logger::getInstance().log(oss.str());
+    ATC_LOG_DEBUG(oss.str());
 }
 
 std::vector<AircraftState> RadarSystem::getTrackedAircraft() const {
@@ -0,0 +1,204 @@
+#include "core/reference_detector.h"
+#include "common/constants.h"
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+namespace atc {
+namespace reference {
+
+namespace {
+
+// ViolationDetector's warning range, as a multiple of the minimum separation
+constexpr double WARNING_RANGE = 2.0;
+
+// The segment flown at `time`: the last one started by then, or the first
+const Trajectory::Segment& segmentAt(const Trajectory& trajectory, double time) {
+    const auto& segments = trajectory.segments();
+    size_t index = 0;
+    for (size_t i = 0; i < segments.size(); ++i) {
+        if (segments[i].start <= time) {
+            index = i;
+        }
+    }
+    return segments[index];
+}
+
+Position positionAt(const Trajectory& trajectory, double time) {
+    const auto& segment = segmentAt(trajectory, time);
+    double elapsed = time - segment.start;
+    return Position{segment.position.x + segment.velocity.vx * elapsed,
+                    segment.position.y + segment.velocity.vy * elapsed,
+                    segment.position.z + segment.velocity.vz * elapsed};
+}
+
+ViolationDetector::ViolationPrediction predict(const Flight& flight1, const Flight& flight2,
+                                               double now, double lookahead) {
+    ViolationDetector::ViolationPrediction prediction;
+    prediction.aircraft1_id = flight1.state.callsign;
+    prediction.aircraft2_id = flight2.state.callsign;
+
+    auto approach = reference::closestApproach(flight1.trajectory, flight2.trajectory, now, now + lookahead);
+    prediction.time_to_violation = approach.time - now;
+    prediction.min_separation = approach.distance;
+
+    Position position1 = positionAt(flight1.trajectory, approach.time);
+    Position position2 = positionAt(flight2.trajectory, approach.time);
+    prediction.conflict_point = {(position1.x + position2.x) / 2,
+                                 (position1.y + position2.y) / 2,
+                                 (position1.z + position2.z) / 2};
+    return prediction;
+}
+
+ViolationInfo violationBetween(const AircraftState& state1, const AircraftState& state2) {
+    ViolationInfo violation;
+    violation.aircraft1_id = state1.callsign;
+    violation.aircraft2_id = state2.callsign;
+    violation.horizontal_separation = std::hypot(state1.position.x - state2.position.x,
+                                                 state1.position.y - state2.position.y);
+    violation.vertical_separation = std::abs(state1.position.z - state2.position.z);
+    violation.is_predicted = false;
+    violation.prediction_time = 0;
+    violation.timestamp = state1.timestamp;
+    return violation;
+}
+
+// The pair in callsign order, as the detector reports it
+std::pair<const Flight&, const Flight&> inCallsignOrder(const Flight& a, const Flight& b) {
+    if (b.state.callsign < a.state.callsign) return {b, a};
+    return {a, b};
+}
+
+} // namespace
+
+std::vector<Flight> snapshot(const std::vector<std::shared_ptr<Aircraft>>& aircraft) {
+    std::vector<Flight> flights;
+    for (const auto& entry : aircraft) {
+        AircraftState state;
+        RouteProgress progress = entry->getRouteProgress(state);
+        Trajectory trajectory = progress.route ? Trajectory::alongRoute(state, progress)
+                                               : Trajectory::straight(state);
+        flights.push_back({state, trajectory});
+    }
+    return flights;
+}
+
+ClosestApproach closestApproach(const Trajectory& a, const Trajectory& b, double from, double until) {
+    until = std::max(until, from);
+
+    // Between these times both aircraft fly straight, so their distance apart
+    // is the square root of a quadratic with one minimum
+    std::vector<double> times = {from, until};
+    for (const auto* trajectory : {&a, &b}) {
+        for (const auto& segment : trajectory->segments()) {
+            if (segment.start > from && segment.start < until) {
+                times.push_back(segment.start);
+            }
+        }
+    }
+    std::sort(times.begin(), times.end());
+    times.erase(std::unique(times.begin(), times.end()), times.end());
+    if (times.size() == 1) {
+        times.push_back(until);
+    }
+
+    ClosestApproach best{from, std::numeric_limits<double>::infinity()};
+    for (size_t k = 0; k + 1 < times.size(); ++k) {
+        double start = times[k];
+        double length = times[k + 1] - start;
+        Position position_a = positionAt(a, start);
+        Position position_b = positionAt(b, start);
+        const Velocity& velocity_a = segmentAt(a, start).velocity;
+        const Velocity& velocity_b = segmentAt(b, start).velocity;
+
+        double x = position_b.x - position_a.x;
+        double y = position_b.y - position_a.y;
+        double vx = velocity_b.vx - velocity_a.vx;
+        double vy = velocity_b.vy - velocity_a.vy;
+        double speed_squared = vx * vx + vy * vy;
+
+        double time = 0.0;
+        if (speed_squared > 0.0) {
+            time = std::min(std::max(-(x * vx + y * vy) / speed_squared, 0.0), length);
+        }
+        double distance = std::hypot(x + vx * time, y + vy * time);
+        if (distance < best.distance) {
+            best = {start + time, distance};
+        }
+    }
+    return best;
+}
+
+std::vector<ViolationDetector::PairConflict> findConflicts(const std::vector<Flight>& flights,
+                                                           double now, double lookahead) {
+    std::vector<ViolationDetector::PairConflict> conflicts;
+    for (size_t i = 0; i < flights.size(); ++i) {
+        for (size_t j = i + 1; j < flights.size(); ++j) {
+            auto [flight1, flight2] = inCallsignOrder(flights[i], flights[j]);
+            const AircraftState& state1 = flight1.state;
+            const AircraftState& state2 = flight2.state;
+
+            ViolationDetector::PairConflict conflict;
+            conflict.horizontal_separation = std::hypot(state1.position.x - state2.position.x,
+                                                        state1.position.y - state2.position.y);
+            conflict.vertical_separation = std::abs(state1.position.z - state2.position.z);
+            double horizontal = conflict.horizontal_separation / constants::MIN_HORIZONTAL_SEPARATION;
+            double vertical = conflict.vertical_separation / constants::MIN_VERTICAL_SEPARATION;
+
+            // Far enough apart either way
+            if (horizontal >= WARNING_RANGE && vertical >= WARNING_RANGE) continue;
+
+            if (horizontal < 1.0 || vertical < 1.0) {
+                // Within the minimum one way: a violation only if within it both ways
+                if (horizontal >= 1.0 || vertical >= 1.0) continue;
+                conflict.kind = ConflictKind::VIOLATION;
+                conflict.violation = violationBetween(state1, state2);
+            } else {
+                // Closest approach inside the lookahead window, whatever its distance
+                conflict.prediction = predict(flight1, flight2, now, lookahead);
+                if (conflict.prediction.time_to_violation >= lookahead) continue;
+                conflict.kind = ConflictKind::CRITICAL_WARNING;
+            }
+            conflicts.push_back(conflict);
+        }
+    }
+    return conflicts;
+}
+
+std::vector<ViolationInfo> currentViolations(const std::vector<Flight>& flights) {
+    std::vector<ViolationInfo> violations;
+    for (size_t i = 0; i < flights.size(); ++i) {
+        for (size_t j = i + 1; j < flights.size(); ++j) {
+            auto [flight1, flight2] = inCallsignOrder(flights[i], flights[j]);
+            auto violation = violationBetween(flight1.state, flight2.state);
+            if (violation.horizontal_separation < constants::MIN_HORIZONTAL_SEPARATION &&
+                violation.vertical_separation < constants::MIN_VERTICAL_SEPARATION) {
+                violations.push_back(violation);
+            }
+        }
+    }
+    std::sort(violations.begin(), violations.end(), [](const ViolationInfo& a, const ViolationInfo& b) {
+        return a.aircraft1_id != b.aircraft1_id ? a.aircraft1_id < b.aircraft1_id
+                                                : a.aircraft2_id < b.aircraft2_id;
+    });
+    return violations;
+}
+
+std::vector<ViolationDetector::ViolationPrediction> predictedViolations(
+    const std::vector<Flight>& flights, double now, double lookahead) {
+    std::vector<ViolationDetector::ViolationPrediction> predictions;
+    for (size_t i = 0; i < flights.size(); ++i) {
+        for (size_t j = i + 1; j < flights.size(); ++j) {
+            auto [flight1, flight2] = inCallsignOrder(flights[i], flights[j]);
+            auto prediction = predict(flight1, flight2, now, lookahead);
+            if (prediction.time_to_violation < lookahead &&
+                prediction.min_separation < constants::MIN_HORIZONTAL_SEPARATION * WARNING_RANGE) {
+                predictions.push_back(prediction);
+            }
+        }
+    }
+    return predictions;
+}
+
+} // namespace reference
+} // namespace atc
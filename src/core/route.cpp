@@ -0,0 +1,239 @@
+#include "core/route.h"
+#include "common/constants.h"
+#include <algorithm>
+#include <cmath>
+
+namespace atc {
+
+namespace {
+
+constexpr double NEVER = std::numeric_limits<double>::infinity();
+constexpr double ARRIVAL_DISTANCE = 1e-3;   // closer than this is at the fix
+constexpr double LEVEL_TOLERANCE = 1e-3;    // closer than this is at the level
+
+// One constant-velocity piece of the route model
+struct Leg {
+    Velocity velocity;
+    double duration;      // until the fix or the level-off, NEVER if neither comes
+    bool reaches_fix;
+    bool levels_off;
+    Position fix;
+    double target_altitude;
+};
+
+// The leg flown from `at`, skipping fixes already reached
+Leg nextLeg(const Position& at, const Velocity& current, RouteProgress& progress) {
+    const Route& route = *progress.route;
+    double speed = std::hypot(current.vx, current.vy);
+    Leg leg{current, NEVER, false, false, at, at.z};
+
+    while (progress.next_waypoint < route.waypoints.size()) {
+        leg.fix = route.fixes->position(route.waypoints[progress.next_waypoint]);
+        if (std::hypot(leg.fix.x - at.x, leg.fix.y - at.y) > ARRIVAL_DISTANCE) break;
+        ++progress.next_waypoint;
+    }
+
+    if (progress.next_waypoint < route.waypoints.size()) {
+        double dx = leg.fix.x - at.x;
+        double dy = leg.fix.y - at.y;
+        double distance = std::hypot(dx, dy);
+        leg.velocity.vx = dx / distance * speed;
+        leg.velocity.vy = dy / distance * speed;
+        if (speed > 0.0) {
+            leg.duration = distance / speed;
+            leg.reaches_fix = true;
+        }
+        leg.target_altitude = leg.fix.z;
+    } else if (!route.waypoints.empty()) {
+        leg.target_altitude = route.fixes->position(route.waypoints.back()).z;
+    }
+    if (!std::isnan(progress.cleared_altitude)) {
+        leg.target_altitude = progress.cleared_altitude;
+    }
+
+    double climb = leg.target_altitude - at.z;
+    leg.velocity.vz = 0.0;
+    if (std::abs(climb) > LEVEL_TOLERANCE) {
+        leg.velocity.vz = std::copysign(constants::ROUTE_CLIMB_RATE, climb);
+        double to_level = std::abs(climb) / constants::ROUTE_CLIMB_RATE;
+        if (to_level <= leg.duration) {
+            leg.reaches_fix = leg.reaches_fix && to_level == leg.duration;
+            leg.duration = to_level;
+            leg.levels_off = true;
+        }
+    }
+    return leg;
+}
+
+// Position after flying `time` seconds of the leg, landing exactly on the fix
+// and level when the leg is flown to its end
+Position advance(const Position& at, const Leg& leg, double time) {
+    Position next{at.x + leg.velocity.vx * time,
+                  at.y + leg.velocity.vy * time,
+                  at.z + leg.velocity.vz * time};
+    if (time >= leg.duration) {
+        if (leg.reaches_fix) {
+            next.x = leg.fix.x;
+            next.y = leg.fix.y;
+        }
+        if (leg.levels_off) {
+            next.z = leg.target_altitude;
+        }
+    }
+    return next;
+}
+
+// Each fix ends one leg and may split it with one level-off; plus the final leg
+size_t maxLegs(const RouteProgress& progress) {
+    return 2 * progress.route->waypoints.size() + 4;
+}
+
+}
+
+FixId FixDatabase::intern(const Position& position) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto key = std::make_tuple(position.x, position.y, position.z);
+    auto it = index_.find(key);
+    if (it != index_.end()) {
+        return it->second;
+    }
+    FixId id = static_cast<FixId>(fixes_.size());
+    fixes_.push_back(position);
+    index_.emplace(key, id);
+    return id;
+}
+
+Position FixDatabase::position(FixId id) const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return fixes_.at(id);
+}
+
+size_t FixDatabase::size() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return fixes_.size();
+}
+
+Trajectory Trajectory::straight(const AircraftState& state) {
+    Trajectory trajectory;
+    trajectory.segments_.push_back({state.timestamp / 1000.0, state.position, state.velocity});
+    return trajectory;
+}
+
+Trajectory Trajectory::alongRoute(const AircraftState& state, RouteProgress progress) {
+    Trajectory trajectory;
+    double time = state.timestamp / 1000.0;
+    Position at = state.position;
+    Velocity velocity = state.velocity;
+
+    for (size_t legs = maxLegs(progress); legs > 0; --legs) {
+        Leg leg = nextLeg(at, velocity, progress);
+        trajectory.segments_.push_back({time, at, leg.velocity});
+        if (leg.duration == NEVER) break;
+        at = advance(at, leg, leg.duration);
+        velocity = leg.velocity;
+        time += leg.duration;
+    }
+    return trajectory;
+}
+
+Position Trajectory::positionAt(double time) const {
+    auto it = std::upper_bound(segments_.begin(), segments_.end(), time,
+        [](double t, const Segment& segment) { return t < segment.start; });
+    const Segment& segment = it == segments_.begin() ? *it : *(it - 1);
+    double elapsed = time - segment.start;
+    return Position{segment.position.x + segment.velocity.vx * elapsed,
+                    segment.position.y + segment.velocity.vy * elapsed,
+                    segment.position.z + segment.velocity.vz * elapsed};
+}
+
+std::shared_ptr<const Trajectory> TrajectoryCache::get(const AircraftState& state,
+                                                       const RouteProgress& progress,
+                                                       bool* rebuilt) {
+    auto it = entries_.find(state.callsign);
+    if (it != entries_.end() && it->second.intent_version == progress.intent_version) {
+        const Trajectory& cached = *it->second.trajectory;
+        // Mirrored tracks change velocity without a new intent version
+        bool same_velocity = progress.route ||
+            (cached.segments()[0].velocity.vx == state.velocity.vx &&
+             cached.segments()[0].velocity.vy == state.velocity.vy &&
+             cached.segments()[0].velocity.vz == state.velocity.vz);
+        Position expected = cached.positionAt(state.timestamp / 1000.0);
+        if (same_velocity &&
+            std::hypot(expected.x - state.position.x, expected.y - state.position.y) <=
+                constants::ROUTE_CONFORMANCE_TOLERANCE &&
+            std::abs(expected.z - state.position.z) <= constants::ROUTE_CONFORMANCE_TOLERANCE) {
+            if (rebuilt) *rebuilt = false;
+            return it->second.trajectory;
+        }
+    }
+
+    auto trajectory = std::make_shared<const Trajectory>(
+        progress.route ? Trajectory::alongRoute(state, progress) : Trajectory::straight(state));
+    entries_[state.callsign] = {progress.intent_version, trajectory};
+    if (rebuilt) *rebuilt = true;
+    return trajectory;
+}
+
+double Trajectory::timeOver(const Position& point) const {
+    // Fixes are flown exactly, so a route passing over one starts a segment there
+    for (const auto& segment : segments_) {
+        if (std::hypot(segment.position.x - point.x, segment.position.y - point.y) <= ARRIVAL_DISTANCE) {
+            return segment.start;
+        }
+    }
+    return NEVER;
+}
+
+void flyRoute(AircraftState& state, RouteProgress& progress, double dt) {
+    double remaining = dt;
+    for (size_t legs = maxLegs(progress); remaining > 0.0 && legs > 0; --legs) {
+        Leg leg = nextLeg(state.position, state.velocity, progress);
+        double step = std::min(remaining, leg.duration);
+        state.position = advance(state.position, leg, step);
+        state.velocity = leg.velocity;
+        remaining -= step;
+    }
+    state.updateHeading();
+}
+
+ClosestApproach closestApproach(const Trajectory& a, const Trajectory& b,
+                                double from, double until) {
+    const auto& segments_a = a.segments();
+    const auto& segments_b = b.segments();
+    size_t i = 0;
+    size_t j = 0;
+    ClosestApproach best{from, NEVER};
+    until = std::max(until, from);
+
+    // Relative motion is linear between consecutive segment starts of either trajectory
+    for (double start = from; ; ) {
+        while (i + 1 < segments_a.size() && segments_a[i + 1].start <= start) ++i;
+        while (j + 1 < segments_b.size() && segments_b[j + 1].start <= start) ++j;
+        double end = until;
+        if (i + 1 < segments_a.size()) end = std::min(end, segments_a[i + 1].start);
+        if (j + 1 < segments_b.size()) end = std::min(end, segments_b[j + 1].start);
+
+        Position position_a = a.positionAt(start);
+        Position position_b = b.positionAt(start);
+        double dx = position_b.x - position_a.x;
+        double dy = position_b.y - position_a.y;
+        double dvx = segments_b[j].velocity.vx - segments_a[i].velocity.vx;
+        double dvy = segments_b[j].velocity.vy - segments_a[i].velocity.vy;
+
+        double closing = dvx * dvx + dvy * dvy;
+        double time = 0.0;
+        if (closing >= 1e-6) {  // otherwise parallel tracks
+            time = std::clamp(-(dx * dvx + dy * dvy) / closing, 0.0, end - start);
+        }
+        double distance = std::hypot(dx + dvx * time, dy + dvy * time);
+        if (distance < best.distance) {
+            best = {start + time, distance};
+        }
+
+        if (end >= until) break;
+        start = end;
+    }
+    return best;
+}
+
+}
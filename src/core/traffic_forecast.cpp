@@ -0,0 +1,152 @@
+#include "core/traffic_forecast.h"
+#include "common/constants.h"
+#include "common/history_rollup.h"
+#include <algorithm>
+#include <cmath>
+
+namespace atc {
+
+namespace {
+// Trajectories are sampled this often within a bin; an aircraft at 500 units/s
+// moves a fifth of a 25,000 unit sector between samples
+constexpr double SAMPLE_SECONDS = 5.0;
+}
+
+TrafficForecast::TrafficForecast(size_t bins, double bin_seconds, uint32_t capacity)
+    : bins_(bins)
+    , bin_seconds_(bin_seconds)
+    , capacity_(capacity)
+    , sectors_(history::sectorCount())
+    , counts_(bins * sectors_, 0)
+    , reported_(bins * sectors_, false) {}
+
+size_t TrafficForecast::slotOf(int64_t bin, uint32_t sector) const {
+    return static_cast<size_t>(bin % static_cast<int64_t>(bins_)) * sectors_ + sector;
+}
+
+void TrafficForecast::advance(double now) {
+    int64_t target = static_cast<int64_t>(std::floor(now / bin_seconds_));
+    if (started_ && target <= first_bin_) return;
+
+    // First call, or the window moved past everything it held: start it afresh
+    if (!started_ || target - first_bin_ >= static_cast<int64_t>(bins_)) {
+        started_ = true;
+        first_bin_ = target;
+        std::fill(counts_.begin(), counts_.end(), 0);
+        std::fill(reported_.begin(), reported_.end(), false);
+        for (auto& entry : aircraft_) {
+            entry.second.cells.clear();
+            for (size_t bin = 0; bin < bins_; ++bin) {
+                addBin(entry.second, first_bin_ + static_cast<int64_t>(bin));
+            }
+        }
+        return;
+    }
+
+    while (first_bin_ < target) {
+        clearBin(first_bin_);
+        ++first_bin_;
+        int64_t newest = first_bin_ + static_cast<int64_t>(bins_) - 1;
+        for (auto& entry : aircraft_) {
+            auto& cells = entry.second.cells;
+            while (!cells.empty() && cells.front().bin < first_bin_) {
+                cells.pop_front();
+            }
+            addBin(entry.second, newest);
+        }
+    }
+}
+
+void TrafficForecast::update(const std::string& callsign,
+                             const std::shared_ptr<const Trajectory>& trajectory) {
+    Footprint& footprint = aircraft_[callsign];
+    for (const auto& cell : footprint.cells) {
+        if (inWindow(cell.bin)) {
+            --counts_[slotOf(cell.bin, cell.sector)];
+        }
+    }
+    footprint.cells.clear();
+    footprint.trajectory = trajectory;
+
+    if (!started_) return;
+    for (size_t bin = 0; bin < bins_; ++bin) {
+        addBin(footprint, first_bin_ + static_cast<int64_t>(bin));
+    }
+}
+
+void TrafficForecast::remove(const std::string& callsign) {
+    auto it = aircraft_.find(callsign);
+    if (it == aircraft_.end()) return;
+    for (const auto& cell : it->second.cells) {
+        if (inWindow(cell.bin)) {
+            --counts_[slotOf(cell.bin, cell.sector)];
+        }
+    }
+    aircraft_.erase(it);
+}
+
+void TrafficForecast::addBin(Footprint& footprint, int64_t bin) {
+    double start = static_cast<double>(bin) * bin_seconds_;
+    double end = start + bin_seconds_;
+    // Nothing is predicted before the trajectory's own start
+    double from = std::max(start, footprint.trajectory->segments().front().start);
+
+    std::vector<uint32_t> visited;
+    for (double time = from; time < end; time += SAMPLE_SECONDS) {
+        Position position = footprint.trajectory->positionAt(time);
+        if (position.x < constants::AIRSPACE_X_MIN || position.x > constants::AIRSPACE_X_MAX ||
+            position.y < constants::AIRSPACE_Y_MIN || position.y > constants::AIRSPACE_Y_MAX) {
+            continue;
+        }
+        uint32_t sector = history::sectorOf(position.x, position.y);
+        if (std::find(visited.begin(), visited.end(), sector) == visited.end()) {
+            visited.push_back(sector);
+        }
+    }
+
+    for (uint32_t sector : visited) {
+        footprint.cells.push_back({bin, sector});
+        size_t slot = slotOf(bin, sector);
+        if (++counts_[slot] > capacity_ && !reported_[slot]) {
+            reported_[slot] = true;
+            overloads_.push_back({bin, sector});
+        }
+    }
+}
+
+void TrafficForecast::clearBin(int64_t bin) {
+    size_t first = slotOf(bin, 0);
+    std::fill(counts_.begin() + first, counts_.begin() + first + sectors_, 0);
+    std::fill(reported_.begin() + first, reported_.begin() + first + sectors_, false);
+}
+
+uint32_t TrafficForecast::count(uint32_t sector, size_t bin) const {
+    if (!started_ || bin >= bins_ || sector >= sectors_) return 0;
+    return counts_[slotOf(first_bin_ + static_cast<int64_t>(bin), sector)];
+}
+
+std::vector<uint32_t> TrafficForecast::counts() const {
+    std::vector<uint32_t> window(bins_ * sectors_, 0);
+    if (!started_) return window;
+    for (size_t bin = 0; bin < bins_; ++bin) {
+        size_t first = slotOf(first_bin_ + static_cast<int64_t>(bin), 0);
+        std::copy(counts_.begin() + first, counts_.begin() + first + sectors_,
+                  window.begin() + bin * sectors_);
+    }
+    return window;
+}
+
+std::vector<TrafficForecast::Overload> TrafficForecast::takeOverloads() {
+    // Counted now rather than when capacity was crossed, so the whole batch shows
+    std::vector<Overload> overloads;
+    for (const auto& cell : overloads_) {
+        if (inWindow(cell.bin)) {
+            overloads.push_back({cell.sector, static_cast<double>(cell.bin) * bin_seconds_,
+                                 counts_[slotOf(cell.bin, cell.sector)]});
+        }
+    }
+    overloads_.clear();
+    return overloads;
+}
+
+}
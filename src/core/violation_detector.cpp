@@ -1,72 +1,179 @@
 #include "core/violation_detector.h"
 #include "common/constants.h"
 #include "common/logger.h"
+#include "common/metrics.h"
+#include "common/perf_counters.h"
+#include "common/sim_clock.h"
 #include <sstream>
 #include <iostream>
 #include <iomanip>
 #include <algorithm>
 #include <cmath>
+#include <cstring>
+#include <tuple>
 
 namespace atc {
 
+namespace {
+metrics::Histogram check_seconds("atc_violation_check_duration_seconds", "Time spent in a separation check pass",
+                                 metrics::Histogram::latencyBounds());
+metrics::Counter pairs_checked("atc_violation_pairs_checked_total", "Aircraft pairs examined by separation checks");
+metrics::Counter pairs_certified("atc_violation_pairs_certified_total",
+                                 "Aircraft pairs skipped under a divergence certificate");
+metrics::Counter pairs_deferred("atc_violation_pairs_deferred_total",
+                                "Aircraft pairs left for a later pass by the check budget");
+metrics::Gauge pair_coverage("atc_violation_pair_coverage_ratio",
+                             "Fraction of the pairs needing a check that the last pass checked");
+metrics::Gauge overdue_deferred("atc_violation_overdue_pairs_deferred",
+                                "Pairs past their refresh deadline that the last pass left unchecked");
+
+PerfKernel pair_detection("pair_detection");
+PerfKernel conflict_prediction("conflict_prediction");
+
+// Pairs checked between clock reads against the check budget
+constexpr size_t BUDGET_CLOCK_STRIDE = 16;
+
+// Pairs are reported in callsign order and results sorted by callsign, so
+// that they do not depend on the order aircraft joined in
+bool callsignsReversed(const AircraftState& first, const AircraftState& second) {
+    return second.callsign < first.callsign;
+}
+
+const std::string& firstCallsign(const ViolationDetector::PairConflict& conflict) {
+    return conflict.kind == ConflictKind::VIOLATION ? conflict.violation.aircraft1_id
+                                                    : conflict.prediction.aircraft1_id;
+}
+
+const std::string& secondCallsign(const ViolationDetector::PairConflict& conflict) {
+    return conflict.kind == ConflictKind::VIOLATION ? conflict.violation.aircraft2_id
+                                                    : conflict.prediction.aircraft2_id;
+}
+
+bool inCallsignOrder(const ViolationDetector::PairConflict& a, const ViolationDetector::PairConflict& b) {
+    return std::tie(firstCallsign(a), secondCallsign(a)) < std::tie(firstCallsign(b), secondCallsign(b));
+}
+
+// How long a pair found clear can wait for its next check under a budget:
+// until its straight-line closest approach, and no longer than the lookahead
+double refreshSlack(const AircraftState& state1, const AircraftState& state2, double lookahead) {
+    double x = state2.position.x - state1.position.x;
+    double y = state2.position.y - state1.position.y;
+    double vx = state2.velocity.vx - state1.velocity.vx;
+    double vy = state2.velocity.vy - state1.velocity.vy;
+    double closing = vx * vx + vy * vy;
+    double time = closing > 0.0 ? -(x * vx + y * vy) / closing : lookahead;
+    return time > 0.0 ? std::min(time, lookahead) : lookahead;
+}
+}
+
 ViolationDetector::ViolationDetector()
     : PeriodicTask(std::chrono::milliseconds(constants::VIOLATION_CHECK_INTERVAL),
                    constants::VIOLATION_CHECK_PRIORITY)
     , lookahead_time_seconds_(constants::DEFAULT_LOOKAHEAD_TIME) {
-    Logger::getInstance().log("Violation detector initialized with lookahead time: " +
-                            std::to_string(lookahead_time_seconds_) + " seconds");
+    ATC_LOG_INFO("Violation detector initialized with lookahead time: " +
+                 std::to_string(lookahead_time_seconds_) + " seconds");
 }
 
 void ViolationDetector::addAircraft(const std::shared_ptr<Aircraft>& aircraft) {
     std::lock_guard<std::mutex> lock(mutex_);
-    aircraft_.push_back(aircraft);
+    aircraft_.add(aircraft);
 }
 
 void ViolationDetector::removeAircraft(const std::string& callsign) {
     std::lock_guard<std::mutex> lock(mutex_);
-    aircraft_.erase(
-        std::remove_if(aircraft_.begin(), aircraft_.end(),
-            [&callsign](const auto& aircraft) {
-                return aircraft->getState().callsign == callsign;
-            }),
-        aircraft_.end());
+    aircraft_.remove(callsign);
+    trajectories_.erase(callsign);
+}
+
+void ViolationDetector::addAircraft(const std::vector<std::shared_ptr<Aircraft>>& aircraft) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    for (const auto& entry : aircraft) {
+        aircraft_.add(entry);
+    }
+}
+
+void ViolationDetector::removeAircraft(const std::vector<std::string>& callsigns) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    for (const auto& callsign : callsigns) {
+        aircraft_.remove(callsign);
+        trajectories_.erase(callsign);
+    }
 }
 
 void ViolationDetector::setLookaheadTime(int seconds) {
     if (seconds > 0 && seconds <= constants::MAX_LOOKAHEAD_TIME) {
         lookahead_time_seconds_ = seconds;
-        Logger::getInstance().log("Lookahead time set to: " + std::to_string(seconds) + " seconds");
+        ATC_LOG_INFO("Lookahead time set to: " + std::to_string(seconds) + " seconds");
     } else {
-        Logger::getInstance().log("Invalid lookahead time: " + std::to_string(seconds));
+        ATC_LOG_WARNING("Invalid lookahead time: " + std::to_string(seconds));
     }
 }
 
-bool ViolationDetector::canIssueWarning(const std::string& ac1, const std::string& ac2) {
-    std::time_t now = std::time(nullptr);
+void ViolationDetector::setConflictLog(const std::shared_ptr<ConflictLog>& log) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    conflict_log_ = log;
+}
+
+void ViolationDetector::setKinetic(bool enabled) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    kinetic_ = enabled ? std::make_unique<KineticSchedule>() : nullptr;
+    ATC_LOG_INFO(std::string("Kinetic conflict detection ") + (enabled ? "enabled" : "disabled"));
+}
+
+void ViolationDetector::setCertificates(bool enabled) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    certify_ = enabled;
+    certificates_.clear();
+    ATC_LOG_INFO(std::string("Divergence certificates ") + (enabled ? "enabled" : "disabled"));
+}
+
+void ViolationDetector::setCheckBudget(std::chrono::nanoseconds budget) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    check_budget_ = budget;
+    deadlines_.clear();
+    ATC_LOG_INFO("Separation check budget: " +
+                 (budget.count() > 0 ? std::to_string(budget.count() / 1000.0) + " us per pass" : std::string("none")));
+}
+
+ViolationDetector::Coverage ViolationDetector::getLastCoverage() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return coverage_;
+}
+
+bool ViolationDetector::canIssueWarning(const std::string& ac1, const std::string& ac2) const {
+    std::time_t now = std::chrono::system_clock::to_time_t(sim_clock::systemNow());
 
     // Always keep aircraft IDs in consistent order
     std::string first_ac = std::min(ac1, ac2);
     std::string second_ac = std::max(ac1, ac2);
 
+    auto it = std::find_if(warnings_.begin(), warnings_.end(),
+        [&first_ac, &second_ac](const WarningRecord& record) {
+            return record.aircraft1 == first_ac && record.aircraft2 == second_ac;
+        });
+
+    return it == warnings_.end() || std::difftime(now, it->last_warning) >= WARNING_COOLDOWN;
+}
+
+void ViolationDetector::updateWarning(const std::string& ac1, const std::string& ac2) {
+    std::time_t now = std::chrono::system_clock::to_time_t(sim_clock::systemNow());
+    std::string first_ac = std::min(ac1, ac2);
+    std::string second_ac = std::max(ac1, ac2);
+
     auto it = std::find_if(warnings_.begin(), warnings_.end(),
         [&first_ac, &second_ac](const WarningRecord& record) {
             return record.aircraft1 == first_ac && record.aircraft2 == second_ac;
         });
 
     if (it != warnings_.end()) {
-        if (std::difftime(now, it->last_warning) < WARNING_COOLDOWN) {
-            return false;
-        }
         it->last_warning = now;
     } else {
         warnings_.push_back({first_ac, second_ac, now});
     }
-
-    return true;
 }
 
 void ViolationDetector::cleanupWarnings() {
-    std::time_t now = std::time(nullptr);
+    std::time_t now = std::chrono::system_clock::to_time_t(sim_clock::systemNow());
     warnings_.erase(
         std::remove_if(warnings_.begin(), warnings_.end(),
             [now](const WarningRecord& record) {
@@ -76,59 +183,153 @@ void ViolationDetector::cleanupWarnings() {
 }
 
 void ViolationDetector::execute() {
+    auto started = std::chrono::steady_clock::now();
     checkViolations();
+    check_seconds.observe(std::chrono::duration<double>(std::chrono::steady_clock::now() - started).count());
 }
 
-void ViolationDetector::checkViolations() {
-    std::lock_guard<std::mutex> lock(mutex_);
-    cleanupWarnings();
-    bool critical_situation = false;
+template <typename Check>
+ViolationDetector::Coverage ViolationDetector::forCandidatePairs(const std::vector<Flight>& flights, double now,
+                                                                Check check, bool budgeted) const {
+    std::vector<PairCertificates::Track> certified;
+    if (certify_) {
+        certified.reserve(flights.size());
+        for (const auto& flight : flights) {
+            certified.push_back({flight.state.timestamp / 1000.0, flight.velocity_version, &flight.state});
+        }
+    }
+    Coverage coverage;
+    size_t skipped = 0;
+    // False for a pair whose certificate shows it clear
+    auto candidate = [&](size_t i, size_t j) {
+        if (certify_ && certificates_.holds(i, j, certified[i], certified[j])) {
+            ++skipped;
+            return false;
+        }
+        ++coverage.candidates;
+        return true;
+    };
+    auto visit = [&](size_t i, size_t j) {
+        ++coverage.refreshed;
+        bool conflict = check(i, j);
+        if (!conflict && certify_) {
+            certificates_.certify(i, j, certified[i], certified[j]);
+        }
+        if (budgeted) {
+            double slack = conflict ? 0.0 : refreshSlack(flights[i].state, flights[j].state, lookahead_time_seconds_);
+            deadlines_(i, j) = {flights[i].velocity_version, flights[j].velocity_version, now + slack};
+        }
+        return conflict;
+    };
 
-    for (size_t i = 0; i < aircraft_.size(); ++i) {
-        for (size_t j = i + 1; j < aircraft_.size(); ++j) {
-            auto state1 = aircraft_[i]->getState();
-            auto state2 = aircraft_[j]->getState();
-
-            // Calculate current separation
-            double dx = state1.position.x - state2.position.x;
-            double dy = state1.position.y - state2.position.y;
-            double dz = std::abs(state1.position.z - state2.position.z);
-
-            double horizontal_separation = std::sqrt(dx * dx + dy * dy);
-            double vertical_separation = std::abs(dz);
-
-            // Calculate separation ratios
-            double h_ratio = horizontal_separation / constants::MIN_HORIZONTAL_SEPARATION;
-            double v_ratio = vertical_separation / constants::MIN_VERTICAL_SEPARATION;
-            double separation_ratio = std::min(h_ratio, v_ratio);
-
-            if (separation_ratio < CRITICAL_WARNING_THRESHOLD &&
-                canIssueWarning(state1.callsign, state2.callsign)) {
-
-                if (separation_ratio < 1.0) {
-                    // Immediate violation
-                    ViolationInfo violation;
-                    if (checkPairViolation(state1, state2, violation)) {
-                        handleImmediateViolation(violation);
-                        critical_situation = true;
-                    }
+    const std::vector<std::pair<size_t, size_t>>* due = nullptr;
+    if (kinetic_) {
+        std::vector<KineticSchedule::Track> tracks;
+        tracks.reserve(flights.size());
+        for (const auto& flight : flights) {
+            tracks.push_back({&flight.state, flight.routed, flight.intent_version});
+        }
+        due = &kinetic_->due(tracks, now, lookahead_time_seconds_);
+    }
+
+    if (!budgeted) {
+        if (due) {
+            for (const auto& [i, j] : *due) {
+                kinetic_->checked(i, j, candidate(i, j) && visit(i, j));
+            }
+        } else {
+            for (size_t i = 0; i < flights.size(); ++i) {
+                for (size_t j = i + 1; j < flights.size(); ++j) {
+                    if (candidate(i, j)) visit(i, j);
+                }
+            }
+        }
+    } else {
+        // Candidates by refresh deadline, then in scan order
+        std::vector<std::tuple<double, size_t, size_t>> queue;
+        auto enqueue = [&](size_t i, size_t j) {
+            const RefreshDeadline* deadline = deadlines_.find(i, j);
+            bool known = deadline && deadline->version1 == flights[i].velocity_version &&
+                         deadline->version2 == flights[j].velocity_version;
+            queue.emplace_back(known ? deadline->time : now, i, j);
+        };
+        if (due) {
+            for (const auto& [i, j] : *due) {
+                if (candidate(i, j)) {
+                    enqueue(i, j);
                 } else {
-                    // Potential future violation
-                    auto prediction = predictViolation(state1, state2);
-                    if (prediction.time_to_violation < lookahead_time_seconds_) {
-                        if (separation_ratio < CRITICAL_WARNING_THRESHOLD) {
-                            handleCriticalWarning(prediction);
-                            critical_situation = true;
-                        } else if (separation_ratio < MEDIUM_WARNING_THRESHOLD) {
-                            handleMediumWarning(prediction);
-                        } else if (separation_ratio < EARLY_WARNING_THRESHOLD) {
-                            handleEarlyWarning(prediction);
-                        }
-                    }
+                    kinetic_->checked(i, j, false);
+                }
+            }
+        } else {
+            for (size_t i = 0; i < flights.size(); ++i) {
+                for (size_t j = i + 1; j < flights.size(); ++j) {
+                    if (candidate(i, j)) enqueue(i, j);
                 }
             }
         }
+        std::sort(queue.begin(), queue.end());
+
+        auto started = std::chrono::steady_clock::now();
+        size_t next = 0;
+        for (; next < queue.size(); ++next) {
+            if (next > 0 && next % BUDGET_CLOCK_STRIDE == 0 &&
+                std::chrono::steady_clock::now() - started >= check_budget_) {
+                break;
+            }
+            auto [deadline, i, j] = queue[next];
+            bool conflict = visit(i, j);
+            if (due) kinetic_->checked(i, j, conflict);
+        }
+        for (; next < queue.size(); ++next) {
+            auto [deadline, i, j] = queue[next];
+            if (deadline <= now) ++coverage.overdue_deferred;
+            // Still due next pass
+            if (due) kinetic_->checked(i, j, true);
+        }
+    }
+    pairs_checked.increment(coverage.refreshed);
+    pairs_certified.increment(skipped);
+    return coverage;
+}
+
+void ViolationDetector::checkViolations() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    cleanupWarnings();
+    bool critical_situation = false;
+    double now = std::chrono::duration<double>(sim_clock::systemNow().time_since_epoch()).count();
+    auto flights = snapshotFlights();
+
+    PerfScope perf(pair_detection);
+    bool budgeted = check_budget_.count() > 0 && !sim_clock::isVirtual();
+    std::vector<PairConflict> conflicts;
+    coverage_ = forCandidatePairs(flights, now, [&](size_t i, size_t j) {
+        const auto& state1 = flights[i].state;
+        const auto& state2 = flights[j].state;
+
+        PairConflict conflict;
+        if (!withinWarningRange(state1, state2, conflict)) return false;
+        // Not classified while its cooldown runs, so it may be in conflict
+        if (!canIssueWarning(state1.callsign, state2.callsign)) return true;
+        bool reversed = callsignsReversed(state1, state2);
+        if (!classifyPair(flights[reversed ? j : i], flights[reversed ? i : j], now, conflict)) return false;
+        conflicts.push_back(std::move(conflict));
+        return true;
+    }, budgeted);
+
+    // Alerts and conflict records go out in callsign order, not scan order
+    std::sort(conflicts.begin(), conflicts.end(), inCallsignOrder);
+    for (const auto& conflict : conflicts) {
+        updateWarning(firstCallsign(conflict), secondCallsign(conflict));
+        reportConflict(conflict);
+        critical_situation = critical_situation ||
+            conflict.kind == ConflictKind::VIOLATION ||
+            conflict.kind == ConflictKind::CRITICAL_WARNING;
     }
+    pairs_deferred.increment(coverage_.candidates - coverage_.refreshed);
+    pair_coverage.set(coverage_.candidates > 0
+                      ? static_cast<double>(coverage_.refreshed) / coverage_.candidates : 1.0);
+    overdue_deferred.set(static_cast<double>(coverage_.overdue_deferred));
 
     // Adjust update frequency based on situation
     if (critical_situation) {
@@ -138,6 +339,68 @@ void ViolationDetector::checkViolations() {
     }
 }
 
+bool ViolationDetector::withinWarningRange(const AircraftState& state1, const AircraftState& state2,
+                                           PairConflict& conflict) const {
+    // Calculate current separation
+    double dx = state1.position.x - state2.position.x;
+    double dy = state1.position.y - state2.position.y;
+    conflict.horizontal_separation = std::sqrt(dx * dx + dy * dy);
+    conflict.vertical_separation = std::abs(state1.position.z - state2.position.z);
+
+    // Calculate separation ratios
+    double h_ratio = conflict.horizontal_separation / constants::MIN_HORIZONTAL_SEPARATION;
+    double v_ratio = conflict.vertical_separation / constants::MIN_VERTICAL_SEPARATION;
+    return std::min(h_ratio, v_ratio) < CRITICAL_WARNING_THRESHOLD;
+}
+
+bool ViolationDetector::classifyPair(const Flight& flight1, const Flight& flight2, double now,
+                                     PairConflict& conflict) const {
+    double separation_ratio = std::min(conflict.horizontal_separation / constants::MIN_HORIZONTAL_SEPARATION,
+                                       conflict.vertical_separation / constants::MIN_VERTICAL_SEPARATION);
+    if (separation_ratio < 1.0) {
+        // Immediate violation
+        conflict.kind = ConflictKind::VIOLATION;
+        return checkPairViolation(flight1.state, flight2.state, conflict.violation);
+    }
+
+    // Potential future violation
+    conflict.prediction = predictViolation(flight1, flight2, now);
+    if (conflict.prediction.time_to_violation >= lookahead_time_seconds_) {
+        return false;
+    }
+    if (separation_ratio < CRITICAL_WARNING_THRESHOLD) {
+        conflict.kind = ConflictKind::CRITICAL_WARNING;
+    } else if (separation_ratio < MEDIUM_WARNING_THRESHOLD) {
+        conflict.kind = ConflictKind::MEDIUM_WARNING;
+    } else if (separation_ratio < EARLY_WARNING_THRESHOLD) {
+        conflict.kind = ConflictKind::EARLY_WARNING;
+    } else {
+        return false;
+    }
+    return true;
+}
+
+void ViolationDetector::reportConflict(const PairConflict& conflict) {
+    switch (conflict.kind) {
+        case ConflictKind::VIOLATION:
+            handleImmediateViolation(conflict.violation);
+            recordConflict(conflict.kind, &conflict.violation, nullptr,
+                           conflict.horizontal_separation, conflict.vertical_separation);
+            return;
+        case ConflictKind::CRITICAL_WARNING:
+            handleCriticalWarning(conflict.prediction);
+            break;
+        case ConflictKind::MEDIUM_WARNING:
+            handleMediumWarning(conflict.prediction);
+            break;
+        case ConflictKind::EARLY_WARNING:
+            handleEarlyWarning(conflict.prediction);
+            break;
+    }
+    recordConflict(conflict.kind, nullptr, &conflict.prediction,
+                   conflict.horizontal_separation, conflict.vertical_separation);
+}
+
 bool ViolationDetector::checkPairViolation(
     const AircraftState& state1,
     const AircraftState& state2,
@@ -166,66 +429,49 @@ bool ViolationDetector::checkPairViolation(
     return false;
 }
 
+std::vector<ViolationDetector::Flight> ViolationDetector::snapshotFlights() const {
+    std::vector<Flight> flights(aircraft_.size());
+    for (size_t i = 0; i < aircraft_.size(); ++i) {
+        RouteProgress progress = aircraft_[i]->getRouteProgress(flights[i].state);
+        flights[i].routed = progress.route != nullptr;
+        flights[i].intent_version = progress.intent_version;
+        flights[i].velocity_version = progress.velocity_version;
+        // A straight line from the latest state costs no more than checking a cached one
+        flights[i].trajectory = progress.route
+            ? trajectories_.get(flights[i].state, progress)
+            : std::make_shared<const Trajectory>(Trajectory::straight(flights[i].state));
+    }
+    return flights;
+}
+
 ViolationDetector::ViolationPrediction ViolationDetector::predictViolation(
-    const AircraftState& state1,
-    const AircraftState& state2) const {
+    const Flight& flight1,
+    const Flight& flight2,
+    double now) const {
 
     ViolationPrediction prediction;
-    prediction.aircraft1_id = state1.callsign;
-    prediction.aircraft2_id = state2.callsign;
-
-    double time_to_min = calculateTimeToMinimumSeparation(state1, state2);
-    prediction.time_to_violation = time_to_min;
+    prediction.aircraft1_id = flight1.state.callsign;
+    prediction.aircraft2_id = flight2.state.callsign;
 
-    // Calculate positions at minimum separation time
-    Position pos1_future = predictPosition(state1, time_to_min);
-    Position pos2_future = predictPosition(state2, time_to_min);
-
-    double dx = pos1_future.x - pos2_future.x;
-    double dy = pos1_future.y - pos2_future.y;
-    prediction.min_separation = std::sqrt(dx*dx + dy*dy);
+    auto approach = closestApproach(*flight1.trajectory, *flight2.trajectory,
+                                    now, now + lookahead_time_seconds_);
+    prediction.time_to_violation = approach.time - now;
+    prediction.min_separation = approach.distance;
 
     // Calculate conflict point
+    Position pos1_future = flight1.trajectory->positionAt(approach.time);
+    Position pos2_future = flight2.trajectory->positionAt(approach.time);
     prediction.conflict_point = {
         (pos1_future.x + pos2_future.x) / 2,
         (pos1_future.y + pos2_future.y) / 2,
         (pos1_future.z + pos2_future.z) / 2
     };
 
-    prediction.resolution_options = generateResolutionOptions(state1, state2);
+    prediction.resolution_options = generateResolutionOptions(flight1.state, flight2.state);
 
     return prediction;
 }
 
-Position ViolationDetector::predictPosition(
-    const AircraftState& state,
-    double time_seconds) const {
-
-    return Position{
-        state.position.x + state.velocity.vx * time_seconds,
-        state.position.y + state.velocity.vy * time_seconds,
-        state.position.z + state.velocity.vz * time_seconds
-    };
-}
-
-double ViolationDetector::calculateTimeToMinimumSeparation(
-    const AircraftState& state1,
-    const AircraftState& state2) const {
-
-    double dx = state2.position.x - state1.position.x;
-    double dy = state2.position.y - state1.position.y;
-    double dvx = state2.velocity.vx - state1.velocity.vx;
-    double dvy = state2.velocity.vy - state1.velocity.vy;
-
-    double a = dvx * dvx + dvy * dvy;
-    if (std::abs(a) < 1e-6) return 0.0;  // Parallel tracks
-
-    double b = 2.0 * (dx * dvx + dy * dvy);
-    double time = -b / (2.0 * a);
-
-    return (time < 0.0) ? 0.0 : time;
-}
-
 std::vector<std::string> ViolationDetector::generateResolutionOptions(
     const AircraftState& state1,
     const AircraftState& state2) const {
@@ -264,6 +510,7 @@ std::vector<std::string> ViolationDetector::generateResolutionOptions(
 
 void ViolationDetector::handleImmediateViolation(const ViolationInfo& violation) {
     logViolation(violation);
+    if (!ATC_LOG_ENABLED(WARNING)) return;
 
     std::ostringstream oss;
     oss << "\nIMMEDIATE VIOLATION - TAKE ACTION NOW!\n"
@@ -278,10 +525,12 @@ void ViolationDetector::handleImmediateViolation(const ViolationInfo& violation)
         << "3. Turn " << violation.aircraft2_id << " left\n"
         << "4. Increase speed differential";
 
-    Logger::getInstance().log(oss.str());
+    ATC_LOG_WARNING(oss.str());
 }
 
 void ViolationDetector::handleCriticalWarning(const ViolationPrediction& prediction) {
+    if (!ATC_LOG_ENABLED(WARNING)) return;
+
     std::ostringstream oss;
     oss << "\nCRITICAL WARNING - Imminent Conflict\n"
         << "Aircraft: " << prediction.aircraft1_id << " and " << prediction.aircraft2_id << "\n"
@@ -293,30 +542,36 @@ void ViolationDetector::handleCriticalWarning(const ViolationPrediction& predict
         oss << "\n- " << option;
     }
 
-    Logger::getInstance().log(oss.str());
+    ATC_LOG_WARNING(oss.str());
 }
 
 void ViolationDetector::handleMediumWarning(const ViolationPrediction& prediction) {
+    if (!ATC_LOG_ENABLED(INFO)) return;
+
     std::ostringstream oss;
     oss << "\nMEDIUM WARNING - Potential Conflict\n"
         << "Aircraft: " << prediction.aircraft1_id << " and " << prediction.aircraft2_id << "\n"
         << "Time to closest approach: " << prediction.time_to_violation << " seconds\n"
         << "Expected minimum separation: " << prediction.min_separation << " units";
 
-    Logger::getInstance().log(oss.str());
+    ATC_LOG_INFO(oss.str());
 }
 
 void ViolationDetector::handleEarlyWarning(const ViolationPrediction& prediction) {
+    if (!ATC_LOG_ENABLED(INFO)) return;
+
     std::ostringstream oss;
     oss << "\nEARLY WARNING - Monitor Situation\n"
         << "Aircraft: " << prediction.aircraft1_id << " and " << prediction.aircraft2_id << "\n"
         << "Time to closest approach: " << prediction.time_to_violation << " seconds\n"
         << "Expected minimum separation: " << prediction.min_separation << " units";
 
-    Logger::getInstance().log(oss.str());
+    ATC_LOG_INFO(oss.str());
 }
 
 void ViolationDetector::logViolation(const ViolationInfo& violation) const {
+    if (!ATC_LOG_ENABLED(WARNING)) return;
+
     std::ostringstream oss;
     oss << "\n=== VIOLATION REPORT ===\n"
         << "Time: " << violation.timestamp << "\n"
@@ -328,7 +583,38 @@ void ViolationDetector::logViolation(const ViolationInfo& violation) const {
         << "Status: " << (violation.is_predicted ? "PREDICTED" : "CURRENT") << "\n"
         << "======================\n";
 
-    Logger::getInstance().log(oss.str());
+    ATC_LOG_WARNING(oss.str());
+}
+
+void ViolationDetector::recordConflict(ConflictKind kind, const ViolationInfo* violation,
+                                       const ViolationPrediction* prediction,
+                                       double horizontal_separation, double vertical_separation) {
+    if (!conflict_log_) return;
+
+    ConflictRecord record;
+    std::memset(&record, 0, sizeof(record));
+    record.kind = static_cast<uint8_t>(kind);
+    record.horizontal_separation = horizontal_separation;
+    record.vertical_separation = vertical_separation;
+
+    const std::string& aircraft1 = violation ? violation->aircraft1_id : prediction->aircraft1_id;
+    const std::string& aircraft2 = violation ? violation->aircraft2_id : prediction->aircraft2_id;
+    std::strncpy(record.aircraft1, aircraft1.c_str(), ConflictRecord::CALLSIGN_LENGTH - 1);
+    std::strncpy(record.aircraft2, aircraft2.c_str(), ConflictRecord::CALLSIGN_LENGTH - 1);
+
+    if (violation) {
+        record.timestamp_ms = static_cast<int64_t>(violation->timestamp);
+        record.min_separation = horizontal_separation;
+    } else {
+        record.timestamp_ms = std::chrono::duration_cast<std::chrono::milliseconds>(
+            sim_clock::systemNow().time_since_epoch()).count();
+        record.time_to_violation = prediction->time_to_violation;
+        record.min_separation = prediction->min_separation;
+        record.x = prediction->conflict_point.x;
+        record.y = prediction->conflict_point.y;
+        record.z = prediction->conflict_point.z;
+    }
+    conflict_log_->record(record);
 }
 
 std::vector<ViolationInfo> ViolationDetector::getCurrentViolations() const {
@@ -338,24 +624,54 @@ std::vector<ViolationInfo> ViolationDetector::getCurrentViolations() const {
     for (size_t i = 0; i < aircraft_.size(); ++i) {
         for (size_t j = i + 1; j < aircraft_.size(); ++j) {
             ViolationInfo violation;
-            if (checkPairViolation(aircraft_[i]->getState(),
-                                 aircraft_[j]->getState(),
-                                 violation)) {
+            AircraftState state1 = aircraft_[i]->getState();
+            AircraftState state2 = aircraft_[j]->getState();
+            bool reversed = callsignsReversed(state1, state2);
+            if (checkPairViolation(reversed ? state2 : state1, reversed ? state1 : state2, violation)) {
                 violations.push_back(violation);
             }
         }
     }
+
+    std::sort(violations.begin(), violations.end(), [](const ViolationInfo& a, const ViolationInfo& b) {
+        return std::tie(a.aircraft1_id, a.aircraft2_id) < std::tie(b.aircraft1_id, b.aircraft2_id);
+    });
     return violations;
 }
 
+std::vector<ViolationDetector::PairConflict> ViolationDetector::findConflicts() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    std::vector<PairConflict> conflicts;
+    double now = std::chrono::duration<double>(sim_clock::systemNow().time_since_epoch()).count();
+    auto flights = snapshotFlights();
+
+    forCandidatePairs(flights, now, [&](size_t i, size_t j) {
+        PairConflict conflict;
+        bool reversed = callsignsReversed(flights[i].state, flights[j].state);
+        if (!withinWarningRange(flights[i].state, flights[j].state, conflict) ||
+            !classifyPair(flights[reversed ? j : i], flights[reversed ? i : j], now, conflict)) {
+            return false;
+        }
+        conflicts.push_back(std::move(conflict));
+        return true;
+    });
+
+    std::sort(conflicts.begin(), conflicts.end(), inCallsignOrder);
+    return conflicts;
+}
+
 std::vector<ViolationDetector::ViolationPrediction>
 ViolationDetector::getPredictedViolations() const {
     std::lock_guard<std::mutex> lock(mutex_);
     std::vector<ViolationPrediction> predictions;
-
-    for (size_t i = 0; i < aircraft_.size(); ++i) {
-        for (size_t j = i + 1; j < aircraft_.size(); ++j) {
-            auto pred = predictViolation(aircraft_[i]->getState(), aircraft_[j]->getState());
+    double now = std::chrono::duration<double>(sim_clock::systemNow().time_since_epoch()).count();
+    auto flights = snapshotFlights();
+
+    PerfScope perf(conflict_prediction);
+    for (size_t i = 0; i < flights.size(); ++i) {
+        for (size_t j = i + 1; j < flights.size(); ++j) {
+            bool reversed = callsignsReversed(flights[i].state, flights[j].state);
+            auto pred = predictViolation(flights[reversed ? j : i], flights[reversed ? i : j], now);
             if (pred.time_to_violation < lookahead_time_seconds_ &&
                 pred.min_separation < constants::MIN_HORIZONTAL_SEPARATION * CRITICAL_WARNING_THRESHOLD) {
                 predictions.push_back(pred);
@@ -363,10 +679,11 @@ ViolationDetector::getPredictedViolations() const {
         }
     }
 
-    // Sort predictions by time to violation
+    // Sort predictions by time to violation, ties by callsign
     std::sort(predictions.begin(), predictions.end(),
               [](const ViolationPrediction& a, const ViolationPrediction& b) {
-                  return a.time_to_violation < b.time_to_violation;
+                  return std::tie(a.time_to_violation, a.aircraft1_id, a.aircraft2_id) <
+                         std::tie(b.time_to_violation, b.aircraft1_id, b.aircraft2_id);
               });
 
     return predictions;
@@ -1,10 +1,11 @@
 #include "display/display_system.h"
 #include "common/constants.h"
 #include "common/logger.h"
+#include "common/perf_counters.h"
+#include "common/timestamp.h"
 #include <iostream>
 #include <iomanip>
 #include <chrono>
-#include <ctime>
 #include <sstream>
 #include <algorithm>
 #include <cmath>
@@ -12,12 +13,18 @@
 
 namespace atc {
 
+namespace {
+LogEvent label_collisions("display label collisions", LogLevel::DEBUG);
+
+PerfKernel display_render("display_render");
+}
+
 DisplaySystem::DisplaySystem(std::shared_ptr<ViolationDetector> violation_detector)
     : PeriodicTask(std::chrono::milliseconds(constants::DISPLAY_UPDATE_INTERVAL),
                    constants::DISPLAY_PRIORITY)
     , violation_detector_(violation_detector) {
-    Logger::getInstance().log("Display system initialized with update interval: " +
-                            std::to_string(constants::DISPLAY_UPDATE_INTERVAL) + "ms");
+    ATC_LOG_INFO("Display system initialized with update interval: " +
+                 std::to_string(constants::DISPLAY_UPDATE_INTERVAL) + "ms");
 }
 
 void DisplaySystem::execute() {
@@ -38,11 +45,8 @@ void DisplaySystem::clearScreen() const {
 }
 
 void DisplaySystem::displayHeader() const {
-    auto now = std::chrono::system_clock::now();
-    auto time = std::chrono::system_clock::to_time_t(now);
-
     std::cout << Colors::bold() << "=== Air Traffic Control System ===" << Colors::reset() << std::endl;
-    std::cout << "Time: " << std::ctime(&time);
+    std::cout << "Time: " << timestamp::now(false) << "\n";
     std::cout << std::string(70, '-') << std::endl;
 }
 
@@ -65,7 +69,10 @@ void DisplaySystem::displayLegend() const {
               << "  " << Colors::red() << "█" << Colors::reset() << Colors::cyan()
               << " = Violation\n"
               << "  " << Colors::blue() << "•" << Colors::reset() << Colors::cyan()
-              << " = Predicted Position"
+              << " = Predicted Position\n"
+              << "  " << Colors::dim() << TRAIL_MARKER << Colors::reset() << Colors::cyan()
+              << " = Recent Track\n"
+              << "  3# = Aircraft sharing one cell"
               << Colors::reset() << std::endl;
     std::cout << std::string(70, '-') << std::endl;
 }
@@ -158,70 +165,111 @@ std::string DisplaySystem::formatAltitude(double altitude) const {
 }
 
 void DisplaySystem::displayAircraft() const {
+    PerfScope perf(display_render);
     std::vector<std::vector<AircraftDisplayInfo>> grid(DISPLAY_HEIGHT,
         std::vector<AircraftDisplayInfo>(DISPLAY_WIDTH));
 
-    // First, calculate warning levels for all aircraft pairs
+    // Trails go down first so aircraft and predictions draw over them
+    if (trails_) {
+        std::vector<TrailPoint> trail;
+        for (const auto& aircraft : aircraft_) {
+            trails_->copyTrail(aircraft->getCallsign(), trail);
+            for (const auto& point : trail) {
+                int x = static_cast<int>((point.x / constants::AIRSPACE_X_MAX) * (DISPLAY_WIDTH - 1));
+                int y = DISPLAY_HEIGHT - 1 - static_cast<int>((point.y / constants::AIRSPACE_Y_MAX) * (DISPLAY_HEIGHT - 1));
+                if (x >= 0 && x < DISPLAY_WIDTH && y >= 0 && y < DISPLAY_HEIGHT) {
+                    grid[y][x].occupied = true;
+                    grid[y][x].marker = TRAIL_MARKER;
+                    grid[y][x].is_trail = true;
+                }
+            }
+        }
+    }
+
+    LabelLayout labels(DISPLAY_WIDTH, DISPLAY_HEIGHT);
+    std::vector<std::pair<int, int>> predicted_cells;
+
     for (const auto& aircraft : aircraft_) {
         const auto& state = aircraft->getState();
 
         int x = static_cast<int>((state.position.x / constants::AIRSPACE_X_MAX) * (DISPLAY_WIDTH - 1));
         int y = DISPLAY_HEIGHT - 1 - static_cast<int>((state.position.y / constants::AIRSPACE_Y_MAX) * (DISPLAY_HEIGHT - 1));
 
-        if (x >= 0 && x < DISPLAY_WIDTH && y >= 0 && y < DISPLAY_HEIGHT) {
-            AircraftDisplayInfo& cell = grid[y][x];
+        if (x < 0 || x >= DISPLAY_WIDTH || y < 0 || y >= DISPLAY_HEIGHT) continue;
+
+        // Calculate warning level
+        WarningLevel max_warning = WarningLevel::NONE;
+        for (const auto& other : aircraft_) {
+            if (other->getCallsign() == state.callsign) continue;
+
+            auto [horiz, vert] = calculateSeparation(state, other->getState());
+            double h_ratio = horiz / constants::MIN_HORIZONTAL_SEPARATION;
+            double v_ratio = vert / constants::MIN_VERTICAL_SEPARATION;
+
+            if (h_ratio < 1.0 || v_ratio < 1.0) {
+                max_warning = WarningLevel::VIOLATION;
+                break;
+            } else if (h_ratio < WARNING_CRITICAL && v_ratio < WARNING_CRITICAL) {
+                max_warning = WarningLevel::CRITICAL;
+            } else if (h_ratio < WARNING_MEDIUM && v_ratio < WARNING_MEDIUM &&
+                     max_warning < WarningLevel::MEDIUM) {
+                max_warning = WarningLevel::MEDIUM;
+            } else if (h_ratio < WARNING_EARLY && v_ratio < WARNING_EARLY &&
+                     max_warning < WarningLevel::EARLY) {
+                max_warning = WarningLevel::EARLY;
+            }
+        }
+
+        auto placement = labels.place(x, y, max_warning);
+        AircraftDisplayInfo& cell = grid[placement.y][placement.x];
+        if (placement.merged) {
+            cell.count = labels.count(placement.x, placement.y);
+            cell.warning_level = labels.warning(placement.x, placement.y);
+        } else {
+            cell = AircraftDisplayInfo();
             cell.marker = state.callsign[0];
             cell.direction = getDirectionSymbol(state.heading);
             cell.occupied = true;
             cell.callsign = state.callsign;
             cell.altitude = state.position.z;
             cell.status = state.status;
-
-            // Calculate warning level
-            WarningLevel max_warning = WarningLevel::NONE;
-            for (const auto& other : aircraft_) {
-                if (other->getState().callsign == state.callsign) continue;
-
-                auto [horiz, vert] = calculateSeparation(state, other->getState());
-                double h_ratio = horiz / constants::MIN_HORIZONTAL_SEPARATION;
-                double v_ratio = vert / constants::MIN_VERTICAL_SEPARATION;
-
-                if (h_ratio < 1.0 || v_ratio < 1.0) {
-                    max_warning = WarningLevel::VIOLATION;
-                    break;
-                } else if (h_ratio < WARNING_CRITICAL && v_ratio < WARNING_CRITICAL) {
-                    max_warning = WarningLevel::CRITICAL;
-                } else if (h_ratio < WARNING_MEDIUM && v_ratio < WARNING_MEDIUM &&
-                         max_warning < WarningLevel::MEDIUM) {
-                    max_warning = WarningLevel::MEDIUM;
-                } else if (h_ratio < WARNING_EARLY && v_ratio < WARNING_EARLY &&
-                         max_warning < WarningLevel::EARLY) {
-                    max_warning = WarningLevel::EARLY;
-                }
-            }
             cell.warning_level = max_warning;
+            cell.count = 1;
+        }
 
-            // Add predicted position if warning level is Critical or higher
-            if (cell.warning_level >= WarningLevel::CRITICAL) {
-                Position future = {
-                    state.position.x + state.velocity.vx * PREDICTION_TIME,
-                    state.position.y + state.velocity.vy * PREDICTION_TIME,
-                    state.position.z + state.velocity.vz * PREDICTION_TIME
-                };
+        // Add predicted position if warning level is Critical or higher
+        if (max_warning >= WarningLevel::CRITICAL) {
+            Position future = {
+                state.position.x + state.velocity.vx * PREDICTION_TIME,
+                state.position.y + state.velocity.vy * PREDICTION_TIME,
+                state.position.z + state.velocity.vz * PREDICTION_TIME
+            };
 
-                int pred_x = static_cast<int>((future.x / constants::AIRSPACE_X_MAX) * (DISPLAY_WIDTH - 1));
-                int pred_y = DISPLAY_HEIGHT - 1 - static_cast<int>((future.y / constants::AIRSPACE_Y_MAX) * (DISPLAY_HEIGHT - 1));
+            int pred_x = static_cast<int>((future.x / constants::AIRSPACE_X_MAX) * (DISPLAY_WIDTH - 1));
+            int pred_y = DISPLAY_HEIGHT - 1 - static_cast<int>((future.y / constants::AIRSPACE_Y_MAX) * (DISPLAY_HEIGHT - 1));
 
-                if (pred_x >= 0 && pred_x < DISPLAY_WIDTH && pred_y >= 0 && pred_y < DISPLAY_HEIGHT &&
-                    (pred_x != x || pred_y != y)) {
-                    grid[pred_y][pred_x].occupied = true;
-                    grid[pred_y][pred_x].marker = PREDICTED_POSITION_MARKER;
-                    grid[pred_y][pred_x].is_predicted = true;
-                }
+            if (pred_x >= 0 && pred_x < DISPLAY_WIDTH && pred_y >= 0 && pred_y < DISPLAY_HEIGHT &&
+                (pred_x != x || pred_y != y)) {
+                predicted_cells.emplace_back(pred_x, pred_y);
             }
         }
     }
 
+    // Predictions never cover an aircraft label
+    for (const auto& [pred_x, pred_y] : predicted_cells) {
+        if (!labels.mayMarkPrediction(pred_x, pred_y)) continue;
+        AircraftDisplayInfo& cell = grid[pred_y][pred_x];
+        cell.occupied = true;
+        cell.marker = PREDICTED_POSITION_MARKER;
+        cell.is_predicted = true;
+        cell.is_trail = false;
+    }
+
+    last_collisions_ = {labels.moved(), labels.merged()};
+    if (labels.moved() + labels.merged() > 0) {
+        label_collisions.record(labels.moved() + labels.merged());
+    }
+
     // Display grid
     std::cout << "+" << std::string(DISPLAY_WIDTH * 2 + 2, '-') << "+" << std::endl;
 
@@ -229,8 +277,14 @@ void DisplaySystem::displayAircraft() const {
         std::cout << "| ";
         for (const auto& cell : row) {
             if (cell.occupied) {
-                if (cell.is_predicted) {
+                if (cell.is_trail) {
+                    std::cout << Colors::dim() << cell.marker << " " << Colors::reset();
+                } else if (cell.is_predicted) {
                     std::cout << Colors::blue() << cell.marker << " " << Colors::reset();
+                } else if (cell.count > 1) {
+                    // Merged labels show how many aircraft share the cell
+                    char count = cell.count <= 9 ? static_cast<char>('0' + cell.count) : '+';
+                    std::cout << getWarningColor(cell.warning_level) << count << '#' << Colors::reset();
                 } else {
                     const char* color = getWarningColor(cell.warning_level);
 
@@ -278,7 +332,7 @@ void DisplaySystem::displayAircraftDetails() const {
         double closure_rate = 0;
 
         for (const auto& other : aircraft_) {
-            if (other->getState().callsign == state.callsign) continue;
+            if (other->getCallsign() == state.callsign) continue;
 
             const auto& other_state = other->getState();
             auto [horizontal, vertical] = calculateSeparation(state, other_state);
@@ -433,6 +487,8 @@ void DisplaySystem::displayFooter() const {
     std::cout << "Aircraft Count: " << aircraft_.size()
               << " | Update Count: " << update_count_
               << " | Update Rate: " << constants::DISPLAY_UPDATE_INTERVAL << "ms"
+              << " | Label Collisions: " << (last_collisions_.offset + last_collisions_.merged)
+              << " (" << last_collisions_.offset << " moved, " << last_collisions_.merged << " merged)"
               << " | Press Ctrl+C to exit" << std::endl;
     std::cout << std::string(70, '-') << std::endl;
 }
@@ -442,7 +498,7 @@ void DisplaySystem::addAircraft(const std::vector<std::shared_ptr<Aircraft>>& ne
     for (const auto& aircraft : new_aircraft) {
         auto it = std::find_if(aircraft_.begin(), aircraft_.end(),
             [&](const auto& existing) {
-                return existing->getState().callsign == aircraft->getState().callsign;
+                return existing->getCallsign() == aircraft->getCallsign();
             });
 
         if (it == aircraft_.end()) {
@@ -460,16 +516,23 @@ void DisplaySystem::displayAlert(const std::string& alert_message) {
 }
 
 void DisplaySystem::updateDisplay(const std::vector<std::shared_ptr<Aircraft>>& current_aircraft) {
+    {
+        std::lock_guard<std::mutex> lock(display_mutex_);
+        aircraft_ = current_aircraft;  // Update the entire aircraft list
+    }
+    execute();  // Refresh the display; takes display_mutex_ itself
+}
+
+void DisplaySystem::setTrailStore(const std::shared_ptr<TrailStore>& trails) {
     std::lock_guard<std::mutex> lock(display_mutex_);
-    aircraft_ = current_aircraft;  // Update the entire aircraft list
-    execute();  // Refresh the display
+    trails_ = trails;
 }
 
 void DisplaySystem::removeAircraft(const std::string& callsign) {
     std::lock_guard<std::mutex> lock(display_mutex_);
     auto it = std::remove_if(aircraft_.begin(), aircraft_.end(),
         [&](const auto& aircraft) {
-            return aircraft->getState().callsign == callsign;
+            return aircraft->getCallsign() == callsign;
         });
     aircraft_.erase(it, aircraft_.end());
 }
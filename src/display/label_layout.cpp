@@ -0,0 +1,48 @@
+#include "display/label_layout.h"
+#include <algorithm>
+
+namespace atc {
+
+LabelLayout::LabelLayout(int width, int height)
+    : width_(width)
+    , height_(height)
+    , counts_(width * height, 0)
+    , warnings_(width * height, WarningLevel::NONE) {}
+
+LabelLayout::Placement LabelLayout::place(int x, int y, WarningLevel warning) {
+    int label_x = x;
+    int label_y = y;
+    if (labelled(x, y) && !findFreeNeighbour(label_x, label_y)) {
+        int cell = y * width_ + x;
+        counts_[cell]++;
+        warnings_[cell] = std::max(warnings_[cell], warning);
+        merged_++;
+        return {x, y, true};
+    }
+
+    if (label_x != x || label_y != y) {
+        moved_++;
+    }
+    int cell = label_y * width_ + label_x;
+    counts_[cell] = 1;
+    warnings_[cell] = warning;
+    return {label_x, label_y, false};
+}
+
+bool LabelLayout::findFreeNeighbour(int& x, int& y) const {
+    static const int offsets[8][2] = {
+        {1, 0}, {-1, 0}, {0, -1}, {0, 1}, {1, -1}, {-1, -1}, {1, 1}, {-1, 1}
+    };
+    for (const auto& offset : offsets) {
+        int nx = x + offset[0];
+        int ny = y + offset[1];
+        if (nx >= 0 && nx < width_ && ny >= 0 && ny < height_ && !labelled(nx, ny)) {
+            x = nx;
+            y = ny;
+            return true;
+        }
+    }
+    return false;
+}
+
+}
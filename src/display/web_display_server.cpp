@@ -0,0 +1,594 @@
+#include "display/web_display_server.h"
+#include "common/logger.h"
+#include "common/metrics.h"
+#include <algorithm>
+#include <arpa/inet.h>
+#include <cctype>
+#include <cerrno>
+#include <cstring>
+#include <fcntl.h>
+#include <netinet/in.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#ifndef MSG_NOSIGNAL
+#define MSG_NOSIGNAL 0
+#endif
+
+namespace atc {
+
+namespace {
+
+constexpr size_t MAX_REQUEST_SIZE = 8192;
+constexpr size_t MAX_CLIENT_FRAME = 4096;   // browsers only send small control frames
+constexpr int POLL_TIMEOUT_MS = 500;
+// Kept small so a stalled client backs up after a few frames and is conflated,
+// instead of the kernel buffering seconds of stale snapshots for it
+constexpr int CLIENT_SEND_BUFFER = 64 * 1024;
+
+constexpr uint8_t WS_OPCODE_BINARY = 0x2;
+constexpr uint8_t WS_OPCODE_CLOSE = 0x8;
+constexpr uint8_t WS_OPCODE_PING = 0x9;
+constexpr uint8_t WS_OPCODE_PONG = 0xA;
+
+const char* const WS_GUID = "258EAFA5-E914-47DA-95CA-C5AB0DC85B11";
+
+uint32_t rotl(uint32_t value, int bits) {
+    return (value << bits) | (value >> (32 - bits));
+}
+
+// SHA-1, only needed for the WebSocket handshake
+std::string sha1(const std::string& message) {
+    uint32_t h[5] = {0x67452301, 0xEFCDAB89, 0x98BADCFE, 0x10325476, 0xC3D2E1F0};
+
+    std::string data = message;
+    uint64_t bit_length = static_cast<uint64_t>(message.size()) * 8;
+    data.push_back(static_cast<char>(0x80));
+    while (data.size() % 64 != 56) {
+        data.push_back('\0');
+    }
+    for (int shift = 56; shift >= 0; shift -= 8) {
+        data.push_back(static_cast<char>((bit_length >> shift) & 0xFF));
+    }
+
+    for (size_t chunk = 0; chunk < data.size(); chunk += 64) {
+        uint32_t w[80];
+        for (int i = 0; i < 16; ++i) {
+            const auto* p = reinterpret_cast<const unsigned char*>(&data[chunk + i * 4]);
+            w[i] = (uint32_t(p[0]) << 24) | (uint32_t(p[1]) << 16) | (uint32_t(p[2]) << 8) | p[3];
+        }
+        for (int i = 16; i < 80; ++i) {
+            w[i] = rotl(w[i - 3] ^ w[i - 8] ^ w[i - 14] ^ w[i - 16], 1);
+        }
+
+        uint32_t a = h[0], b = h[1], c = h[2], d = h[3], e = h[4];
+        for (int i = 0; i < 80; ++i) {
+            uint32_t f, k;
+            if (i < 20) {
+                f = (b & c) | (~b & d);
+                k = 0x5A827999;
+            } else if (i < 40) {
+                f = b ^ c ^ d;
+                k = 0x6ED9EBA1;
+            } else if (i < 60) {
+                f = (b & c) | (b & d) | (c & d);
+                k = 0x8F1BBCDC;
+            } else {
+                f = b ^ c ^ d;
+                k = 0xCA62C1D6;
+            }
+            uint32_t temp = rotl(a, 5) + f + e + k + w[i];
+            e = d;
+            d = c;
+            c = rotl(b, 30);
+            b = a;
+            a = temp;
+        }
+        h[0] += a;
+        h[1] += b;
+        h[2] += c;
+        h[3] += d;
+        h[4] += e;
+    }
+
+    std::string digest;
+    for (uint32_t word : h) {
+        for (int shift = 24; shift >= 0; shift -= 8) {
+            digest.push_back(static_cast<char>((word >> shift) & 0xFF));
+        }
+    }
+    return digest;
+}
+
+std::string base64(const std::string& bytes) {
+    static const char table[] =
+        "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+    std::string out;
+    size_t i = 0;
+    for (; i + 2 < bytes.size(); i += 3) {
+        uint32_t n = (uint8_t(bytes[i]) << 16) | (uint8_t(bytes[i + 1]) << 8) | uint8_t(bytes[i + 2]);
+        out += table[(n >> 18) & 63];
+        out += table[(n >> 12) & 63];
+        out += table[(n >> 6) & 63];
+        out += table[n & 63];
+    }
+    if (i < bytes.size()) {
+        uint32_t n = uint8_t(bytes[i]) << 16;
+        if (i + 1 < bytes.size()) n |= uint8_t(bytes[i + 1]) << 8;
+        out += table[(n >> 18) & 63];
+        out += table[(n >> 12) & 63];
+        out += (i + 1 < bytes.size()) ? table[(n >> 6) & 63] : '=';
+        out += '=';
+    }
+    return out;
+}
+
+std::string lowercase(std::string text) {
+    std::transform(text.begin(), text.end(), text.begin(),
+                   [](unsigned char c) { return static_cast<char>(std::tolower(c)); });
+    return text;
+}
+
+std::string trim(const std::string& text) {
+    size_t start = text.find_first_not_of(" \t");
+    size_t end = text.find_last_not_of(" \t\r");
+    return start == std::string::npos ? std::string() : text.substr(start, end - start + 1);
+}
+
+bool setNonBlocking(int fd) {
+    int flags = ::fcntl(fd, F_GETFL, 0);
+    return flags >= 0 && ::fcntl(fd, F_SETFL, flags | O_NONBLOCK) == 0;
+}
+
+} // namespace
+
+WebDisplayServer::WebDisplayServer(uint16_t port, std::string page)
+    : port_(port)
+    , page_(std::move(page)) {
+}
+
+WebDisplayServer::~WebDisplayServer() {
+    stop();
+}
+
+bool WebDisplayServer::start() {
+    if (running_) return true;
+
+    listen_fd_ = ::socket(AF_INET, SOCK_STREAM, 0);
+    if (listen_fd_ < 0) {
+        ATC_LOG_ERROR("Web display: failed to create socket: " + std::string(std::strerror(errno)));
+        return false;
+    }
+    int reuse = 1;
+    ::setsockopt(listen_fd_, SOL_SOCKET, SO_REUSEADDR, &reuse, sizeof(reuse));
+
+    sockaddr_in address{};
+    address.sin_family = AF_INET;
+    address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    address.sin_port = htons(port_);
+    socklen_t length = sizeof(address);
+    if (::bind(listen_fd_, reinterpret_cast<sockaddr*>(&address), sizeof(address)) != 0 ||
+        ::listen(listen_fd_, 16) != 0 ||
+        ::getsockname(listen_fd_, reinterpret_cast<sockaddr*>(&address), &length) != 0 ||
+        !setNonBlocking(listen_fd_) ||
+        ::pipe(wake_fds_) != 0) {
+        ATC_LOG_ERROR("Web display: failed to listen on port " + std::to_string(port_) +
+                      ": " + std::strerror(errno));
+        stop();
+        return false;
+    }
+    setNonBlocking(wake_fds_[0]);
+    setNonBlocking(wake_fds_[1]);
+    port_ = ntohs(address.sin_port);
+
+    running_ = true;
+    thread_ = std::thread(&WebDisplayServer::run, this);
+    ATC_LOG_INFO("Web display listening on http://127.0.0.1:" + std::to_string(port_) + "/");
+    return true;
+}
+
+void WebDisplayServer::stop() {
+    running_ = false;
+    wake();
+    if (thread_.joinable()) {
+        thread_.join();
+    }
+    for (auto& client : clients_) {
+        ::close(client.fd);
+    }
+    clients_.clear();
+    client_count_ = 0;
+    for (int* fd : {&listen_fd_, &wake_fds_[0], &wake_fds_[1]}) {
+        if (*fd >= 0) {
+            ::close(*fd);
+            *fd = -1;
+        }
+    }
+}
+
+void WebDisplayServer::publish(std::shared_ptr<const Snapshot> snapshot) {
+    {
+        // The replaced snapshot is released after the lock
+        std::lock_guard<std::mutex> lock(snapshot_mutex_);
+        latest_.swap(snapshot);
+    }
+    wake();
+}
+
+void WebDisplayServer::wake() {
+    if (wake_fds_[1] >= 0) {
+        char byte = 0;
+        // A full pipe already guarantees a wakeup
+        (void)!::write(wake_fds_[1], &byte, 1);
+    }
+}
+
+void WebDisplayServer::run() {
+    std::vector<pollfd> fds;
+    while (running_) {
+        std::shared_ptr<const Snapshot> latest;
+        {
+            std::lock_guard<std::mutex> lock(snapshot_mutex_);
+            latest = latest_;
+        }
+
+        // Hand idle WebSocket clients the newest snapshot and push pending bytes
+        for (auto& client : clients_) {
+            bool failed = false;
+            // A second round sends the first snapshot right behind the handshake
+            for (int round = 0; round < 2 && !failed; ++round) {
+                if (client.websocket && !client.closing && client.out.empty()) {
+                    queueSnapshot(client, latest);
+                }
+                if (client.out.empty()) break;
+                failed = !writeClient(client);
+                if (!client.out.empty()) break;
+            }
+            if (failed) {
+                client.closing = true;
+                client.out.clear();
+            }
+        }
+        clients_.erase(std::remove_if(clients_.begin(), clients_.end(),
+            [](const Client& client) {
+                if (client.closing && client.out.empty()) {
+                    ::close(client.fd);
+                    return true;
+                }
+                return false;
+            }), clients_.end());
+        client_count_ = clients_.size();
+
+        fds.clear();
+        fds.push_back({listen_fd_, POLLIN, 0});
+        fds.push_back({wake_fds_[0], POLLIN, 0});
+        for (const auto& client : clients_) {
+            short events = POLLIN;
+            if (!client.out.empty()) events |= POLLOUT;
+            fds.push_back({client.fd, events, 0});
+        }
+
+        if (::poll(fds.data(), fds.size(), POLL_TIMEOUT_MS) < 0 && errno != EINTR) {
+            ATC_LOG_ERROR("Web display: poll failed: " + std::string(std::strerror(errno)));
+            break;
+        }
+
+        if (fds[1].revents & POLLIN) {
+            char drain[64];
+            while (::read(wake_fds_[0], drain, sizeof(drain)) > 0) {}
+        }
+        for (size_t i = 0; i < clients_.size(); ++i) {
+            short revents = fds[i + 2].revents;
+            if ((revents & (POLLERR | POLLHUP | POLLNVAL)) && !(revents & POLLIN)) {
+                clients_[i].closing = true;
+                clients_[i].out.clear();
+            } else if ((revents & POLLIN) && !readClient(clients_[i])) {
+                clients_[i].closing = true;
+                clients_[i].out.clear();
+            }
+        }
+        if (fds[0].revents & POLLIN) {
+            acceptClients();
+        }
+    }
+}
+
+void WebDisplayServer::acceptClients() {
+    while (true) {
+        int fd = ::accept(listen_fd_, nullptr, nullptr);
+        if (fd < 0) return;
+        if (!setNonBlocking(fd)) {
+            ::close(fd);
+            continue;
+        }
+        int send_buffer = CLIENT_SEND_BUFFER;
+        ::setsockopt(fd, SOL_SOCKET, SO_SNDBUF, &send_buffer, sizeof(send_buffer));
+        Client client;
+        client.fd = fd;
+        clients_.push_back(std::move(client));
+    }
+}
+
+bool WebDisplayServer::readClient(Client& client) {
+    char buffer[4096];
+    bool eof = false;
+    while (true) {
+        ssize_t n = ::recv(client.fd, buffer, sizeof(buffer), 0);
+        if (n > 0) {
+            client.in.append(buffer, static_cast<size_t>(n));
+            continue;
+        }
+        if (n == 0) {
+            eof = true;
+            break;
+        }
+        if (errno == EAGAIN || errno == EWOULDBLOCK) break;
+        if (errno != EINTR) return false;
+    }
+
+    bool ok = true;
+    if (client.closing) {
+        client.in.clear();
+    } else {
+        ok = client.websocket ? handleFrames(client) : handleRequest(client);
+    }
+    // A peer that stopped sending still gets any response already queued
+    if (eof) {
+        client.closing = true;
+    }
+    return ok;
+}
+
+bool WebDisplayServer::handleRequest(Client& client) {
+    size_t end = client.in.find("\r\n\r\n");
+    if (end == std::string::npos) {
+        return client.in.size() <= MAX_REQUEST_SIZE;
+    }
+
+    std::string request = client.in.substr(0, end);
+    client.in.erase(0, end + 4);
+
+    size_t line_end = request.find("\r\n");
+    std::string request_line = request.substr(0, line_end);
+    std::string method = request_line.substr(0, request_line.find(' '));
+    size_t path_start = request_line.find(' ');
+    size_t path_end = request_line.find(' ', path_start + 1);
+    std::string path = path_start == std::string::npos ? std::string()
+                       : request_line.substr(path_start + 1, path_end - path_start - 1);
+
+    std::string upgrade;
+    std::string key;
+    size_t pos = line_end == std::string::npos ? request.size() : line_end + 2;
+    while (pos < request.size()) {
+        size_t next = request.find("\r\n", pos);
+        if (next == std::string::npos) next = request.size();
+        std::string line = request.substr(pos, next - pos);
+        size_t colon = line.find(':');
+        if (colon != std::string::npos) {
+            std::string name = lowercase(trim(line.substr(0, colon)));
+            std::string value = trim(line.substr(colon + 1));
+            if (name == "upgrade") upgrade = lowercase(value);
+            else if (name == "sec-websocket-key") key = value;
+        }
+        pos = next + 2;
+    }
+
+    std::string response;
+    if (method == "GET" && path == "/ws" && upgrade == "websocket" && !key.empty()) {
+        response = "HTTP/1.1 101 Switching Protocols\r\n"
+                   "Upgrade: websocket\r\n"
+                   "Connection: Upgrade\r\n"
+                   "Sec-WebSocket-Accept: " + base64(sha1(key + WS_GUID)) + "\r\n\r\n";
+        client.websocket = true;
+        client.out += response;
+        return client.in.empty() || handleFrames(client);
+    }
+
+    if (method == "GET" && (path == "/" || path == "/index.html")) {
+        response = "HTTP/1.1 200 OK\r\n"
+                   "Content-Type: text/html; charset=utf-8\r\n"
+                   "Content-Length: " + std::to_string(page_.size()) + "\r\n"
+                   "Cache-Control: no-cache\r\n"
+                   "Connection: close\r\n\r\n" + page_;
+    } else if (method == "GET" && path == "/metrics") {
+        std::string body = metrics::MetricsRegistry::getInstance().expose();
+        response = "HTTP/1.1 200 OK\r\n"
+                   "Content-Type: text/plain; version=0.0.4; charset=utf-8\r\n"
+                   "Content-Length: " + std::to_string(body.size()) + "\r\n"
+                   "Cache-Control: no-cache\r\n"
+                   "Connection: close\r\n\r\n" + body;
+    } else {
+        static const std::string body = "Not found\n";
+        response = "HTTP/1.1 404 Not Found\r\n"
+                   "Content-Type: text/plain\r\n"
+                   "Content-Length: " + std::to_string(body.size()) + "\r\n"
+                   "Connection: close\r\n\r\n" + body;
+    }
+    client.out += response;
+    client.closing = true;
+    return true;
+}
+
+bool WebDisplayServer::handleFrames(Client& client) {
+    while (client.in.size() >= 2) {
+        auto byte0 = static_cast<uint8_t>(client.in[0]);
+        auto byte1 = static_cast<uint8_t>(client.in[1]);
+        uint8_t opcode = byte0 & 0x0F;
+        bool masked = (byte1 & 0x80) != 0;
+        uint64_t length = byte1 & 0x7F;
+        size_t header = 2;
+        if (length == 126) {
+            if (client.in.size() < 4) return true;
+            length = (uint8_t(client.in[2]) << 8) | uint8_t(client.in[3]);
+            header = 4;
+        } else if (length == 127) {
+            // Far beyond anything a display client sends
+            return false;
+        }
+        if (length > MAX_CLIENT_FRAME) return false;
+        size_t mask_offset = header;
+        if (masked) header += 4;
+        if (client.in.size() < header + length) return true;
+
+        std::string payload = client.in.substr(header, static_cast<size_t>(length));
+        if (masked) {
+            for (size_t i = 0; i < payload.size(); ++i) {
+                payload[i] = static_cast<char>(payload[i] ^ client.in[mask_offset + (i % 4)]);
+            }
+        }
+        client.in.erase(0, header + static_cast<size_t>(length));
+
+        if (opcode == WS_OPCODE_CLOSE) {
+            queueFrame(client, WS_OPCODE_CLOSE, payload.data(), std::min<size_t>(payload.size(), 2));
+            client.closing = true;
+            return true;
+        }
+        if (opcode == WS_OPCODE_PING) {
+            queueFrame(client, WS_OPCODE_PONG, payload.data(), payload.size());
+        }
+    }
+    return true;
+}
+
+void WebDisplayServer::queueSnapshot(Client& client, const std::shared_ptr<const Snapshot>& latest) {
+    if (!latest || (client.sent && client.sent->sequence == latest->sequence)) {
+        return;
+    }
+    if (client.sent && latest->sequence > client.sent->sequence + 1) {
+        snapshots_conflated_ += latest->sequence - client.sent->sequence - 1;
+    }
+    encodeSnapshotDelta(client.sent.get(), *latest, frame_scratch_);
+    queueFrame(client, WS_OPCODE_BINARY, frame_scratch_.data(), frame_scratch_.size());
+    client.sent = latest;
+    frames_sent_++;
+}
+
+void WebDisplayServer::queueFrame(Client& client, uint8_t opcode, const char* data, size_t size) {
+    client.out.push_back(static_cast<char>(0x80 | opcode));
+    if (size < 126) {
+        client.out.push_back(static_cast<char>(size));
+    } else if (size <= 0xFFFF) {
+        client.out.push_back(static_cast<char>(126));
+        client.out.push_back(static_cast<char>((size >> 8) & 0xFF));
+        client.out.push_back(static_cast<char>(size & 0xFF));
+    } else {
+        client.out.push_back(static_cast<char>(127));
+        for (int shift = 56; shift >= 0; shift -= 8) {
+            client.out.push_back(static_cast<char>((static_cast<uint64_t>(size) >> shift) & 0xFF));
+        }
+    }
+    client.out.append(data, size);
+}
+
+bool WebDisplayServer::writeClient(Client& client) {
+    while (client.out_offset < client.out.size()) {
+        ssize_t n = ::send(client.fd, client.out.data() + client.out_offset,
+                           client.out.size() - client.out_offset, MSG_NOSIGNAL);
+        if (n > 0) {
+            client.out_offset += static_cast<size_t>(n);
+            continue;
+        }
+        if (n < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) return true;
+        if (n < 0 && errno == EINTR) continue;
+        return false;
+    }
+    client.out.clear();
+    client.out_offset = 0;
+    return true;
+}
+
+const std::string& WebDisplayServer::defaultPage() {
+    static const std::string page = R"HTML(<!DOCTYPE html>
+<html>
+<head>
+<meta charset="utf-8">
+<title>ATC Situation Display</title>
+<style>
+body { margin: 0; background: #0b1320; color: #c8d3e0; font: 12px monospace; }
+#status { position: fixed; top: 8px; left: 8px; }
+canvas { display: block; margin: 0 auto; }
+</style>
+</head>
+<body>
+<div id="status">connecting...</div>
+<canvas id="scope"></canvas>
+<script>
+const AIRSPACE = 100000;
+const STATUS = ['ENTERING', 'CRUISING', 'HOLDING', 'EXITING', 'EMERGENCY'];
+const canvas = document.getElementById('scope');
+const ctx = canvas.getContext('2d');
+const statusLine = document.getElementById('status');
+const decoder = new TextDecoder();
+let tracks = new Map();
+let sequence = -1n;
+
+function connect() {
+  const ws = new WebSocket(`ws://${location.host}/ws`);
+  ws.binaryType = 'arraybuffer';
+  ws.onmessage = (event) => {
+    const view = new DataView(event.data);
+    const key = (view.getUint8(5) & 1) !== 0;
+    const next = view.getBigUint64(8, true);
+    const base = view.getBigUint64(16, true);
+    if (!key && base !== sequence) { ws.close(); return; }
+    if (key) tracks = new Map();
+    const upserts = view.getUint32(32, true);
+    const removals = view.getUint32(36, true);
+    let offset = 40;
+    const callsign = () => {
+      const length = view.getUint8(offset);
+      const text = decoder.decode(new Uint8Array(event.data, offset + 1, length));
+      offset += 1 + length;
+      return text;
+    };
+    for (let i = 0; i < upserts; i++) {
+      const id = callsign();
+      const f = (n) => view.getFloat32(offset + 4 * n, true);
+      tracks.set(id, { x: f(0), y: f(1), z: f(2), heading: f(3), speed: f(4),
+                       status: view.getUint8(offset + 20), flags: view.getUint8(offset + 21) });
+      offset += 22;
+    }
+    for (let i = 0; i < removals; i++) tracks.delete(callsign());
+    sequence = next;
+    statusLine.textContent = `${tracks.size} tracks, snapshot ${sequence}`;
+  };
+  ws.onclose = () => { statusLine.textContent = 'disconnected, retrying...'; sequence = -1n;
+                       setTimeout(connect, 1000); };
+}
+
+function draw() {
+  const size = Math.min(window.innerWidth, window.innerHeight);
+  if (canvas.width !== size) { canvas.width = size; canvas.height = size; }
+  ctx.fillStyle = '#0b1320';
+  ctx.fillRect(0, 0, size, size);
+  ctx.strokeStyle = '#1e2d44';
+  for (let i = 1; i < 4; i++) {
+    const p = i * size / 4;
+    ctx.beginPath(); ctx.moveTo(p, 0); ctx.lineTo(p, size); ctx.moveTo(0, p); ctx.lineTo(size, p); ctx.stroke();
+  }
+  for (const [id, t] of tracks) {
+    const x = t.x / AIRSPACE * size;
+    const y = size - t.y / AIRSPACE * size;
+    const color = (t.flags & 1) ? '#ff4040' : (t.flags & 2) ? '#ffd040' :
+                  t.status === 4 ? '#ff80ff' : '#40e070';
+    const rad = t.heading * Math.PI / 180;
+    ctx.strokeStyle = ctx.fillStyle = color;
+    ctx.fillRect(x - 2, y - 2, 4, 4);
+    ctx.beginPath(); ctx.moveTo(x, y);
+    ctx.lineTo(x + Math.cos(rad) * 12, y - Math.sin(rad) * 12); ctx.stroke();
+    ctx.fillText(`${id} FL${Math.round(t.z / 100)} ${STATUS[t.status] || ''}`, x + 5, y - 5);
+  }
+  requestAnimationFrame(draw);
+}
+
+connect();
+requestAnimationFrame(draw);
+</script>
+</body>
+</html>
+)HTML";
+    return page;
+}
+
+}
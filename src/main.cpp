@@ -1,12 +1,28 @@
 #include "core/aircraft.h"
 #include "core/violation_detector.h"
 #include "core/radar_system.h"
+#include "core/aircraft_registry.h"
+#include "core/traffic_forecast.h"
+#include "core/arrival_sequencer.h"
 #include "display/display_system.h"
 #include "common/types.h"
 #include "common/constants.h"
 #include "common/logger.h"
 #include "common/history_logger.h"
+#include "common/log_flusher.h"
+#include "common/metrics.h"
+#include "common/perf_counters.h"
+#include "common/trail_store.h"
+#include "common/process_supervisor.h"
+#include "common/journal.h"
+#include "common/sim_clock.h"
+#include "common/virtual_scheduler.h"
+#include "display/web_display_server.h"
+#include "common/timestamp.h"
 #include "communication/qnx_channel.h"
+#include "communication/shm_ring.h"
+#include "communication/replication.h"
+#include "communication/situation_frames.h"
 #include <iostream>
 #include <iomanip>
 #include <thread>
@@ -20,6 +36,10 @@
 #include <algorithm>
 #include <chrono>
 #include <ctime>
+#include <deque>
+#include <random>
+#include <unordered_map>
+#include <unordered_set>
 
 namespace {
     std::atomic<bool> g_running{true};
@@ -30,57 +50,119 @@ namespace {
 
 namespace atc {
 
-// System metrics structure for tracking performance and statistics
+namespace {
+LogEvent dropped_frames("frames dropped on a full shared-memory ring", LogLevel::WARNING);
+
+metrics::Counter cycles_run("atc_cycles_total", "Main control cycles run");
+metrics::Counter violation_checks("atc_violation_checks_total", "Cycles that checked for separation violations");
+metrics::Counter display_updates("atc_display_updates_total", "Console display updates");
+metrics::Counter alerts_raised("atc_alerts_total", "Alerts raised");
+metrics::Gauge active_aircraft("atc_active_aircraft", "Aircraft in the system");
+metrics::Histogram cycle_seconds("atc_cycle_duration_seconds", "Time spent in a control cycle",
+                                 metrics::Histogram::latencyBounds());
+
+const char* const TRACKS_RING = "/atc_tracks";         // surveillance -> detection
+const char* const SITUATION_RING = "/atc_situation";   // detection -> presentation
+const char* const REPLICATION_RING = "/atc_replication"; // primary -> hot standby
+}
+
+// Which parts of the system a process runs. ALL is the single-process deployment;
+// the others are the processes of a split deployment (--split), which hand track
+// states and alerts down the shared-memory rings above.
+enum class ProcessRole {
+    ALL,
+    SURVEILLANCE,   // aircraft, radar and the command channel
+    DETECTION,      // separation checks and the conflict log
+    PRESENTATION    // displays and history
+};
+
+// Report times; the counts live in the metrics registry (common/metrics.h)
 struct SystemMetrics {
     std::chrono::steady_clock::time_point start_time;
     std::chrono::steady_clock::time_point last_update_time;
-    uint64_t processed_updates;
-    uint64_t violation_checks;
-    uint64_t radar_updates;
-    uint64_t display_updates;
 
     SystemMetrics()
         : start_time(std::chrono::steady_clock::now())
-        , last_update_time(std::chrono::steady_clock::now())
-        , processed_updates(0)
-        , violation_checks(0)
-        , radar_updates(0)
-        , display_updates(0) {}
+        , last_update_time(std::chrono::steady_clock::now()) {}
 };
 
 class ATCSystem {
 public:
-    ATCSystem()
-        : violation_detector_(std::make_shared<ViolationDetector>())
-        , display_system_(std::make_shared<DisplaySystem>(violation_detector_))
-        , history_logger_(std::make_shared<HistoryLogger>("atc_history.log"))
+    // A replaying system takes its channel messages from the journal and runs no presentation
+    explicit ATCSystem(ProcessRole role = ProcessRole::ALL, bool replaying = false)
+        : role_(role)
+        , replaying_(replaying)
+        , violation_detector_(std::make_shared<ViolationDetector>())
+        , log_flusher_(std::make_shared<LogFlusher>())
         , metrics_() {
 
         // Initialize signal handlers
         std::signal(SIGINT, signal_handler);
         std::signal(SIGTERM, signal_handler);
 
-        // Initialize communication channel
-        channel_ = std::make_shared<comm::QnxChannel>("ATC_CHANNEL");
-        if (!channel_->initialize()) {
-            Logger::getInstance().log("Failed to initialize communication channel");
-            throw std::runtime_error("Failed to initialize communication channel");
+        if (runsSurveillance()) {
+            // Initialize communication channel
+            if (!replaying_) {
+                channel_ = std::make_shared<comm::QnxChannel>("ATC_CHANNEL");
+                if (!channel_->initialize()) {
+                    ATC_LOG_ERROR("Failed to initialize communication channel");
+                    throw std::runtime_error("Failed to initialize communication channel");
+                }
+            }
+
+            // Initialize radar system
+            radar_system_ = std::make_shared<RadarSystem>(channel_);
+            if (!radar_system_) {
+                ATC_LOG_ERROR("Failed to initialize radar system");
+                throw std::runtime_error("Failed to initialize radar system");
+            }
         }
 
-        // Initialize radar system
-        radar_system_ = std::make_shared<RadarSystem>(channel_);
-        if (!radar_system_) {
-            Logger::getInstance().log("Failed to initialize radar system");
-            throw std::runtime_error("Failed to initialize radar system");
+        if (runsDetection()) {
+            conflict_log_ = std::make_shared<ConflictLog>("history");
+            if (!conflict_log_->isOperational()) {
+                ATC_LOG_WARNING("Conflict log unavailable - violations will only be logged as text");
+            }
+            violation_detector_->setConflictLog(conflict_log_);
+            // Event-driven pair checks instead of every pair every pass
+            if (const char* kinetic = std::getenv("ATC_KINETIC_DETECTION")) {
+                violation_detector_->setKinetic(std::string(kinetic) == "1");
+            }
+            if (const char* certificates = std::getenv("ATC_PAIR_CERTIFICATES")) {
+                violation_detector_->setCertificates(std::string(certificates) != "0");
+            }
+            // Anytime detection: most urgent pairs first, the rest next pass
+            if (const char* budget = std::getenv("ATC_DETECTION_BUDGET_US")) {
+                violation_detector_->setCheckBudget(std::chrono::microseconds(std::atoll(budget)));
+            }
+        }
+
+        if (runsPresentation()) {
+            // The presentation process keeps its own detector over mirrored tracks for the display
+            display_system_ = std::make_shared<DisplaySystem>(violation_detector_);
+            history_logger_ = std::make_shared<HistoryLogger>("atc_history.log");
+            history_compressor_ = std::make_shared<HistoryCompressor>();
+            trail_store_ = std::make_shared<TrailStore>();
+            web_display_ = std::make_shared<WebDisplayServer>(constants::WEB_DISPLAY_PORT);
+
+            // Check history logger
+            if (!history_logger_->isOperational()) {
+                ATC_LOG_ERROR("Failed to initialize history logger");
+                throw std::runtime_error("Failed to initialize history logger");
+            }
+            history_logger_->setCompressor(history_compressor_);
+            display_system_->setTrailStore(trail_store_);
         }
 
-        // Check history logger
-        if (!history_logger_->isOperational()) {
-            Logger::getInstance().log("Failed to initialize history logger");
-            throw std::runtime_error("Failed to initialize history logger");
+        // Rings are created by the supervisor before any role starts
+        if (role_ == ProcessRole::DETECTION || role_ == ProcessRole::PRESENTATION) {
+            input_ring_ = openRing(role_ == ProcessRole::DETECTION ? TRACKS_RING : SITUATION_RING);
+        }
+        if (role_ == ProcessRole::SURVEILLANCE || role_ == ProcessRole::DETECTION) {
+            output_ring_ = openRing(role_ == ProcessRole::SURVEILLANCE ? TRACKS_RING : SITUATION_RING);
         }
 
-        Logger::getInstance().log("ATC System initialized successfully");
+        ATC_LOG_INFO("ATC System initialized successfully");
     }
 
     ~ATCSystem() {
@@ -92,31 +174,41 @@ public:
     }
 
     void cleanup() {
-        Logger::getInstance().log("Starting system cleanup...");
+        ATC_LOG_INFO("Starting system cleanup...");
 
         if (radar_system_) {
-            Logger::getInstance().log("Stopping radar system...");
+            ATC_LOG_INFO("Stopping radar system...");
             radar_system_->stop();
         }
 
         if (history_logger_) {
-            Logger::getInstance().log("Stopping history logger...");
+            ATC_LOG_INFO("Stopping history logger...");
             history_logger_->stop();
         }
 
+        if (history_compressor_) {
+            ATC_LOG_INFO("Stopping history compressor...");
+            history_compressor_->stop();
+        }
+
+        if (web_display_) {
+            ATC_LOG_INFO("Stopping web display...");
+            web_display_->stop();
+        }
+
         if (display_system_) {
-            Logger::getInstance().log("Stopping display system...");
+            ATC_LOG_INFO("Stopping display system...");
             display_system_->stop();
         }
 
         if (violation_detector_) {
-            Logger::getInstance().log("Stopping violation detector...");
+            ATC_LOG_INFO("Stopping violation detector...");
             violation_detector_->stop();
         }
 
         for (const auto& aircraft : aircraft_) {
             if (aircraft) {
-                Logger::getInstance().log("Stopping aircraft: " + aircraft->getState().callsign);
+                ATC_LOG_INFO("Stopping aircraft: " + aircraft->getCallsign());
                 aircraft->stop();
             }
         }
@@ -127,26 +219,81 @@ public:
         logFinalStatistics();
 
         channel_.reset();
-        Logger::getInstance().log("System cleanup completed successfully.");
+        ATC_LOG_INFO("System cleanup completed successfully.");
+
+        if (log_flusher_) {
+            log_flusher_->stop();
+        }
+        Logger::getInstance().flushAll();
+    }
+
+    // Primary side of a hot-standby pair (--primary): states, alerts and commands
+    // are streamed to the standby, which creates the ring
+    void enableReplication() {
+        replication_ = std::make_unique<comm::ReplicationWriter>(REPLICATION_RING);
+    }
+
+    // Takes over from a failed primary with the standby's replica in place of the data file
+    bool adoptReplica(const comm::ReplicaState& replica) {
+        for (const auto& state : replica.getStates()) {
+            try {
+                auto aircraft = std::make_shared<Aircraft>(state.callsign, state.position, state.velocity);
+                aircraft->setState(state);
+                aircraft_.add(aircraft);
+                violation_detector_->addAircraft(aircraft);
+                radar_system_->addAircraft(aircraft);
+            } catch (const std::exception& e) {
+                ATC_LOG_ERROR("Cannot take over aircraft " + state.callsign + ": " + e.what());
+            }
+        }
+
+        // Commands the primary applied after its last delta are not in the states yet
+        for (const auto& command : replica.getPendingCommands()) {
+            handleCommand(command);
+        }
+        for (const auto& alert : replica.getRecentAlerts()) {
+            raiseAlert(alert);
+        }
+
+        ATC_LOG_INFO("Took over " + std::to_string(aircraft_.size()) +
+                     " aircraft at replication sequence " + std::to_string(replica.getSequence()));
+        return !aircraft_.empty();
+    }
+
+    // Recording (--record): inputs and alerts go to the journal as they are handled
+    void setJournal(const std::shared_ptr<JournalWriter>& journal) {
+        journal_ = journal;
+    }
+
+    // Replay (--replay): channel messages to inject and the alerts the recording raised
+    void setReplayInputs(std::deque<JournalEntry> messages, std::deque<JournalEntry> alerts) {
+        replay_messages_ = std::move(messages);
+        expected_alerts_ = std::move(alerts);
     }
 
     bool loadAircraftData(const std::string& filename) {
-        Logger::getInstance().log("Loading aircraft data from: " + filename);
+        ATC_LOG_INFO("Loading aircraft data from: " + filename);
         std::ifstream file(filename);
         if (!file) {
-            Logger::getInstance().log("ERROR: Cannot open file: " + filename);
+            ATC_LOG_ERROR("ERROR: Cannot open file: " + filename);
             return false;
         }
+        return loadAircraftRows(file);
+    }
 
+    bool loadAircraftRows(std::istream& file) {
         std::string line;
         if (!std::getline(file, line)) {
-            Logger::getInstance().log("ERROR: Empty file or cannot read header");
+            ATC_LOG_ERROR("ERROR: Empty file or cannot read header");
             return false;
         }
+        if (journal_) {
+            journal_->writeScenarioRow(std::chrono::milliseconds(0), line);
+        }
 
         // Verify header format
         if (line != "Time,ID,X,Y,Z,SpeedX,SpeedY,SpeedZ") {
-            Logger::getInstance().log("ERROR: Invalid header format");
+            ATC_LOG_ERROR("ERROR: Invalid header format");
             return false;
         }
 
@@ -156,6 +303,9 @@ public:
 
         while (std::getline(file, line)) {
             if (line.empty()) continue;
+            if (journal_) {
+                journal_->writeScenarioRow(std::chrono::milliseconds(0), line);
+            }
 
             std::istringstream iss(line);
             std::string token;
@@ -166,7 +316,7 @@ public:
             }
 
             if (tokens.size() != 8) {
-                Logger::getInstance().log("ERROR: Invalid number of fields in line: " + line);
+                ATC_LOG_ERROR("ERROR: Invalid number of fields in line: " + line);
                 error_count++;
                 continue;
             }
@@ -181,39 +331,32 @@ public:
                 double speedY = std::stod(tokens[6]);
                 double speedZ = std::stod(tokens[7]);
 
-                // Validate position
-                if (x < constants::AIRSPACE_X_MIN || x > constants::AIRSPACE_X_MAX ||
-                    y < constants::AIRSPACE_Y_MIN || y > constants::AIRSPACE_Y_MAX ||
-                    z < constants::AIRSPACE_Z_MIN || z > constants::AIRSPACE_Z_MAX) {
+                Position pos{x, y, z};
+                Velocity vel{speedX, speedY, speedZ};
 
-                    Logger::getInstance().log("ERROR: Position out of bounds for aircraft " + id);
-                    failed_entries.push_back(id + " (Invalid Position)");
+                if (aircraft_.contains(id)) {
+                    ATC_LOG_ERROR("ERROR: Duplicate aircraft " + id);
+                    failed_entries.push_back(id + " (Duplicate)");
                     error_count++;
                     continue;
                 }
-
-                // Validate speed
-                double speed = std::sqrt(speedX*speedX + speedY*speedY + speedZ*speedZ);
-                if (speed < constants::MIN_SPEED || speed > constants::MAX_SPEED) {
-                    Logger::getInstance().log("ERROR: Invalid speed for aircraft " + id);
-                    failed_entries.push_back(id + " (Invalid Speed)");
+                if (const char* problem = entryProblem(pos, vel)) {
+                    ATC_LOG_ERROR("ERROR: " + std::string(problem) + " for aircraft " + id);
+                    failed_entries.push_back(id + " (" + problem + ")");
                     error_count++;
                     continue;
                 }
 
-                Position pos{x, y, z};
-                Velocity vel{speedX, speedY, speedZ};
-
                 auto aircraft = std::make_shared<Aircraft>(id, pos, vel);
-                aircraft_.push_back(aircraft);
+                aircraft_.add(aircraft);
                 violation_detector_->addAircraft(aircraft);
                 radar_system_->addAircraft(aircraft);
 
                 success_count++;
-                Logger::getInstance().log("Successfully loaded aircraft: " + id);
+                ATC_LOG_INFO("Successfully loaded aircraft: " + id);
 
             } catch (const std::exception& e) {
-                Logger::getInstance().log("ERROR: Failed to parse aircraft data: " + std::string(e.what()));
+                ATC_LOG_ERROR("ERROR: Failed to parse aircraft data: " + std::string(e.what()));
                 failed_entries.push_back(tokens[1] + " (" + e.what() + ")");
                 error_count++;
                 continue;
@@ -233,44 +376,178 @@ public:
             }
         }
 
-        Logger::getInstance().log(summary.str());
+        ATC_LOG_INFO(summary.str());
         return success_count > 0;
     }
 
     void run() {
-        Logger::getInstance().log("Starting ATC System components...");
+        ATC_LOG_INFO("Starting ATC System components...");
+        log_flusher_->start();
 
-        radar_system_->start();
-        Logger::getInstance().log("Radar system started");
+        if (runsSurveillance()) {
+            radar_system_->start();
+            ATC_LOG_INFO("Radar system started");
 
-        for (const auto& aircraft : aircraft_) {
-            aircraft->start();
-            Logger::getInstance().log("Started aircraft: " + aircraft->getState().callsign);
+            for (const auto& aircraft : aircraft_) {
+                aircraft->start();
+                ATC_LOG_INFO("Started aircraft: " + aircraft->getCallsign());
+            }
         }
 
-        violation_detector_->start();
-        display_system_->start();
-        history_logger_->start();
+        if (runsDetection()) {
+            violation_detector_->start();
+        }
+        startPresentation();
 
-        Logger::getInstance().log("All system components started");
+        ATC_LOG_INFO("All system components started");
 
         auto last_metrics_update = std::chrono::steady_clock::now();
+        auto last_metrics_write = last_metrics_update;
 
         while (isRunning()) {
             auto cycle_start = std::chrono::steady_clock::now();
 
-            // Get current aircraft states
-            std::vector<std::shared_ptr<Aircraft>> current_aircraft = aircraft_;
+            // Downstream processes run a cycle per batch of states from the ring
+            if (!input_ring_ || receiveFrames()) {
+                runTimedCycle(cycle_start);
+            }
+
+            // Process system tasks
+            processSystemTasks();
+
+            // Log metrics every 60 seconds
+            auto now = std::chrono::steady_clock::now();
+            if (std::chrono::duration_cast<std::chrono::seconds>(
+                now - last_metrics_update).count() >= 60) {
+                logSystemMetrics();
+                last_metrics_update = now;
+            }
+
+            // Prometheus text file for a local scraper
+            if (now - last_metrics_write >= std::chrono::milliseconds(constants::METRICS_INTERVAL)) {
+                metrics::MetricsRegistry::getInstance().writeFile(metricsPath());
+                last_metrics_write = now;
+            }
+
+            // Maintain update cycle timing
+            auto cycle_end = std::chrono::steady_clock::now();
+            auto cycle_duration = std::chrono::duration_cast<std::chrono::milliseconds>(
+                cycle_end - cycle_start);
+
+            if (!input_ring_ && cycle_duration.count() < 100) {
+                std::this_thread::sleep_for(std::chrono::milliseconds(100) - cycle_duration);
+            }
+        }
+
+        cleanup();
+    }
+
+    // Record and replay: aircraft, radar, detector and the main cycle take turns
+    // on this thread in virtual time, so the run depends only on the journaled
+    // inputs. Presentation keeps its own threads; it only reads the results.
+    void runScheduled(VirtualScheduler& scheduler, std::chrono::milliseconds until) {
+        ATC_LOG_INFO("Starting ATC System components in virtual time...");
+        log_flusher_->start();
+        scheduler_ = &scheduler;
+
+        for (const auto& aircraft : aircraft_) {
+            scheduler.addTask(aircraft);
+        }
+        scheduler.addTask(radar_system_);
+        scheduler.addTask(violation_detector_);
+        startPresentation();
+
+        // Same cycle as run()
+        scheduler.addPeriodic(scheduler.now(), [this] {
+            runTimedCycle(sim_clock::steadyNow());
+            processSystemTasks();
+            if (journal_) {
+                journal_->flush();
+            }
+            return true;
+        }, [] { return std::chrono::milliseconds(100); });
+
+        ATC_LOG_INFO("All system components scheduled");
+        scheduler.runUntil(until, g_running);
+        cleanup();
+    }
+
+    // True if the replay raised exactly the recorded alerts
+    bool reportReplay() {
+        replay_mismatches_ += expected_alerts_.size();
+        if (replay_mismatches_ == 0) {
+            ATC_LOG_INFO("Replay reproduced all " + std::to_string(replay_matched_) + " recorded alerts");
+            return true;
+        }
+        ATC_LOG_ERROR("Replay diverged from the recording: " + std::to_string(replay_matched_) +
+                      " alerts matched, " + std::to_string(replay_mismatches_) + " differed");
+        return false;
+    }
+
+private:
+    bool runsSurveillance() const {
+        return role_ == ProcessRole::ALL || role_ == ProcessRole::SURVEILLANCE;
+    }
+    bool runsDetection() const {
+        return role_ == ProcessRole::ALL || role_ == ProcessRole::DETECTION;
+    }
+    bool runsPresentation() const {
+        return !replaying_ && (role_ == ProcessRole::ALL || role_ == ProcessRole::PRESENTATION);
+    }
+
+    void startPresentation() {
+        if (!runsPresentation()) return;
+        display_system_->start();
+        history_logger_->start();
+        history_compressor_->start();
+        if (!web_display_->start()) {
+            ATC_LOG_WARNING("Web display unavailable - continuing with the terminal display only");
+        }
+    }
+
+    void runCycle(std::chrono::steady_clock::time_point cycle_start) {
+        // Get current aircraft states
+        if (runsSurveillance()) {
+            applyAdmissions();
+        }
+        const std::vector<std::shared_ptr<Aircraft>>& current_aircraft = aircraft_.all();
+        states_.clear();
+        for (const auto& aircraft : current_aircraft) {
+            states_.push_back(aircraft->getState());
+        }
+
+        if (replication_) {
+            replication_->appendStates(states_);
+        }
+
+        if (role_ == ProcessRole::SURVEILLANCE) {
+            comm::encodeTrackStates(states_, frame_);
+            writeFrame();
+            return;
+        }
+
+        if (runsPresentation()) {
+            // Extend track trails in one pass over all aircraft
+            trail_store_->update(states_);
 
             // Update display
             display_system_->updateDisplay(current_aircraft);
-            metrics_.display_updates++;
+            display_updates.increment();
 
             // Update history logger
             history_logger_->updateAircraftStates(current_aircraft);
+        }
 
-            // Get violations from detector
-            auto violations = violation_detector_->getCurrentViolations();
+        // Detection passes the states on first so presentation draws the batch the alerts refer to
+        if (role_ == ProcessRole::DETECTION) {
+            comm::encodeTrackStates(states_, frame_);
+            writeFrame();
+        }
+
+        // Get violations from detector
+        auto violations = violation_detector_->getCurrentViolations();
+        auto predictions = violation_detector_->getPredictedViolations();
+        if (runsDetection()) {
             for (const auto& violation : violations) {
                 std::ostringstream alert;
                 alert << "Separation violation between "
@@ -279,11 +556,10 @@ public:
                       << " (H:" << std::fixed << std::setprecision(1)
                       << violation.horizontal_separation
                       << ", V:" << violation.vertical_separation << ")";
-                display_system_->displayAlert(alert.str());
+                raiseAlert(alert.str());
             }
 
             // Check predicted violations
-            auto predictions = violation_detector_->getPredictedViolations();
             for (const auto& pred : predictions) {
                 std::ostringstream alert;
                 alert << "Predicted violation in "
@@ -291,40 +567,267 @@ public:
                       << pred.time_to_violation << "s between "
                       << pred.aircraft1_id << " and "
                       << pred.aircraft2_id;
-                display_system_->displayAlert(alert.str());
+                raiseAlert(alert.str());
             }
+            violation_checks.increment();
 
-            metrics_.violation_checks++;
+            if (cycle_start - last_forecast_update_ >=
+                std::chrono::milliseconds(constants::TRAFFIC_FORECAST_INTERVAL)) {
+                updateTrafficPredictions(cycle_start);
+                last_forecast_update_ = cycle_start;
+            }
+        }
 
-            // Process system tasks
-            processSystemTasks();
-            metrics_.processed_updates++;
+        // Browser display gets a snapshot each time aircraft positions move
+        if (runsPresentation() &&
+            cycle_start - last_web_publish_ >= std::chrono::milliseconds(constants::WEB_DISPLAY_INTERVAL)) {
+            publishWebSnapshot(violations, predictions);
+            last_web_publish_ = cycle_start;
+        }
+    }
 
-            // Log metrics every 60 seconds
-            auto now = std::chrono::steady_clock::now();
-            if (std::chrono::duration_cast<std::chrono::seconds>(
-                now - last_metrics_update).count() >= 60) {
-                logSystemMetrics();
-                last_metrics_update = now;
+    void runTimedCycle(std::chrono::steady_clock::time_point cycle_start) {
+        auto started = std::chrono::steady_clock::now();
+        runCycle(cycle_start);
+        cycle_seconds.observe(std::chrono::duration<double>(std::chrono::steady_clock::now() - started).count());
+        cycles_run.increment();
+        active_aircraft.set(static_cast<double>(states_.size()));
+    }
+
+    std::unique_ptr<comm::ShmRing> openRing(const char* name) {
+        auto ring = std::make_unique<comm::ShmRing>(name);
+        if (!ring->open()) {
+            throw std::runtime_error(std::string("Failed to open shared memory ring ") + name);
+        }
+        return ring;
+    }
+
+    // Shows an alert here, or hands it down the ring to the process that shows it
+    void raiseAlert(const std::string& text) {
+        alerts_raised.increment();
+        if (replication_) {
+            replication_->appendAlert(text);
+        }
+        if (journal_) {
+            journal_->writeAlert(scheduler_->now(), text);
+        }
+        if (replaying_) {
+            checkReplayedAlert(text);
+        }
+        if (display_system_) {
+            display_system_->displayAlert(text);
+        } else if (output_ring_) {
+            comm::encodeAlert(text, alert_frame_);
+            if (!output_ring_->write(alert_frame_.data(), alert_frame_.size()) && dropped_frames.record()) {
+                ATC_LOG_WARNING("Ring full, dropping alert: " + text);
             }
+        }
+    }
 
-            // Maintain update cycle timing
-            auto cycle_end = std::chrono::steady_clock::now();
-            auto cycle_duration = std::chrono::duration_cast<std::chrono::milliseconds>(
-                cycle_end - cycle_start);
+    // A replay has to raise the recorded alerts at the recorded times, in order
+    void checkReplayedAlert(const std::string& text) {
+        auto now = scheduler_->now();
+        // Recorded alerts from earlier cycles that the replay never raised
+        while (!expected_alerts_.empty() && expected_alerts_.front().at < now) {
+            reportReplayDivergence(now, "missed '" + expected_alerts_.front().payload + "' from " +
+                                   std::to_string(expected_alerts_.front().at.count()) + " ms");
+            expected_alerts_.pop_front();
+        }
 
-            if (cycle_duration.count() < 100) {
-                std::this_thread::sleep_for(std::chrono::milliseconds(100) - cycle_duration);
+        if (expected_alerts_.empty() || expected_alerts_.front().at > now) {
+            reportReplayDivergence(now, "raised '" + text + "', which the recording did not");
+            return;
+        }
+        if (expected_alerts_.front().payload == text) {
+            replay_matched_++;
+        } else {
+            reportReplayDivergence(now, "raised '" + text + "' where the recording had '" +
+                                   expected_alerts_.front().payload + "'");
+        }
+        expected_alerts_.pop_front();
+    }
+
+    // Only the first divergence is spelled out; the rest follow from it
+    void reportReplayDivergence(std::chrono::milliseconds at, const std::string& what) {
+        if (replay_mismatches_++ == 0) {
+            ATC_LOG_ERROR("Replay diverged at " + std::to_string(at.count()) + " ms: " + what);
+        }
+    }
+
+    void writeFrame() {
+        if (!output_ring_->write(frame_.data(), frame_.size()) && dropped_frames.record()) {
+            ATC_LOG_WARNING("Ring full, dropping track states - is the next process running?");
+        }
+    }
+
+    // Drains the input ring, waiting up to one cycle for the first frame. True if track states arrived.
+    bool receiveFrames() {
+        bool fresh = false;
+        int64_t timeout_us = 100000;
+        while (input_ring_->read(frame_, timeout_us)) {
+            timeout_us = 0;
+            comm::FrameKind kind;
+            std::string alert;
+            if (!comm::frameKind(frame_, kind)) {
+                ATC_LOG_WARNING("Ignoring malformed frame from the shared memory ring");
+            } else if (kind == comm::FrameKind::TRACK_STATES) {
+                if (comm::decodeTrackStates(frame_, received_states_)) {
+                    mirrorStates(received_states_);
+                    fresh = true;
+                }
+            } else if (comm::decodeAlert(frame_, alert)) {
+                raiseAlert(alert);
             }
         }
+        return fresh;
+    }
 
-        cleanup();
+    // Downstream processes track aircraft through mirrors whose tasks never run;
+    // the detector and display use them exactly like locally simulated aircraft
+    void mirrorStates(const std::vector<AircraftState>& states) {
+        for (const auto& state : states) {
+            auto aircraft = aircraft_.find(state.callsign);
+            if (!aircraft) {
+                try {
+                    aircraft = std::make_shared<Aircraft>(state.callsign, state.position, state.velocity);
+                    aircraft_.add(aircraft);
+                    violation_detector_->addAircraft(aircraft);
+                } catch (const std::exception& e) {
+                    ATC_LOG_WARNING("Cannot mirror aircraft " + state.callsign + ": " + e.what());
+                    continue;
+                }
+            }
+            aircraft->setState(state);
+        }
+
+        if (aircraft_.size() > states.size()) {
+            std::unordered_set<std::string> live;
+            for (const auto& state : states) {
+                live.insert(state.callsign);
+            }
+            std::vector<std::string> gone;
+            for (const auto& aircraft : aircraft_) {
+                if (!live.count(aircraft->getCallsign())) {
+                    gone.push_back(aircraft->getCallsign());
+                }
+            }
+            for (const auto& callsign : gone) {
+                aircraft_.remove(callsign);
+            }
+            violation_detector_->removeAircraft(gone);
+            forgetPredictions(gone);
+        }
+    }
+
+    // The load forecast and the arrival sequencer share the predicted
+    // trajectories; only aircraft whose trajectory changed are looked at again
+    void updateTrafficPredictions(std::chrono::steady_clock::time_point cycle_start) {
+        double now = std::chrono::duration<double>(sim_clock::systemNow().time_since_epoch()).count();
+        traffic_forecast_.advance(now);
+        AircraftState state;
+        for (const auto& aircraft : aircraft_) {
+            RouteProgress progress = aircraft->getRouteProgress(state);
+            bool rebuilt = false;
+            auto trajectory = traffic_trajectories_.get(state, progress, &rebuilt);
+            if (rebuilt) {
+                traffic_forecast_.update(state.callsign, trajectory);
+                if (progress.route) {
+                    arrival_sequencer_.update(state.callsign, *progress.route, trajectory);
+                } else {
+                    arrival_sequencer_.remove(state.callsign);
+                }
+            }
+        }
+
+        for (const auto& overload : traffic_forecast_.takeOverloads()) {
+            std::ostringstream alert;
+            alert << "Sector " << overload.sector << " forecast over capacity: "
+                  << overload.aircraft << " aircraft ";
+            if (overload.bin_start <= now) {
+                alert << "now";
+            } else {
+                alert << "in " << static_cast<int>(std::ceil((overload.bin_start - now) / 60.0)) << " min";
+            }
+            raiseAlert(alert.str());
+        }
+
+        if (cycle_start - last_arrival_sequence_ >=
+            std::chrono::milliseconds(constants::ARRIVAL_SEQUENCE_INTERVAL)) {
+            sequenceArrivals(now);
+            last_arrival_sequence_ = cycle_start;
+        }
+    }
+
+    void sequenceArrivals(double now) {
+        for (const auto& slot : arrival_sequencer_.resequence(now)) {
+            std::ostringstream advisory;
+            advisory << "Arrival advisory: " << slot.callsign;
+            if (slot.hold) {
+                advisory << " hold, " << std::fixed << std::setprecision(0)
+                         << slot.scheduled - slot.eta << "s delay";
+            } else if (slot.advised_speed > 0.0) {
+                advisory << " reduce speed to " << std::fixed << std::setprecision(0)
+                         << slot.advised_speed << ", landing in " << slot.scheduled - now << "s";
+            } else {
+                continue;   // back on its own schedule; nothing to tell
+            }
+            raiseAlert(advisory.str());
+        }
+    }
+
+    void forgetPredictions(const std::vector<std::string>& callsigns) {
+        for (const auto& callsign : callsigns) {
+            traffic_forecast_.remove(callsign);
+            arrival_sequencer_.remove(callsign);
+            traffic_trajectories_.erase(callsign);
+        }
+    }
+
+    void publishWebSnapshot(const std::vector<ViolationInfo>& violations,
+                            const std::vector<ViolationDetector::ViolationPrediction>& predictions) {
+        auto snapshot = std::make_shared<Snapshot>(makeSnapshot(
+            states_, ++web_sequence_,
+            std::chrono::duration_cast<std::chrono::milliseconds>(
+                std::chrono::system_clock::now().time_since_epoch()).count()));
+
+        auto markTrack = [&snapshot](const std::string& callsign, uint8_t flag) {
+            auto it = std::lower_bound(snapshot->tracks.begin(), snapshot->tracks.end(), callsign,
+                [](const SnapshotTrack& track, const std::string& key) { return track.callsign < key; });
+            if (it != snapshot->tracks.end() && it->callsign == callsign) {
+                it->flags |= flag;
+            }
+        };
+        for (const auto& violation : violations) {
+            markTrack(violation.aircraft1_id, TRACK_FLAG_VIOLATION);
+            markTrack(violation.aircraft2_id, TRACK_FLAG_VIOLATION);
+        }
+        for (const auto& prediction : predictions) {
+            markTrack(prediction.aircraft1_id, TRACK_FLAG_PREDICTED);
+            markTrack(prediction.aircraft2_id, TRACK_FLAG_PREDICTED);
+        }
+        web_display_->publish(std::move(snapshot));
     }
 
-private:
     void processSystemTasks() {
         comm::Message msg;
+        if (replaying_) {
+            // Each message is handled in the cycle the recording handled it in
+            while (!replay_messages_.empty() && replay_messages_.front().at <= scheduler_->now()) {
+                if (JournalReader::decodeMessage(replay_messages_.front().payload, msg)) {
+                    handleMessage(msg);
+                } else {
+                    ATC_LOG_WARNING("Skipping malformed message in the journal");
+                }
+                replay_messages_.pop_front();
+            }
+            return;
+        }
+
+        if (!channel_) return;
         while (channel_->receiveMessage(msg, 0)) {
+            if (journal_) {
+                journal_->writeMessage(scheduler_->now(), msg);
+            }
             handleMessage(msg);
         }
     }
@@ -348,68 +851,193 @@ private:
                     handleStatusRequest(msg.sender_id);
                     break;
 
+                case comm::MessageType::FLIGHT_PLAN:
+                    handleFlightPlan(std::get<comm::FlightPlanData>(msg.payload));
+                    break;
+
+                case comm::MessageType::AIRCRAFT_ENTER:
+                    pending_admissions_.push_back({true, std::get<AircraftState>(msg.payload)});
+                    break;
+
+                case comm::MessageType::AIRCRAFT_EXIT:
+                    pending_admissions_.push_back({false, std::get<AircraftState>(msg.payload)});
+                    break;
+
                 default:
-                    Logger::getInstance().log("Unknown message type received from " + msg.sender_id);
+                    ATC_LOG_WARNING("Unknown message type received from " + msg.sender_id);
             }
         } catch (const std::exception& e) {
-            Logger::getInstance().log("Error handling message: " + std::string(e.what()));
+            ATC_LOG_ERROR("Error handling message: " + std::string(e.what()));
         }
     }
 
     void handleCommand(const comm::CommandData& cmd) {
-        Logger::getInstance().log("Received command for " + cmd.target_id + ": " + cmd.command);
-
-        auto aircraft_it = std::find_if(aircraft_.begin(), aircraft_.end(),
-            [&cmd](const auto& aircraft) {
-                return aircraft->getState().callsign == cmd.target_id;
-            });
+        ATC_LOG_INFO("Received command for " + cmd.target_id + ": " + cmd.command);
+        if (replication_) {
+            replication_->appendCommand(cmd);
+        }
 
-        if (aircraft_it != aircraft_.end()) {
+        auto aircraft = aircraft_.find(cmd.target_id);
+        if (aircraft) {
             if (cmd.command == "SPEED" && !cmd.params.empty()) {
                 try {
                     double new_speed = std::stod(cmd.params[0]);
-                    if ((*aircraft_it)->updateSpeed(new_speed)) {
-                        Logger::getInstance().log("Speed updated for " + cmd.target_id);
+                    if (aircraft->updateSpeed(new_speed)) {
+                        ATC_LOG_INFO("Speed updated for " + cmd.target_id);
                     }
                 } catch (const std::exception& e) {
-                    Logger::getInstance().log("Error processing speed command: " + std::string(e.what()));
+                    ATC_LOG_ERROR("Error processing speed command: " + std::string(e.what()));
                 }
             }
             else if (cmd.command == "ALTITUDE" && !cmd.params.empty()) {
                 try {
                     double new_altitude = std::stod(cmd.params[0]);
-                    if ((*aircraft_it)->updateAltitude(new_altitude)) {
-                        Logger::getInstance().log("Altitude updated for " + cmd.target_id);
+                    if (aircraft->updateAltitude(new_altitude)) {
+                        ATC_LOG_INFO("Altitude updated for " + cmd.target_id);
                     }
                 } catch (const std::exception& e) {
-                    Logger::getInstance().log("Error processing altitude command: " + std::string(e.what()));
+                    ATC_LOG_ERROR("Error processing altitude command: " + std::string(e.what()));
                 }
             }
             else if (cmd.command == "EMERGENCY") {
-                (*aircraft_it)->declareEmergency();
-                Logger::getInstance().log("Emergency declared for " + cmd.target_id);
+                aircraft->declareEmergency();
+                ATC_LOG_WARNING("Emergency declared for " + cmd.target_id);
             }
         } else {
-            Logger::getInstance().log("Aircraft not found: " + cmd.target_id);
+            ATC_LOG_WARNING("Aircraft not found: " + cmd.target_id);
+        }
+    }
+
+    void handleFlightPlan(const comm::FlightPlanData& plan) {
+        if (plan.waypoints.empty()) {
+            ATC_LOG_WARNING("Ignoring flight plan without waypoints for " + plan.callsign);
+            return;
         }
+        for (const auto& waypoint : plan.waypoints) {
+            if (!waypoint.isValid()) {
+                ATC_LOG_WARNING("Ignoring flight plan for " + plan.callsign +
+                                " with a waypoint outside the airspace");
+                return;
+            }
+        }
+
+        auto route = std::make_shared<Route>();
+        route->fixes = fixes_;
+        route->cruise_speed = plan.cruise_speed;
+        route->wake = plan.wake_category;
+        route->waypoints.reserve(plan.waypoints.size());
+        for (const auto& waypoint : plan.waypoints) {
+            route->waypoints.push_back(fixes_->intern(waypoint));
+        }
+        routes_[plan.callsign] = route;
+        ATC_LOG_INFO("Flight plan filed for " + plan.callsign + ": " +
+                     std::to_string(plan.waypoints.size()) + " waypoints");
+
+        // A new plan replaces the route of an aircraft already flying
+        if (auto aircraft = aircraft_.find(plan.callsign)) {
+            aircraft->setRoute(route);
+        }
+    }
+
+    // Why an aircraft cannot be admitted at this position and velocity, or null if it can
+    static const char* entryProblem(const Position& position, const Velocity& velocity) {
+        if (!position.isValid()) {
+            return "Invalid Position";
+        }
+        double speed = std::sqrt(velocity.vx * velocity.vx + velocity.vy * velocity.vy +
+                                 velocity.vz * velocity.vz);
+        if (speed < constants::MIN_SPEED || speed > constants::MAX_SPEED) {
+            return "Invalid Speed";
+        }
+        return nullptr;
+    }
+
+    // Entries and exits received since the last tick are applied as one batch,
+    // so the detector and radar each take their lock once per tick. Every step
+    // is O(1) amortized per aircraft. Aircraft that flew out of the airspace
+    // last cycle leave with the batch.
+    void applyAdmissions() {
+        for (const auto& state : states_) {
+            if (state.status == AircraftStatus::EXITING) {
+                pending_admissions_.push_back({false, state});
+            }
+        }
+        if (pending_admissions_.empty()) return;
+
+        std::vector<std::shared_ptr<Aircraft>> entered;
+        std::vector<std::string> exited;
+        for (const auto& admission : pending_admissions_) {
+            const std::string& callsign = admission.state.callsign;
+            if (!admission.entering) {
+                auto aircraft = aircraft_.remove(callsign);
+                if (!aircraft) {
+                    ATC_LOG_WARNING("Exit for unknown aircraft: " + callsign);
+                    continue;
+                }
+                aircraft->stop();
+                routes_.erase(callsign);
+                exited.push_back(callsign);
+                continue;
+            }
+
+            if (aircraft_.contains(callsign)) {
+                ATC_LOG_WARNING("Aircraft " + callsign + " is already in the system");
+                continue;
+            }
+            if (const char* problem = entryProblem(admission.state.position, admission.state.velocity)) {
+                ATC_LOG_WARNING("Cannot admit aircraft " + callsign + ": " + problem);
+                continue;
+            }
+            try {
+                auto aircraft = std::make_shared<Aircraft>(callsign, admission.state.position,
+                                                           admission.state.velocity);
+                auto route = routes_.find(callsign);
+                if (route != routes_.end()) {
+                    aircraft->setRoute(route->second);
+                }
+                aircraft_.add(aircraft);
+                entered.push_back(aircraft);
+            } catch (const std::exception& e) {
+                ATC_LOG_WARNING("Cannot admit aircraft " + callsign + ": " + e.what());
+            }
+        }
+
+        // Drop aircraft that also left within this batch; removals go first so a
+        // callsign that left and re-entered ends up with its new aircraft
+        entered.erase(std::remove_if(entered.begin(), entered.end(),
+            [this](const auto& aircraft) { return aircraft_.find(aircraft->getCallsign()) != aircraft; }),
+            entered.end());
+        violation_detector_->removeAircraft(exited);
+        radar_system_->removeAircraft(exited);
+        forgetPredictions(exited);
+        violation_detector_->addAircraft(entered);
+        radar_system_->addAircraft(entered);
+        for (const auto& aircraft : entered) {
+            if (scheduler_) {
+                scheduler_->addTask(aircraft);
+            } else {
+                aircraft->start();
+            }
+        }
+
+        ATC_LOG_INFO("Admitted " + std::to_string(entered.size()) + " and retired " +
+                     std::to_string(exited.size()) + " aircraft (" +
+                     std::to_string(aircraft_.size()) + " active)");
+        pending_admissions_.clear();
     }
 
     void handleAlert(const comm::AlertData& alert) {
         std::ostringstream oss;
         oss << "ALERT [Level " << static_cast<int>(alert.level) << "]: "
             << alert.description;
-        Logger::getInstance().log(oss.str());
-        display_system_->displayAlert(oss.str());
+        ATC_LOG_WARNING(oss.str());
+        raiseAlert(oss.str());
     }
 
     void handlePositionUpdate(const AircraftState& state) {
-        auto aircraft_it = std::find_if(aircraft_.begin(), aircraft_.end(),
-            [&state](const auto& aircraft) {
-                return aircraft->getState().callsign == state.callsign;
-            });
-
-        if (aircraft_it != aircraft_.end()) {
-            std::vector<std::shared_ptr<Aircraft>> current_aircraft = {*aircraft_it};
+        auto aircraft = aircraft_.find(state.callsign);
+        if (aircraft && display_system_) {
+            std::vector<std::shared_ptr<Aircraft>> current_aircraft = {aircraft};
             display_system_->updateDisplay(current_aircraft);
         }
     }
@@ -418,10 +1046,11 @@ private:
         std::ostringstream status;
         status << "System Status Report:\n"
                << "Active Aircraft: " << aircraft_.size() << "\n"
-               << "Updates Processed: " << metrics_.processed_updates << "\n"
-               << "Violation Checks: " << metrics_.violation_checks << "\n"
+               << "Updates Processed: " << cycles_run.count() << "\n"
+               << "Violation Checks: " << violation_checks.count() << "\n"
                << "System Uptime: " << getSystemUptime() << "s";
 
+        if (!channel_) return;
         comm::AlertData response{0, status.str()};
         comm::Message msg = comm::Message::createAlert("ATC_SYSTEM", response);
         channel_->sendMessage(msg);
@@ -432,19 +1061,31 @@ private:
         auto uptime = std::chrono::duration_cast<std::chrono::seconds>(
             now - metrics_.start_time).count();
 
-        std::ostringstream oss;
-        oss << "\n=== System Metrics Report ===\n"
-            << "Uptime: " << uptime << " seconds\n"
-            << "Active Aircraft: " << aircraft_.size() << "\n"
-            << "Processed Updates: " << metrics_.processed_updates << "\n"
-            << "Violation Checks: " << metrics_.violation_checks << "\n"
-            << "Radar Updates: " << metrics_.radar_updates << "\n"
-            << "Display Updates: " << metrics_.display_updates << "\n"
-            << "Updates/Second: " << (metrics_.processed_updates / std::max(1L, uptime)) << "\n"
-            << "Last Update: " << formatTimestamp(metrics_.last_update_time) << "\n"
-            << "=========================\n";
-
-        Logger::getInstance().log(oss.str());
+        if (ATC_LOG_ENABLED(INFO)) {
+            std::ostringstream oss;
+            oss << "\n=== System Metrics Report ===\n"
+                << "Uptime: " << uptime << " seconds\n"
+                << "Active Aircraft: " << aircraft_.size() << "\n"
+                << "Processed Updates: " << cycles_run.count() << "\n"
+                << "Violation Checks: " << violation_checks.count() << "\n"
+                << "Radar Updates: " << radarUpdates() << "\n"
+                << "Display Updates: " << display_updates.count() << "\n"
+                << "Updates/Second: " << (cycles_run.count() / std::max(1L, uptime)) << "\n"
+                << "Last Update: " << formatTimestamp(metrics_.last_update_time) << "\n";
+            if (replication_) {
+                auto stats = replication_->getStats();
+                uint64_t records = std::max<uint64_t>(1, stats.frames + stats.dropped);
+                oss << "Replication: " << (replication_->isConnected() ? "connected" : "no standby")
+                    << ", " << stats.frames << " records (" << stats.key_frames << " key), "
+                    << stats.bytes << " bytes, " << stats.dropped << " dropped\n"
+                    << "Replication Cost: mean "
+                    << stats.total_cost_ns / records / 1000 << " us, max " << stats.max_cost_ns / 1000 << " us, "
+                    << stats.over_budget << " cycles over budget\n";
+            }
+            oss << "=========================\n";
+
+            ATC_LOG_INFO(oss.str());
+        }
         metrics_.last_update_time = now;
     }
 
@@ -457,22 +1098,36 @@ private:
         oss << "\n=== Final System Statistics ===\n"
             << "Total Runtime: " << total_runtime << " seconds\n"
             << "Total Aircraft Tracked: " << aircraft_.size() << "\n"
-            << "Total Updates Processed: " << metrics_.processed_updates << "\n"
-            << "Total Violation Checks: " << metrics_.violation_checks << "\n"
-            << "Total Radar Updates: " << metrics_.radar_updates << "\n"
-            << "Total Display Updates: " << metrics_.display_updates << "\n"
-            << "Average Updates/Second: " << (metrics_.processed_updates / std::max(1L, total_runtime)) << "\n"
+            << "Total Updates Processed: " << cycles_run.count() << "\n"
+            << "Total Violation Checks: " << violation_checks.count() << "\n"
+            << "Total Radar Updates: " << radarUpdates() << "\n"
+            << "Total Display Updates: " << display_updates.count() << "\n"
+            << "Average Updates/Second: " << (cycles_run.count() / std::max(1L, total_runtime)) << "\n"
             << "============================\n";
+        if (PerfCounters::isEnabled()) {
+            oss << PerfCounters::report();
+        }
 
-        Logger::getInstance().log(oss.str());
+        ATC_LOG_INFO(oss.str());
+    }
+
+    // One file per process of a split deployment
+    std::string metricsPath() const {
+        switch (role_) {
+            case ProcessRole::SURVEILLANCE: return "atc_metrics_surveillance.prom";
+            case ProcessRole::DETECTION: return "atc_metrics_detection.prom";
+            case ProcessRole::PRESENTATION: return "atc_metrics_presentation.prom";
+            default: return "atc_metrics.prom";
+        }
+    }
+
+    // Counted by the radar itself, so it is in the registry by name only
+    static uint64_t radarUpdates() {
+        return static_cast<uint64_t>(metrics::MetricsRegistry::getInstance().value("atc_radar_track_updates_total"));
     }
 
     std::string formatTimestamp(const std::chrono::steady_clock::time_point& time_point) {
-        auto now = std::chrono::system_clock::now();
-        auto time = std::chrono::system_clock::to_time_t(now);
-        std::stringstream ss;
-        ss << std::put_time(std::localtime(&time), "%Y-%m-%d %H:%M:%S");
-        return ss.str();
+        return timestamp::format(timestamp::toSystem(time_point), false);
     }
 
     long getSystemUptime() {
@@ -483,62 +1138,324 @@ private:
 
 private:
     // Member variables
-    std::vector<std::shared_ptr<Aircraft>> aircraft_;
+    ProcessRole role_;
+    bool replaying_;
+    AircraftRegistry aircraft_;
     std::shared_ptr<ViolationDetector> violation_detector_;
     std::shared_ptr<DisplaySystem> display_system_;
     std::shared_ptr<HistoryLogger> history_logger_;
+    std::shared_ptr<HistoryCompressor> history_compressor_;
+    std::shared_ptr<ConflictLog> conflict_log_;
+    std::shared_ptr<LogFlusher> log_flusher_;
+    std::shared_ptr<TrailStore> trail_store_;
+    std::vector<AircraftState> states_;        // this cycle's states, gathered once
+    std::shared_ptr<WebDisplayServer> web_display_;
+    std::chrono::steady_clock::time_point last_web_publish_;
+    // Sector load over the next hour and the landing sequence
+    TrafficForecast traffic_forecast_{static_cast<size_t>(constants::TRAFFIC_FORECAST_BINS),
+                                      constants::TRAFFIC_FORECAST_BIN / 1000.0,
+                                      static_cast<uint32_t>(constants::SECTOR_CAPACITY)};
+    ArrivalSequencer arrival_sequencer_{Position{constants::ARRIVAL_FIX_X, constants::ARRIVAL_FIX_Y,
+                                                 constants::AIRSPACE_Z_MIN}};
+    TrajectoryCache traffic_trajectories_;
+    std::chrono::steady_clock::time_point last_forecast_update_;
+    std::chrono::steady_clock::time_point last_arrival_sequence_;
+    uint64_t web_sequence_ = 0;
     std::shared_ptr<RadarSystem> radar_system_;
     std::shared_ptr<comm::QnxChannel> channel_;
     SystemMetrics metrics_;
+
+    // Live admission: FLIGHT_PLAN, AIRCRAFT_ENTER and AIRCRAFT_EXIT messages
+    struct Admission {
+        bool entering;
+        AircraftState state;   // only the callsign is used for an exit
+    };
+    std::vector<Admission> pending_admissions_;
+    // Filed routes by callsign, their fixes shared through one database
+    std::shared_ptr<FixDatabase> fixes_ = std::make_shared<FixDatabase>();
+    std::unordered_map<std::string, std::shared_ptr<const Route>> routes_;
+
+    // Split deployment
+    std::unique_ptr<comm::ShmRing> input_ring_;
+    std::unique_ptr<comm::ShmRing> output_ring_;
+    std::string frame_;
+    std::string alert_frame_;
+    std::vector<AircraftState> received_states_;
+
+    std::unique_ptr<comm::ReplicationWriter> replication_;
+
+    // Record and replay
+    VirtualScheduler* scheduler_ = nullptr;
+    std::shared_ptr<JournalWriter> journal_;
+    std::deque<JournalEntry> replay_messages_;
+    std::deque<JournalEntry> expected_alerts_;
+    uint64_t replay_matched_ = 0;
+    uint64_t replay_mismatches_ = 0;
 };
 
+int runProcess(ProcessRole role, const std::string& data_file, bool replicate = false,
+               const comm::ReplicaState* replica = nullptr) {
+    try {
+        ATCSystem system(role);
+        if (replicate) {
+            system.enableReplication();
+        }
+
+        if (replica) {
+            if (!system.adoptReplica(*replica)) {
+                ATC_LOG_ERROR("Replica holds no aircraft to take over");
+                return 1;
+            }
+        } else if (role == ProcessRole::ALL || role == ProcessRole::SURVEILLANCE) {
+            // Load aircraft data
+            if (!system.loadAircraftData(data_file)) {
+                ATC_LOG_ERROR("Failed to load aircraft data from: " + data_file);
+                return 1;
+            }
+            ATC_LOG_INFO("Successfully loaded aircraft data, starting system...");
+        }
+
+        // Run the system
+        system.run();
+
+        ATC_LOG_INFO("System shutdown completed normally.");
+        return 0;
+
+    } catch (const std::runtime_error& e) {
+        ATC_LOG_ERROR("System initialization failed: " +
+                      std::string(e.what()));
+        return 1;
+    } catch (const std::exception& e) {
+        ATC_LOG_ERROR("Unexpected error during system operation: " +
+                      std::string(e.what()));
+        return 1;
+    }
+}
+
+// Surveillance, detection and presentation each in their own process, so a
+// display or logging fault cannot stall separation checks. The supervisor owns
+// the rings between them and restarts presentation if it dies.
+int runSplitDeployment(const std::string& data_file) {
+    std::signal(SIGINT, signal_handler);
+    std::signal(SIGTERM, signal_handler);
+
+    comm::ShmRing tracks(TRACKS_RING);
+    comm::ShmRing situation(SITUATION_RING);
+    if (!tracks.create(constants::SHM_RING_SIZE) || !situation.create(constants::SHM_RING_SIZE)) {
+        ATC_LOG_ERROR("Failed to create shared memory rings for the split deployment");
+        return 1;
+    }
+
+    ProcessSupervisor supervisor;
+    supervisor.addProcess("surveillance",
+        [&data_file] { return runProcess(ProcessRole::SURVEILLANCE, data_file); }, true);
+    supervisor.addProcess("detection",
+        [&data_file] { return runProcess(ProcessRole::DETECTION, data_file); }, true);
+    supervisor.addProcess("presentation",
+        [&data_file] { return runProcess(ProcessRole::PRESENTATION, data_file); }, false);
+    if (!supervisor.start()) {
+        return 1;
+    }
+    return supervisor.run(g_running);
+}
+
+// Hot standby (--standby): applies the primary's replication stream and, once
+// the primary has been silent for REPLICATION_TAKEOVER_TIMEOUT, carries on as a
+// single-process system from the replicated state.
+int runStandby(const std::string& data_file) {
+    std::signal(SIGINT, signal_handler);
+    std::signal(SIGTERM, signal_handler);
+
+    comm::ShmRing ring(REPLICATION_RING);
+    if (!ring.create(constants::SHM_RING_SIZE)) {
+        ATC_LOG_ERROR("Failed to create the replication ring");
+        return 1;
+    }
+    ATC_LOG_INFO("Standby waiting for the primary's replication stream");
+
+    comm::ReplicaState replica;
+    std::string record;
+    bool synchronised = false;
+    const auto takeover_timeout = std::chrono::milliseconds(constants::REPLICATION_TAKEOVER_TIMEOUT);
+    while (g_running) {
+        while (ring.read(record, 10000)) {
+            replica.apply(record);
+        }
+        if (replica.isSynchronised() != synchronised) {
+            synchronised = replica.isSynchronised();
+            if (synchronised) {
+                ATC_LOG_INFO("Standby synchronised with the primary at sequence " +
+                             std::to_string(replica.getSequence()));
+            }
+        }
+        if (replica.primaryLost(std::chrono::steady_clock::now(), takeover_timeout)) {
+            ATC_LOG_WARNING("Primary silent for " + std::to_string(constants::REPLICATION_TAKEOVER_TIMEOUT) +
+                            " ms - standby taking over");
+            return runProcess(ProcessRole::ALL, data_file, false, &replica);
+        }
+    }
+    return 0;
+}
+
+// Live run with its inputs journaled (--record <journal>). Surveillance and
+// detection run in virtual time paced to the wall clock, so --replay can
+// reproduce the run exactly.
+int runRecording(const std::string& data_file, const std::string& journal_path) {
+    auto seed = static_cast<uint64_t>(std::random_device{}());
+    auto epoch = std::chrono::system_clock::now();
+    auto journal = std::make_shared<JournalWriter>(journal_path);
+    if (!journal->open(seed, epoch)) {
+        return 1;
+    }
+    sim_clock::useVirtualTime(epoch);
+    std::srand(static_cast<unsigned>(seed));
+
+    try {
+        ATCSystem system;
+        system.setJournal(journal);
+        if (!system.loadAircraftData(data_file)) {
+            ATC_LOG_ERROR("Failed to load aircraft data from: " + data_file);
+            return 1;
+        }
+
+        VirtualScheduler scheduler(true);
+        system.runScheduled(scheduler, std::chrono::milliseconds::max());
+        journal->close(scheduler.now());
+        ATC_LOG_INFO("Recorded " + std::to_string(scheduler.now().count()) + " ms to " + journal_path);
+        return 0;
+    } catch (const std::exception& e) {
+        ATC_LOG_ERROR("Recording failed: " + std::string(e.what()));
+        return 1;
+    }
+}
+
+// Feeds a journal back through the virtual-time scheduler as fast as it will
+// run (--replay <journal>). Exits non-zero if the alerts differ from the
+// recording's.
+int runReplay(const std::string& journal_path) {
+    std::signal(SIGINT, signal_handler);
+    std::signal(SIGTERM, signal_handler);
+
+    JournalReader reader;
+    if (!reader.open(journal_path)) {
+        return 1;
+    }
+
+    std::string scenario;
+    std::deque<JournalEntry> messages;
+    std::deque<JournalEntry> alerts;
+    std::chrono::milliseconds end(0);
+    bool complete = false;
+    JournalEntry entry;
+    while (reader.next(entry)) {
+        end = std::max(end, entry.at);
+        switch (entry.kind) {
+            case JournalKind::SCENARIO_ROW:
+                scenario += entry.payload + "\n";
+                break;
+            case JournalKind::CHANNEL_MESSAGE:
+                messages.push_back(std::move(entry));
+                break;
+            case JournalKind::ALERT:
+                alerts.push_back(std::move(entry));
+                break;
+            case JournalKind::END:
+                complete = true;
+                break;
+        }
+    }
+    if (!complete) {
+        ATC_LOG_WARNING("Journal " + journal_path + " has no end record - replaying up to its last record");
+    }
+
+    sim_clock::useVirtualTime(reader.getEpoch());
+    std::srand(static_cast<unsigned>(reader.getSeed()));
+
+    try {
+        ATCSystem system(ProcessRole::ALL, true);
+        system.setReplayInputs(std::move(messages), std::move(alerts));
+        std::istringstream rows(scenario);
+        if (!system.loadAircraftRows(rows)) {
+            ATC_LOG_ERROR("Journal " + journal_path + " holds no usable scenario");
+            return 1;
+        }
+
+        VirtualScheduler scheduler(false);
+        auto wall_start = std::chrono::steady_clock::now();
+        system.runScheduled(scheduler, end);
+        auto wall = std::chrono::duration_cast<std::chrono::milliseconds>(
+            std::chrono::steady_clock::now() - wall_start);
+        ATC_LOG_INFO("Replayed " + std::to_string(scheduler.now().count()) + " ms of recorded time in " +
+                     std::to_string(wall.count()) + " ms");
+        return system.reportReplay() ? 0 : 1;
+    } catch (const std::exception& e) {
+        ATC_LOG_ERROR("Replay failed: " + std::string(e.what()));
+        return 1;
+    }
+}
+
 } // namespace atc
 
 int main(int argc, char** argv) {
     try {
         if (argc < 2) {
-            std::cerr << "Usage: " << argv[0] << " <aircraft_data_file>" << std::endl;
+            std::cerr << "Usage: " << argv[0]
+                      << " <aircraft_data_file> [--split | --primary | --standby | --record <journal>]\n"
+                      << "       " << argv[0] << " --replay <journal>" << std::endl;
             return 1;
         }
 
-        atc::Logger::getInstance().log("Starting ATC System...");
-
-        try {
-            atc::ATCSystem system;
-
-            // Load aircraft data
-            if (!system.loadAircraftData(argv[1])) {
-                atc::Logger::getInstance().log("Failed to load aircraft data from: " +
-                                            std::string(argv[1]));
-                return 1;
+        // Runtime log threshold; statements below ATC_LOG_MIN_LEVEL are compiled out
+        if (const char* level_name = std::getenv("ATC_LOG_LEVEL")) {
+            atc::LogLevel level;
+            if (atc::Logger::parseLevel(level_name, level)) {
+                atc::Logger::setLevel(level);
+            } else {
+                std::cerr << "Ignoring unknown ATC_LOG_LEVEL: " << level_name << std::endl;
             }
+        }
 
-            atc::Logger::getInstance().log("Successfully loaded aircraft data, starting system...");
+        // Optional hardware counters around periodic tasks and the main kernels
+        if (const char* perf = std::getenv("ATC_PERF_COUNTERS")) {
+            if (std::string(perf) == "1") {
+                atc::PerfCounters::enable();
+            }
+        }
 
-            // Run the system
-            system.run();
+        ATC_LOG_INFO("Starting ATC System...");
 
-            atc::Logger::getInstance().log("System shutdown completed normally.");
-            return 0;
+        if (std::string(argv[1]) == "--replay") {
+            if (argc < 3) {
+                std::cerr << "--replay needs a journal file" << std::endl;
+                return 1;
+            }
+            return atc::runReplay(argv[2]);
+        }
 
-        } catch (const std::runtime_error& e) {
-            atc::Logger::getInstance().log("System initialization failed: " +
-                                         std::string(e.what()));
-            return 1;
-        } catch (const std::exception& e) {
-            atc::Logger::getInstance().log("Unexpected error during system operation: " +
-                                         std::string(e.what()));
-            return 1;
+        std::string mode = argc > 2 ? argv[2] : "";
+        if (mode == "--record") {
+            if (argc < 4) {
+                std::cerr << "--record needs a journal file" << std::endl;
+                return 1;
+            }
+            return atc::runRecording(argv[1], argv[3]);
+        }
+        if (mode == "--split") {
+            return atc::runSplitDeployment(argv[1]);
+        }
+        if (mode == "--standby") {
+            return atc::runStandby(argv[1]);
         }
+        return atc::runProcess(atc::ProcessRole::ALL, argv[1], mode == "--primary");
     }
     catch (const std::exception& e) {
         std::cerr << "Fatal error: " << e.what() << std::endl;
-        atc::Logger::getInstance().log("Fatal error: " + std::string(e.what()));
+        ATC_LOG_ERROR("Fatal error: " + std::string(e.what()));
         return 1;
     }
     catch (...) {
         std::cerr << "Unknown fatal error occurred" << std::endl;
-        atc::Logger::getInstance().log("Unknown fatal error occurred");
+        ATC_LOG_ERROR("Unknown fatal error occurred");
         return 1;
     }
 }
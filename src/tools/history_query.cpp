@@ -0,0 +1,182 @@
+#include "common/history_export.h"
+#include "common/history_rollup.h"
+#include <chrono>
+#include <cstdlib>
+#include <ctime>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+namespace {
+
+void printUsage(const char* program) {
+    std::cerr << "Usage:\n"
+              << "  " << program << " <history_dir> info\n"
+              << "  " << program << " [-r <ms>] <history_dir> trajectory <callsign> <start> <end>\n"
+              << "  " << program << " [-r <ms>] <history_dir> window <start> <end> [x_min y_min x_max y_max]\n"
+              << "  " << program << " <history_dir> sectors <start> <end>\n"
+              << "  " << program << " <history_dir> export <start> <end> <snapshots.arrows> [conflicts.arrows]\n"
+              << "Times are epoch milliseconds or local \"YYYY-MM-DD HH:MM:SS\".\n"
+              << "-r accepts samples up to <ms> apart so coarser rollups can answer the query." << std::endl;
+}
+
+bool parseTime(const std::string& text, int64_t& time_ms) {
+    if (text.find(':') == std::string::npos) {
+        char* end = nullptr;
+        time_ms = std::strtoll(text.c_str(), &end, 10);
+        return end && *end == '\0';
+    }
+
+    std::tm tm = {};
+    std::istringstream iss(text);
+    iss >> std::get_time(&tm, "%Y-%m-%d %H:%M:%S");
+    if (iss.fail()) {
+        iss.clear();
+        iss.str(text);
+        iss >> std::get_time(&tm, "%Y-%m-%dT%H:%M:%S");
+    }
+    if (iss.fail()) {
+        return false;
+    }
+    tm.tm_isdst = -1;
+    time_ms = static_cast<int64_t>(std::mktime(&tm)) * 1000;
+    return true;
+}
+
+void printRecords(const std::vector<atc::HistoryRecord>& records) {
+    // Same column layout as the scenario input files
+    std::cout << "Time,ID,X,Y,Z,SpeedX,SpeedY,SpeedZ\n"
+              << std::fixed << std::setprecision(2);
+    for (const auto& record : records) {
+        std::cout << record.timestamp_ms << ',' << record.getCallsign() << ','
+                  << record.x << ',' << record.y << ',' << record.z << ','
+                  << record.vx << ',' << record.vy << ',' << record.vz << '\n';
+    }
+}
+
+// Arrow IPC streams for columnar tools (pyarrow.ipc.open_stream, DuckDB, ...)
+bool exportArrow(const std::string& directory, int64_t t_start, int64_t t_end,
+                 const char* snapshot_path, const char* conflict_path) {
+    auto start = std::chrono::steady_clock::now();
+    atc::HistoryReader reader(directory);
+
+    std::ofstream snapshots(snapshot_path, std::ios::binary | std::ios::trunc);
+    uint64_t rows = 0;
+    if (!snapshots || !atc::history::exportSnapshotsArrow(reader, t_start, t_end, snapshots, &rows)) {
+        std::cerr << "Failed to export snapshots to " << snapshot_path << std::endl;
+        return false;
+    }
+    std::cerr << rows << " snapshot rows written to " << snapshot_path << std::endl;
+
+    if (conflict_path) {
+        std::ofstream conflicts(conflict_path, std::ios::binary | std::ios::trunc);
+        if (!conflicts ||
+            !atc::history::exportConflictsArrow(directory, t_start, t_end, conflicts, &rows)) {
+            std::cerr << "Failed to export conflicts to " << conflict_path << std::endl;
+            return false;
+        }
+        std::cerr << rows << " conflict rows written to " << conflict_path << std::endl;
+    }
+
+    auto elapsed = std::chrono::duration_cast<std::chrono::microseconds>(
+        std::chrono::steady_clock::now() - start).count();
+    std::cerr << "Export took " << elapsed / 1000.0 << " ms" << std::endl;
+    return true;
+}
+
+}
+
+int main(int argc, char** argv) {
+    // Strip the optional resolution flag so positional arguments stay fixed
+    int resolution_ms = 0;
+    std::vector<char*> args;
+    for (int i = 0; i < argc; ++i) {
+        if (std::string(argv[i]) == "-r" && i + 1 < argc) {
+            resolution_ms = std::atoi(argv[++i]);
+        } else {
+            args.push_back(argv[i]);
+        }
+    }
+    argc = static_cast<int>(args.size());
+    argv = args.data();
+
+    if (argc < 3) {
+        printUsage(argv[0]);
+        return 1;
+    }
+
+    auto start = std::chrono::steady_clock::now();
+    atc::HistoryArchive archive(argv[1]);
+    std::string command = argv[2];
+    std::vector<atc::HistoryRecord> records;
+    int used_resolution = 0;
+
+    if (command == "info") {
+        atc::HistoryReader reader(argv[1]);
+        std::cout << "Segments: " << reader.getSegmentCount() << "\n"
+                  << "First record: " << reader.getStartTime() << "\n"
+                  << "Last record: " << reader.getEndTime() << std::endl;
+        return 0;
+    } else if (command == "sectors" && argc == 5) {
+        int64_t t_start, t_end;
+        if (!parseTime(argv[3], t_start) || !parseTime(argv[4], t_end)) {
+            std::cerr << "Invalid time range" << std::endl;
+            return 1;
+        }
+        auto occupancy = archive.sectorOccupancy(t_start, t_end);
+        auto elapsed = std::chrono::duration_cast<std::chrono::microseconds>(
+            std::chrono::steady_clock::now() - start).count();
+
+        std::cout << "Time,Sector,Aircraft\n";
+        for (const auto& bucket : occupancy) {
+            std::cout << bucket.bucket_ms << ',' << bucket.sector << ',' << bucket.aircraft << '\n';
+        }
+        std::cerr << occupancy.size() << " occupancy buckets in " << elapsed / 1000.0
+                  << " ms" << std::endl;
+        return 0;
+    } else if (command == "export" && (argc == 6 || argc == 7)) {
+        int64_t t_start, t_end;
+        if (!parseTime(argv[3], t_start) || !parseTime(argv[4], t_end)) {
+            std::cerr << "Invalid time range" << std::endl;
+            return 1;
+        }
+        return exportArrow(argv[1], t_start, t_end, argv[5], argc == 7 ? argv[6] : nullptr) ? 0 : 1;
+    } else if (command == "trajectory" && argc == 6) {
+        int64_t t_start, t_end;
+        if (!parseTime(argv[4], t_start) || !parseTime(argv[5], t_end)) {
+            std::cerr << "Invalid time range" << std::endl;
+            return 1;
+        }
+        used_resolution = archive.selectResolution(resolution_ms, t_start);
+        records = archive.trajectory(argv[3], t_start, t_end, resolution_ms);
+    } else if (command == "window" && (argc == 5 || argc == 9)) {
+        int64_t t_start, t_end;
+        if (!parseTime(argv[3], t_start) || !parseTime(argv[4], t_end)) {
+            std::cerr << "Invalid time range" << std::endl;
+            return 1;
+        }
+        auto region = atc::HistoryRegion::everything();
+        if (argc == 9) {
+            region.x_min = std::atof(argv[5]);
+            region.y_min = std::atof(argv[6]);
+            region.x_max = std::atof(argv[7]);
+            region.y_max = std::atof(argv[8]);
+        }
+        used_resolution = archive.selectResolution(resolution_ms, t_start);
+        records = archive.window(t_start, t_end, region, resolution_ms);
+    } else {
+        printUsage(argv[0]);
+        return 1;
+    }
+
+    auto elapsed = std::chrono::duration_cast<std::chrono::microseconds>(
+        std::chrono::steady_clock::now() - start).count();
+
+    printRecords(records);
+    std::cerr << records.size() << " records at " << used_resolution << " ms resolution in "
+              << elapsed / 1000.0 << " ms" << std::endl;
+    return 0;
+}
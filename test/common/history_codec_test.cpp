@@ -0,0 +1,146 @@
+#include <gtest/gtest.h>
+#include "common/history_codec.h"
+#include <chrono>
+#include <cstring>
+#include <random>
+#include <vector>
+
+namespace atc {
+namespace test {
+
+class HistoryCodecTest : public ::testing::Test {
+protected:
+    // Straight-line traffic sampled at 1 Hz, as written by the history logger
+    std::vector<HistoryRecord> makeTraffic(int aircraft, int seconds) {
+        std::vector<HistoryRecord> records;
+        for (int t = 0; t < seconds; ++t) {
+            for (int i = 0; i < aircraft; ++i) {
+                AircraftState state;
+                state.callsign = "AC" + std::to_string(100 + i);
+                state.velocity = {400.0 - i, 10.0 * i, i % 3 == 0 ? 5.0 : 0.0};
+                state.position = {1000.0 + state.velocity.vx * t,
+                                  2000.0 * i + state.velocity.vy * t,
+                                  16000.0 + 200.0 * i + state.velocity.vz * t};
+                state.heading = 90.0 - i;
+                state.status = AircraftStatus::CRUISING;
+                state.timestamp = 1.7e12 + t * 1000.0 + i;
+                records.push_back(HistoryRecord::fromState(state));
+            }
+        }
+        return records;
+    }
+
+    void expectRoundTrip(const std::vector<HistoryRecord>& records, double min_ratio) {
+        HistoryColumns columns;
+        columns.fromRecords(records);
+        std::vector<uint8_t> compressed;
+        codec::compressBlock(columns, compressed);
+
+        HistoryColumns decoded;
+        ASSERT_TRUE(codec::decompressBlock(compressed.data(), compressed.size(), records.size(), decoded));
+        std::vector<HistoryRecord> restored;
+        decoded.toRecords(restored);
+
+        ASSERT_EQ(restored.size(), records.size());
+        EXPECT_EQ(std::memcmp(restored.data(), records.data(),
+                              records.size() * sizeof(HistoryRecord)), 0);
+        EXPECT_GE(records.size() * sizeof(HistoryRecord) / double(compressed.size()), min_ratio);
+    }
+};
+
+TEST_F(HistoryCodecTest, RoundTripSteadyTraffic) {
+    expectRoundTrip(makeTraffic(8, 128), 10.0);
+}
+
+TEST_F(HistoryCodecTest, RoundTripRandomValues) {
+    std::mt19937_64 rng(42);
+    std::vector<HistoryRecord> records;
+    for (int i = 0; i < 1000; ++i) {
+        HistoryRecord record;
+        std::memset(&record, 0, sizeof(record));
+        record.timestamp_ms = static_cast<int64_t>(rng());
+        std::snprintf(record.callsign, sizeof(record.callsign), "R%03d", int(rng() % 300));
+        for (double* value : {&record.x, &record.y, &record.z, &record.vx,
+                              &record.vy, &record.vz, &record.heading}) {
+            uint64_t bits = rng();
+            std::memcpy(value, &bits, sizeof(bits));
+        }
+        record.status = static_cast<uint8_t>(rng());
+        records.push_back(record);
+    }
+    expectRoundTrip(records, 0.9);
+}
+
+TEST_F(HistoryCodecTest, EmptyBlock) {
+    expectRoundTrip({}, 0.0);
+}
+
+TEST_F(HistoryCodecTest, CorruptSizesAreRejected) {
+    auto records = makeTraffic(4, 16);
+    HistoryColumns columns;
+    columns.fromRecords(records);
+    std::vector<uint8_t> compressed;
+    codec::compressBlock(columns, compressed);
+    EXPECT_FALSE(codec::decompressBlock(compressed.data(), compressed.size(), records.size() - 1, columns));
+    EXPECT_FALSE(codec::decompressBlock(compressed.data(), compressed.size(), records.size() + 1, columns));
+
+    // A packed size of nearly 4 GB, rejected before anything is allocated
+    std::vector<uint8_t> block(16, 0);
+    block[3] = 0xF0;
+    EXPECT_FALSE(codec::decompressBlock(block.data(), block.size(), records.size(), columns));
+
+    // A record count of nearly 2^32 inside a well-formed packed stream
+    std::vector<uint8_t> packed = {0xF0, 0xFF, 0xFF, 0xFF, 0, 0};
+    block = {static_cast<uint8_t>(packed.size()), 0, 0, 0};
+    std::vector<uint8_t> lz;
+    codec::lzCompress(packed.data(), packed.size(), lz);
+    block.insert(block.end(), lz.begin(), lz.end());
+    EXPECT_FALSE(codec::decompressBlock(block.data(), block.size(), records.size(), columns));
+}
+
+TEST_F(HistoryCodecTest, LzRoundTrip) {
+    std::vector<uint8_t> input;
+    for (int i = 0; i < 100000; ++i) {
+        input.push_back(static_cast<uint8_t>(i % 7 == 0 ? i : (i / 13) % 5));
+    }
+    std::vector<uint8_t> compressed;
+    codec::lzCompress(input.data(), input.size(), compressed);
+    std::vector<uint8_t> output(input.size());
+    ASSERT_TRUE(codec::lzDecompress(compressed.data(), compressed.size(),
+                                    output.data(), output.size()));
+    EXPECT_EQ(output, input);
+
+    // Corrupt input must be rejected, not overrun the output
+    compressed.resize(compressed.size() / 2);
+    EXPECT_FALSE(codec::lzDecompress(compressed.data(), compressed.size(),
+                                     output.data(), output.size()));
+}
+
+TEST_F(HistoryCodecTest, DecompressionThroughput) {
+    auto records = makeTraffic(16, 64);
+    HistoryColumns columns;
+    columns.fromRecords(records);
+    std::vector<uint8_t> compressed;
+    codec::compressBlock(columns, compressed);
+
+    const int iterations = 2000;
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < iterations; ++i) {
+        ASSERT_TRUE(codec::decompressBlock(compressed.data(), compressed.size(), records.size(), columns));
+    }
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    // Unoptimized builds decode about 0.3 GB/s; the bound leaves room for
+    // slow machines and sanitizers while catching a decoder gone quadratic
+    double bytes = double(iterations) * records.size() * sizeof(HistoryRecord);
+    EXPECT_GT(bytes / seconds, 30e6) << "bytes/s decoded";
+    EXPECT_GT(records.size() * sizeof(HistoryRecord), 10 * compressed.size());
+}
+
+}
+}
+
+int main(int argc, char **argv) {
+    testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
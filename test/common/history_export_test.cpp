@@ -0,0 +1,192 @@
+#include <gtest/gtest.h>
+#include "common/history_export.h"
+#include "common/conflict_log.h"
+#include <cstdlib>
+#include <cstring>
+#include <sstream>
+#include <string>
+#include <vector>
+
+namespace atc {
+namespace test {
+
+namespace {
+
+struct StreamMessage {
+    uint8_t header_type;
+    int64_t body_length;
+};
+
+template <typename T>
+T readValue(const uint8_t* data) {
+    T value;
+    std::memcpy(&value, data, sizeof(T));
+    return value;
+}
+
+// Walk the encapsulated messages of an Arrow IPC stream, reading only the
+// Message table fields needed to skip each body
+bool parseStream(const std::string& stream, std::vector<StreamMessage>& messages) {
+    const auto* data = reinterpret_cast<const uint8_t*>(stream.data());
+    size_t position = 0;
+    while (position + 8 <= stream.size()) {
+        if (readValue<uint32_t>(data + position) != 0xFFFFFFFF) return false;
+        int32_t metadata_length = readValue<int32_t>(data + position + 4);
+        position += 8;
+        if (metadata_length == 0) {
+            return position == stream.size();
+        }
+        if (metadata_length % 8 != 0 || position + metadata_length > stream.size()) return false;
+
+        const uint8_t* metadata = data + position;
+        const uint8_t* table = metadata + readValue<uint32_t>(metadata);
+        const uint8_t* vtable = table - readValue<int32_t>(table);
+        uint16_t vtable_size = readValue<uint16_t>(vtable);
+        auto field = [&](int id) -> const uint8_t* {
+            if (4 + 2 * id >= vtable_size) return nullptr;
+            uint16_t offset = readValue<uint16_t>(vtable + 4 + 2 * id);
+            return offset ? table + offset : nullptr;
+        };
+
+        StreamMessage message;
+        message.header_type = field(1) ? *field(1) : 0;
+        message.body_length = field(3) ? readValue<int64_t>(field(3)) : 0;
+        if (field(0) == nullptr || readValue<int16_t>(field(0)) != 4) return false;
+        messages.push_back(message);
+
+        position += metadata_length + message.body_length;
+    }
+    return false;
+}
+
+} // namespace
+
+class HistoryExportTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        char dir_template[] = "/tmp/atc_export_XXXXXX";
+        directory_ = mkdtemp(dir_template);
+    }
+
+    void TearDown() override {
+        std::system(("rm -rf " + directory_).c_str());
+    }
+
+    ConflictRecord makeConflict(int64_t time_ms, ConflictKind kind) {
+        ConflictRecord record;
+        std::memset(&record, 0, sizeof(record));
+        record.timestamp_ms = time_ms;
+        record.kind = static_cast<uint8_t>(kind);
+        std::strncpy(record.aircraft1, "AC001", ConflictRecord::CALLSIGN_LENGTH - 1);
+        std::strncpy(record.aircraft2, "AC002", ConflictRecord::CALLSIGN_LENGTH - 1);
+        record.horizontal_separation = 2500.0;
+        record.vertical_separation = 500.0;
+        return record;
+    }
+
+    std::string directory_;
+};
+
+TEST_F(HistoryExportTest, ConflictLogSurvivesRestart) {
+    {
+        ConflictLog log(directory_);
+        ASSERT_TRUE(log.isOperational());
+        for (int i = 0; i < 10; ++i) {
+            log.record(makeConflict(i * 1000, ConflictKind::EARLY_WARNING));
+        }
+    }
+    {
+        ConflictLog log(directory_);
+        log.record(makeConflict(10000, ConflictKind::VIOLATION));
+    }
+
+    std::vector<ConflictRecord> found;
+    ASSERT_TRUE(history::readConflicts(directory_, 3000, 10000, 4,
+        [&](const ConflictRecord* records, size_t count) {
+            found.insert(found.end(), records, records + count);
+            return true;
+        }));
+    ASSERT_EQ(found.size(), 8u);
+    EXPECT_EQ(found.front().timestamp_ms, 3000);
+    EXPECT_EQ(found.back().kind, static_cast<uint8_t>(ConflictKind::VIOLATION));
+    EXPECT_EQ(found.back().getAircraft2(), "AC002");
+}
+
+TEST_F(HistoryExportTest, SnapshotStreamHasBatchPerBlock) {
+    {
+        HistoryWriter writer(directory_);
+        for (int t = 0; t < 600; ++t) {
+            std::vector<AircraftState> states;
+            for (int i = 0; i < 4; ++i) {
+                AircraftState state;
+                state.callsign = "AC00" + std::to_string(i + 1);
+                state.position = {1000.0 + t * 10.0, 20000.0 * (i + 1), 20000.0};
+                state.velocity = {10.0, 0.0, 0.0};
+                state.heading = 90.0;
+                state.status = AircraftStatus::CRUISING;
+                state.timestamp = static_cast<double>(t * 1000);
+                states.push_back(state);
+            }
+            writer.append(states);
+        }
+    }
+
+    HistoryReader reader(directory_);
+    std::ostringstream out;
+    uint64_t rows = 0;
+    ASSERT_TRUE(history::exportSnapshotsArrow(reader, 100000, 499000, out, &rows));
+    EXPECT_EQ(rows, 400u * 4);
+
+    // Schema, one dictionary (the callsign set never changes), one batch per touched block
+    std::vector<StreamMessage> messages;
+    ASSERT_TRUE(parseStream(out.str(), messages));
+    ASSERT_EQ(messages.size(), 4u);
+    EXPECT_EQ(messages[0].header_type, 1);
+    EXPECT_EQ(messages[0].body_length, 0);
+    EXPECT_EQ(messages[1].header_type, 2);
+    for (size_t i = 2; i < messages.size(); ++i) {
+        EXPECT_EQ(messages[i].header_type, 3);
+        EXPECT_EQ(messages[i].body_length % 8, 0);
+    }
+}
+
+TEST_F(HistoryExportTest, ConflictStreamWithoutLogIsEmpty) {
+    std::ostringstream out;
+    uint64_t rows = 1;
+    ASSERT_TRUE(history::exportConflictsArrow(directory_, 0, 1000, out, &rows));
+    EXPECT_EQ(rows, 0u);
+
+    std::vector<StreamMessage> messages;
+    ASSERT_TRUE(parseStream(out.str(), messages));
+    ASSERT_EQ(messages.size(), 2u);
+    EXPECT_EQ(messages[0].header_type, 1);
+    EXPECT_EQ(messages[1].header_type, 2);
+}
+
+TEST_F(HistoryExportTest, ConflictStreamBatches) {
+    {
+        ConflictLog log(directory_);
+        for (int i = 0; i < 5000; ++i) {
+            log.record(makeConflict(i * 100, ConflictKind::CRITICAL_WARNING));
+        }
+    }
+
+    std::ostringstream out;
+    uint64_t rows = 0;
+    ASSERT_TRUE(history::exportConflictsArrow(directory_, 0, 1000000, out, &rows));
+    EXPECT_EQ(rows, 5000u);
+
+    std::vector<StreamMessage> messages;
+    ASSERT_TRUE(parseStream(out.str(), messages));
+    ASSERT_EQ(messages.size(), 4u);
+    EXPECT_EQ(messages[2].header_type, 3);
+    EXPECT_EQ(messages[3].header_type, 3);
+}
+
+}
+}
+
+int main(int argc, char **argv) {
+    testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
@@ -0,0 +1,169 @@
+#include <gtest/gtest.h>
+#include "common/history_rollup.h"
+#include "common/constants.h"
+#include <cstdlib>
+#include <string>
+#include <vector>
+
+namespace atc {
+namespace test {
+
+class HistoryRollupTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        char dir_template[] = "/tmp/atc_rollup_XXXXXX";
+        directory_ = mkdtemp(dir_template);
+    }
+
+    void TearDown() override {
+        std::system(("rm -rf " + directory_).c_str());
+    }
+
+    // Two aircraft in the south-west sector and one crossing east, one snapshot per second
+    std::vector<AircraftState> snapshot(int64_t time_ms, int t) {
+        std::vector<AircraftState> states;
+        for (int i = 0; i < 3; ++i) {
+            AircraftState state;
+            state.callsign = "AC00" + std::to_string(i + 1);
+            double x = (i == 2) ? 1000.0 + t * 100.0 : 5000.0;
+            state.position = {x, 5000.0 + i * 1000.0, 20000.0};
+            state.velocity = {i == 2 ? 100.0 : 0.0, 0.0, 0.0};
+            state.heading = 90.0;
+            state.status = AircraftStatus::CRUISING;
+            state.timestamp = static_cast<double>(time_ms);
+            states.push_back(state);
+        }
+        return states;
+    }
+
+    void writeHistory(int64_t start_ms, int seconds) {
+        HistoryWriter store(directory_);
+        HistoryRollupWriter rollup(directory_);
+        for (int t = 0; t < seconds; ++t) {
+            auto states = snapshot(start_ms + t * 1000, t);
+            store.append(states);
+            rollup.append(states);
+        }
+    }
+
+    std::string directory_;
+};
+
+TEST_F(HistoryRollupTest, RollupsKeepOneSamplePerInterval) {
+    writeHistory(0, 600);
+
+    HistoryReader fine(directory_, history::rollupPrefix(constants::HISTORY_ROLLUP_FINE_INTERVAL));
+    HistoryReader coarse(directory_, history::rollupPrefix(constants::HISTORY_ROLLUP_COARSE_INTERVAL));
+
+    auto fine_records = fine.trajectory("AC003", 0, 600000);
+    ASSERT_EQ(fine_records.size(), 60u);
+    for (size_t i = 0; i < fine_records.size(); ++i) {
+        EXPECT_EQ(fine_records[i].timestamp_ms, static_cast<int64_t>(i) * 10000);
+    }
+    EXPECT_EQ(coarse.trajectory("AC003", 0, 600000).size(), 10u);
+}
+
+TEST_F(HistoryRollupTest, DepartedAircraftAreForgotten) {
+    HistoryRollupWriter rollup(directory_);
+    // A new aircraft every second, each reporting for 5 s
+    for (int t = 0; t < 600; ++t) {
+        std::vector<AircraftState> states;
+        for (int age = 0; age < 5 && age <= t; ++age) {
+            AircraftState state = snapshot(t * 1000, t).front();
+            state.callsign = "NEW" + std::to_string(t - age);
+            states.push_back(state);
+        }
+        rollup.append(states);
+    }
+    // At most the last two buckets' aircraft per level, not all 600
+    size_t bound = 2 * (constants::HISTORY_ROLLUP_FINE_INTERVAL + constants::HISTORY_ROLLUP_COARSE_INTERVAL) / 1000 + 10;
+    EXPECT_LE(rollup.trackedAircraft(), bound);
+
+    // One that comes back after a gap still gets its first sample
+    std::vector<AircraftState> states = {snapshot(600000, 600).front()};
+    states[0].callsign = "NEW0";
+    rollup.append(states);
+    rollup.flush();
+    HistoryReader fine(directory_, history::rollupPrefix(constants::HISTORY_ROLLUP_FINE_INTERVAL));
+    EXPECT_EQ(fine.trajectory("NEW0", 0, 700000).size(), 2u);
+}
+
+TEST_F(HistoryRollupTest, QueryPicksCoarsestSufficientResolution) {
+    writeHistory(0, 600);
+    HistoryArchive archive(directory_);
+
+    EXPECT_EQ(archive.selectResolution(0, 0), constants::HISTORY_SNAPSHOT_INTERVAL);
+    EXPECT_EQ(archive.selectResolution(5000, 0), constants::HISTORY_SNAPSHOT_INTERVAL);
+    EXPECT_EQ(archive.selectResolution(30000, 0), constants::HISTORY_ROLLUP_FINE_INTERVAL);
+    EXPECT_EQ(archive.selectResolution(3600000, 0), constants::HISTORY_ROLLUP_COARSE_INTERVAL);
+
+    EXPECT_EQ(archive.trajectory("AC001", 0, 600000).size(), 600u);
+    EXPECT_EQ(archive.trajectory("AC001", 0, 600000, 30000).size(), 60u);
+    EXPECT_EQ(archive.window(0, 600000, HistoryRegion::everything(), 60000).size(), 30u);
+}
+
+TEST_F(HistoryRollupTest, RollupsWithoutRawCoverageAreSkipped) {
+    {
+        // Raw history predating the rollups
+        HistoryWriter store(directory_);
+        for (int t = 0; t < 600; ++t) {
+            store.append(snapshot(t * 1000, t));
+        }
+    }
+    writeHistory(600000, 600);
+
+    HistoryArchive archive(directory_);
+    EXPECT_EQ(archive.selectResolution(60000, 0), constants::HISTORY_SNAPSHOT_INTERVAL);
+    EXPECT_EQ(archive.selectResolution(60000, 600000), constants::HISTORY_ROLLUP_COARSE_INTERVAL);
+}
+
+TEST_F(HistoryRollupTest, SectorOccupancyPerMinute) {
+    writeHistory(0, 300);
+
+    HistoryArchive archive(directory_);
+    auto occupancy = archive.sectorOccupancy(0, 300000);
+
+    // The last minute is written when the writer shuts down
+    uint32_t south_west = history::sectorOf(5000.0, 5000.0);
+    int minutes = 0;
+    for (const auto& bucket : occupancy) {
+        EXPECT_EQ(bucket.bucket_ms % constants::HISTORY_OCCUPANCY_INTERVAL, 0);
+        if (bucket.sector == south_west) {
+            ++minutes;
+            EXPECT_GE(bucket.aircraft, 2u);
+        }
+    }
+    EXPECT_EQ(minutes, 5);
+
+    // The crossing aircraft reaches the next sector column during the fifth minute
+    uint32_t next_column = history::sectorOf(30000.0, 5000.0);
+    auto last_minute = archive.sectorOccupancy(240000, 250000);
+    bool found = false;
+    for (const auto& bucket : last_minute) {
+        EXPECT_EQ(bucket.bucket_ms, 240000);
+        found |= (bucket.sector == next_column && bucket.aircraft == 1);
+    }
+    EXPECT_TRUE(found);
+}
+
+TEST_F(HistoryRollupTest, OccupancyResumesAfterRestart) {
+    writeHistory(0, 90);
+    writeHistory(90000, 90);
+
+    HistoryArchive archive(directory_);
+    auto occupancy = archive.sectorOccupancy(0, 180000);
+    int64_t previous = -1;
+    for (const auto& bucket : occupancy) {
+        EXPECT_GE(bucket.bucket_ms, previous);
+        previous = bucket.bucket_ms;
+    }
+    EXPECT_EQ(previous, 120000);
+}
+
+}
+}
+
+int main(int argc, char **argv) {
+    testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
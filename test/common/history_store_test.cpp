@@ -0,0 +1,169 @@
+#include <gtest/gtest.h>
+#include "common/history_store.h"
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <string>
+#include <vector>
+
+namespace atc {
+namespace test {
+
+class HistoryStoreTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        char dir_template[] = "/tmp/atc_history_XXXXXX";
+        directory_ = mkdtemp(dir_template);
+    }
+
+    void TearDown() override {
+        std::system(("rm -rf " + directory_).c_str());
+    }
+
+    // Four aircraft flying east, one snapshot per second
+    void writeSnapshots(HistoryWriter& writer, int64_t start_ms, int seconds) {
+        for (int t = 0; t < seconds; ++t) {
+            std::vector<AircraftState> states;
+            for (int i = 0; i < 4; ++i) {
+                AircraftState state;
+                state.callsign = "AC00" + std::to_string(i + 1);
+                state.position = {1000.0 + t * 100.0, 20000.0 * (i + 1), 20000.0};
+                state.velocity = {100.0, 0.0, 0.0};
+                state.heading = 0.0;
+                state.status = AircraftStatus::CRUISING;
+                state.timestamp = static_cast<double>(start_ms + t * 1000);
+                states.push_back(state);
+            }
+            writer.append(states);
+        }
+    }
+
+    std::string directory_;
+};
+
+TEST_F(HistoryStoreTest, TrajectoryQuery) {
+    {
+        HistoryWriter writer(directory_);
+        writeSnapshots(writer, 1000000, 3000);
+    }
+
+    HistoryReader reader(directory_);
+    EXPECT_EQ(reader.getSegmentCount(), 1u);
+    EXPECT_EQ(reader.getStartTime(), 1000000);
+
+    auto records = reader.trajectory("AC002", 1000000 + 120000, 1000000 + 420000);
+    ASSERT_EQ(records.size(), 301u);
+    EXPECT_EQ(records.front().timestamp_ms, 1120000);
+    EXPECT_EQ(records.back().timestamp_ms, 1420000);
+    for (const auto& record : records) {
+        EXPECT_EQ(record.getCallsign(), "AC002");
+        EXPECT_DOUBLE_EQ(record.y, 40000.0);
+    }
+
+    EXPECT_TRUE(reader.trajectory("UNKNOWN", 0, 5000000).empty());
+}
+
+TEST_F(HistoryStoreTest, WindowQueryWithRegion) {
+    {
+        HistoryWriter writer(directory_);
+        writeSnapshots(writer, 0, 100);
+    }
+
+    HistoryReader reader(directory_);
+    auto all = reader.window(10000, 19000);
+    EXPECT_EQ(all.size(), 40u);
+
+    auto region = HistoryRegion::everything();
+    region.y_min = 50000.0;
+    auto north = reader.window(10000, 19000, region);
+    EXPECT_EQ(north.size(), 20u);
+}
+
+TEST_F(HistoryStoreTest, FlushedOpenSegmentIsQueryable) {
+    HistoryWriter writer(directory_);
+    writeSnapshots(writer, 0, 10);
+    writer.flush();
+    writeSnapshots(writer, 10000, 10);
+    writer.flush();
+
+    HistoryReader reader(directory_);
+    EXPECT_EQ(reader.trajectory("AC001", 0, 20000).size(), 20u);
+}
+
+TEST_F(HistoryStoreTest, RestartContinuesSegmentNumbering) {
+    {
+        HistoryWriter writer(directory_);
+        writeSnapshots(writer, 0, 10);
+    }
+    {
+        HistoryWriter writer(directory_);
+        writeSnapshots(writer, 10000, 10);
+    }
+
+    HistoryReader reader(directory_);
+    EXPECT_EQ(reader.getSegmentCount(), 2u);
+    EXPECT_EQ(reader.trajectory("AC004", 0, 20000).size(), 20u);
+}
+
+TEST_F(HistoryStoreTest, CorruptIndexCountsAreRejected) {
+    std::string segment;
+    {
+        HistoryWriter writer(directory_);
+        segment = writer.getSegmentPath();
+        writeSnapshots(writer, 0, 20);
+    }
+    std::string index_path = history::indexPath(segment);
+    HistorySegmentIndex index;
+    ASSERT_TRUE(index.load(index_path));
+
+    // A block count far beyond the file: the block count follows the 8-byte magic
+    {
+        std::fstream file(index_path, std::ios::binary | std::ios::in | std::ios::out);
+        uint32_t block_count = 0xFFFFFFFF;
+        file.seekp(8);
+        file.write(reinterpret_cast<const char*>(&block_count), sizeof(block_count));
+    }
+    HistorySegmentIndex corrupt;
+    EXPECT_FALSE(corrupt.load(index_path));
+    EXPECT_TRUE(corrupt.empty());
+
+    // The reader falls back to scanning the segment itself
+    HistoryReader reader(directory_);
+    EXPECT_EQ(reader.trajectory("AC001", 0, 20000).size(), 20u);
+}
+
+TEST_F(HistoryStoreTest, CompressedSegmentAnswersSameQueries) {
+    std::string segment;
+    {
+        HistoryWriter writer(directory_);
+        segment = writer.getSegmentPath();
+        writeSnapshots(writer, 0, 2000);
+    }
+
+    HistoryReader raw_reader(directory_);
+    auto expected = raw_reader.trajectory("AC003", 100000, 900000);
+    auto expected_window = raw_reader.window(0, 2000000);
+
+    uint64_t raw_bytes = 0;
+    uint64_t compressed_bytes = 0;
+    ASSERT_TRUE(history::compressSegment(segment, &raw_bytes, &compressed_bytes));
+    EXPECT_LT(compressed_bytes * 5, raw_bytes);
+
+    HistoryReader reader(directory_);
+    auto actual = reader.trajectory("AC003", 100000, 900000);
+    ASSERT_EQ(actual.size(), expected.size());
+    EXPECT_EQ(std::memcmp(actual.data(), expected.data(),
+                          actual.size() * sizeof(HistoryRecord)), 0);
+    EXPECT_EQ(reader.window(0, 2000000).size(), expected_window.size());
+
+    // Compressing twice is a no-op
+    EXPECT_TRUE(history::compressSegment(segment));
+}
+
+}
+}
+
+int main(int argc, char **argv) {
+    testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
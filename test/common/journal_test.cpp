@@ -0,0 +1,177 @@
+#include <gtest/gtest.h>
+#include "common/journal.h"
+#include <cstdio>
+#include <fstream>
+#include <string>
+#include <unistd.h>
+
+namespace atc {
+namespace test {
+
+class JournalTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        path_ = "/tmp/atc_journal_test_" + std::to_string(::getpid()) + ".bin";
+    }
+
+    void TearDown() override {
+        std::remove(path_.c_str());
+    }
+
+    std::string path_;
+};
+
+TEST_F(JournalTest, RoundTripsEveryInput) {
+    auto epoch = std::chrono::system_clock::time_point(std::chrono::microseconds(1760000000123456));
+    {
+        JournalWriter writer(path_);
+        ASSERT_TRUE(writer.open(42, epoch));
+        writer.writeScenarioRow(std::chrono::milliseconds(0), "Time,ID,X,Y,Z,SpeedX,SpeedY,SpeedZ");
+
+        AircraftState state;
+        state.callsign = "AC001";
+        state.position = {1000.5, 2000.25, 20000.0};
+        state.velocity = {250.0, -10.125, 0.0};
+        state.heading = 357.75;
+        state.status = AircraftStatus::HOLDING;
+        state.timestamp = 1.76e12;
+        writer.writeMessage(std::chrono::milliseconds(100), comm::Message::createPositionUpdate("RADAR", state));
+
+        comm::CommandData command("AC001", "ALTITUDE");
+        command.params.push_back("21000");
+        writer.writeMessage(std::chrono::milliseconds(200), comm::Message::createCommand("CONSOLE", command));
+        writer.writeMessage(std::chrono::milliseconds(200),
+                            comm::Message::createAlert("CONSOLE", comm::AlertData(2, "Weather")));
+        writer.writeAlert(std::chrono::milliseconds(300), "Separation violation between AC001 and AC002");
+        writer.close(std::chrono::milliseconds(400));
+    }
+
+    JournalReader reader;
+    ASSERT_TRUE(reader.open(path_));
+    EXPECT_EQ(reader.getSeed(), 42u);
+    EXPECT_EQ(reader.getEpoch(), epoch);
+
+    JournalEntry entry;
+    ASSERT_TRUE(reader.next(entry));
+    EXPECT_EQ(entry.kind, JournalKind::SCENARIO_ROW);
+    EXPECT_EQ(entry.payload, "Time,ID,X,Y,Z,SpeedX,SpeedY,SpeedZ");
+
+    comm::Message message;
+    ASSERT_TRUE(reader.next(entry));
+    EXPECT_EQ(entry.kind, JournalKind::CHANNEL_MESSAGE);
+    EXPECT_EQ(entry.at.count(), 100);
+    ASSERT_TRUE(JournalReader::decodeMessage(entry.payload, message));
+    EXPECT_EQ(message.type, comm::MessageType::POSITION_UPDATE);
+    EXPECT_EQ(message.sender_id, "RADAR");
+    const auto& state = std::get<AircraftState>(message.payload);
+    EXPECT_EQ(state.callsign, "AC001");
+    EXPECT_EQ(state.position.y, 2000.25);
+    EXPECT_EQ(state.velocity.vy, -10.125);
+    EXPECT_EQ(state.heading, 357.75);
+    EXPECT_EQ(state.status, AircraftStatus::HOLDING);
+
+    ASSERT_TRUE(reader.next(entry));
+    ASSERT_TRUE(JournalReader::decodeMessage(entry.payload, message));
+    const auto& command = std::get<comm::CommandData>(message.payload);
+    EXPECT_EQ(command.command, "ALTITUDE");
+    ASSERT_EQ(command.params.size(), 1u);
+    EXPECT_EQ(command.params[0], "21000");
+
+    ASSERT_TRUE(reader.next(entry));
+    ASSERT_TRUE(JournalReader::decodeMessage(entry.payload, message));
+    EXPECT_EQ(std::get<comm::AlertData>(message.payload).level, 2);
+    EXPECT_EQ(std::get<comm::AlertData>(message.payload).description, "Weather");
+
+    ASSERT_TRUE(reader.next(entry));
+    EXPECT_EQ(entry.kind, JournalKind::ALERT);
+    EXPECT_EQ(entry.at.count(), 300);
+
+    ASSERT_TRUE(reader.next(entry));
+    EXPECT_EQ(entry.kind, JournalKind::END);
+    EXPECT_EQ(entry.at.count(), 400);
+    EXPECT_FALSE(reader.next(entry));
+}
+
+TEST_F(JournalTest, RoundTripsAdmissionMessages) {
+    comm::FlightPlanData plan;
+    plan.callsign = "AC100";
+    plan.cruise_speed = 240.0;
+    plan.wake_category = WakeCategory::HEAVY;
+    plan.waypoints = {{1000.0, 2000.0, 20000.0}, {50000.0, 2000.0, 21000.0}};
+    AircraftState entering{};
+    entering.callsign = "AC100";
+    entering.position = {1000.0, 2000.0, 20000.0};
+    entering.velocity = {240.0, 0.0, 0.0};
+    {
+        JournalWriter writer(path_);
+        ASSERT_TRUE(writer.open(1, std::chrono::system_clock::now()));
+        writer.writeMessage(std::chrono::milliseconds(100), comm::Message::createFlightPlan("FDP", plan));
+        writer.writeMessage(std::chrono::milliseconds(100), comm::Message::createAircraftEnter("FDP", entering));
+        writer.writeMessage(std::chrono::milliseconds(900), comm::Message::createAircraftExit("FDP", "AC100"));
+        writer.close(std::chrono::milliseconds(1000));
+    }
+
+    JournalReader reader;
+    ASSERT_TRUE(reader.open(path_));
+    JournalEntry entry;
+    comm::Message message;
+    ASSERT_TRUE(reader.next(entry));
+    ASSERT_TRUE(JournalReader::decodeMessage(entry.payload, message));
+    EXPECT_EQ(message.type, comm::MessageType::FLIGHT_PLAN);
+    const auto& decoded = std::get<comm::FlightPlanData>(message.payload);
+    EXPECT_EQ(decoded.callsign, "AC100");
+    EXPECT_EQ(decoded.cruise_speed, 240.0);
+    EXPECT_EQ(decoded.wake_category, WakeCategory::HEAVY);
+    ASSERT_EQ(decoded.waypoints.size(), 2u);
+    EXPECT_EQ(decoded.waypoints[1].z, 21000.0);
+
+    ASSERT_TRUE(reader.next(entry));
+    ASSERT_TRUE(JournalReader::decodeMessage(entry.payload, message));
+    EXPECT_EQ(message.type, comm::MessageType::AIRCRAFT_ENTER);
+    EXPECT_EQ(std::get<AircraftState>(message.payload).velocity.vx, 240.0);
+
+    ASSERT_TRUE(reader.next(entry));
+    ASSERT_TRUE(JournalReader::decodeMessage(entry.payload, message));
+    EXPECT_EQ(message.type, comm::MessageType::AIRCRAFT_EXIT);
+    EXPECT_EQ(std::get<AircraftState>(message.payload).callsign, "AC100");
+}
+
+TEST_F(JournalTest, StopsAtRecordCutShortByCrash) {
+    {
+        JournalWriter writer(path_);
+        ASSERT_TRUE(writer.open(7, std::chrono::system_clock::now()));
+        writer.writeAlert(std::chrono::milliseconds(100), "first");
+        writer.writeAlert(std::chrono::milliseconds(200), "second");
+        writer.flush();
+    }
+    std::string data;
+    {
+        std::ifstream in(path_, std::ios::binary);
+        data.assign(std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>());
+    }
+    std::ofstream(path_, std::ios::binary | std::ios::trunc).write(data.data(), data.size() - 3);
+
+    JournalReader reader;
+    ASSERT_TRUE(reader.open(path_));
+    JournalEntry entry;
+    ASSERT_TRUE(reader.next(entry));
+    EXPECT_EQ(entry.payload, "first");
+    EXPECT_FALSE(reader.next(entry));
+}
+
+TEST_F(JournalTest, RejectsOtherFilesAndMalformedMessages) {
+    std::ofstream(path_) << "Time,ID,X,Y,Z,SpeedX,SpeedY,SpeedZ\n";
+    JournalReader reader;
+    EXPECT_FALSE(reader.open(path_));
+
+    comm::Message message;
+    EXPECT_FALSE(JournalReader::decodeMessage(std::string("\x01\x02", 2), message));
+}
+
+}
+}
+
+int main(int argc, char **argv) {
+    testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
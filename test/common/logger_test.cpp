@@ -0,0 +1,128 @@
+#include <gtest/gtest.h>
+#include "common/logger.h"
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <thread>
+
+namespace atc {
+namespace test {
+
+class LoggerTest : public ::testing::Test {
+protected:
+    void SetUp() override { saved_ = Logger::getLevel(); }
+    void TearDown() override { Logger::setLevel(saved_); }
+
+    LogLevel saved_;
+};
+
+// Logger always writes system.log in the working directory
+std::string readLog() {
+    std::ifstream in("system.log");
+    std::stringstream contents;
+    contents << in.rdbuf();
+    return contents.str();
+}
+
+std::string countedMessage(int& evaluations) {
+    ++evaluations;
+    return "message " + std::to_string(evaluations);
+}
+
+TEST_F(LoggerTest, DisabledLevelSkipsFormatting) {
+    int evaluations = 0;
+    Logger::setLevel(LogLevel::WARNING);
+
+    ATC_LOG_DEBUG(countedMessage(evaluations));
+    ATC_LOG_INFO(countedMessage(evaluations));
+    EXPECT_EQ(evaluations, 0);
+
+    ATC_LOG_WARNING(countedMessage(evaluations));
+    ATC_LOG_ERROR(countedMessage(evaluations));
+    EXPECT_EQ(evaluations, 2);
+}
+
+TEST_F(LoggerTest, OffSilencesEverything) {
+    int evaluations = 0;
+    Logger::setLevel(LogLevel::OFF);
+    ATC_LOG_ERROR(countedMessage(evaluations));
+    EXPECT_FALSE(ATC_LOG_ENABLED(ERROR));
+    EXPECT_EQ(evaluations, 0);
+}
+
+TEST_F(LoggerTest, ParseLevelNames) {
+    LogLevel level = LogLevel::INFO;
+    EXPECT_TRUE(Logger::parseLevel("DEBUG", level));
+    EXPECT_EQ(level, LogLevel::DEBUG);
+    EXPECT_TRUE(Logger::parseLevel("ERROR", level));
+    EXPECT_EQ(level, LogLevel::ERROR);
+    EXPECT_FALSE(Logger::parseLevel("verbose", level));
+    EXPECT_EQ(level, LogLevel::ERROR);
+}
+
+TEST_F(LoggerTest, InfoLinesAreStagedUntilFlush) {
+    Logger::setLevel(LogLevel::INFO);
+    Logger::getInstance().flushAll();
+    size_t before = readLog().size();
+
+    ATC_LOG_INFO("staged line one");
+    ATC_LOG_INFO("staged line two");
+    EXPECT_EQ(readLog().size(), before);
+
+    Logger::getInstance().flush();
+    std::string written = readLog().substr(before);
+    EXPECT_NE(written.find("[INFO] staged line one\n"), std::string::npos);
+    EXPECT_LT(written.find("staged line one"), written.find("staged line two"));
+}
+
+TEST_F(LoggerTest, WarningWritesThroughWithStagedLines) {
+    Logger::setLevel(LogLevel::INFO);
+    Logger::getInstance().flushAll();
+    size_t before = readLog().size();
+
+    ATC_LOG_INFO("context before warning");
+    ATC_LOG_WARNING("warning line");
+    std::string written = readLog().substr(before);
+    EXPECT_LT(written.find("context before warning"), written.find("[WARNING] warning line"));
+}
+
+TEST_F(LoggerTest, ThreadExitFlushesItsBuffer) {
+    Logger::setLevel(LogLevel::INFO);
+    Logger::getInstance().flushAll();
+    size_t before = readLog().size();
+
+    std::thread worker([] { ATC_LOG_INFO("from worker thread"); });
+    worker.join();
+    EXPECT_NE(readLog().find("from worker thread", before), std::string::npos);
+}
+
+TEST_F(LoggerTest, EventsAreAggregated) {
+    LogEvent event("test events", LogLevel::INFO);
+    Logger::setLevel(LogLevel::INFO);
+    Logger::getInstance().flushAll();
+    size_t before = readLog().size();
+
+    EXPECT_TRUE(event.record());
+    for (int i = 0; i < 41; ++i) {
+        EXPECT_FALSE(event.record());
+    }
+    Logger::getInstance().flushAll();
+    std::string written = readLog().substr(before);
+    EXPECT_NE(written.find("[INFO] 42 test events in last "), std::string::npos);
+
+    // A new interval samples again; disabled levels are not counted
+    EXPECT_TRUE(event.record());
+    Logger::setLevel(LogLevel::WARNING);
+    EXPECT_FALSE(event.record());
+    Logger::setLevel(LogLevel::INFO);
+    Logger::getInstance().flushAll();
+    EXPECT_NE(readLog().find("[INFO] 1 test events in last ", before), std::string::npos);
+}
+
+}
+}
+
+int main(int argc, char **argv) {
+    testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
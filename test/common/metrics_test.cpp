@@ -0,0 +1,121 @@
+#include <gtest/gtest.h>
+#include "common/metrics.h"
+#include <cstdio>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace atc {
+namespace test {
+
+using metrics::Counter;
+using metrics::Gauge;
+using metrics::Histogram;
+using metrics::MetricsRegistry;
+
+TEST(MetricsTest, CounterAddsUpEveryThread) {
+    Counter counter("test_events_total", "Events");
+    std::vector<std::thread> threads;
+    for (int t = 0; t < 8; ++t) {
+        threads.emplace_back([&counter] {
+            for (int i = 0; i < 100000; ++i) {
+                counter.increment();
+            }
+        });
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+    counter.increment(5);
+    EXPECT_EQ(counter.count(), 800005u);
+}
+
+TEST(MetricsTest, GaugeKeepsTheLastValue) {
+    Gauge gauge("test_level", "Level");
+    gauge.set(3.0);
+    gauge.set(1.5);
+    EXPECT_EQ(gauge.value(), 1.5);
+}
+
+TEST(MetricsTest, HistogramBucketsByUpperBound) {
+    Histogram histogram("test_seconds", "Durations", {1.0, 2.0, 5.0});
+    for (double value : {0.5, 1.0, 1.5, 10.0}) {
+        histogram.observe(value);
+    }
+    EXPECT_EQ(histogram.bucketCounts(), (std::vector<uint64_t>{2, 1, 0, 1}));
+    EXPECT_DOUBLE_EQ(histogram.sum(), 13.0);
+    EXPECT_EQ(histogram.value(), 4.0);
+}
+
+TEST(MetricsTest, ExposesPrometheusText) {
+    Counter counter("test_b_total", "Things\nthat happened");
+    Histogram histogram("test_a_seconds", "Durations", {0.5, 1.0});
+    counter.increment(3);
+    histogram.observe(0.25);
+    histogram.observe(0.75);
+
+    std::string text = MetricsRegistry::getInstance().expose();
+    const std::string expected_histogram =
+        "# HELP test_a_seconds Durations\n"
+        "# TYPE test_a_seconds histogram\n"
+        "test_a_seconds_bucket{le=\"0.5\"} 1\n"
+        "test_a_seconds_bucket{le=\"1\"} 2\n"
+        "test_a_seconds_bucket{le=\"+Inf\"} 2\n"
+        "test_a_seconds_sum 1\n"
+        "test_a_seconds_count 2\n";
+    const std::string expected_counter =
+        "# HELP test_b_total Things\\nthat happened\n"
+        "# TYPE test_b_total counter\n"
+        "test_b_total 3\n";
+    size_t histogram_at = text.find(expected_histogram);
+    size_t counter_at = text.find(expected_counter);
+    ASSERT_NE(histogram_at, std::string::npos) << text;
+    ASSERT_NE(counter_at, std::string::npos) << text;
+    EXPECT_LT(histogram_at, counter_at);   // sorted by name
+
+    EXPECT_EQ(MetricsRegistry::getInstance().value("test_b_total"), 3.0);
+}
+
+TEST(MetricsTest, LabelledSeriesShareOneHeader) {
+    Counter radar("test_scoped_total", "Per scope", {{"scope", "radar"}});
+    Counter detector("test_scoped_total", "Per scope", {{"scope", "say \"hi\""}});
+    radar.increment(2);
+    detector.increment(5);
+
+    std::string text = MetricsRegistry::getInstance().expose();
+    EXPECT_NE(text.find("# TYPE test_scoped_total counter\n"
+                        "test_scoped_total{scope=\"radar\"} 2\n"
+                        "test_scoped_total{scope=\"say \\\"hi\\\"\"} 5\n"), std::string::npos) << text;
+    EXPECT_EQ(MetricsRegistry::getInstance().value("test_scoped_total"), 7.0);
+}
+
+TEST(MetricsTest, DestroyedMetricsLeaveTheRegistry) {
+    {
+        Gauge gauge("test_temporary", "Temporary");
+        EXPECT_NE(MetricsRegistry::getInstance().expose().find("test_temporary"), std::string::npos);
+    }
+    EXPECT_EQ(MetricsRegistry::getInstance().expose().find("test_temporary"), std::string::npos);
+}
+
+TEST(MetricsTest, WritesTheExpositionToAFile) {
+    Counter counter("test_written_total", "Written");
+    counter.increment();
+    const std::string path = "metrics_test.prom";
+    ASSERT_TRUE(MetricsRegistry::getInstance().writeFile(path));
+
+    std::ifstream in(path);
+    std::stringstream contents;
+    contents << in.rdbuf();
+    EXPECT_EQ(contents.str(), MetricsRegistry::getInstance().expose());
+    std::remove(path.c_str());
+}
+
+}
+}
+
+int main(int argc, char **argv) {
+    testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
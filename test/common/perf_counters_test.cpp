@@ -0,0 +1,76 @@
+#include <gtest/gtest.h>
+#include "common/perf_counters.h"
+#include <string>
+#include <vector>
+
+namespace atc {
+namespace test {
+
+struct SampleTask {
+    virtual ~SampleTask() = default;
+};
+
+// Runs first: nothing is measured until instrumentation is enabled
+TEST(PerfCountersTest, DisabledScopeRecordsNothing) {
+    ASSERT_FALSE(PerfCounters::isEnabled());
+    PerfKernel kernel("test_disabled");
+    {
+        PerfScope scope(kernel);
+    }
+    EXPECT_EQ(kernel.getRuns(), 0u);
+}
+
+TEST(PerfCountersTest, KernelAddsToLabelledMetrics) {
+    PerfKernel kernel("test_kernel");
+    PerfSample sample;
+    sample.cycles = 1000;
+    sample.instructions = 2500;
+    sample.cache_misses = 3;
+    sample.branch_misses = 7;
+    kernel.add(sample);
+    kernel.add(sample);
+
+    EXPECT_EQ(kernel.getRuns(), 2u);
+    EXPECT_EQ(kernel.getTotals().instructions, 5000u);
+    std::string text = metrics::MetricsRegistry::getInstance().expose();
+    EXPECT_NE(text.find("atc_perf_cycles_total{scope=\"test_kernel\"} 2000\n"), std::string::npos) << text;
+    EXPECT_NE(text.find("atc_perf_branch_misses_total{scope=\"test_kernel\"} 14\n"), std::string::npos);
+
+    std::string report = PerfCounters::report();
+    EXPECT_NE(report.find("test_kernel"), std::string::npos);
+    EXPECT_NE(report.find("2.50"), std::string::npos);   // instructions per cycle
+    EXPECT_EQ(report.find("test_disabled"), std::string::npos);   // never ran
+}
+
+TEST(PerfCountersTest, TasksShareAKernelPerClass) {
+    SampleTask first;
+    SampleTask second;
+    PerfKernel& kernel = PerfKernel::forTask(typeid(first));
+    EXPECT_EQ(&kernel, &PerfKernel::forTask(typeid(second)));
+    EXPECT_EQ(kernel.getScope(), "test::SampleTask");
+}
+
+TEST(PerfCountersTest, CountsAMeasuredLoop) {
+    if (!PerfCounters::enable()) {
+        GTEST_SKIP() << "perf_event_open is not available here";
+    }
+    PerfKernel kernel("test_loop");
+    volatile uint64_t total = 0;
+    {
+        PerfScope scope(kernel);
+        for (uint64_t i = 0; i < 1000000; ++i) {
+            total = total + i;
+        }
+    }
+    ASSERT_EQ(kernel.getRuns(), 1u);
+    EXPECT_GT(kernel.getTotals().instructions, 1000000u);
+    EXPECT_GT(kernel.getTotals().cycles, 0u);
+}
+
+}
+}
+
+int main(int argc, char **argv) {
+    testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
@@ -0,0 +1,90 @@
+#include <gtest/gtest.h>
+#include "common/process_supervisor.h"
+#include <chrono>
+#include <csignal>
+#include <thread>
+#include <unistd.h>
+
+namespace atc {
+namespace test {
+
+// Polls until `done` holds or a second passes
+template <typename Predicate>
+bool pollUntil(ProcessSupervisor& supervisor, Predicate done) {
+    auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(1);
+    while (std::chrono::steady_clock::now() < deadline) {
+        bool healthy = supervisor.poll();
+        if (done(healthy)) return true;
+        std::this_thread::sleep_for(std::chrono::milliseconds(5));
+    }
+    return false;
+}
+
+int sleepForever() {
+    while (true) {
+        ::pause();
+    }
+}
+
+TEST(ProcessSupervisorTest, RestartsNonCriticalProcessUpToLimit) {
+    ProcessSupervisor supervisor(std::chrono::milliseconds(10), 3);
+    supervisor.addProcess("display", [] { return 3; }, false);
+    supervisor.addProcess("detection", sleepForever, true);
+    ASSERT_TRUE(supervisor.start());
+    pid_t detection = supervisor.getPid("detection");
+
+    EXPECT_TRUE(pollUntil(supervisor, [&](bool) {
+        return supervisor.getRestartCount("display") == 3 && supervisor.getPid("display") < 0;
+    }));
+    // Given up on the display, but the critical process keeps running untouched
+    for (int i = 0; i < 5; ++i) {
+        EXPECT_TRUE(supervisor.poll());
+        std::this_thread::sleep_for(std::chrono::milliseconds(20));
+    }
+    EXPECT_EQ(supervisor.getRestartCount("display"), 3);
+    EXPECT_EQ(supervisor.getPid("detection"), detection);
+}
+
+TEST(ProcessSupervisorTest, CriticalFailureStopsDeployment) {
+    ProcessSupervisor supervisor(std::chrono::milliseconds(10), 3);
+    supervisor.addProcess("display", sleepForever, false);
+    supervisor.addProcess("detection", [] { return 0; }, true);
+    ASSERT_TRUE(supervisor.start());
+
+    EXPECT_TRUE(pollUntil(supervisor, [](bool healthy) { return !healthy; }));
+    EXPECT_EQ(supervisor.getRestartCount("detection"), 0);
+
+    std::atomic<bool> running{true};
+    EXPECT_EQ(supervisor.run(running), 1);
+    EXPECT_LT(supervisor.getPid("display"), 0);
+}
+
+TEST(ProcessSupervisorTest, StopTerminatesEveryProcess) {
+    ProcessSupervisor supervisor(std::chrono::milliseconds(10), 3);
+    supervisor.addProcess("surveillance", sleepForever, true);
+    supervisor.addProcess("display", sleepForever, false);
+    ASSERT_TRUE(supervisor.start());
+    pid_t display = supervisor.getPid("display");
+    ASSERT_GT(display, 0);
+
+    // A killed non-critical process comes back as a new one
+    ::kill(display, SIGKILL);
+    EXPECT_TRUE(pollUntil(supervisor, [&](bool) {
+        return supervisor.getPid("display") > 0 && supervisor.getPid("display") != display;
+    }));
+
+    auto start = std::chrono::steady_clock::now();
+    supervisor.stop();
+    EXPECT_LT(std::chrono::steady_clock::now() - start, std::chrono::seconds(1));
+    EXPECT_LT(supervisor.getPid("surveillance"), 0);
+    EXPECT_LT(supervisor.getPid("display"), 0);
+    EXPECT_EQ(supervisor.getRestartCount("display"), 1);
+}
+
+}
+}
+
+int main(int argc, char **argv) {
+    testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
@@ -0,0 +1,87 @@
+#include <gtest/gtest.h>
+#include "common/snapshot_delta.h"
+#include <string>
+#include <vector>
+
+namespace atc {
+namespace test {
+
+SnapshotTrack makeTrack(const std::string& callsign, float x) {
+    return {callsign, x, 5000.0f, 20000.0f, 90.0f, 250.0f,
+            static_cast<uint8_t>(AircraftStatus::CRUISING), 0};
+}
+
+Snapshot makeFrameSnapshot(uint64_t sequence, std::vector<SnapshotTrack> tracks) {
+    Snapshot snapshot;
+    snapshot.sequence = sequence;
+    snapshot.timestamp_ms = static_cast<int64_t>(sequence) * 1000;
+    snapshot.tracks = std::move(tracks);
+    return snapshot;
+}
+
+TEST(SnapshotDeltaTest, KeyFrameThenDeltaRoundTrip) {
+    Snapshot first = makeFrameSnapshot(1, {makeTrack("AAL1", 1), makeTrack("BAW2", 2), makeTrack("DLH3", 3)});
+    Snapshot second = makeFrameSnapshot(2, {makeTrack("AAL1", 1), makeTrack("CCA9", 9), makeTrack("DLH3", 4)});
+    second.tracks[2].flags = TRACK_FLAG_VIOLATION;
+
+    std::string key;
+    encodeSnapshotDelta(nullptr, first, key);
+    Snapshot client;
+    ASSERT_TRUE(applySnapshotDelta(client, key.data(), key.size()));
+    EXPECT_EQ(client.sequence, 1u);
+    EXPECT_EQ(client.tracks, first.tracks);
+
+    // Only CCA9 and DLH3 are sent, plus the removal of BAW2
+    std::string delta;
+    encodeSnapshotDelta(&first, second, delta);
+    EXPECT_EQ(delta.size(), 40u + 2 * (1 + 4 + 22) + (1 + 4));
+    ASSERT_TRUE(applySnapshotDelta(client, delta.data(), delta.size()));
+    EXPECT_EQ(client.sequence, 2u);
+    EXPECT_EQ(client.timestamp_ms, 2000);
+    EXPECT_EQ(client.tracks, second.tracks);
+}
+
+TEST(SnapshotDeltaTest, RejectsWrongBaseAndTruncatedFrames) {
+    Snapshot first = makeFrameSnapshot(1, {makeTrack("AAL1", 1)});
+    Snapshot second = makeFrameSnapshot(2, {makeTrack("AAL1", 2)});
+    Snapshot third = makeFrameSnapshot(3, {});
+
+    std::string delta;
+    encodeSnapshotDelta(&second, third, delta);
+    Snapshot client;
+    std::string key;
+    encodeSnapshotDelta(nullptr, first, key);
+    ASSERT_TRUE(applySnapshotDelta(client, key.data(), key.size()));
+    EXPECT_FALSE(applySnapshotDelta(client, delta.data(), delta.size()));
+    EXPECT_EQ(client.tracks, first.tracks);
+
+    encodeSnapshotDelta(&first, second, delta);
+    EXPECT_FALSE(applySnapshotDelta(client, delta.data(), delta.size() - 1));
+    EXPECT_FALSE(applySnapshotDelta(client, delta.data(), 12));
+    EXPECT_EQ(client.sequence, 1u);
+}
+
+TEST(SnapshotDeltaTest, MakeSnapshotSortsByCallsign) {
+    std::vector<AircraftState> states(2);
+    states[0].callsign = "ZZZ1";
+    states[0].position = {1000.0, 2000.0, 21000.0};
+    states[0].velocity = {3.0, 4.0, 0.0};
+    states[0].heading = 53.0;
+    states[0].status = AircraftStatus::HOLDING;
+    states[1] = states[0];
+    states[1].callsign = "AAA1";
+
+    Snapshot snapshot = makeSnapshot(states, 7, 1234);
+    ASSERT_EQ(snapshot.tracks.size(), 2u);
+    EXPECT_EQ(snapshot.tracks[0].callsign, "AAA1");
+    EXPECT_FLOAT_EQ(snapshot.tracks[1].speed, 5.0f);
+    EXPECT_EQ(snapshot.tracks[1].status, static_cast<uint8_t>(AircraftStatus::HOLDING));
+}
+
+}
+}
+
+int main(int argc, char **argv) {
+    testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
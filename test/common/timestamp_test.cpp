@@ -0,0 +1,70 @@
+#include <gtest/gtest.h>
+#include "common/timestamp.h"
+#include <ctime>
+#include <string>
+
+namespace atc {
+namespace test {
+
+using Clock = std::chrono::system_clock;
+
+std::string strftimeSeconds(Clock::time_point time) {
+    std::time_t t = Clock::to_time_t(time);
+    std::tm tm;
+    localtime_r(&t, &tm);
+    char buffer[32];
+    size_t length = std::strftime(buffer, sizeof(buffer), "%Y-%m-%d %H:%M:%S", &tm);
+    return std::string(buffer, length);
+}
+
+Clock::time_point atSecond(std::time_t second, int64_t micros = 0) {
+    return Clock::from_time_t(second) + std::chrono::microseconds(micros);
+}
+
+TEST(TimestampTest, MatchesStrftime) {
+    // Spread across years, months and times of day
+    for (std::time_t second = 0; second < 2000000000; second += 7777777) {
+        auto time = atSecond(second);
+        EXPECT_EQ(timestamp::format(time, false), strftimeSeconds(time));
+    }
+}
+
+TEST(TimestampTest, MicrosecondsArePadded) {
+    std::time_t second = 1700000000;
+    std::string prefix = strftimeSeconds(atSecond(second));
+    EXPECT_EQ(timestamp::format(atSecond(second, 0)), prefix + ".000000");
+    EXPECT_EQ(timestamp::format(atSecond(second, 7)), prefix + ".000007");
+    EXPECT_EQ(timestamp::format(atSecond(second, 45006)), prefix + ".045006");
+    EXPECT_EQ(timestamp::format(atSecond(second, 999999)), prefix + ".999999");
+}
+
+TEST(TimestampTest, CacheFollowsSecondChanges) {
+    // Alternate between two seconds so the cached prefix must be replaced
+    std::time_t first = 1700000000;
+    std::time_t second = 1700003661;
+    for (int i = 0; i < 3; ++i) {
+        EXPECT_EQ(timestamp::format(atSecond(first, 999999), false), strftimeSeconds(atSecond(first)));
+        EXPECT_EQ(timestamp::format(atSecond(first + 1), false), strftimeSeconds(atSecond(first + 1)));
+        EXPECT_EQ(timestamp::format(atSecond(second), false), strftimeSeconds(atSecond(second)));
+    }
+
+    char buffer[timestamp::MICROS_LENGTH];
+    EXPECT_EQ(timestamp::format(atSecond(first), buffer), timestamp::MICROS_LENGTH);
+    EXPECT_EQ(timestamp::format(atSecond(first), buffer, false), timestamp::SECONDS_LENGTH);
+}
+
+TEST(TimestampTest, SteadyPointMapsToWallClock) {
+    auto before = Clock::now();
+    auto mapped = timestamp::toSystem(std::chrono::steady_clock::now() - std::chrono::seconds(5));
+    auto after = Clock::now();
+    EXPECT_LE(mapped, after - std::chrono::seconds(5));
+    EXPECT_GE(mapped, before - std::chrono::seconds(6));
+}
+
+}
+}
+
+int main(int argc, char **argv) {
+    testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
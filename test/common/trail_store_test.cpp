@@ -0,0 +1,115 @@
+#include <gtest/gtest.h>
+#include "common/trail_store.h"
+#include <string>
+#include <vector>
+
+namespace atc {
+namespace test {
+
+AircraftState makeState(const std::string& callsign, double x, double y, int64_t timestamp_ms) {
+    AircraftState state;
+    state.callsign = callsign;
+    state.position = {x, y, 20000.0};
+    state.velocity = {0.0, 0.0, 0.0};
+    state.heading = 0.0;
+    state.status = AircraftStatus::CRUISING;
+    state.timestamp = static_cast<double>(timestamp_ms);
+    return state;
+}
+
+TEST(TrailStoreTest, SamplesAtInterval) {
+    TrailStore store(4, 8, 1000);
+    for (int64_t t = 0; t <= 3000; t += 250) {
+        store.update({makeState("AC1", t, 0.0, t)});
+    }
+
+    std::vector<TrailPoint> trail;
+    ASSERT_EQ(store.copyTrail("AC1", trail), 4u);
+    for (size_t i = 0; i < trail.size(); ++i) {
+        EXPECT_EQ(trail[i].timestamp_ms, static_cast<int64_t>(i) * 1000);
+    }
+}
+
+TEST(TrailStoreTest, RingKeepsNewestOldestFirst) {
+    TrailStore store(2, 4, 0);
+    for (int64_t t = 0; t < 10; ++t) {
+        store.update({makeState("AC1", t * 100.0, 0.0, t)});
+    }
+
+    std::vector<TrailPoint> trail;
+    ASSERT_EQ(store.copyTrail("AC1", trail), 4u);
+    EXPECT_EQ(trail.front().timestamp_ms, 6);
+    EXPECT_EQ(trail.back().timestamp_ms, 9);
+    EXPECT_DOUBLE_EQ(trail.back().x, 900.0);
+}
+
+TEST(TrailStoreTest, DepartedTracksReleaseSlots) {
+    TrailStore store(2, 4, 0);
+    store.update({makeState("AC1", 0, 0, 0), makeState("AC2", 0, 0, 0)});
+    store.update({makeState("AC1", 0, 0, 1), makeState("AC3", 0, 0, 1)});
+    EXPECT_EQ(store.getDroppedCount(), 1u);
+
+    // AC2 left, so AC3 gets its slot with an empty trail
+    store.update({makeState("AC1", 0, 0, 2), makeState("AC3", 5, 5, 2)});
+    std::vector<TrailPoint> trail;
+    EXPECT_EQ(store.copyTrail("AC2", trail), 0u);
+    ASSERT_EQ(store.copyTrail("AC3", trail), 1u);
+    EXPECT_DOUBLE_EQ(trail[0].x, 5.0);
+    EXPECT_EQ(store.copyTrail("AC1", trail), 3u);
+    EXPECT_EQ(store.getTrackCount(), 2u);
+}
+
+TEST(TrailStoreTest, ChurnKeepsEveryTrackFindable) {
+    // Tracks enter and leave in a shifting window, so lookups probe past
+    // buckets freed by departed tracks many times over
+    TrailStore store(16, 4, 0);
+    for (int64_t t = 0; t < 500; ++t) {
+        std::vector<AircraftState> states;
+        for (int64_t k = t / 3; k < t / 3 + 12; ++k) {
+            states.push_back(makeState("AC" + std::to_string(k * 7 % 101), k, 0, t));
+        }
+        store.update(states);
+        ASSERT_EQ(store.getTrackCount(), states.size()) << t;
+
+        std::vector<TrailPoint> trail;
+        for (const auto& state : states) {
+            ASSERT_GT(store.copyTrail(state.callsign, trail), 0u) << state.callsign;
+            EXPECT_EQ(trail.back().timestamp_ms, t);
+        }
+        EXPECT_EQ(store.copyTrail("AC" + std::to_string((t / 3 + 12) * 7 % 101), trail), 0u) << t;
+    }
+    EXPECT_EQ(store.getDroppedCount(), 0u);
+}
+
+TEST(TrailStoreTest, SmoothnessOfStraightAndTurningTracks) {
+    TrailStore store(2, 8, 0);
+    // AC1 flies straight at constant speed; AC2 turns 90 degrees once
+    const double legs[][2] = {{0, 0}, {100, 0}, {200, 0}, {200, 100}, {200, 200}};
+    for (int64_t i = 0; i < 5; ++i) {
+        store.update({makeState("AC1", i * 100.0, 0.0, i * 1000),
+                      makeState("AC2", legs[i][0], legs[i][1], i * 1000)});
+    }
+
+    TrailSmoothness straight;
+    ASSERT_TRUE(store.smoothness("AC1", straight));
+    EXPECT_EQ(straight.samples, 5u);
+    EXPECT_NEAR(straight.max_turn, 0.0, 1e-9);
+    EXPECT_NEAR(straight.rms_acceleration, 0.0, 1e-9);
+
+    TrailSmoothness turning;
+    ASSERT_TRUE(store.smoothness("AC2", turning));
+    EXPECT_NEAR(turning.max_turn, 90.0, 1e-9);
+    EXPECT_NEAR(turning.mean_turn, 30.0, 1e-9);
+    EXPECT_GT(turning.rms_acceleration, 0.0);
+
+    TrailSmoothness missing;
+    EXPECT_FALSE(store.smoothness("AC9", missing));
+}
+
+}
+}
+
+int main(int argc, char **argv) {
+    testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
@@ -0,0 +1,124 @@
+#include <gtest/gtest.h>
+#include "common/virtual_scheduler.h"
+#include "common/sim_clock.h"
+#include <string>
+#include <vector>
+
+namespace atc {
+namespace test {
+
+using std::chrono::milliseconds;
+
+std::atomic<bool> keep_running{true};
+
+class CountingTask : public PeriodicTask {
+public:
+    CountingTask(int runs_before_stop, std::vector<std::string>& trace)
+        : PeriodicTask(milliseconds(250), 10), remaining_(runs_before_stop), trace_(trace) {}
+
+protected:
+    void execute() override {
+        trace_.push_back("task@" + std::to_string(
+            std::chrono::duration_cast<milliseconds>(
+                sim_clock::systemNow().time_since_epoch()).count()));
+        if (--remaining_ == 0) {
+            stop();
+        }
+    }
+
+private:
+    int remaining_;
+    std::vector<std::string>& trace_;
+};
+
+TEST(VirtualSchedulerTest, RunsByDueTimeThenAdditionOrder) {
+    VirtualScheduler scheduler(false);
+    std::vector<std::string> trace;
+    auto record = [&trace, &scheduler](const std::string& name) {
+        trace.push_back(name + "@" + std::to_string(scheduler.now().count()));
+        return true;
+    };
+    scheduler.addPeriodic(milliseconds(0), [&] { return record("a"); }, [] { return milliseconds(30); });
+    scheduler.addPeriodic(milliseconds(0), [&] { return record("b"); }, [] { return milliseconds(20); });
+
+    EXPECT_TRUE(scheduler.runUntil(milliseconds(60), keep_running));
+    std::vector<std::string> expected = {"a@0", "b@0", "b@20", "a@30", "b@40", "a@60", "b@60"};
+    EXPECT_EQ(trace, expected);
+    EXPECT_EQ(scheduler.now().count(), 60);
+}
+
+TEST(VirtualSchedulerTest, FollowsAdaptivePeriodsAndDropsFinishedEvents) {
+    VirtualScheduler scheduler(false);
+    std::vector<int64_t> runs;
+    milliseconds period(100);
+    scheduler.addPeriodic(milliseconds(0), [&] {
+        runs.push_back(scheduler.now().count());
+        period = milliseconds(50);
+        return runs.size() < 4;
+    }, [&period] { return period; });
+
+    scheduler.runUntil(milliseconds(1000), keep_running);
+    EXPECT_EQ(runs, (std::vector<int64_t>{0, 50, 100, 150}));
+    EXPECT_TRUE(scheduler.empty());
+}
+
+TEST(VirtualSchedulerTest, DrivesPeriodicTasksOnVirtualClock) {
+    sim_clock::useVirtualTime(std::chrono::system_clock::time_point(milliseconds(5000)));
+    VirtualScheduler scheduler(false);
+    std::vector<std::string> trace;
+    auto task = std::make_shared<CountingTask>(3, trace);
+    scheduler.addTask(task);
+
+    scheduler.runUntil(milliseconds(10000), keep_running);
+    EXPECT_EQ(trace, (std::vector<std::string>{"task@5000", "task@5250", "task@5500"}));
+    EXPECT_EQ(sim_clock::steadyNow() - sim_clock::detail::steadyBase(), milliseconds(500));
+}
+
+TEST(VirtualSchedulerTest, StopsOnlyBetweenVirtualTimes) {
+    VirtualScheduler scheduler(false);
+    std::atomic<bool> running{true};
+    std::vector<int64_t> first;
+    std::vector<int64_t> second;
+    scheduler.addPeriodic(milliseconds(0), [&] {
+        first.push_back(scheduler.now().count());
+        if (scheduler.now() == milliseconds(200)) running = false;
+        return true;
+    }, [] { return milliseconds(100); });
+    scheduler.addPeriodic(milliseconds(0), [&] {
+        second.push_back(scheduler.now().count());
+        return true;
+    }, [] { return milliseconds(100); });
+
+    EXPECT_FALSE(scheduler.runUntil(milliseconds(1000), running));
+    EXPECT_EQ(first, (std::vector<int64_t>{0, 100, 200}));
+    EXPECT_EQ(second, first);
+}
+
+TEST(VirtualSchedulerTest, UnpacedRunIsFasterThanRealTime) {
+    VirtualScheduler scheduler(false);
+    int cycles = 0;
+    scheduler.addPeriodic(milliseconds(0), [&cycles] { ++cycles; return true; },
+                          [] { return milliseconds(100); });
+
+    auto start = std::chrono::steady_clock::now();
+    scheduler.runUntil(std::chrono::hours(1), keep_running);
+    EXPECT_EQ(cycles, 36001);
+    EXPECT_LT(std::chrono::steady_clock::now() - start, std::chrono::seconds(1));
+}
+
+TEST(VirtualSchedulerTest, PacedRunKeepsToWallClock) {
+    VirtualScheduler scheduler(true);
+    scheduler.addPeriodic(milliseconds(0), [] { return true; }, [] { return milliseconds(20); });
+
+    auto start = std::chrono::steady_clock::now();
+    scheduler.runUntil(milliseconds(100), keep_running);
+    EXPECT_GE(std::chrono::steady_clock::now() - start, milliseconds(100));
+}
+
+}
+}
+
+int main(int argc, char **argv) {
+    testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
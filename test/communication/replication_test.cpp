@@ -0,0 +1,188 @@
+#include <gtest/gtest.h>
+#include "communication/replication.h"
+#include <unistd.h>
+
+namespace atc {
+namespace comm {
+namespace test {
+
+std::string ringName(const std::string& suffix) {
+    return "/atc_test_replication_" + suffix + "_" + std::to_string(::getpid());
+}
+
+std::vector<AircraftState> makeStates(size_t count, int step) {
+    std::vector<AircraftState> states(count);
+    for (size_t i = 0; i < count; ++i) {
+        auto& state = states[i];
+        state.callsign = "AC" + std::to_string(1000 + i);
+        // Only even tracks move, so deltas carry half of them
+        double offset = (i % 2 == 0) ? step * 250.125 : 0.0;
+        state.position = {1000.0 + i + offset, 2000.0 + i, 20000.0};
+        state.velocity = {250.125, -10.5, 0.0};
+        state.heading = 90.0;
+        state.status = AircraftStatus::CRUISING;
+        state.timestamp = 1.7e12;
+    }
+    return states;
+}
+
+void expectSameStates(const std::vector<AircraftState>& actual, const std::vector<AircraftState>& expected) {
+    ASSERT_EQ(actual.size(), expected.size());
+    for (size_t i = 0; i < expected.size(); ++i) {
+        EXPECT_EQ(actual[i].callsign, expected[i].callsign);
+        EXPECT_EQ(actual[i].position.x, expected[i].position.x);
+        EXPECT_EQ(actual[i].position.y, expected[i].position.y);
+        EXPECT_EQ(actual[i].velocity.vx, expected[i].velocity.vx);
+        EXPECT_EQ(actual[i].status, expected[i].status);
+    }
+}
+
+// Applies everything waiting in the ring; false if any record was rejected
+bool drain(ShmRing& ring, ReplicaState& replica) {
+    bool all_applied = true;
+    std::string record;
+    while (ring.read(record, 0)) {
+        all_applied = replica.apply(record) && all_applied;
+    }
+    return all_applied;
+}
+
+TEST(ReplicationTest, StandbyFollowsDeltasAndRemovals) {
+    ShmRing ring(ringName("follow"));
+    ASSERT_TRUE(ring.create(1 << 16));
+    ReplicationWriter writer(ringName("follow"), 50, std::chrono::microseconds(1000));
+    ReplicaState replica;
+
+    auto states = makeStates(20, 0);
+    writer.appendStates(states);
+    ASSERT_TRUE(writer.isConnected());
+    ASSERT_TRUE(drain(ring, replica));
+    EXPECT_TRUE(replica.isSynchronised());
+    uint64_t key_bytes = writer.getStats().bytes;
+
+    for (int step = 1; step <= 5; ++step) {
+        states = makeStates(20, step);
+        if (step == 3) {
+            states.erase(states.begin() + 4);   // a track leaves
+        }
+        writer.appendStates(states);
+        ASSERT_TRUE(drain(ring, replica));
+        expectSameStates(replica.getStates(), states);
+    }
+    EXPECT_EQ(replica.getSequence(), 6u);
+
+    // Deltas carry only the moving half of the tracks
+    auto stats = writer.getStats();
+    EXPECT_EQ(stats.key_frames, 1u);
+    EXPECT_LT((stats.bytes - key_bytes) / 5, key_bytes * 6 / 10);
+}
+
+TEST(ReplicationTest, DroppedDeltaResynchronisesWithKeyFrame) {
+    ShmRing ring(ringName("resync"));
+    ASSERT_TRUE(ring.create(4096));
+    ReplicationWriter writer(ringName("resync"), 1000, std::chrono::microseconds(1000));
+    ReplicaState replica;
+
+    writer.appendStates(makeStates(10, 0));
+    ASSERT_TRUE(drain(ring, replica));
+
+    // The standby stalls long enough for the ring to fill
+    int step = 1;
+    while (writer.getStats().dropped == 0) {
+        writer.appendStates(makeStates(10, step++));
+    }
+    EXPECT_TRUE(drain(ring, replica));
+    EXPECT_LT(replica.getSequence(), static_cast<uint64_t>(step));
+
+    // The next delta after the gap is a key frame, so the replica catches up
+    auto latest = makeStates(9, step);
+    writer.appendStates(latest);
+    EXPECT_TRUE(drain(ring, replica));
+    EXPECT_TRUE(replica.isSynchronised());
+    expectSameStates(replica.getStates(), latest);
+    EXPECT_EQ(writer.getStats().key_frames, 2u);
+
+    // A delta whose base was never seen is rejected, not misapplied
+    ReplicaState late;
+    writer.appendStates(makeStates(9, step + 1));
+    std::string record;
+    ASSERT_TRUE(ring.read(record, 0));
+    EXPECT_FALSE(late.apply(record));
+    EXPECT_FALSE(late.isSynchronised());
+}
+
+TEST(ReplicationTest, CommandsAndAlertsAfterLastDeltaArePending) {
+    ShmRing ring(ringName("pending"));
+    ASSERT_TRUE(ring.create(1 << 16));
+    ReplicationWriter writer(ringName("pending"), 50, std::chrono::microseconds(1000));
+    ReplicaState replica;
+
+    writer.appendStates(makeStates(4, 0));
+    writer.appendAlert("Separation violation between AC1000 and AC1001");
+    CommandData command("AC1002", "ALTITUDE");
+    command.params.push_back("21000");
+    writer.appendCommand(command);
+    ASSERT_TRUE(drain(ring, replica));
+
+    ASSERT_EQ(replica.getPendingCommands().size(), 1u);
+    EXPECT_EQ(replica.getPendingCommands()[0].target_id, "AC1002");
+    EXPECT_EQ(replica.getPendingCommands()[0].command, "ALTITUDE");
+    ASSERT_EQ(replica.getPendingCommands()[0].params.size(), 1u);
+    EXPECT_EQ(replica.getPendingCommands()[0].params[0], "21000");
+    ASSERT_EQ(replica.getRecentAlerts().size(), 1u);
+
+    // The next delta includes the command's effect
+    writer.appendStates(makeStates(4, 1));
+    ASSERT_TRUE(drain(ring, replica));
+    EXPECT_TRUE(replica.getPendingCommands().empty());
+    EXPECT_TRUE(replica.getRecentAlerts().empty());
+}
+
+TEST(ReplicationTest, StandbyDetectsSilentPrimary) {
+    ShmRing ring(ringName("silent"));
+    ASSERT_TRUE(ring.create(1 << 16));
+    ReplicationWriter writer(ringName("silent"), 50, std::chrono::microseconds(1000));
+    ReplicaState replica;
+
+    auto timeout = std::chrono::milliseconds(500);
+    EXPECT_FALSE(replica.primaryLost(std::chrono::steady_clock::now() + std::chrono::hours(1), timeout));
+
+    writer.appendStates(makeStates(4, 0));
+    ASSERT_TRUE(drain(ring, replica));
+    auto now = std::chrono::steady_clock::now();
+    EXPECT_FALSE(replica.primaryLost(now, timeout));
+    EXPECT_TRUE(replica.primaryLost(now + std::chrono::milliseconds(600), timeout));
+}
+
+TEST(ReplicationTest, PrimaryCostIsBoundedWithOrWithoutStandby) {
+    // No standby: the writer only retries the ring once a second
+    ReplicationWriter orphan(ringName("none"), 50, std::chrono::microseconds(1000));
+    auto states = makeStates(500, 0);
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < 100; ++i) {
+        orphan.appendStates(states);
+    }
+    EXPECT_LT(std::chrono::steady_clock::now() - start, std::chrono::milliseconds(20));
+    EXPECT_FALSE(orphan.isConnected());
+
+    // A stalled standby: the ring fills, records drop, nothing blocks
+    ShmRing ring(ringName("cost"));
+    ASSERT_TRUE(ring.create(1 << 20));
+    ReplicationWriter writer(ringName("cost"), 50, std::chrono::microseconds(1000));
+    for (int step = 0; step < 200; ++step) {
+        writer.appendStates(makeStates(500, step));
+    }
+    auto stats = writer.getStats();
+    EXPECT_GT(stats.frames, 0u);
+    uint64_t mean_ns = stats.total_cost_ns / (stats.frames + stats.dropped);
+    EXPECT_LT(mean_ns, 1000000u) << "mean cost per record, ns";
+}
+
+}
+}
+}
+
+int main(int argc, char **argv) {
+    testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
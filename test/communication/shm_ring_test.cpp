@@ -0,0 +1,137 @@
+#include <gtest/gtest.h>
+#include "communication/shm_ring.h"
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <string>
+#include <sys/wait.h>
+#include <thread>
+#include <unistd.h>
+#include <vector>
+
+namespace atc {
+namespace comm {
+namespace test {
+
+std::string ringName(const std::string& suffix) {
+    return "/atc_test_" + suffix + "_" + std::to_string(::getpid());
+}
+
+int64_t monotonicNanos() {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+TEST(ShmRingTest, RecordsSurviveWrapAround) {
+    ShmRing writer(ringName("wrap"));
+    ASSERT_TRUE(writer.create(4096));
+    ShmRing reader(ringName("wrap"));
+    ASSERT_TRUE(reader.open());
+    EXPECT_EQ(reader.getCapacity(), 4096u);
+
+    std::string record;
+    EXPECT_FALSE(reader.read(record, 0));
+
+    // Odd sizes keep moving the wrap point; many laps of the buffer
+    for (int i = 0; i < 2000; ++i) {
+        std::string sent(static_cast<size_t>(1 + (i * 37) % 900), static_cast<char>('a' + i % 26));
+        ASSERT_TRUE(writer.write(sent.data(), sent.size())) << "record " << i;
+        ASSERT_TRUE(reader.read(record, 0));
+        ASSERT_EQ(record, sent);
+    }
+    EXPECT_EQ(writer.getDroppedCount(), 0u);
+}
+
+TEST(ShmRingTest, FullRingDropsInsteadOfBlocking) {
+    ShmRing ring(ringName("full"));
+    ASSERT_TRUE(ring.create(4096));
+
+    std::string big(ring.getMaxRecordSize() + 1, 'x');
+    EXPECT_FALSE(ring.write(big.data(), big.size()));
+
+    std::string record(1000, 'r');
+    int written = 0;
+    auto start = std::chrono::steady_clock::now();
+    while (ring.write(record.data(), record.size())) {
+        ++written;
+    }
+    EXPECT_LT(std::chrono::steady_clock::now() - start, std::chrono::milliseconds(10));
+    EXPECT_EQ(written, 4);
+    EXPECT_EQ(ring.getDroppedCount(), 2u);
+
+    // Draining one record makes room again
+    std::string out;
+    ASSERT_TRUE(ring.read(out, 0));
+    EXPECT_TRUE(ring.write(record.data(), record.size()));
+}
+
+TEST(ShmRingTest, OpenNeedsAnExistingRing) {
+    ShmRing missing(ringName("missing"));
+    EXPECT_FALSE(missing.open());
+    EXPECT_FALSE(missing.write("x", 1));
+
+    {
+        ShmRing owner(ringName("owned"));
+        ASSERT_TRUE(owner.create(8192));
+    }
+    // The creator unlinks the segment when it goes away
+    ShmRing late(ringName("owned"));
+    EXPECT_FALSE(late.open());
+}
+
+TEST(ShmRingTest, CrossProcessHandoffMedianStaysUnder100Microseconds) {
+    constexpr int RECORDS = 2000;
+    const std::string request_name = ringName("latency");
+    const std::string result_name = ringName("latency_results");
+    ShmRing requests(request_name);
+    ShmRing results(result_name);
+    ASSERT_TRUE(requests.create(1 << 16));
+    ASSERT_TRUE(results.create(1 << 16));
+
+    pid_t child = ::fork();
+    ASSERT_GE(child, 0);
+    if (child == 0) {
+        // Reader process: one-way latency of every record, measured against the shared monotonic clock
+        ShmRing in(request_name);
+        ShmRing out(result_name);
+        if (!in.open() || !out.open()) ::_exit(1);
+        std::vector<int64_t> latencies;
+        std::string record;
+        while (latencies.size() < RECORDS && in.read(record, 5000000)) {
+            int64_t sent;
+            std::memcpy(&sent, record.data(), sizeof(sent));
+            latencies.push_back(monotonicNanos() - sent);
+        }
+        out.write(latencies.data(), latencies.size() * sizeof(int64_t));
+        ::_exit(0);
+    }
+
+    // Spaced out so the reader goes to sleep between records and the wakeup path is measured too
+    for (int i = 0; i < RECORDS; ++i) {
+        std::string record(64, '\0');
+        int64_t now = monotonicNanos();
+        std::memcpy(&record[0], &now, sizeof(now));
+        ASSERT_TRUE(requests.write(record.data(), record.size()));
+        std::this_thread::sleep_for(std::chrono::microseconds(i % 2 ? 20 : 200));
+    }
+
+    std::string reply;
+    ASSERT_TRUE(results.read(reply, 5000000));
+    int status;
+    ::waitpid(child, &status, 0);
+    ASSERT_EQ(reply.size(), RECORDS * sizeof(int64_t));
+
+    std::vector<int64_t> latencies(RECORDS);
+    std::memcpy(latencies.data(), reply.data(), reply.size());
+    std::sort(latencies.begin(), latencies.end());
+    EXPECT_LT(latencies[RECORDS / 2], 100000) << "median handoff latency, ns";
+}
+
+}
+}
+}
+
+int main(int argc, char **argv) {
+    testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
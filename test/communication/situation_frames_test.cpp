@@ -0,0 +1,81 @@
+#include <gtest/gtest.h>
+#include "communication/situation_frames.h"
+
+namespace atc {
+namespace comm {
+namespace test {
+
+AircraftState makeState(const std::string& callsign, double x, AircraftStatus status) {
+    AircraftState state;
+    state.callsign = callsign;
+    state.position = {x, 20000.5, 31000.25};
+    state.velocity = {-250.125, 10.0, 0.5};
+    state.heading = 177.7;
+    state.status = status;
+    state.timestamp = 1.7e12 + x;
+    return state;
+}
+
+TEST(SituationFramesTest, TrackStatesRoundTripAtFullPrecision) {
+    std::vector<AircraftState> states = {
+        makeState("AC001", 1.0 / 3.0, AircraftStatus::CRUISING),
+        makeState("AC002", 99999.875, AircraftStatus::EMERGENCY),
+    };
+    std::string frame;
+    encodeTrackStates(states, frame);
+
+    FrameKind kind;
+    ASSERT_TRUE(frameKind(frame, kind));
+    EXPECT_EQ(kind, FrameKind::TRACK_STATES);
+
+    std::vector<AircraftState> decoded;
+    ASSERT_TRUE(decodeTrackStates(frame, decoded));
+    ASSERT_EQ(decoded.size(), states.size());
+    for (size_t i = 0; i < states.size(); ++i) {
+        EXPECT_EQ(decoded[i].callsign, states[i].callsign);
+        EXPECT_EQ(decoded[i].position.x, states[i].position.x);
+        EXPECT_EQ(decoded[i].position.z, states[i].position.z);
+        EXPECT_EQ(decoded[i].velocity.vx, states[i].velocity.vx);
+        EXPECT_EQ(decoded[i].heading, states[i].heading);
+        EXPECT_EQ(decoded[i].status, states[i].status);
+        EXPECT_EQ(decoded[i].timestamp, states[i].timestamp);
+    }
+
+    // Truncated frames are rejected rather than read past the end, at every length
+    std::vector<AircraftState> partial;
+    for (size_t length = 0; length < frame.size(); ++length) {
+        EXPECT_FALSE(decodeTrackStates(frame.substr(0, length), partial)) << length;
+    }
+    // So is a count the frame cannot hold; the count follows the kind byte
+    std::string inflated = frame;
+    uint32_t count = 0x40000000;
+    inflated.replace(1, sizeof(count), reinterpret_cast<const char*>(&count), sizeof(count));
+    EXPECT_FALSE(decodeTrackStates(inflated, partial));
+    std::string text;
+    EXPECT_FALSE(decodeAlert(frame, text));
+}
+
+TEST(SituationFramesTest, AlertsCarryTheirText) {
+    std::string frame;
+    encodeAlert("Separation violation between AC001 and AC002", frame);
+
+    FrameKind kind;
+    ASSERT_TRUE(frameKind(frame, kind));
+    EXPECT_EQ(kind, FrameKind::ALERT);
+    std::string text;
+    ASSERT_TRUE(decodeAlert(frame, text));
+    EXPECT_EQ(text, "Separation violation between AC001 and AC002");
+
+    std::vector<AircraftState> states;
+    EXPECT_FALSE(decodeTrackStates(frame, states));
+    EXPECT_FALSE(frameKind(std::string(1, '\x7f'), kind));
+}
+
+}
+}
+}
+
+int main(int argc, char **argv) {
+    testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
@@ -0,0 +1,135 @@
+#include <gtest/gtest.h>
+#include "core/aircraft_registry.h"
+#include <algorithm>
+#include <chrono>
+#include <thread>
+#include <string>
+#include <vector>
+
+namespace atc {
+namespace test {
+
+std::shared_ptr<Aircraft> makeAircraft(const std::string& callsign, double x = 1000.0) {
+    return std::make_shared<Aircraft>(callsign, Position{x, 20000.0, 20000.0},
+                                      Velocity{250.0, 0.0, 0.0});
+}
+
+class AircraftRegistryTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        // Aircraft construction logs its initial state
+        Logger::setLevel(LogLevel::ERROR);
+    }
+};
+
+TEST_F(AircraftRegistryTest, AddsFindsAndRejectsDuplicates) {
+    AircraftRegistry registry;
+    auto first = makeAircraft("AC001");
+    EXPECT_TRUE(registry.add(first));
+    EXPECT_TRUE(registry.add(makeAircraft("AC002")));
+    EXPECT_FALSE(registry.add(makeAircraft("AC001")));
+
+    EXPECT_EQ(registry.size(), 2u);
+    EXPECT_EQ(registry.find("AC001"), first);
+    EXPECT_EQ(registry.find("AC999"), nullptr);
+    EXPECT_TRUE(registry.contains("AC002"));
+}
+
+TEST_F(AircraftRegistryTest, RemovalMovesLastAircraftIntoGap) {
+    AircraftRegistry registry;
+    for (int i = 1; i <= 4; ++i) {
+        registry.add(makeAircraft("AC00" + std::to_string(i)));
+    }
+
+    auto removed = registry.remove("AC002");
+    ASSERT_NE(removed, nullptr);
+    EXPECT_EQ(removed->getCallsign(), "AC002");
+    EXPECT_EQ(registry.remove("AC002"), nullptr);
+
+    std::vector<std::string> order;
+    for (const auto& aircraft : registry) {
+        order.push_back(aircraft->getCallsign());
+    }
+    EXPECT_EQ(order, (std::vector<std::string>{"AC001", "AC004", "AC003"}));
+
+    // The moved aircraft is still found at its new slot, and the last one removes cleanly
+    EXPECT_EQ(registry.find("AC004"), registry[1]);
+    EXPECT_NE(registry.remove("AC003"), nullptr);
+    EXPECT_NE(registry.remove("AC001"), nullptr);
+    EXPECT_EQ(registry.size(), 1u);
+    EXPECT_EQ(registry[0]->getCallsign(), "AC004");
+}
+
+TEST_F(AircraftRegistryTest, ThreadedAircraftFlyingOutIsRetired) {
+    AircraftRegistry registry;
+    auto leaving = std::make_shared<Aircraft>("AC001", Position{99990.0, 20000.0, 20000.0},
+                                              Velocity{250.0, 0.0, 0.0});
+    registry.add(leaving);
+    registry.add(makeAircraft("AC002"));
+    leaving->start();
+
+    // Its own thread finds it outside the airspace and stops the task
+    auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(10);
+    auto flying = [&leaving] {
+        auto status = leaving->getState().status;
+        return status == AircraftStatus::ENTERING || status == AircraftStatus::CRUISING;
+    };
+    while (flying() && std::chrono::steady_clock::now() < deadline) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    }
+    ASSERT_EQ(leaving->getState().status, AircraftStatus::EXITING);
+
+    // Retired as the system does each tick: exiting aircraft leave the registry
+    std::vector<std::string> exiting;
+    for (const auto& aircraft : registry) {
+        if (aircraft->getState().status == AircraftStatus::EXITING) {
+            exiting.push_back(aircraft->getCallsign());
+        }
+    }
+    ASSERT_EQ(exiting, std::vector<std::string>{"AC001"});
+    auto removed = registry.remove("AC001");
+    ASSERT_EQ(removed, leaving);
+    removed->stop();
+    EXPECT_EQ(registry.size(), 1u);
+    EXPECT_FALSE(registry.contains("AC001"));
+}
+
+TEST_F(AircraftRegistryTest, ChurnMovesOnlyTheLastAircraft) {
+    // Steady churn through a large population: one leaves, one enters. Each
+    // exit fills its slot with the last aircraft and leaves the rest in place,
+    // so its cost does not depend on the population.
+    const size_t population = 1000;
+    AircraftRegistry registry;
+    std::vector<std::shared_ptr<Aircraft>> spare;
+    for (size_t i = 0; i < population + 200; ++i) {
+        spare.push_back(makeAircraft("AC" + std::to_string(i), 1000.0 + i % 1000));
+    }
+    for (size_t i = 0; i < population; ++i) {
+        registry.add(spare[i]);
+    }
+
+    for (size_t i = 0; i < 200; ++i) {
+        std::vector<std::shared_ptr<Aircraft>> before(registry.begin(), registry.end());
+        size_t gap = std::find(before.begin(), before.end(), spare[i]) - before.begin();
+        ASSERT_LT(gap, before.size());
+
+        registry.remove(spare[i]->getCallsign());
+        ASSERT_EQ(registry.size(), population - 1);
+        for (size_t k = 0; k + 1 < population; ++k) {
+            ASSERT_EQ(registry[k], k == gap ? before.back() : before[k]) << "exit " << i << ", slot " << k;
+        }
+        EXPECT_EQ(registry.find(before.back()->getCallsign()), before.back());
+
+        registry.add(spare[population + i]);
+        EXPECT_EQ(registry[population - 1], spare[population + i]);
+    }
+    EXPECT_EQ(registry.size(), population);
+}
+
+}
+}
+
+int main(int argc, char **argv) {
+    testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
@@ -0,0 +1,151 @@
+#include <gtest/gtest.h>
+#include "core/arrival_sequencer.h"
+#include "common/constants.h"
+#include <chrono>
+#include <random>
+
+namespace atc {
+namespace test {
+
+constexpr double T0 = 1000.0;
+const Position RUNWAY{50000.0, 50000.0, 15000.0};
+
+class ArrivalSequencerTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        fixes_ = std::make_shared<FixDatabase>();
+    }
+
+    // Flies straight along the x axis to the runway fix, over it `distance / speed` after T0
+    bool inbound(const std::string& callsign, double distance, double speed, WakeCategory wake,
+                 const Position& destination = RUNWAY) {
+        Route route;
+        route.fixes = fixes_;
+        route.cruise_speed = speed;
+        route.wake = wake;
+        route.waypoints.push_back(fixes_->intern(destination));
+
+        AircraftState state{};
+        state.callsign = callsign;
+        state.position = {destination.x - distance, destination.y, 15000.0};
+        state.velocity = {speed, 0.0, 0.0};
+        state.timestamp = T0 * 1000.0;
+        RouteProgress progress;
+        progress.route = std::make_shared<Route>(route);
+        auto trajectory = std::make_shared<const Trajectory>(Trajectory::alongRoute(state, progress));
+        return sequencer_.update(callsign, route, trajectory);
+    }
+
+    std::vector<std::string> order() const {
+        std::vector<std::string> callsigns;
+        for (const auto& slot : sequencer_.sequence()) {
+            callsigns.push_back(slot.callsign);
+        }
+        return callsigns;
+    }
+
+    std::shared_ptr<FixDatabase> fixes_;
+    ArrivalSequencer sequencer_{RUNWAY};
+};
+
+TEST_F(ArrivalSequencerTest, SpacesFollowersByWakeCategory) {
+    inbound("HVY1", 25000.0, 250.0, WakeCategory::HEAVY);   // +100 s
+    inbound("LGT1", 50000.0, 250.0, WakeCategory::LIGHT);   // +200 s, too late to gain by going first
+    sequencer_.resequence(T0);
+
+    const auto& sequence = sequencer_.sequence();
+    ASSERT_EQ(sequence.size(), 2u);
+    EXPECT_DOUBLE_EQ(sequence[0].eta, T0 + 100.0);
+    EXPECT_DOUBLE_EQ(sequence[0].scheduled, T0 + 100.0);
+    EXPECT_DOUBLE_EQ(sequence[1].scheduled,
+                     T0 + 100.0 + ArrivalSequencer::spacing(WakeCategory::HEAVY, WakeCategory::LIGHT));
+}
+
+TEST_F(ArrivalSequencerTest, ShiftsOnePlaceWhenThatCutsDelay) {
+    // A light behind a medium needs twice the spacing a medium behind a light does
+    inbound("LGT1", 25000.0, 250.0, WakeCategory::LIGHT);    // over the fix at +100 s
+    inbound("MED1", 27500.0, 250.0, WakeCategory::MEDIUM);   // +110 s
+    inbound("LGT2", 30000.0, 250.0, WakeCategory::LIGHT);    // +120 s
+    sequencer_.resequence(T0);
+
+    EXPECT_EQ(order(), (std::vector<std::string>{"LGT1", "LGT2", "MED1"}));
+    EXPECT_DOUBLE_EQ(sequencer_.sequence()[1].scheduled, T0 + 160.0);
+    EXPECT_DOUBLE_EQ(sequencer_.sequence()[2].scheduled, T0 + 220.0);
+}
+
+TEST_F(ArrivalSequencerTest, AdvisesSpeedOrHold) {
+    inbound("MED1", 25000.0, 250.0, WakeCategory::MEDIUM);   // +100 s
+    inbound("MED2", 27500.0, 250.0, WakeCategory::MEDIUM);   // +110 s, slotted at +160 s
+    inbound("MED3", 27750.0, 250.0, WakeCategory::MEDIUM);   // +111 s, slotted at +220 s
+    auto changed = sequencer_.resequence(T0);
+
+    ASSERT_EQ(changed.size(), 2u);
+    EXPECT_EQ(changed[0].callsign, "MED2");
+    EXPECT_EQ(changed[0].advised_speed, std::floor(250.0 * 110.0 / 160.0));
+    EXPECT_FALSE(changed[0].hold);
+    EXPECT_EQ(changed[1].callsign, "MED3");
+    EXPECT_TRUE(changed[1].hold);
+
+    // Nothing new to advise on an unchanged picture
+    EXPECT_TRUE(sequencer_.resequence(T0 + 5.0).empty());
+}
+
+TEST_F(ArrivalSequencerTest, KeepsSlotsNearLandingFrozen) {
+    inbound("MED1", 25000.0, 250.0, WakeCategory::MEDIUM);   // +100 s, inside the freeze time
+    sequencer_.resequence(T0);
+
+    // An earlier ETA no longer takes the frozen aircraft's place
+    inbound("LGT1", 22500.0, 250.0, WakeCategory::LIGHT);    // +90 s
+    sequencer_.resequence(T0 + 5.0);
+    EXPECT_EQ(order(), (std::vector<std::string>{"MED1", "LGT1"}));
+}
+
+TEST_F(ArrivalSequencerTest, IgnoresOtherDestinationsAndLandedAircraft) {
+    EXPECT_FALSE(inbound("DEP1", 10000.0, 250.0, WakeCategory::MEDIUM, {90000.0, 50000.0, 20000.0}));
+    EXPECT_TRUE(inbound("MED1", 25000.0, 250.0, WakeCategory::MEDIUM));
+    sequencer_.resequence(T0);
+    EXPECT_EQ(sequencer_.sequence().size(), 1u);
+
+    sequencer_.resequence(T0 + 101.0);
+    EXPECT_TRUE(sequencer_.sequence().empty());
+}
+
+TEST_F(ArrivalSequencerTest, ResequencesManyInboundQuickly) {
+    std::mt19937 rng(3);
+    std::uniform_real_distribution<double> distance(20000.0, 49000.0);
+    std::uniform_int_distribution<int> wake(0, 3);
+    for (int i = 0; i < 150; ++i) {
+        inbound("AC" + std::to_string(i), distance(rng), 250.0, static_cast<WakeCategory>(wake(rng)));
+    }
+    sequencer_.resequence(T0);
+
+    // A few new trajectories, then a full pass, as every few seconds in service
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < 10; ++i) {
+        inbound("AC" + std::to_string(i * 7), distance(rng), 250.0, static_cast<WakeCategory>(wake(rng)));
+    }
+    sequencer_.resequence(T0 + 5.0);
+    auto elapsed = std::chrono::steady_clock::now() - start;
+    std::cout << "Re-sequenced 150 inbound in "
+              << std::chrono::duration<double, std::micro>(elapsed).count() << " us" << std::endl;
+    EXPECT_LT(elapsed, std::chrono::milliseconds(10));
+
+    // Slots respect wake spacing and never come before the ETA
+    const auto& sequence = sequencer_.sequence();
+    ASSERT_EQ(sequence.size(), 150u);
+    for (size_t i = 0; i < sequence.size(); ++i) {
+        EXPECT_GE(sequence[i].scheduled, sequence[i].eta);
+        if (i > 0) {
+            EXPECT_GE(sequence[i].scheduled - sequence[i - 1].scheduled + 1e-9,
+                      ArrivalSequencer::spacing(sequence[i - 1].wake, sequence[i].wake));
+        }
+    }
+}
+
+}
+}
+
+int main(int argc, char **argv) {
+    testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
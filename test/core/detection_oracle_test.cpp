@@ -0,0 +1,526 @@
+#include <gtest/gtest.h>
+#include "core/reference_detector.h"
+#include "core/violation_detector.h"
+#include "core/aircraft.h"
+#include "common/conflict_log.h"
+#include "common/constants.h"
+#include "common/metrics.h"
+#include "common/sim_clock.h"
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <functional>
+#include <limits>
+#include <map>
+#include <random>
+#include <sstream>
+
+namespace atc {
+namespace test {
+
+using PairConflict = ViolationDetector::PairConflict;
+using Prediction = ViolationDetector::ViolationPrediction;
+
+constexpr double NOW = 1700000000.0;   // virtual time, seconds
+
+struct Scenario {
+    std::vector<std::shared_ptr<Aircraft>> aircraft;
+    int lookahead = constants::DEFAULT_LOOKAHEAD_TIME;
+};
+
+// A detector that must find what the reference finds, given a scenario at NOW.
+// Faster detectors are added to the list below.
+struct Candidate {
+    const char* name;
+    std::function<std::vector<PairConflict>(const Scenario&)> findConflicts;
+};
+
+std::vector<Candidate> candidates() {
+    return {
+        {"ViolationDetector", [](const Scenario& scenario) {
+            ViolationDetector detector;
+            detector.setLookaheadTime(scenario.lookahead);
+            detector.addAircraft(scenario.aircraft);
+            return detector.findConflicts();
+        }},
+        {"ViolationDetector (kinetic)", [](const Scenario& scenario) {
+            ViolationDetector detector;
+            detector.setKinetic(true);
+            detector.setLookaheadTime(scenario.lookahead);
+            detector.addAircraft(scenario.aircraft);
+            return detector.findConflicts();
+        }},
+    };
+}
+
+// Equal to within rounding, relative to the size of the values
+bool near(double a, double b) {
+    return std::abs(a - b) <= 1e-9 * std::max({1.0, std::abs(a), std::abs(b)}) + 1e-6;
+}
+
+std::pair<std::string, std::string> pairOf(const std::string& a, const std::string& b) {
+    return a < b ? std::make_pair(a, b) : std::make_pair(b, a);
+}
+
+template <typename T>
+std::string describe(const T& values) {
+    std::ostringstream oss;
+    for (double value : values) oss << " " << value;
+    return oss.str();
+}
+
+void expectSamePrediction(const Prediction& expected, const Prediction& actual) {
+    EXPECT_TRUE(near(expected.time_to_violation, actual.time_to_violation) &&
+                near(expected.min_separation, actual.min_separation) &&
+                near(expected.conflict_point.x, actual.conflict_point.x) &&
+                near(expected.conflict_point.y, actual.conflict_point.y) &&
+                near(expected.conflict_point.z, actual.conflict_point.z))
+        << expected.aircraft1_id << "/" << expected.aircraft2_id << " time, distance, point: expected"
+        << describe(std::vector<double>{expected.time_to_violation, expected.min_separation,
+                                        expected.conflict_point.x, expected.conflict_point.y,
+                                        expected.conflict_point.z})
+        << ", got"
+        << describe(std::vector<double>{actual.time_to_violation, actual.min_separation,
+                                        actual.conflict_point.x, actual.conflict_point.y,
+                                        actual.conflict_point.z});
+}
+
+void expectSameConflicts(const std::vector<PairConflict>& expected, const std::vector<PairConflict>& actual) {
+    auto index = [](const std::vector<PairConflict>& conflicts) {
+        std::map<std::pair<std::string, std::string>, const PairConflict*> pairs;
+        for (const auto& conflict : conflicts) {
+            const auto& ids = conflict.kind == ConflictKind::VIOLATION
+                ? pairOf(conflict.violation.aircraft1_id, conflict.violation.aircraft2_id)
+                : pairOf(conflict.prediction.aircraft1_id, conflict.prediction.aircraft2_id);
+            EXPECT_TRUE(pairs.emplace(ids, &conflict).second) << "pair reported twice";
+        }
+        return pairs;
+    };
+    auto expected_pairs = index(expected);
+    auto actual_pairs = index(actual);
+
+    for (const auto& [ids, want] : expected_pairs) {
+        auto it = actual_pairs.find(ids);
+        if (it == actual_pairs.end()) {
+            ADD_FAILURE() << "missed " << ids.first << "/" << ids.second << " ("
+                          << history::conflictKindName(want->kind) << ", separation "
+                          << want->horizontal_separation << " x " << want->vertical_separation << ")";
+            continue;
+        }
+        const PairConflict& got = *it->second;
+        EXPECT_EQ(want->kind, got.kind) << ids.first << "/" << ids.second;
+        EXPECT_TRUE(near(want->horizontal_separation, got.horizontal_separation) &&
+                    near(want->vertical_separation, got.vertical_separation))
+            << ids.first << "/" << ids.second;
+        if (want->kind != got.kind) continue;
+        if (want->kind == ConflictKind::VIOLATION) {
+            EXPECT_EQ(want->violation.timestamp, got.violation.timestamp);
+            EXPECT_FALSE(got.violation.is_predicted);
+        } else {
+            expectSamePrediction(want->prediction, got.prediction);
+        }
+    }
+    for (const auto& [ids, got] : actual_pairs) {
+        if (!expected_pairs.count(ids)) {
+            ADD_FAILURE() << "spurious " << ids.first << "/" << ids.second << " ("
+                          << history::conflictKindName(got->kind) << ", separation "
+                          << got->horizontal_separation << " x " << got->vertical_separation << ")";
+        }
+    }
+}
+
+// Every candidate and every ViolationDetector query against the reference
+void expectMatchesReference(const Scenario& scenario) {
+    auto flights = reference::snapshot(scenario.aircraft);
+    auto expected = reference::findConflicts(flights, NOW, scenario.lookahead);
+    for (const auto& candidate : candidates()) {
+        SCOPED_TRACE(candidate.name);
+        expectSameConflicts(expected, candidate.findConflicts(scenario));
+    }
+
+    ViolationDetector detector;
+    detector.setLookaheadTime(scenario.lookahead);
+    detector.addAircraft(scenario.aircraft);
+
+    auto current = detector.getCurrentViolations();
+    auto expected_current = reference::currentViolations(flights);
+    ASSERT_EQ(current.size(), expected_current.size());
+    for (size_t i = 0; i < current.size(); ++i) {
+        EXPECT_EQ(pairOf(current[i].aircraft1_id, current[i].aircraft2_id),
+                  pairOf(expected_current[i].aircraft1_id, expected_current[i].aircraft2_id));
+        EXPECT_TRUE(near(current[i].horizontal_separation, expected_current[i].horizontal_separation));
+        EXPECT_EQ(current[i].vertical_separation, expected_current[i].vertical_separation);
+    }
+
+    auto predictions = detector.getPredictedViolations();
+    auto expected_predictions = reference::predictedViolations(flights, NOW, scenario.lookahead);
+    ASSERT_EQ(predictions.size(), expected_predictions.size());
+    std::map<std::pair<std::string, std::string>, const Prediction*> by_pair;
+    for (const auto& prediction : predictions) {
+        by_pair[pairOf(prediction.aircraft1_id, prediction.aircraft2_id)] = &prediction;
+    }
+    for (const auto& want : expected_predictions) {
+        auto it = by_pair.find(pairOf(want.aircraft1_id, want.aircraft2_id));
+        ASSERT_NE(it, by_pair.end()) << "missed prediction " << want.aircraft1_id << "/" << want.aircraft2_id;
+        expectSamePrediction(want, *it->second);
+    }
+    EXPECT_TRUE(std::is_sorted(predictions.begin(), predictions.end(), [](const Prediction& a, const Prediction& b) {
+        return std::tie(a.time_to_violation, a.aircraft1_id, a.aircraft2_id) <
+               std::tie(b.time_to_violation, b.aircraft1_id, b.aircraft2_id);
+    }));
+}
+
+// Everything the detector's queries return, every double to the last bit
+std::string transcript(const ViolationDetector& detector) {
+    std::ostringstream oss;
+    oss << std::hexfloat;
+    auto prediction = [&oss](const Prediction& p) {
+        oss << p.aircraft1_id << " " << p.aircraft2_id << " " << p.time_to_violation << " " << p.min_separation
+            << " " << p.conflict_point.x << " " << p.conflict_point.y << " " << p.conflict_point.z;
+        for (const auto& option : p.resolution_options) oss << " | " << option;
+        oss << "\n";
+    };
+    auto violation = [&oss](const ViolationInfo& v) {
+        oss << v.aircraft1_id << " " << v.aircraft2_id << " " << v.horizontal_separation << " "
+            << v.vertical_separation << " " << v.timestamp << "\n";
+    };
+    for (const auto& conflict : detector.findConflicts()) {
+        oss << history::conflictKindName(conflict.kind) << " " << conflict.horizontal_separation << " "
+            << conflict.vertical_separation << ": ";
+        if (conflict.kind == ConflictKind::VIOLATION) {
+            violation(conflict.violation);
+        } else {
+            prediction(conflict.prediction);
+        }
+    }
+    oss << "current\n";
+    for (const auto& v : detector.getCurrentViolations()) violation(v);
+    oss << "predicted\n";
+    for (const auto& p : detector.getPredictedViolations()) prediction(p);
+    return oss.str();
+}
+
+// The conflict records in a directory, one line each in the order written;
+// the detector raises an alert with each
+std::string conflictLogTranscript(const std::string& directory, size_t& records) {
+    std::ostringstream oss;
+    oss << std::hexfloat;
+    history::readConflicts(directory, std::numeric_limits<int64_t>::min(), std::numeric_limits<int64_t>::max(), 64,
+        [&](const ConflictRecord* record, size_t count) {
+            for (const ConflictRecord* end = record + count; record != end; ++record) {
+                oss << history::conflictKindName(static_cast<ConflictKind>(record->kind)) << " "
+                    << record->getAircraft1() << " " << record->getAircraft2() << " " << record->timestamp_ms << " "
+                    << record->horizontal_separation << " " << record->vertical_separation << " "
+                    << record->time_to_violation << " " << record->min_separation << " " << record->x << " "
+                    << record->y << " " << record->z << "\n";
+            }
+            records += count;
+            return true;
+        });
+    return oss.str();
+}
+
+class DetectionOracleTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        Logger::setLevel(LogLevel::ERROR);
+        sim_clock::useVirtualTime(std::chrono::system_clock::time_point(
+            std::chrono::seconds(static_cast<int64_t>(NOW))));
+        fixes_ = std::make_shared<FixDatabase>();
+    }
+
+    // An aircraft whose last report is `age` seconds old
+    std::shared_ptr<Aircraft> add(Scenario& scenario, const Position& position, const Velocity& velocity,
+                                  double age = 0.0) {
+        auto aircraft = std::make_shared<Aircraft>("AC" + std::to_string(scenario.aircraft.size() + 100),
+                                                   Position{50000, 50000, 20000}, Velocity{250, 0, 0});
+        AircraftState state = aircraft->getState();
+        state.position = position;
+        state.velocity = velocity;
+        state.updateHeading();
+        state.timestamp = (NOW - age) * 1000.0;
+        aircraft->setState(state);
+        scenario.aircraft.push_back(aircraft);
+        return aircraft;
+    }
+
+    // Puts the aircraft on a route through these fixes, keeping its state
+    void route(const std::shared_ptr<Aircraft>& aircraft, const std::vector<Position>& waypoints, double speed) {
+        auto route = std::make_shared<Route>();
+        route->fixes = fixes_;
+        route->cruise_speed = speed;
+        for (const auto& waypoint : waypoints) {
+            route->waypoints.push_back(fixes_->intern(waypoint));
+        }
+        AircraftState state = aircraft->getState();
+        aircraft->setRoute(route);
+        aircraft->setState(state);
+    }
+
+    // Traffic in a box of random size, so some scenarios are crowded. Levels
+    // are often shared and speeds, headings and report ages vary; a quarter
+    // of the aircraft fly routes with turns and level changes.
+    // A quarter of the aircraft fly routes if `routes` is set
+    Scenario randomScenario(std::mt19937& rng, bool routes = true) {
+        auto uniform = [&rng](double low, double high) {
+            return std::uniform_real_distribution<double>(low, high)(rng);
+        };
+        Scenario scenario;
+        const int lookaheads[] = {30, 60, 120, 180, 300};
+        scenario.lookahead = lookaheads[rng() % 5];
+
+        size_t count = 2 + rng() % 59;
+        double size = uniform(5000.0, 100000.0);
+        double x0 = uniform(0.0, 100000.0 - size);
+        double y0 = uniform(0.0, 100000.0 - size);
+        for (size_t i = 0; i < count; ++i) {
+            Position position{x0 + uniform(0.0, size), y0 + uniform(0.0, size),
+                              rng() % 2 ? 15000.0 + 1000.0 * (rng() % 11) : uniform(15000.0, 25000.0)};
+            double speed = rng() % 8 ? uniform(constants::MIN_SPEED, constants::MAX_SPEED) : 0.0;
+            double heading = uniform(0.0, 2.0 * M_PI);
+            Velocity velocity{speed * std::cos(heading), speed * std::sin(heading),
+                              rng() % 4 ? 0.0 : uniform(-30.0, 30.0)};
+            auto aircraft = add(scenario, position, velocity, uniform(0.0, 2.0));
+
+            if (routes && rng() % 4 == 0) {
+                std::vector<Position> waypoints;
+                for (size_t fix = 1 + rng() % 4; fix > 0; --fix) {
+                    waypoints.push_back({uniform(0.0, 100000.0), uniform(0.0, 100000.0),
+                                         15000.0 + 1000.0 * (rng() % 11)});
+                }
+                route(aircraft, waypoints, uniform(constants::MIN_SPEED, constants::MAX_SPEED));
+            }
+        }
+        return scenario;
+    }
+
+    std::shared_ptr<FixDatabase> fixes_;
+};
+
+TEST_F(DetectionOracleTest, ReferenceMatchesHandWorkedPairs) {
+    // Pairs are 2000 or more apart vertically from each other, out of warning range
+    Scenario scenario;
+    scenario.lookahead = 60;
+    // Level and 2000 apart: a violation
+    add(scenario, {10000, 10000, 20000}, {0, 0, 0});
+    add(scenario, {12000, 10000, 20000}, {0, 0, 0});
+    // 4000 apart and 1500 above each other, head-on at 200 units/s: they pass in 20 s
+    add(scenario, {10000, 50000, 15000}, {100, 0, 0});
+    add(scenario, {14000, 50000, 16500}, {-100, 0, 0});
+    // As close but diverging: closest now
+    add(scenario, {10000, 80000, 22500}, {-100, 0, 0});
+    add(scenario, {14000, 80000, 24000}, {100, 0, 0});
+    auto flights = reference::snapshot(scenario.aircraft);
+
+    auto conflicts = reference::findConflicts(flights, NOW, scenario.lookahead);
+    ASSERT_EQ(conflicts.size(), 3u);
+    EXPECT_EQ(conflicts[0].kind, ConflictKind::VIOLATION);
+    EXPECT_EQ(conflicts[0].violation.horizontal_separation, 2000.0);
+    EXPECT_EQ(conflicts[0].violation.vertical_separation, 0.0);
+
+    EXPECT_EQ(conflicts[1].kind, ConflictKind::CRITICAL_WARNING);
+    EXPECT_DOUBLE_EQ(conflicts[1].prediction.time_to_violation, 20.0);
+    EXPECT_DOUBLE_EQ(conflicts[1].prediction.min_separation, 0.0);
+    EXPECT_DOUBLE_EQ(conflicts[1].prediction.conflict_point.x, 12000.0);
+    EXPECT_DOUBLE_EQ(conflicts[1].prediction.conflict_point.z, 15750.0);
+
+    EXPECT_EQ(conflicts[2].kind, ConflictKind::CRITICAL_WARNING);
+    EXPECT_EQ(conflicts[2].prediction.time_to_violation, 0.0);
+    EXPECT_DOUBLE_EQ(conflicts[2].prediction.min_separation, 4000.0);
+
+    EXPECT_EQ(reference::currentViolations(flights).size(), 1u);
+    // The level pair is predicted too; the diverging one stays 4000 apart, inside 6000
+    EXPECT_EQ(reference::predictedViolations(flights, NOW, scenario.lookahead).size(), 3u);
+
+    expectMatchesReference(scenario);
+}
+
+TEST_F(DetectionOracleTest, BoundaryGeometriesMatch) {
+    const double h = constants::MIN_HORIZONTAL_SEPARATION;
+    const double v = constants::MIN_VERTICAL_SEPARATION;
+    Scenario scenario;
+    scenario.lookahead = 60;
+    double y = 2000;
+    auto pair = [&](const Position& offset, const Velocity& first, const Velocity& second) {
+        add(scenario, {20000, y, 18000}, first);
+        add(scenario, {20000 + offset.x, y + offset.y, 18000 + offset.z}, second);
+        y += 2.5 * h;
+    };
+    pair({h, 0, 0.5 * v}, {0, 0, 0}, {0, 0, 0});                   // exactly the minimum apart
+    pair({0.6 * h, 0.8 * h, 0.5 * v}, {0, 0, 0}, {0, 0, 0});       // the same along a diagonal
+    pair({std::nextafter(h, 0.0), 0, std::nextafter(v, 0.0)}, {0, 0, 0}, {0, 0, 0});
+    pair({0, 0, 0}, {200, 0, 0}, {200, 0, 0});                     // on top of each other
+    pair({0, 0, v}, {200, 0, 0}, {-200, 0, 0});                    // stacked exactly the minimum apart
+    pair({2 * h, 0, 2 * v}, {100, 0, 0}, {-100, 0, 0});            // just out of warning range
+    pair({1.5 * h, 0, 2 * v}, {100, 0, 0}, {-100, 0, 0});          // in range horizontally only
+    pair({1.5 * h, 0, 1.2 * v}, {150, 0, 0}, {150, 0, 0});         // parallel, never closing
+    pair({1.5 * h, 0, 1.2 * v}, {0, 150, 0}, {0, -150, 0});        // crossing behind
+    pair({1.5 * h, 0, 1.2 * v}, {150.05, 0, 0}, {150, 0, 0});      // all but parallel, closing slowly
+    pair({1.5 * h, 0, 1.2 * v}, {75, 0, 0}, {0, 0, 0});            // closest exactly at the lookahead
+    pair({1.5 * h, 0, 1.2 * v}, {75.0000001, 0, 0}, {0, 0, 0});    // and just inside it
+    pair({1.5 * h, 0, 1.2 * v}, {0, 0, 10}, {0, 0, -10});          // closing vertically only
+    add(scenario, {60000, 10000, 18000}, {0, 0, 0});               // alone
+    expectMatchesReference(scenario);
+
+    // Aircraft in trail on one route fly parallel legs through every turn
+    Scenario trail;
+    auto lead = add(trail, {40000, 40000, 20000}, {250, 0, 0});
+    auto follow = add(trail, {35500, 40000, 21200}, {250, 0, 0});
+    std::vector<Position> fixes = {{50000, 40000, 20000}, {50000, 60000, 21000}, {30000, 70000, 21000}};
+    route(lead, fixes, 250.0);
+    route(follow, fixes, 250.0);
+    add(trail, {50000, 75000, 21500}, {0, -250, 0});
+    expectMatchesReference(trail);
+}
+
+// Kinetic detection and divergence certificates keep state between passes,
+// so both are followed over a minute of traffic: aircraft report along their
+// lines with a little noise and up to 2 s late, take clearances, and come and
+// go. None fly routes: the trajectory cache keeps a route's prediction while
+// reports stay near it, which these reports would not.
+TEST_F(DetectionOracleTest, DetectorsMatchAsTrafficMoves) {
+    struct Line {
+        Position origin;
+        Velocity velocity;
+        double time;
+        double report_age;
+        double noise;
+    };
+    auto& registry = metrics::MetricsRegistry::getInstance();
+    double skipped = registry.value("atc_violation_pairs_certified_total");
+    for (uint32_t seed = 1; seed <= 20; ++seed) {
+        SCOPED_TRACE("seed " + std::to_string(seed));
+        std::mt19937 rng(seed);
+        auto uniform = [&rng](double low, double high) {
+            return std::uniform_real_distribution<double>(low, high)(rng);
+        };
+        Scenario scenario = randomScenario(rng, false);
+        std::vector<Line> lines;
+        for (const auto& aircraft : scenario.aircraft) {
+            AircraftState state = aircraft->getState();
+            lines.push_back({state.position, state.velocity, NOW, uniform(0.0, 2.0), rng() % 2 ? 1.0 : 10.0});
+        }
+        ViolationDetector certified;
+        ViolationDetector kinetic;
+        kinetic.setKinetic(true);
+        for (auto* detector : {&certified, &kinetic}) {
+            detector->setLookaheadTime(scenario.lookahead);
+            detector->addAircraft(scenario.aircraft);
+        }
+
+        for (int step = 0; step <= 60; ++step) {
+            double now = NOW + step;
+            sim_clock::setElapsed(std::chrono::seconds(step));
+            if (step == 30) {
+                for (auto* detector : {&certified, &kinetic}) {
+                    detector->removeAircraft(scenario.aircraft.back()->getCallsign());
+                }
+                scenario.aircraft.pop_back();
+                lines.pop_back();
+                auto arrival = add(scenario, {uniform(20000, 80000), uniform(20000, 80000), 20000},
+                                   {uniform(-300, 300), uniform(-300, 300), 0});
+                lines.push_back({arrival->getState().position, arrival->getState().velocity, now, 0.5, 1.0});
+                for (auto* detector : {&certified, &kinetic}) {
+                    detector->addAircraft(arrival);
+                }
+            }
+            for (size_t i = 0; i < scenario.aircraft.size(); ++i) {
+                const Line& line = lines[i];
+                AircraftState state = scenario.aircraft[i]->getState();
+                double time = std::max(line.time, now - line.report_age);
+                state.position = {line.origin.x + line.velocity.vx * (time - line.time) + uniform(-line.noise, line.noise),
+                                  line.origin.y + line.velocity.vy * (time - line.time) + uniform(-line.noise, line.noise),
+                                  line.origin.z + line.velocity.vz * (time - line.time) + uniform(-line.noise, line.noise)};
+                state.timestamp = time * 1000.0;
+                scenario.aircraft[i]->setState(state);
+            }
+            if (step % 3 == 1) {
+                // A clearance starts a new line from where the aircraft is
+                size_t i = rng() % scenario.aircraft.size();
+                auto& aircraft = scenario.aircraft[i];
+                switch (rng() % 3) {
+                    case 0: aircraft->updateHeading(uniform(0.0, 359.0)); break;
+                    case 1: aircraft->updateSpeed(uniform(constants::MIN_SPEED, constants::MAX_SPEED)); break;
+                    default: aircraft->updateAltitude(15000.0 + 1000.0 * (rng() % 11)); break;
+                }
+                AircraftState state = aircraft->getState();
+                lines[i] = {state.position, state.velocity, now, lines[i].report_age, lines[i].noise};
+            }
+
+            auto expected = reference::findConflicts(reference::snapshot(scenario.aircraft), now,
+                                                     scenario.lookahead);
+            SCOPED_TRACE("step " + std::to_string(step));
+            expectSameConflicts(expected, certified.findConflicts());
+            expectSameConflicts(expected, kinetic.findConflicts());
+            if (HasFailure()) return;
+        }
+    }
+    // Certificates were relied on, not just issued
+    EXPECT_GT(registry.value("atc_violation_pairs_certified_total"), skipped);
+}
+
+// Replays and audits compare detector output byte for byte, so it must not
+// depend on the order aircraft joined in or on the detection mode. That
+// includes the alerts and conflict records a periodic pass emits.
+TEST_F(DetectionOracleTest, OutputIsIdenticalWhateverTheOrderAndMode) {
+    char dir_template[] = "/tmp/atc_oracle_XXXXXX";
+    std::string directory = mkdtemp(dir_template);
+    size_t records = 0;
+    const std::vector<std::function<void(ViolationDetector&)>> modes = {
+        [](ViolationDetector&) {},
+        [](ViolationDetector& detector) { detector.setKinetic(true); },
+        [](ViolationDetector& detector) { detector.setCertificates(false); },
+    };
+    for (uint32_t seed = 1; seed <= 20; ++seed) {
+        SCOPED_TRACE("seed " + std::to_string(seed));
+        std::mt19937 rng(seed);
+        Scenario scenario = randomScenario(rng);
+        auto reversed = scenario.aircraft;
+        std::reverse(reversed.begin(), reversed.end());
+        auto shuffled = scenario.aircraft;
+        std::shuffle(shuffled.begin(), shuffled.end(), rng);
+
+        std::string expected;
+        for (const auto* order : {&scenario.aircraft, &reversed, &shuffled}) {
+            for (const auto& mode : modes) {
+                ViolationDetector detector;
+                mode(detector);
+                detector.setLookaheadTime(scenario.lookahead);
+                detector.addAircraft(*order);
+                std::string output = transcript(detector);
+
+                std::remove(history::conflictPath(directory).c_str());
+                detector.setConflictLog(std::make_shared<ConflictLog>(directory));
+                detector.startScheduled();
+                detector.runOnce();
+                output += "alerts\n" + conflictLogTranscript(directory, records);
+                if (expected.empty()) {
+                    expected = output;
+                } else {
+                    EXPECT_EQ(output, expected);
+                }
+            }
+        }
+        if (HasFailure()) break;
+    }
+    std::system(("rm -rf " + directory).c_str());
+    EXPECT_GT(records, 0u);
+}
+
+TEST_F(DetectionOracleTest, RandomScenariosMatch) {
+    for (uint32_t seed = 1; seed <= 200; ++seed) {
+        SCOPED_TRACE("seed " + std::to_string(seed));
+        std::mt19937 rng(seed);
+        expectMatchesReference(randomScenario(rng));
+        if (HasFailure()) break;   // one seed's report is enough to debug from
+    }
+}
+
+}
+}
+
+int main(int argc, char **argv) {
+    testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
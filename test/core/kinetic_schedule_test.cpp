@@ -0,0 +1,251 @@
+#include <gtest/gtest.h>
+#include "core/kinetic_schedule.h"
+#include "common/constants.h"
+#include <deque>
+#include <random>
+
+namespace atc {
+namespace test {
+
+using Pairs = std::vector<std::pair<size_t, size_t>>;
+
+class KineticScheduleTest : public ::testing::Test {
+protected:
+    // An aircraft reporting on a straight line through `position` at time 0
+    void add(const std::string& callsign, const Position& position, const Velocity& velocity) {
+        AircraftState state{};
+        state.callsign = callsign;
+        state.position = position;
+        state.velocity = velocity;
+        state.timestamp = 0.0;
+        states_.push_back(state);
+        origins_.push_back(position);
+        routed_.push_back(false);
+        intents_.push_back(0);
+    }
+
+    // Every aircraft reports where its line has it at `now`; then the due
+    // pairs are checked, none in conflict
+    Pairs pass(double now) {
+        std::vector<KineticSchedule::Track> tracks;
+        for (size_t i = 0; i < states_.size(); ++i) {
+            auto& state = states_[i];
+            state.position = {origins_[i].x + state.velocity.vx * now, origins_[i].y + state.velocity.vy * now,
+                              origins_[i].z + state.velocity.vz * now};
+            state.timestamp = now * 1000.0;
+            tracks.push_back({&state, routed_[i], intents_[i]});
+        }
+        Pairs due = schedule_.due(tracks, now, lookahead_);
+        for (const auto& [i, j] : due) {
+            schedule_.checked(i, j, false);
+        }
+        return due;
+    }
+
+    KineticSchedule schedule_;
+    std::vector<AircraftState> states_;
+    std::vector<Position> origins_;
+    std::vector<bool> routed_;
+    std::vector<uint64_t> intents_;
+    double lookahead_ = constants::DEFAULT_LOOKAHEAD_TIME;
+};
+
+TEST_F(KineticScheduleTest, FirstPassChecksEveryPairInOrder) {
+    add("AC001", {10000, 10000, 20000}, {0, 0, 0});
+    add("AC002", {50000, 10000, 20000}, {0, 0, 0});
+    add("AC003", {90000, 10000, 20000}, {0, 0, 0});
+    EXPECT_EQ(pass(0.0), (Pairs{{0, 1}, {0, 2}, {1, 2}}));
+    // Standing still far apart, nothing can change
+    EXPECT_TRUE(pass(1.0).empty());
+    EXPECT_EQ(schedule_.scheduledPairs(), 0u);
+}
+
+TEST_F(KineticScheduleTest, PairWaitsUntilItNearsAThreshold) {
+    // 20000 apart and closing at 500 units/s, 5000 apart vertically
+    add("AC001", {10000, 50000, 15000}, {250, 0, 0});
+    add("AC002", {30000, 50000, 20000}, {-250, 0, 0});
+    EXPECT_EQ(pass(0.0).size(), 1u);
+
+    // Within 2 * 3000 plus the margin for report age and drift
+    double margin = 2 * constants::KINETIC_DRIFT_TOLERANCE + 500.0 * constants::KINETIC_MAX_REPORT_AGE;
+    double entry = (20000 - 2 * constants::MIN_HORIZONTAL_SEPARATION - margin) / 500.0;
+    for (double now = 1.0; now < entry; now += 1.0) {
+        EXPECT_TRUE(pass(now).empty()) << now;
+    }
+    EXPECT_EQ(pass(std::ceil(entry)).size(), 1u);
+    // Inside the margin it is checked every pass
+    EXPECT_EQ(pass(std::ceil(entry) + 1.0).size(), 1u);
+}
+
+TEST_F(KineticScheduleTest, ClosestApproachEnteringTheWindowIsAnEvent) {
+    // Far apart on both axes, so only the lookahead window matters
+    lookahead_ = 60.0;
+    add("AC001", {10000, 50000, 15000}, {100, 0, 0});
+    add("AC002", {90000, 90000, 25000}, {-100, 0, 0});
+    pass(0.0);
+    // Closest approach at 400 s, so it enters a 60 s window at 340 s less the slack
+    EXPECT_TRUE(pass(300.0).empty());
+    EXPECT_EQ(pass(340.0).size(), 1u);
+}
+
+TEST_F(KineticScheduleTest, ConflictsAreCheckedEveryPass) {
+    add("AC001", {10000, 10000, 20000}, {0, 0, 0});
+    add("AC002", {90000, 90000, 20000}, {0, 0, 0});
+    std::vector<KineticSchedule::Track> tracks = {{&states_[0], false, 0}, {&states_[1], false, 0}};
+    ASSERT_EQ(schedule_.due(tracks, 0.0, lookahead_).size(), 1u);
+    schedule_.checked(0, 1, true);
+    EXPECT_EQ(pass(1.0).size(), 1u);
+    EXPECT_TRUE(pass(2.0).empty());
+}
+
+TEST_F(KineticScheduleTest, AircraftOffTheirLinesHaveEveryPairChecked) {
+    add("AC001", {10000, 10000, 20000}, {200, 0, 0});
+    add("AC002", {50000, 50000, 20000}, {0, 200, 0});
+    add("AC003", {90000, 10000, 16000}, {-200, 0, 0});
+    add("AC004", {10000, 90000, 24000}, {0, -200, 0});
+    pass(0.0);
+    EXPECT_TRUE(pass(1.0).empty());
+
+    // A heading clearance: new velocity and intent
+    states_[1].velocity = {200, 0, 0};
+    origins_[1] = {50000 - 200 * 2.0, 50000 + 200 * 2.0, 20000};
+    ++intents_[1];
+    EXPECT_EQ(pass(2.0), (Pairs{{0, 1}, {1, 2}, {1, 3}}));
+    EXPECT_TRUE(pass(3.0).empty());
+
+    // Drift beyond the tolerance
+    origins_[2].x += 2 * constants::KINETIC_DRIFT_TOLERANCE;
+    EXPECT_EQ(pass(4.0), (Pairs{{0, 2}, {1, 2}, {2, 3}}));
+
+    // Flying a route
+    routed_[3] = true;
+    EXPECT_EQ(pass(5.0), (Pairs{{0, 3}, {1, 3}, {2, 3}}));
+    EXPECT_EQ(pass(6.0), (Pairs{{0, 3}, {1, 3}, {2, 3}}));
+}
+
+TEST_F(KineticScheduleTest, LateReportsHaveEveryPairChecked) {
+    add("AC001", {10000, 10000, 20000}, {200, 0, 0});
+    add("AC002", {90000, 90000, 16000}, {-200, 0, 0});
+    pass(0.0);
+
+    std::vector<KineticSchedule::Track> tracks = {{&states_[0], false, 0}, {&states_[1], false, 0}};
+    // Reports from 0 s read at a pass well past the oldest age allowed
+    EXPECT_EQ(schedule_.due(tracks, 2 * constants::KINETIC_MAX_REPORT_AGE, lookahead_).size(), 1u);
+    schedule_.checked(0, 1, false);
+}
+
+TEST_F(KineticScheduleTest, DepartedAircraftAreForgotten) {
+    add("AC001", {10000, 10000, 20000}, {0, 0, 0});
+    add("AC002", {50000, 10000, 20000}, {0, 0, 0});
+    add("AC003", {90000, 10000, 20000}, {0, 0, 0});
+    pass(0.0);
+
+    // AC002 leaves and AC004 takes its place in the list
+    states_[1].callsign = "AC004";
+    EXPECT_EQ(pass(1.0), (Pairs{{0, 1}, {1, 2}}));
+    EXPECT_TRUE(pass(2.0).empty());
+}
+
+TEST_F(KineticScheduleTest, ChecksScaleWithEventsNotPairs) {
+    std::mt19937 rng(7);
+    std::uniform_real_distribution<double> coordinate(0.0, 100000.0);
+    std::uniform_real_distribution<double> speed(-350.0, 350.0);
+    for (int i = 0; i < 600; ++i) {
+        add("AC" + std::to_string(1000 + i), {coordinate(rng), coordinate(rng), 15000.0 + 2500.0 * (i % 5)},
+            {speed(rng), speed(rng), 0});
+    }
+    size_t pairs = 600 * 599 / 2;
+    EXPECT_EQ(pass(0.0).size(), pairs);
+
+    // Those near a threshold or about to be, and those whose closest approach nears the window
+    size_t checked = 0;
+    for (double now = 1.0; now <= 10.0; now += 1.0) {
+        checked += pass(now).size();
+    }
+    EXPECT_LT(checked / 10, pairs / 20);
+}
+
+class PairCertificatesTest : public ::testing::Test {
+protected:
+    // The report of an aircraft on this line at `time`
+    PairCertificates::Track report(size_t index, double time) {
+        AircraftState& state = states_[index];
+        state.position = {origins_[index].x + state.velocity.vx * time, origins_[index].y + state.velocity.vy * time,
+                          origins_[index].z + state.velocity.vz * time};
+        state.timestamp = time * 1000.0;
+        return {time, versions_[index], &state};
+    }
+
+    void add(const Position& origin, const Velocity& velocity) {
+        AircraftState state{};
+        state.velocity = velocity;
+        states_.push_back(state);
+        origins_.push_back(origin);
+        versions_.push_back(states_.size());
+    }
+
+    void certify(double time1, double time2) {
+        certificates_.certify(0, 1, report(0, time1), report(1, time2));
+    }
+
+    bool holds(double time1, double time2) {
+        return certificates_.holds(0, 1, report(0, time1), report(1, time2));
+    }
+
+    PairCertificates certificates_;
+    std::deque<AircraftState> states_;
+    std::vector<Position> origins_;
+    std::vector<uint64_t> versions_;
+};
+
+TEST_F(PairCertificatesTest, DivergingPairsHoldUntilOneManoeuvres) {
+    // Level, 10000 apart and diverging
+    add({40000, 50000, 20000}, {-250, 0, 0});
+    add({50000, 50000, 20000}, {250, 0, 0});
+    EXPECT_FALSE(holds(0.0, 0.0));
+    certify(0.0, 0.0);
+    EXPECT_TRUE(holds(1.0, 1.0));
+    EXPECT_TRUE(holds(3600.0, 3600.0));
+
+    versions_[1] = 100;
+    EXPECT_FALSE(holds(3601.0, 3601.0));
+}
+
+TEST_F(PairCertificatesTest, ClosingPairsHoldUntilNearTheMinimum) {
+    // Level, 20000 apart and closing at 500 units/s
+    add({40000, 50000, 20000}, {250, 0, 0});
+    add({60000, 50000, 20000}, {-250, 0, 0});
+    certify(0.0, 0.0);
+
+    double margin = 4 * constants::VELOCITY_LINE_TOLERANCE + 1.0 + 500.0 * constants::CERTIFICATE_MAX_REPORT_SKEW;
+    double until = (20000 - constants::MIN_HORIZONTAL_SEPARATION - margin) / 500.0;
+    EXPECT_TRUE(holds(until - 0.01, until - 0.01));
+    EXPECT_FALSE(holds(until, until));
+}
+
+TEST_F(PairCertificatesTest, PairsInWarningRangeAreNotCertified) {
+    // Far apart but 1500 apart vertically: a warning whenever the closest approach is in the window
+    add({10000, 10000, 20000}, {-250, 0, 0});
+    add({90000, 90000, 21500}, {250, 0, 0});
+    certify(0.0, 0.0);
+    EXPECT_FALSE(holds(1.0, 1.0));
+}
+
+TEST_F(PairCertificatesTest, ReportsFarApartInTimeAreNotTrusted) {
+    add({40000, 50000, 20000}, {-250, 0, 0});
+    add({50000, 50000, 20000}, {250, 0, 0});
+    certify(0.0, 2 * constants::CERTIFICATE_MAX_REPORT_SKEW);
+    EXPECT_FALSE(holds(10.0, 10.0));
+
+    certify(0.0, 0.0);
+    EXPECT_TRUE(holds(10.0, 10.0));
+    EXPECT_FALSE(holds(10.0, 10.0 + 2 * constants::CERTIFICATE_MAX_REPORT_SKEW));
+}
+
+}
+}
+
+int main(int argc, char **argv) {
+    testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
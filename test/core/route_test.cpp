@@ -0,0 +1,157 @@
+#include <gtest/gtest.h>
+#include "core/route.h"
+#include "core/aircraft.h"
+#include "core/violation_detector.h"
+#include "common/constants.h"
+
+namespace atc {
+namespace test {
+
+class RouteTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        Logger::setLevel(LogLevel::ERROR);
+        fixes_ = std::make_shared<FixDatabase>();
+    }
+
+    std::shared_ptr<const Route> makeRoute(const std::vector<Position>& waypoints, double speed) {
+        auto route = std::make_shared<Route>();
+        route->fixes = fixes_;
+        route->cruise_speed = speed;
+        for (const auto& waypoint : waypoints) {
+            route->waypoints.push_back(fixes_->intern(waypoint));
+        }
+        return route;
+    }
+
+    static AircraftState makeState(const Position& position, const Velocity& velocity) {
+        AircraftState state{};
+        state.callsign = "AC001";
+        state.position = position;
+        state.velocity = velocity;
+        state.timestamp = 1000000.0;
+        return state;
+    }
+
+    std::shared_ptr<FixDatabase> fixes_;
+};
+
+TEST_F(RouteTest, RoutesShareFixes) {
+    auto first = makeRoute({{30000, 50000, 20000}, {30000, 90000, 20000}}, 250.0);
+    auto second = makeRoute({{10000, 10000, 18000}, {30000, 90000, 20000}}, 250.0);
+    EXPECT_EQ(fixes_->size(), 3u);
+    EXPECT_EQ(first->waypoints[1], second->waypoints[1]);
+    EXPECT_EQ(fixes_->position(second->waypoints[0]).z, 18000.0);
+}
+
+TEST_F(RouteTest, TurnsAtFixesAndChangesLevel) {
+    RouteProgress progress;
+    progress.route = makeRoute({{12000, 10000, 20000}, {12000, 14000, 21000}}, 200.0);
+    auto state = makeState({10000, 10000, 20000}, {200, 0, 0});
+
+    flyRoute(state, progress, 10.0);
+    EXPECT_DOUBLE_EQ(state.position.x, 12000.0);
+    EXPECT_DOUBLE_EQ(state.position.y, 10000.0);
+
+    // Turned north at the fix and climbing toward the next fix's level
+    flyRoute(state, progress, 5.0);
+    EXPECT_DOUBLE_EQ(state.position.x, 12000.0);
+    EXPECT_DOUBLE_EQ(state.position.y, 11000.0);
+    EXPECT_DOUBLE_EQ(state.position.z, 20000.0 + 5.0 * constants::ROUTE_CLIMB_RATE);
+    EXPECT_NEAR(state.heading, 90.0, 1e-9);
+
+    // Levels off at the fix altitude, then holds the heading past the last fix
+    flyRoute(state, progress, 60.0);
+    EXPECT_DOUBLE_EQ(state.position.z, 21000.0);
+    EXPECT_NEAR(state.position.y, 14000.0 + 45.0 * 200.0, 1e-6);
+    EXPECT_EQ(progress.next_waypoint, 2u);
+}
+
+TEST_F(RouteTest, TrajectoryMatchesFlownRoute) {
+    RouteProgress progress;
+    progress.route = makeRoute({{20000, 10000, 18000}, {40000, 30000, 22000},
+                                {40000, 60000, 22000}}, 300.0);
+    auto state = makeState({10000, 10000, 20000}, {300, 0, 0});
+    auto trajectory = Trajectory::alongRoute(state, progress);
+
+    for (int step = 1; step <= 240; ++step) {
+        flyRoute(state, progress, 1.0);
+        Position expected = trajectory.positionAt(1000.0 + step);
+        ASSERT_NEAR(state.position.x, expected.x, 1e-6) << "at " << step << "s";
+        ASSERT_NEAR(state.position.y, expected.y, 1e-6) << "at " << step << "s";
+        ASSERT_NEAR(state.position.z, expected.z, 1e-6) << "at " << step << "s";
+    }
+}
+
+TEST_F(RouteTest, ClosestApproachFollowsTurns) {
+    // A turns north at (30000, 50000) after 80s into the path of B heading south
+    RouteProgress progress;
+    progress.route = makeRoute({{30000, 50000, 20000}, {30000, 90000, 20000}}, 250.0);
+    auto a = makeState({10000, 50000, 20000}, {250, 0, 0});
+    auto b = makeState({30000, 90000, 20000}, {0, -250, 0});
+
+    auto straight = closestApproach(Trajectory::straight(a), Trajectory::straight(b), 1000.0, 1180.0);
+    EXPECT_NEAR(straight.time, 1120.0, 1e-6);
+    EXPECT_NEAR(straight.distance, 10000.0 * std::sqrt(2.0), 1e-6);
+
+    auto routed = closestApproach(Trajectory::alongRoute(a, progress), Trajectory::straight(b),
+                                  1000.0, 1180.0);
+    EXPECT_NEAR(routed.time, 1120.0, 1e-6);
+    EXPECT_NEAR(routed.distance, 0.0, 1e-6);
+}
+
+TEST_F(RouteTest, DetectorPredictsConflictAlongRoute) {
+    auto route = makeRoute({{30000, 50000, 20000}, {30000, 90000, 20000}}, 250.0);
+    auto a = std::make_shared<Aircraft>("AC001", Position{10000, 50000, 20000}, Velocity{250, 0, 0});
+    auto b = std::make_shared<Aircraft>("AC002", Position{30000, 90000, 20000}, Velocity{0, -250, 0});
+    ViolationDetector detector;
+    detector.addAircraft(a);
+    detector.addAircraft(b);
+
+    EXPECT_TRUE(detector.getPredictedViolations().empty());
+
+    a->setRoute(route);
+    auto predictions = detector.getPredictedViolations();
+    ASSERT_EQ(predictions.size(), 1u);
+    EXPECT_NEAR(predictions[0].time_to_violation, 120.0, 1.0);
+    EXPECT_LT(predictions[0].min_separation, 500.0);
+
+    // A heading clearance takes the aircraft off its route
+    a->updateHeading(0.0);
+    EXPECT_TRUE(detector.getPredictedViolations().empty());
+}
+
+TEST_F(RouteTest, VelocityVersionChangesOffTheLine) {
+    auto a = std::make_shared<Aircraft>("AC001", Position{10000, 50000, 20000}, Velocity{250, 0, 0});
+    auto b = std::make_shared<Aircraft>("AC002", Position{10000, 50000, 20000}, Velocity{250, 0, 0});
+    AircraftState state;
+    uint64_t version = a->getRouteProgress(state).velocity_version;
+    EXPECT_NE(version, b->getRouteProgress(state).velocity_version);
+
+    // Reports along the line, within the tolerance
+    AircraftState start = a->getState();
+    for (double elapsed : {1.0, 2.0, 3.0}) {
+        state = start;
+        state.position.x += 250.0 * elapsed + 0.5 * constants::VELOCITY_LINE_TOLERANCE;
+        state.timestamp += elapsed * 1000.0;
+        a->setState(state);
+        EXPECT_EQ(a->getRouteProgress(state).velocity_version, version);
+    }
+
+    // A jump off the line, then a clearance
+    state = a->getState();
+    state.position.y += 2 * constants::VELOCITY_LINE_TOLERANCE;
+    a->setState(state);
+    uint64_t jumped = a->getRouteProgress(state).velocity_version;
+    EXPECT_NE(jumped, version);
+    a->updateAltitude(21000);
+    EXPECT_NE(a->getRouteProgress(state).velocity_version, jumped);
+}
+
+}
+}
+
+int main(int argc, char **argv) {
+    testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
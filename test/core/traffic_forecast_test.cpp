@@ -0,0 +1,133 @@
+#include <gtest/gtest.h>
+#include "core/traffic_forecast.h"
+#include "common/history_rollup.h"
+#include <random>
+
+namespace atc {
+namespace test {
+
+// Bin-aligned start time, in seconds
+constexpr double T0 = 600000.0;
+
+std::shared_ptr<const Trajectory> straight(const Position& position, const Velocity& velocity,
+                                           double at = T0) {
+    AircraftState state{};
+    state.position = position;
+    state.velocity = velocity;
+    state.timestamp = at * 1000.0;
+    return std::make_shared<const Trajectory>(Trajectory::straight(state));
+}
+
+TEST(TrafficForecastTest, CountsAircraftPerSectorAndBin) {
+    TrafficForecast forecast(60, 60.0, 10);
+    forecast.advance(T0);
+    // Crosses from the first sector into the next after 96 s
+    forecast.update("AC001", straight({1000, 1000, 20000}, {250, 0, 0}));
+
+    uint32_t first = history::sectorOf(1000, 1000);
+    uint32_t second = history::sectorOf(30000, 1000);
+    EXPECT_EQ(forecast.count(first, 0), 1u);
+    EXPECT_EQ(forecast.count(second, 0), 0u);
+    EXPECT_EQ(forecast.count(first, 1), 1u);
+    EXPECT_EQ(forecast.count(second, 1), 1u);
+    EXPECT_EQ(forecast.count(first, 2), 0u);
+
+    // Out of the airspace after 396 s, so nothing from bin 7 on
+    EXPECT_EQ(forecast.count(history::sectorOf(99000, 1000), 6), 1u);
+    uint32_t later = 0;
+    auto counts = forecast.counts();
+    for (size_t i = 7 * forecast.sectors(); i < counts.size(); ++i) {
+        later += counts[i];
+    }
+    EXPECT_EQ(later, 0u);
+
+    forecast.remove("AC001");
+    EXPECT_EQ(forecast.count(first, 0), 0u);
+}
+
+TEST(TrafficForecastTest, SlidingWindowAddsTheNewBin) {
+    TrafficForecast forecast(10, 60.0, 10);
+    forecast.advance(T0);
+    forecast.update("AC001", straight({1000, 1000, 20000}, {0, 0, 0}));
+    forecast.advance(T0 + 3 * 60.0 + 5.0);
+
+    uint32_t sector = history::sectorOf(1000, 1000);
+    for (size_t bin = 0; bin < forecast.bins(); ++bin) {
+        EXPECT_EQ(forecast.count(sector, bin), 1u) << "bin " << bin;
+    }
+    EXPECT_EQ(forecast.windowStart(), T0 + 3 * 60.0);
+}
+
+TEST(TrafficForecastTest, IncrementalMatchesRecomputed) {
+    std::mt19937 rng(7);
+    std::uniform_real_distribution<double> coordinate(0.0, 100000.0);
+    std::uniform_real_distribution<double> speed(-400.0, 400.0);
+    auto random_trajectory = [&](double at) {
+        return straight({coordinate(rng), coordinate(rng), 20000}, {speed(rng), speed(rng), 0}, at);
+    };
+
+    TrafficForecast incremental(30, 60.0, 5);
+    std::unordered_map<std::string, std::shared_ptr<const Trajectory>> current;
+    double now = T0;
+    incremental.advance(now);
+    for (int step = 0; step < 400; ++step) {
+        std::string callsign = "AC" + std::to_string(rng() % 40);
+        switch (rng() % 4) {
+            case 0:
+                incremental.remove(callsign);
+                current.erase(callsign);
+                break;
+            case 1:
+                now += 25.0;
+                incremental.advance(now);
+                break;
+            default: {
+                auto trajectory = random_trajectory(now);
+                incremental.update(callsign, trajectory);
+                current[callsign] = trajectory;
+                break;
+            }
+        }
+    }
+
+    TrafficForecast recomputed(30, 60.0, 5);
+    recomputed.advance(now);
+    for (const auto& entry : current) {
+        recomputed.update(entry.first, entry.second);
+    }
+    EXPECT_EQ(incremental.counts(), recomputed.counts());
+    EXPECT_EQ(incremental.aircraftCount(), current.size());
+}
+
+TEST(TrafficForecastTest, ReportsEachOverloadOnce) {
+    TrafficForecast forecast(5, 60.0, 2);
+    forecast.advance(T0);
+    forecast.update("AC001", straight({1000, 1000, 20000}, {0, 0, 0}));
+    forecast.update("AC002", straight({2000, 1000, 20000}, {0, 0, 0}));
+    EXPECT_TRUE(forecast.takeOverloads().empty());
+
+    forecast.update("AC003", straight({3000, 1000, 20000}, {0, 0, 0}));
+    auto overloads = forecast.takeOverloads();
+    ASSERT_EQ(overloads.size(), 5u);   // every bin of the window
+    EXPECT_EQ(overloads[0].sector, history::sectorOf(1000, 1000));
+    EXPECT_EQ(overloads[0].aircraft, 3u);
+    EXPECT_EQ(overloads[0].bin_start, T0);
+
+    // Still over capacity, already reported
+    forecast.update("AC003", straight({3500, 1000, 20000}, {0, 0, 0}));
+    EXPECT_TRUE(forecast.takeOverloads().empty());
+
+    // Only the bin that comes into view is new
+    forecast.advance(T0 + 60.0);
+    overloads = forecast.takeOverloads();
+    ASSERT_EQ(overloads.size(), 1u);
+    EXPECT_EQ(overloads[0].bin_start, T0 + 5 * 60.0);
+}
+
+}
+}
+
+int main(int argc, char **argv) {
+    testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
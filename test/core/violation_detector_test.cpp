@@ -0,0 +1,87 @@
+#include <gtest/gtest.h>
+#include "core/violation_detector.h"
+#include "core/aircraft.h"
+#include <chrono>
+#include <string>
+#include <vector>
+
+namespace atc {
+namespace test {
+
+// Runs on the real clock: the check budget is ignored in virtual time
+class ViolationDetectorTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        Logger::setLevel(LogLevel::ERROR);
+        detector_.startScheduled();
+    }
+
+    void add(const Position& position, const Velocity& velocity) {
+        aircraft_.push_back(std::make_shared<Aircraft>("AC" + std::to_string(100 + aircraft_.size()),
+                                                       position, velocity));
+    }
+
+    ViolationDetector::Coverage pass() {
+        detector_.runOnce();
+        return detector_.getLastCoverage();
+    }
+
+    ViolationDetector detector_;
+    std::vector<std::shared_ptr<Aircraft>> aircraft_;
+};
+
+TEST_F(ViolationDetectorTest, UnbudgetedPassChecksEveryPair) {
+    for (int i = 0; i < 10; ++i) {
+        add({10000.0 + 8000.0 * i, 50000, 20000}, {250, 0, 0});
+    }
+    detector_.setCertificates(false);
+    detector_.addAircraft(aircraft_);
+
+    auto coverage = pass();
+    EXPECT_EQ(coverage.candidates, 45u);
+    EXPECT_EQ(coverage.refreshed, 45u);
+    EXPECT_EQ(coverage.overdue_deferred, 0u);
+}
+
+TEST_F(ViolationDetectorTest, BudgetedPassesCheckMostUrgentPairsFirst) {
+    // A pair in violation, then a formation flying in parallel that can wait
+    add({50000, 50000, 23000}, {250, 0, 0});
+    add({50500, 50000, 23200}, {250, 0, 0});
+    for (int i = 0; i < 40; ++i) {
+        add({10000.0 + 7000.0 * (i % 10), 80000, 15000.0 + 2000.0 * (i / 10)}, {250, 0, 0});
+    }
+    size_t pairs = aircraft_.size() * (aircraft_.size() - 1) / 2;
+    detector_.setCertificates(false);
+    // The clock is read every 16 checks, so a tiny budget allows exactly 16
+    detector_.setCheckBudget(std::chrono::nanoseconds(1));
+    detector_.addAircraft(aircraft_);
+
+    auto coverage = pass();
+    EXPECT_EQ(coverage.candidates, pairs);
+    EXPECT_EQ(coverage.refreshed, 16u);
+    EXPECT_EQ(coverage.overdue_deferred, pairs - 16);
+    ASSERT_EQ(detector_.getCurrentViolations().size(), 1u);
+
+    // Never-checked pairs are due at once; the violating pair, due again at
+    // once, takes one of the 16 checks every pass and they get the rest
+    size_t passes = (pairs - 1 + 14) / 15;
+    for (size_t k = 2; k < passes; ++k) {
+        coverage = pass();
+        EXPECT_EQ(coverage.refreshed, 16u);
+        EXPECT_GT(coverage.overdue_deferred, 0u) << k;
+    }
+    // After that nothing deferred is overdue
+    for (int k = 0; k < 5; ++k) {
+        coverage = pass();
+        EXPECT_EQ(coverage.refreshed, 16u);
+        EXPECT_EQ(coverage.overdue_deferred, 0u) << k;
+    }
+}
+
+}
+}
+
+int main(int argc, char **argv) {
+    testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
@@ -0,0 +1,74 @@
+#include <gtest/gtest.h>
+#include "display/label_layout.h"
+
+namespace atc {
+namespace test {
+
+TEST(LabelLayoutTest, CollisionMovesToAFreeNeighbour) {
+    LabelLayout labels(10, 10);
+    auto first = labels.place(4, 4, WarningLevel::NONE);
+    EXPECT_EQ(first.x, 4);
+    EXPECT_EQ(first.y, 4);
+    EXPECT_FALSE(first.merged);
+
+    // Right first, then left
+    auto second = labels.place(4, 4, WarningLevel::EARLY);
+    EXPECT_EQ(second.x, 5);
+    EXPECT_EQ(second.y, 4);
+    EXPECT_FALSE(second.merged);
+    auto third = labels.place(4, 4, WarningLevel::NONE);
+    EXPECT_EQ(third.x, 3);
+    EXPECT_EQ(third.y, 4);
+
+    EXPECT_EQ(labels.moved(), 2);
+    EXPECT_EQ(labels.merged(), 0);
+    EXPECT_EQ(labels.count(4, 4), 1);
+    EXPECT_EQ(labels.warning(5, 4), WarningLevel::EARLY);
+}
+
+TEST(LabelLayoutTest, NeighboursOffTheGridAreSkipped) {
+    LabelLayout labels(10, 10);
+    labels.place(9, 0, WarningLevel::NONE);
+    auto moved = labels.place(9, 0, WarningLevel::NONE);
+    EXPECT_EQ(moved.x, 8);
+    EXPECT_EQ(moved.y, 0);
+}
+
+TEST(LabelLayoutTest, FullNeighbourhoodMergesWithTheHighestWarning) {
+    LabelLayout labels(10, 10);
+    // The cell and all eight neighbours
+    for (int i = 0; i < 9; ++i) {
+        EXPECT_FALSE(labels.place(4, 4, WarningLevel::EARLY).merged);
+    }
+    EXPECT_EQ(labels.moved(), 8);
+
+    auto critical = labels.place(4, 4, WarningLevel::CRITICAL);
+    EXPECT_TRUE(critical.merged);
+    EXPECT_EQ(critical.x, 4);
+    EXPECT_EQ(critical.y, 4);
+    auto medium = labels.place(4, 4, WarningLevel::MEDIUM);
+    EXPECT_TRUE(medium.merged);
+
+    // Shown as "3#" in the critical colour
+    EXPECT_EQ(labels.count(4, 4), 3);
+    EXPECT_EQ(labels.warning(4, 4), WarningLevel::CRITICAL);
+    EXPECT_EQ(labels.merged(), 2);
+}
+
+TEST(LabelLayoutTest, PredictionsNeverCoverALabel) {
+    LabelLayout labels(10, 10);
+    EXPECT_TRUE(labels.mayMarkPrediction(4, 4));
+    labels.place(4, 4, WarningLevel::CRITICAL);
+    labels.place(4, 4, WarningLevel::CRITICAL);   // moved to (5, 4)
+    EXPECT_FALSE(labels.mayMarkPrediction(4, 4));
+    EXPECT_FALSE(labels.mayMarkPrediction(5, 4));
+    EXPECT_TRUE(labels.mayMarkPrediction(3, 4));
+}
+
+}
+}
+
+int main(int argc, char **argv) {
+    testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
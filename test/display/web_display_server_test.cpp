@@ -0,0 +1,249 @@
+#include <gtest/gtest.h>
+#include "display/web_display_server.h"
+#include "common/metrics.h"
+#include <arpa/inet.h>
+#include <chrono>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <sys/time.h>
+#include <unistd.h>
+#include <string>
+#include <vector>
+
+namespace atc {
+namespace test {
+
+// Blocking local client speaking just enough HTTP and WebSocket for the tests
+class TestClient {
+public:
+    // A small receive buffer makes an idle client back up quickly
+    explicit TestClient(uint16_t port, int receive_buffer = 0) {
+        fd_ = ::socket(AF_INET, SOCK_STREAM, 0);
+        if (receive_buffer > 0) {
+            ::setsockopt(fd_, SOL_SOCKET, SO_RCVBUF, &receive_buffer, sizeof(receive_buffer));
+        }
+        sockaddr_in address{};
+        address.sin_family = AF_INET;
+        address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+        address.sin_port = htons(port);
+        connected_ = ::connect(fd_, reinterpret_cast<sockaddr*>(&address), sizeof(address)) == 0;
+        timeval timeout{5, 0};
+        ::setsockopt(fd_, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
+    }
+    ~TestClient() { ::close(fd_); }
+
+    bool isConnected() const { return connected_; }
+
+    void send(const std::string& data) {
+        ASSERT_EQ(::send(fd_, data.data(), data.size(), 0), static_cast<ssize_t>(data.size()));
+    }
+
+    // Everything up to the peer closing the connection
+    std::string readAll() {
+        std::string data;
+        char buffer[4096];
+        ssize_t n;
+        while ((n = ::recv(fd_, buffer, sizeof(buffer), 0)) > 0) {
+            data.append(buffer, static_cast<size_t>(n));
+        }
+        return data;
+    }
+
+    std::string readHeaders() {
+        std::string data;
+        char c;
+        while (data.find("\r\n\r\n") == std::string::npos && ::recv(fd_, &c, 1, 0) == 1) {
+            data.push_back(c);
+        }
+        return data;
+    }
+
+    std::string upgrade(const std::string& key = "dGhlIHNhbXBsZSBub25jZQ==") {
+        send("GET /ws HTTP/1.1\r\nHost: localhost\r\nUpgrade: websocket\r\n"
+             "Connection: Upgrade\r\nSec-WebSocket-Key: " + key +
+             "\r\nSec-WebSocket-Version: 13\r\n\r\n");
+        return readHeaders();
+    }
+
+    bool readFrame(uint8_t& opcode, std::string& payload) {
+        unsigned char header[2];
+        if (!readExact(reinterpret_cast<char*>(header), 2)) return false;
+        opcode = header[0] & 0x0F;
+        uint64_t length = header[1] & 0x7F;
+        if (length >= 126) {
+            unsigned char extended[8];
+            size_t bytes = length == 126 ? 2 : 8;
+            if (!readExact(reinterpret_cast<char*>(extended), bytes)) return false;
+            length = 0;
+            for (size_t i = 0; i < bytes; ++i) {
+                length = (length << 8) | extended[i];
+            }
+        }
+        payload.resize(static_cast<size_t>(length));
+        return readExact(&payload[0], payload.size());
+    }
+
+    bool readSnapshot(Snapshot& state) {
+        uint8_t opcode;
+        std::string payload;
+        return readFrame(opcode, payload) && opcode == 0x2 &&
+               applySnapshotDelta(state, payload.data(), payload.size());
+    }
+
+    // Client frames must be masked
+    void sendFrame(uint8_t opcode, const std::string& payload) {
+        const unsigned char mask[4] = {0x11, 0x22, 0x33, 0x44};
+        std::string frame;
+        frame.push_back(static_cast<char>(0x80 | opcode));
+        frame.push_back(static_cast<char>(0x80 | payload.size()));
+        frame.append(reinterpret_cast<const char*>(mask), 4);
+        for (size_t i = 0; i < payload.size(); ++i) {
+            frame.push_back(static_cast<char>(payload[i] ^ mask[i % 4]));
+        }
+        send(frame);
+    }
+
+private:
+    bool readExact(char* data, size_t size) {
+        size_t done = 0;
+        while (done < size) {
+            ssize_t n = ::recv(fd_, data + done, size - done, 0);
+            if (n <= 0) return false;
+            done += static_cast<size_t>(n);
+        }
+        return true;
+    }
+
+    int fd_;
+    bool connected_;
+};
+
+std::shared_ptr<const Snapshot> makeSnapshot(uint64_t sequence, size_t tracks, float offset = 0.0f) {
+    auto snapshot = std::make_shared<Snapshot>();
+    snapshot->sequence = sequence;
+    snapshot->timestamp_ms = static_cast<int64_t>(sequence) * 1000;
+    for (size_t i = 0; i < tracks; ++i) {
+        char callsign[32];
+        std::snprintf(callsign, sizeof(callsign), "TRK%05zu", i);
+        snapshot->tracks.push_back({callsign, static_cast<float>(i) + offset, 100.0f, 20000.0f,
+                                    45.0f, 250.0f, 1, 0});
+    }
+    return snapshot;
+}
+
+class WebDisplayServerTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        server_ = std::make_unique<WebDisplayServer>(0, "<html>test page</html>");
+        ASSERT_TRUE(server_->start());
+    }
+    void TearDown() override { server_->stop(); }
+
+    std::unique_ptr<WebDisplayServer> server_;
+};
+
+TEST_F(WebDisplayServerTest, ServesPageAndNotFound) {
+    TestClient page(server_->getPort());
+    ASSERT_TRUE(page.isConnected());
+    page.send("GET / HTTP/1.1\r\nHost: localhost\r\n\r\n");
+    std::string response = page.readAll();
+    EXPECT_EQ(response.rfind("HTTP/1.1 200 OK\r\n", 0), 0u);
+    EXPECT_NE(response.find("\r\n\r\n<html>test page</html>"), std::string::npos);
+
+    TestClient missing(server_->getPort());
+    missing.send("GET /missing HTTP/1.1\r\n\r\n");
+    EXPECT_EQ(missing.readAll().rfind("HTTP/1.1 404", 0), 0u);
+}
+
+TEST_F(WebDisplayServerTest, ServesMetrics) {
+    metrics::Counter requests("test_requests_total", "Requests");
+    requests.increment(2);
+
+    TestClient client(server_->getPort());
+    client.send("GET /metrics HTTP/1.1\r\nHost: localhost\r\n\r\n");
+    std::string response = client.readAll();
+    EXPECT_EQ(response.rfind("HTTP/1.1 200 OK\r\n", 0), 0u);
+    EXPECT_NE(response.find("Content-Type: text/plain; version=0.0.4"), std::string::npos);
+    EXPECT_NE(response.find("\ntest_requests_total 2\n"), std::string::npos);
+}
+
+TEST_F(WebDisplayServerTest, HandshakeUsesRfcAcceptKey) {
+    TestClient client(server_->getPort());
+    std::string headers = client.upgrade();
+    EXPECT_EQ(headers.rfind("HTTP/1.1 101", 0), 0u);
+    EXPECT_NE(headers.find("Sec-WebSocket-Accept: s3pPLMBiTxaQ9kYGzzhZRbK+xOo=\r\n"), std::string::npos);
+
+    // Pings are answered and a close is echoed
+    uint8_t opcode;
+    std::string payload;
+    client.sendFrame(0x9, "hi");
+    ASSERT_TRUE(client.readFrame(opcode, payload));
+    EXPECT_EQ(opcode, 0xA);
+    EXPECT_EQ(payload, "hi");
+    client.sendFrame(0x8, "");
+    ASSERT_TRUE(client.readFrame(opcode, payload));
+    EXPECT_EQ(opcode, 0x8);
+}
+
+TEST_F(WebDisplayServerTest, StreamsKeyFrameThenDeltas) {
+    server_->publish(makeSnapshot(1, 3));
+    TestClient client(server_->getPort());
+    client.upgrade();
+
+    Snapshot state;
+    ASSERT_TRUE(client.readSnapshot(state));
+    EXPECT_EQ(state.sequence, 1u);
+    EXPECT_EQ(state.tracks.size(), 3u);
+
+    auto next = makeSnapshot(2, 2, 0.5f);
+    server_->publish(next);
+    ASSERT_TRUE(client.readSnapshot(state));
+    EXPECT_EQ(state.sequence, 2u);
+    EXPECT_EQ(state.tracks, next->tracks);
+    EXPECT_EQ(server_->getClientCount(), 1u);
+}
+
+TEST_F(WebDisplayServerTest, SlowClientIsConflatedWithoutBlocking) {
+    TestClient slow(server_->getPort(), 16 * 1024);
+    slow.upgrade();
+    TestClient fast(server_->getPort());
+    fast.upgrade();
+
+    // Every snapshot moves all tracks, so each delta is about 40 KB
+    constexpr uint64_t SNAPSHOTS = 200;
+    Snapshot fast_state;
+    auto worst_publish = std::chrono::nanoseconds(0);
+    for (uint64_t sequence = 1; sequence <= SNAPSHOTS; ++sequence) {
+        auto snapshot = makeSnapshot(sequence, 1500, static_cast<float>(sequence));
+        auto start = std::chrono::steady_clock::now();
+        server_->publish(snapshot);
+        worst_publish = std::max(worst_publish, std::chrono::steady_clock::now() - start);
+
+        // The fast client keeps up with every snapshot, unaffected by the stalled one
+        while (fast_state.sequence < sequence) {
+            ASSERT_TRUE(fast.readSnapshot(fast_state));
+        }
+    }
+    EXPECT_EQ(fast_state.sequence, SNAPSHOTS);
+    // A blocked publish would wait on the stalled client for seconds
+    EXPECT_LT(worst_publish, std::chrono::milliseconds(50));
+
+    // The slow client catches up to the newest snapshot having skipped most of them
+    Snapshot slow_state;
+    uint64_t slow_frames = 0;
+    while (slow_state.sequence < SNAPSHOTS) {
+        ASSERT_TRUE(slow.readSnapshot(slow_state));
+        ++slow_frames;
+    }
+    EXPECT_EQ(slow_state.tracks, makeSnapshot(SNAPSHOTS, 1500, SNAPSHOTS)->tracks);
+    EXPECT_LT(slow_frames, SNAPSHOTS / 2);
+    EXPECT_GT(server_->getSnapshotsConflated(), SNAPSHOTS / 2);
+}
+
+}
+}
+
+int main(int argc, char **argv) {
+    testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}